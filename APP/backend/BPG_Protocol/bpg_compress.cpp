@@ -0,0 +1,295 @@
+#include "bpg_compress.h"
+#include <algorithm> // For std::min
+#ifdef _MSC_VER
+#include <intrin.h> // For _BitScanForward64
+#endif
+
+namespace BPG {
+
+// --- LZ4 block codec ---
+// Greedy single-pass LZ4 (the block format of lz4.org: token, literals,
+// 16-bit offset, match length). Streams decode with any LZ4 block decoder,
+// e.g. LZ4_decompress_safe. The end-of-block rules apply: the last 5 bytes
+// are literals and no match starts in the last 12 bytes.
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MF_LIMIT = 12;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr int HASH_LOG = 12; // 16 KB table: stays in L1, plenty for image rows
+constexpr size_t WILD_COPY = 8; // decoder copies in chunks of this, overshooting into free space
+
+// Copies `length` bytes in WILD_COPY chunks; the caller guarantees
+// WILD_COPY bytes of slack behind both ranges, which do not overlap
+// within a chunk. Cheaper than memcpy for the short runs LZ4 produces.
+inline void wildCopy(uint8_t* dst, const uint8_t* src, size_t length) {
+    uint8_t* const end = dst + length;
+    do {
+        std::memcpy(dst, src, WILD_COPY);
+        dst += WILD_COPY;
+        src += WILD_COPY;
+    } while (dst < end);
+}
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash4(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+// Index of the first differing byte of two 8-byte loads (diff != 0)
+inline size_t firstDifferentByte(uint64_t diff) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, diff);
+    return index >> 3;
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_clzll(diff) >> 3;
+#else
+    return __builtin_ctzll(diff) >> 3;
+#endif
+}
+
+// Length of the common run of `ip` and `match` (match < ip), ip stopping at `limit`
+inline size_t matchLength(const uint8_t* ip, const uint8_t* match, const uint8_t* limit) {
+    const uint8_t* start = ip;
+    while (ip + sizeof(uint64_t) <= limit) {
+        uint64_t diff = read64(ip) ^ read64(match);
+        if (diff) return static_cast<size_t>(ip - start) + firstDifferentByte(diff);
+        ip += sizeof(uint64_t);
+        match += sizeof(uint64_t);
+    }
+    while (ip < limit && *ip == *match) {
+        ip++;
+        match++;
+    }
+    return static_cast<size_t>(ip - start);
+}
+
+// Length bytes following the token for a field that does not fit its nibble
+inline uint8_t* writeExtraLength(uint8_t* op, size_t length) {
+    if (length < 15) return op;
+    length -= 15;
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+// Appends one sequence; match_length 0 writes the final literals-only one.
+// False if it does not fit.
+inline bool writeSequence(uint8_t*& op, const uint8_t* oend, const uint8_t* literals, size_t literal_length,
+                          size_t offset, size_t match_length) {
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    size_t worst = 1 + literal_length / 255 + 1 + literal_length + (match_length ? 2 + match_code / 255 + 1 : 0);
+    if (static_cast<size_t>(oend - op) < worst) return false;
+
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+    op = writeExtraLength(op, literal_length);
+    if (literal_length) std::memcpy(op, literals, literal_length);
+    op += literal_length;
+    if (match_length) {
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        op = writeExtraLength(op, match_code);
+    }
+    return true;
+}
+
+inline bool readExtraLength(const uint8_t*& ip, const uint8_t* iend, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip >= iend) return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+size_t lz4Compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    uint8_t* op = dst;
+    const uint8_t* const oend = dst + capacity;
+    const uint8_t* const iend = src + size;
+    const uint8_t* anchor = src;
+
+    if (size > MF_LIMIT) {
+        const uint8_t* const mflimit = iend - MF_LIMIT;
+        const uint8_t* const matchlimit = iend - LAST_LITERALS;
+        uint32_t table[1u << HASH_LOG] = {}; // input position + 1 of the last sequence per hash, 0 = none
+        const uint8_t* ip = src;
+        while (ip < mflimit) {
+            uint32_t sequence = read32(ip);
+            uint32_t& entry = table[hash4(sequence)];
+            size_t pos = static_cast<size_t>(ip - src);
+            size_t candidate = entry;
+            entry = static_cast<uint32_t>(pos + 1);
+            if (candidate == 0 || pos + 1 - candidate > MAX_DISTANCE || read32(src + candidate - 1) != sequence) {
+                // Step faster the longer nothing matched, so incompressible
+                // data costs little more than a copy
+                ip += 1 + (static_cast<size_t>(ip - anchor) >> 6);
+                continue;
+            }
+
+            const uint8_t* match = src + candidate - 1;
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+            size_t length = MIN_MATCH + matchLength(ip + MIN_MATCH, match + MIN_MATCH, matchlimit);
+            if (!writeSequence(op, oend, anchor, static_cast<size_t>(ip - anchor),
+                               static_cast<size_t>(ip - match), length)) {
+                return 0;
+            }
+            ip += length;
+            anchor = ip;
+            if (ip < mflimit) {
+                // Index a position inside the match so the next run can continue it
+                table[hash4(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src + 1);
+            }
+        }
+    }
+
+    if (!writeSequence(op, oend, anchor, static_cast<size_t>(iend - anchor), 0, 0)) return 0;
+    return static_cast<size_t>(op - dst);
+}
+
+bool lz4Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size) {
+    const uint8_t* ip = src;
+    const uint8_t* const iend = src + size;
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + raw_size;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !readExtraLength(ip, iend, literal_length)) return false;
+        if (literal_length > static_cast<size_t>(iend - ip) || literal_length > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+        if (static_cast<size_t>(iend - ip) >= literal_length + WILD_COPY &&
+            static_cast<size_t>(oend - op) >= literal_length + WILD_COPY) {
+            wildCopy(op, ip, literal_length);
+        } else if (literal_length) {
+            std::memcpy(op, ip, literal_length);
+        }
+        ip += literal_length;
+        op += literal_length;
+        if (ip == iend) break; // the last sequence has no match
+
+        if (iend - ip < 2) return false;
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+        size_t match_length = token & 15;
+        if (match_length == 15 && !readExtraLength(ip, iend, match_length)) return false;
+        match_length += MIN_MATCH;
+        if (match_length > static_cast<size_t>(oend - op)) return false;
+
+        if (offset >= WILD_COPY && static_cast<size_t>(oend - op) >= match_length + WILD_COPY) {
+            wildCopy(op, op - offset, match_length);
+        } else if (offset >= match_length) {
+            std::memcpy(op, op - offset, match_length);
+        } else if (match_length <= 2 * WILD_COPY) {
+            // Short overlapping match (typically a pixel repeated)
+            for (size_t i = 0; i < match_length; i++) op[i] = op[i - offset];
+        } else {
+            // Overlapping match: the output repeats with period `offset`.
+            // Copy whole periods, doubling them as the repeated run grows.
+            size_t period = offset;
+            size_t done = 0;
+            while (done < match_length) {
+                size_t n = std::min(period, match_length - done);
+                std::memcpy(op + done, op + done - period, n);
+                done += n;
+                while (period * 2 <= done + offset) period *= 2;
+            }
+        }
+        op += match_length;
+    }
+    return op == oend;
+}
+
+// --- Encoding ---
+BpgError encodeCompressed(const AppPacket& packet, const CodecTable& codecs, BufferWriter& writer) {
+    if (!packet.content) return packet.encode(writer);
+    const HybridData* data = packet.content.get();
+    size_t raw_size = data->calculateEncodedSize() - sizeof(uint32_t) - data->metadata_str.length();
+    Codec codec = codecs.codecFor(packet.tl, raw_size);
+    if (codec != Codec::Lz4 || raw_size == 0) return packet.encode(writer);
+
+    // The codec needs the raw binary in one piece
+    const uint8_t* raw = nullptr;
+    if (data->internal_binary_bytes.size() == raw_size) {
+        raw = data->internal_binary_bytes.data();
+    } else if (data->external_binary_bytes.size() == raw_size) {
+        raw = data->external_binary_bytes.data();
+    } else {
+        static thread_local std::vector<uint8_t> staged; // keeps its capacity across packets
+        staged.resize(raw_size);
+        BufferWriter staging(staged.data(), staged.size());
+        BpgError err = data->encode_binary_to(staging);
+        if (err != BpgError::Success) return err;
+        raw = staged.data();
+        raw_size = staging.size();
+    }
+
+    uint32_t prop = packet.is_end_of_group ? BPG_PROP_EG_BIT_MASK : 0;
+    if (data->metadata_is_binary) prop |= BPG_PROP_BIN_META_BIT_MASK;
+    size_t packet_start = writer.size();
+    bool compressed = false;
+    BpgError err = AppPacket::s_encode_with(
+        packet.group_id, packet.target_id, packet.tl, prop,
+        static_cast<uint32_t>(data->metadata_str.length()), data->metadata_str.data(), writer,
+        [&](BufferWriter& binary_writer) {
+            size_t binary_start = binary_writer.size();
+            // Only a stream smaller than the raw bytes is worth sending
+            size_t limit = std::min(BPG_COMPRESSED_PREFIX_SIZE + lz4CompressBound(raw_size), raw_size - 1);
+            size_t room = std::min(binary_writer.remaining(), limit);
+            if (room > BPG_COMPRESSED_PREFIX_SIZE) {
+                uint8_t* dst = binary_writer.claim_space(room);
+                size_t stream_size = lz4Compress(raw, raw_size, dst + BPG_COMPRESSED_PREFIX_SIZE,
+                                                 room - BPG_COMPRESSED_PREFIX_SIZE);
+                if (stream_size) {
+                    uint32_t raw_size_n = htonl(static_cast<uint32_t>(raw_size));
+                    std::memcpy(dst, &raw_size_n, sizeof(raw_size_n));
+                    binary_writer.rewind_to(binary_start + BPG_COMPRESSED_PREFIX_SIZE + stream_size);
+                    compressed = true;
+                    return BpgError::Success;
+                }
+                binary_writer.rewind_to(binary_start);
+            }
+            return binary_writer.append(raw, raw_size) ? BpgError::Success : BpgError::BufferTooSmall;
+        });
+    if (err == BpgError::Success && compressed) {
+        writer.patch_uint32_network(packet_start + BPG_FRAME_PREFIX_SIZE + sizeof(PacketType),
+                                    prop | codecProp(codec));
+    }
+    return err;
+}
+
+BpgError encodeGroup(const AppPacketGroup& group, const CodecTable& codecs, BufferWriter& writer) {
+    size_t group_start = writer.size();
+    for (const AppPacket& packet : group) {
+        BpgError err = encodeCompressed(packet, codecs, writer);
+        if (err != BpgError::Success) {
+            writer.rewind_to(group_start);
+            return err;
+        }
+    }
+    return BpgError::Success;
+}
+
+} // namespace BPG
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "bpg_types.h"
+
+namespace BPG {
+
+// --- Payload compression ---
+// A packet whose prop has BPG_PROP_COMPRESSED_BIT_MASK set carries its binary
+// part as [raw_size 4 BE][codec stream]; the codec id sits in prop bits
+// 16..23. Metadata is never compressed. The encoder only sets the bit when
+// the stream is smaller than the raw bytes, so a reader may see either form
+// for the same TL.
+constexpr uint32_t BPG_PROP_COMPRESSED_BIT_MASK = 0x00000004;
+constexpr uint32_t BPG_PROP_CODEC_SHIFT = 16;
+constexpr uint32_t BPG_PROP_CODEC_MASK = 0x00ff0000;
+constexpr size_t BPG_COMPRESSED_PREFIX_SIZE = sizeof(uint32_t); // raw_size
+
+enum class Codec : uint8_t {
+    None = 0,
+    Lz4 = 1,   // LZ4 block format (no frame header), implemented in bpg_compress.cpp
+};
+
+inline Codec codecFromProp(uint32_t prop) {
+    return (prop & BPG_PROP_COMPRESSED_BIT_MASK)
+        ? static_cast<Codec>((prop & BPG_PROP_CODEC_MASK) >> BPG_PROP_CODEC_SHIFT)
+        : Codec::None;
+}
+
+inline uint32_t codecProp(Codec codec) {
+    return BPG_PROP_COMPRESSED_BIT_MASK | (static_cast<uint32_t>(codec) << BPG_PROP_CODEC_SHIFT);
+}
+
+// Worst-case LZ4 output for `size` input bytes
+inline size_t lz4CompressBound(size_t size) { return size + size / 255 + 16; }
+
+// Compresses `src` into `dst` as one LZ4 block. Returns the compressed size,
+// or 0 if it does not fit in `capacity`.
+size_t lz4Compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+// Decompresses one LZ4 block that must expand to exactly `raw_size` bytes.
+// Never reads or writes out of bounds; false on a malformed block.
+bool lz4Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size);
+
+// Largest raw_size a codec stream of `size` bytes can legitimately claim,
+// so a corrupt header cannot make the decoder allocate gigabytes
+inline size_t maxInflatedSize(Codec codec, size_t size) {
+    return codec == Codec::Lz4 ? size * 255 + 16 : 0;
+}
+
+// Which codec the encoder uses per packet type. Binaries below `min_size`
+// are sent raw: the prefix and the codec call would cost more than they save.
+class CodecTable {
+public:
+    void set(const PacketType tl, Codec codec, size_t min_size = 4096) {
+        for (Entry& entry : entries_) {
+            if (std::memcmp(entry.tl, tl, sizeof(PacketType)) == 0) {
+                entry.codec = codec;
+                entry.min_size = min_size;
+                return;
+            }
+        }
+        Entry entry;
+        std::memcpy(entry.tl, tl, sizeof(PacketType));
+        entry.codec = codec;
+        entry.min_size = min_size;
+        entries_.push_back(entry);
+    }
+
+    Codec codecFor(const PacketType tl, size_t binary_size) const {
+        for (const Entry& entry : entries_) {
+            if (std::memcmp(entry.tl, tl, sizeof(PacketType)) == 0) {
+                return binary_size >= entry.min_size ? entry.codec : Codec::None;
+            }
+        }
+        return Codec::None;
+    }
+
+    bool empty() const { return entries_.empty(); }
+
+private:
+    struct Entry {
+        PacketType tl;
+        Codec codec;
+        size_t min_size;
+    };
+    std::vector<Entry> entries_; // a handful of TLs: a linear scan beats hashing
+};
+
+// Encodes `packet`, compressing its binary part with the codec `codecs`
+// picks for its TL. The codec writes straight into `writer`; a binary the
+// codec cannot shrink is written raw. A subclass that produces its binary in
+// encode_binary_to() is staged once in a per-thread scratch buffer first.
+BpgError encodeCompressed(const AppPacket& packet, const CodecTable& codecs, BufferWriter& writer);
+
+// encodeGroup() with encodeCompressed() per packet
+BpgError encodeGroup(const AppPacketGroup& group, const CodecTable& codecs, BufferWriter& writer);
+
+} // namespace BPG
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "bpg_types.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace BPG {
+
+// Recycles the HybridData objects the decoder hands out. acquire() returns an
+// ordinary std::shared_ptr<HybridData>, but both the object and the
+// shared_ptr control block come from free lists: when the last reference
+// drops, the object goes back to the pool with its string/vector capacity
+// intact, so steady-state decoding does not touch the heap.
+//
+// Thread safe: packets may be released on any thread, and may outlive the
+// decoder (every outstanding pointer keeps the pool alive).
+class HybridDataPool : public std::enable_shared_from_this<HybridDataPool> {
+public:
+    static constexpr size_t MAX_FREE_OBJECTS = 256;
+    static constexpr size_t CONTROL_BLOCK_SIZE = 128;
+
+    static std::shared_ptr<HybridDataPool> create(size_t max_retained_bytes = 64 * 1024 * 1024) {
+        return std::shared_ptr<HybridDataPool>(new HybridDataPool(max_retained_bytes));
+    }
+
+    ~HybridDataPool() {
+        for (HybridData* data : free_data_) delete data;
+        for (void* block : free_blocks_) ::operator delete(block);
+    }
+
+    HybridDataPool(const HybridDataPool&) = delete;
+    HybridDataPool& operator=(const HybridDataPool&) = delete;
+
+    // Returns an empty HybridData (metadata and binary cleared)
+    std::shared_ptr<HybridData> acquire() {
+        HybridData* data = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_data_.empty()) {
+                data = free_data_.back();
+                free_data_.pop_back();
+                retained_bytes_ -= retainedSize(data);
+                hits_++;
+            }
+        }
+        if (!data) {
+            data = new HybridData();
+            misses_++;
+        }
+        std::shared_ptr<HybridDataPool> self = shared_from_this();
+        return std::shared_ptr<HybridData>(data, Recycler{self}, BlockAllocator<HybridData>(self));
+    }
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    explicit HybridDataPool(size_t max_retained_bytes)
+        : max_retained_bytes_(max_retained_bytes) {
+        free_data_.reserve(MAX_FREE_OBJECTS);
+        free_blocks_.reserve(MAX_FREE_OBJECTS);
+    }
+
+    struct Recycler {
+        std::shared_ptr<HybridDataPool> pool;
+        void operator()(HybridData* data) const { pool->recycle(data); }
+    };
+
+    // Serves the shared_ptr control block allocation from the pool
+    template <typename T>
+    struct BlockAllocator {
+        using value_type = T;
+        std::shared_ptr<HybridDataPool> pool;
+
+        explicit BlockAllocator(std::shared_ptr<HybridDataPool> p) : pool(std::move(p)) {}
+        template <typename U>
+        BlockAllocator(const BlockAllocator<U>& other) : pool(other.pool) {}
+
+        T* allocate(size_t n) {
+            if (n != 1 || sizeof(T) > CONTROL_BLOCK_SIZE) {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T*>(pool->allocateBlock());
+        }
+        void deallocate(T* p, size_t n) {
+            if (n != 1 || sizeof(T) > CONTROL_BLOCK_SIZE) {
+                ::operator delete(p);
+                return;
+            }
+            pool->deallocateBlock(p);
+        }
+
+        template <typename U>
+        bool operator==(const BlockAllocator<U>& other) const { return pool == other.pool; }
+        template <typename U>
+        bool operator!=(const BlockAllocator<U>& other) const { return pool != other.pool; }
+    };
+
+    static size_t retainedSize(const HybridData* data) {
+        return data->metadata_str.capacity() + data->internal_binary_bytes.capacity();
+    }
+
+    void recycle(HybridData* data) {
+        data->metadata_str.clear();
+        data->internal_binary_bytes.clear();
+        data->external_binary_bytes = BufferWriter(nullptr, 0);
+        size_t size = retainedSize(data);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_data_.size() < MAX_FREE_OBJECTS && retained_bytes_ + size <= max_retained_bytes_) {
+                free_data_.push_back(data);
+                retained_bytes_ += size;
+                return;
+            }
+        }
+        delete data;
+    }
+
+    void* allocateBlock() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_blocks_.empty()) {
+                void* block = free_blocks_.back();
+                free_blocks_.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(CONTROL_BLOCK_SIZE);
+    }
+
+    void deallocateBlock(void* block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_blocks_.size() < MAX_FREE_OBJECTS) {
+                free_blocks_.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+    std::mutex mutex_;
+    std::vector<HybridData*> free_data_;
+    std::vector<void*> free_blocks_;
+    size_t max_retained_bytes_;
+    size_t retained_bytes_ = 0;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace BPG
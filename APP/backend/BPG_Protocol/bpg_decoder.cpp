@@ -9,22 +9,43 @@
 #endif
 #include <iostream> // For potential debug output
 #include <algorithm> // For std::copy, std::copy_n, std::min
-#include <iterator> // For std::make_move_iterator, std::next
 #include <iomanip> // For std::setw, std::setfill
-#include <vector> // For temporary contiguous buffer
+#include <vector>
 
 namespace BPG {
 
 // --- Forward Declarations for new helpers ---
 static bool parseHeaderFromBuffer(const uint8_t* buffer_start, size_t buffer_len, PacketHeader& out_header);
-static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridData& out_data);
+static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridDataView& out_view);
 // ---
 
-BpgDecoder::BpgDecoder() = default;
+// Bytes of a frame that tell whether its binary is forwarded and where it
+// starts: the wire header and the str_length field
+static constexpr size_t FORWARD_PROBE_SIZE = BPG_WIRE_HEADER_SIZE + sizeof(uint32_t);
+
+static void setViewHeader(AppPacketView& view, const PacketHeader& header) {
+    view.group_id = header.group_id;
+    view.target_id = header.target_id;
+    std::memcpy(view.tl, header.tl, sizeof(PacketType));
+    // Check the EG bit from the uint32_t prop field
+    view.is_end_of_group = (header.prop & BPG_PROP_EG_BIT_MASK) != 0;
+    view.content.metadata_is_binary = (header.prop & BPG_PROP_BIN_META_BIT_MASK) != 0;
+}
+
+BpgDecoder::BpgDecoder() : data_pool_(HybridDataPool::create()) {}
 
 void BpgDecoder::reset() {
-    internal_buffer_.clear();
+    abandonForward();
+    forward_declined_ = false;
+    buffer_.clear();
+    read_pos_ = 0;
     active_groups_.clear();
+    active_view_groups_.forEach([this](uint32_t, ViewGroup& group) {
+        for (uint32_t pin_id : group.pins) release(pin_id);
+    });
+    active_view_groups_.clear();
+    group_ages_.clear();
+    views_pending_ = false;
     std::cout << "BPG Decoder reset." << std::endl;
 }
 
@@ -58,7 +79,8 @@ static bool parseHeaderFromBuffer(const uint8_t* buffer_start, size_t buffer_len
 }
 
 // --- New Helper: Parse Data from contiguous buffer ---
-static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridData& out_data) {
+// Locates metadata and binary inside the payload without copying them
+static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridDataView& out_view) {
      if (!data_start) {
          std::cerr << "[BPG Decode ERR] parseDataFromBuffer called with null data_start for TL: " << std::string(header.tl, 2) << std::endl;
          return BpgError::DecodingError; 
@@ -97,162 +119,641 @@ static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* d
         return BpgError::DecodingError;
     }
 
-    // 2. Read metadata string
-    out_data.metadata_str.clear();
+    // 2. Metadata string
+    out_view.metadata = std::string_view();
     if (str_len > 0) {
         if (current_ptr + str_len > data_end) {
              std::cerr << "[BPG Decode ERR] Incomplete metadata string data for TL: " << std::string(header.tl, 2) << std::endl;
              return BpgError::IncompletePacket;
         }
-        out_data.metadata_str.assign(reinterpret_cast<const char*>(current_ptr), str_len);
+        out_view.metadata = std::string_view(reinterpret_cast<const char*>(current_ptr), str_len);
         current_ptr += str_len;
     }
 
-    // 3. Read remaining binary bytes
-    out_data.internal_binary_bytes.clear();
+    // 3. Remaining binary bytes
+    out_view.binary = ByteSpan();
     size_t binary_bytes_len = header.data_length - STR_LENGTH_SIZE - str_len;
      if (binary_bytes_len > 0) {
         if (current_ptr + binary_bytes_len > data_end) {
             std::cerr << "[BPG Decode ERR] Incomplete Binary data for TL: " << std::string(header.tl, 2) << std::endl;
              return BpgError::IncompletePacket;
         }
-        out_data.internal_binary_bytes.assign(current_ptr, current_ptr + binary_bytes_len);
+        out_view.binary.data = current_ptr;
+        out_view.binary.size = binary_bytes_len;
     }
 
     return BpgError::Success;
 }
 
-// --- Refactored tryParsePacket ---
-bool BpgDecoder::tryParsePacket(std::deque<uint8_t>& buffer,
-                            const AppPacketCallback& packet_callback,
-                            const AppPacketGroupCallback& group_callback) {
-    // --- Step 1: Frame magic + inner header --- 
-    if (buffer.size() < BPG_FRAME_PREFIX_SIZE) {
-        return false;
+// --- Staging buffer ---
+void BpgDecoder::compactBuffer() {
+    size_t live = buffered();
+    if (read_pos_ == 0) return;
+    if (live > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + read_pos_, live);
+        stats_.bytes_copied += live;
+    }
+    buffer_.resize(live);
+    read_pos_ = 0;
+}
+
+void BpgDecoder::appendToBuffer(const uint8_t* data, size_t len) {
+    if (len == 0) return;
+    // Reclaim the consumed prefix before the vector would reallocate
+    if (read_pos_ > 0 && (buffered() == 0 || buffer_.size() + len > buffer_.capacity())) {
+        compactBuffer();
+    }
+    buffer_.insert(buffer_.end(), data, data + len);
+    stats_.bytes_copied += len;
+}
+
+size_t BpgDecoder::bytesNeeded() const {
+    size_t have = buffered();
+    if (have < BPG_FRAME_PREFIX_SIZE) {
+        // Only complete the magic first, so a false candidate is dropped
+        // without dragging more input through the staging buffer
+        return BPG_FRAME_PREFIX_SIZE - have;
     }
     uint32_t magic_n;
-    std::memcpy(&magic_n, &buffer[0], sizeof(magic_n));
-    if (ntohl(magic_n) != BPG_FRAME_MAGIC) {
-        buffer.erase(buffer.begin());
-        return true; // resync one byte at a time
+    std::memcpy(&magic_n, buffer_.data() + read_pos_, sizeof(magic_n));
+    if (ntohl(magic_n) != BPG_FRAME_MAGIC) return 0; // parseFrames resyncs first
+    if (have < BPG_WIRE_HEADER_SIZE) {
+        return BPG_WIRE_HEADER_SIZE - have;
+    }
+    uint32_t data_length_n;
+    std::memcpy(&data_length_n, buffer_.data() + read_pos_ + BPG_WIRE_HEADER_SIZE - sizeof(uint32_t), sizeof(data_length_n));
+    size_t total_packet_size = BPG_WIRE_HEADER_SIZE + ntohl(data_length_n);
+    if (forwarding_ && !forward_declined_) {
+        // Stage only the head of a forwarded packet; beginForward() takes over at 0
+        size_t probe = std::min(FORWARD_PROBE_SIZE, total_packet_size);
+        if (have < probe) return probe - have;
+        size_t head = forwardHeadSize(buffer_.data() + read_pos_, have);
+        if (head) return head > have ? head - have : 0;
     }
+    return total_packet_size > have ? total_packet_size - have : 0;
+}
 
-    if (buffer.size() < BPG_WIRE_HEADER_SIZE) {
-        return false;
+// Offset of the next byte in [from, len) that can start a frame, or len.
+// memchr finds candidates for the first magic byte (vectorized in libc);
+// only those get the full 4-byte compare. A candidate too close to the end
+// to compare is returned as is, so the caller stages it.
+static size_t findFrameCandidate(const uint8_t* data, size_t len, size_t from) {
+    const uint8_t first_byte = static_cast<uint8_t>(BPG_FRAME_MAGIC >> 24);
+    const uint32_t magic_n = htonl(BPG_FRAME_MAGIC);
+    while (from < len) {
+        size_t pos = from;
+        if (data[pos] != first_byte) { // runs of the first byte skip the call
+            const void* hit = std::memchr(data + pos, first_byte, len - pos);
+            if (!hit) return len;
+            pos = static_cast<const uint8_t*>(hit) - data;
+        }
+        if (len - pos < BPG_FRAME_PREFIX_SIZE) {
+            if (std::memcmp(data + pos, &magic_n, len - pos) == 0) return pos;
+        } else {
+            uint32_t word;
+            std::memcpy(&word, data + pos, sizeof(word));
+            if (word == magic_n) return pos;
+        }
+        from = pos + 1;
     }
+    return len;
+}
 
-    // --- Step 2: Peek inner header (after magic) to get data_length --- 
-    uint8_t header_peek_bytes[BPG_HEADER_SIZE];
-    std::copy_n(std::next(buffer.begin(), static_cast<std::ptrdiff_t>(BPG_FRAME_PREFIX_SIZE)),
-                BPG_HEADER_SIZE,
-                header_peek_bytes);
-    PacketHeader peek_header;
-    if (!parseHeaderFromBuffer(header_peek_bytes, BPG_HEADER_SIZE, peek_header)) {
-         std::cerr << "[BPG Decode ERR] Header peek failed during parseHeaderFromBuffer." << std::endl;
-         reset();
-         return false;
+bool BpgDecoder::stagedMagicContinues(const uint8_t* data, size_t len) {
+    // Staged bytes plus the head of the input, enough to test every staged
+    // offset against the full magic
+    uint8_t probe[2 * BPG_FRAME_PREFIX_SIZE];
+    size_t staged = buffered();
+    size_t from_input = std::min(len, BPG_FRAME_PREFIX_SIZE - 1);
+    std::memcpy(probe, buffer_.data() + read_pos_, staged);
+    std::memcpy(probe + staged, data, from_input);
+    size_t pos = findFrameCandidate(probe, staged + from_input, 0);
+    if (pos >= staged) return false;
+    stats_.bytes_discarded += pos;
+    read_pos_ += pos;
+    return true;
+}
+
+// --- Frame parsing (in place) ---
+size_t BpgDecoder::parseFrames(const uint8_t* data, size_t len, const Sinks& sinks) {
+    size_t offset = 0;
+    while (len - offset >= BPG_FRAME_PREFIX_SIZE) {
+        const uint8_t* frame = data + offset;
+        uint32_t magic_n;
+        std::memcpy(&magic_n, frame, sizeof(magic_n));
+        if (ntohl(magic_n) != BPG_FRAME_MAGIC) {
+            size_t next = findFrameCandidate(data, len, offset + 1);
+            stats_.bytes_discarded += next - offset;
+            offset = next;
+            continue;
+        }
+
+        if (len - offset < BPG_WIRE_HEADER_SIZE) {
+            break;
+        }
+
+        PacketHeader header;
+        if (!parseHeaderFromBuffer(frame + BPG_FRAME_PREFIX_SIZE, BPG_HEADER_SIZE, header)) {
+            std::cerr << "[BPG Decode ERR] Header parse failed." << std::endl;
+            offset++;
+            continue;
+        }
+        size_t total_packet_size = BPG_WIRE_HEADER_SIZE + static_cast<size_t>(header.data_length);
+        if (len - offset < total_packet_size) {
+            break;
+        }
+
+        AppPacketView view;
+        BpgError data_err = parseDataFromBuffer(header, frame + BPG_WIRE_HEADER_SIZE, view.content);
+        offset += total_packet_size;
+
+        if (data_err == BpgError::Success) {
+            setViewHeader(view, header);
+            Codec codec = codecFromProp(header.prop);
+            uint8_t* forward_dst = nullptr;
+            if ((sinks.view_packet || sinks.view_group) && forwarding_ && codec == Codec::None &&
+                !view.content.binary.empty() &&
+                std::memcmp(view.tl, forward_tl_, sizeof(PacketType)) == 0) {
+                forward_dst = reserveForward(view, view.content.binary.size);
+            }
+            if (forward_dst) {
+                // The one copy of a forwarded binary, straight from the input
+                std::memcpy(forward_dst, view.content.binary.data, view.content.binary.size);
+                stats_.bytes_copied += view.content.binary.size;
+                stats_.bytes_forwarded += view.content.binary.size;
+                view.content.binary.data = forward_dst;
+                deliverForwarded(view, sinks);
+            } else if (sinks.view_packet || sinks.view_group) {
+                if (codec == Codec::None) {
+                    dispatchView(view, sinks);
+                } else {
+                    dispatchInflated(view, codec, sinks);
+                }
+            } else {
+                dispatchPacket(view, codec, sinks);
+            }
+        } else {
+            std::cerr << "BPG Decoder: Error deserializing app data for packet type "
+                      << std::string(header.tl, 2) << " (Error code: " << static_cast<int>(data_err) << ")" << std::endl;
+        }
     }
-    uint32_t data_length = peek_header.data_length;
-    size_t total_packet_size = BPG_WIRE_HEADER_SIZE + data_length;
+    if (offset < len && len - offset < BPG_FRAME_PREFIX_SIZE) {
+        // Do not stage a short tail that cannot begin a frame
+        size_t next = findFrameCandidate(data, len, offset);
+        stats_.bytes_discarded += next - offset;
+        offset = next;
+    }
+    return offset;
+}
 
-    // --- Step 3: Enough data for full packet --- 
-    if (buffer.size() < total_packet_size) {
-        return false;
+void BpgDecoder::dispatchPacket(const AppPacketView& view, Codec codec, const Sinks& sinks) {
+    std::shared_ptr<HybridData> hybrid_data = data_pool_->acquire();
+    if (codec == Codec::None) {
+        hybrid_data->internal_binary_bytes.assign(view.content.binary.begin(), view.content.binary.end());
+        stats_.bytes_copied += view.content.binary.size;
+    } else if (!inflateBinary(view, codec, hybrid_data->internal_binary_bytes, 0)) {
+        return; // dropped, the HybridData goes back to the pool
     }
+    hybrid_data->metadata_str.assign(view.content.metadata.data(), view.content.metadata.size());
+    hybrid_data->metadata_is_binary = view.content.metadata_is_binary;
+    stats_.bytes_copied += view.content.metadata.size();
+
+    AppPacket app_packet;
+    app_packet.group_id = view.group_id;
+    app_packet.target_id = view.target_id;
+    std::memcpy(app_packet.tl, view.tl, sizeof(PacketType));
+    app_packet.is_end_of_group = view.is_end_of_group;
+    app_packet.content = std::move(hybrid_data);
+
+    AppPacketGroup& group = active_groups_.findOrInsert(view.group_id);
+    if (group.empty() && !view.is_end_of_group) noteGroupStarted(view.group_id);
+    group.push_back(std::move(app_packet));
+
+    if (sinks.packet && *sinks.packet) {
+        try { (*sinks.packet)(group.back()); } catch(const std::exception& e) {
+             std::cerr << "[BPG ERR] Exception in packet_callback: " << e.what() << std::endl;
+         } catch(...) { std::cerr << "[BPG ERR] Unknown exception in packet_callback" << std::endl; }
+    }
+
+    if (view.is_end_of_group) {
+        if (sinks.group && *sinks.group) {
+            // A callback that moves the group out takes its storage with it;
+            // one that only reads it leaves the vector to be recycled.
+            AppPacketGroup* finished = active_groups_.find(view.group_id);
+            try { (*sinks.group)(view.group_id, std::move(*finished)); } catch(const std::exception& e) {
+                 std::cerr << "[BPG ERR] Exception in group_callback: " << e.what() << std::endl;
+             } catch(...) { std::cerr << "[BPG ERR] Unknown exception in group_callback" << std::endl; }
+        }
+        active_groups_.erase(view.group_id);
+        group_ages_.erase(view.group_id);
+    }
+}
 
-    // --- Step 4: Copy full packet --- 
-    std::vector<uint8_t> temp_packet_buffer(total_packet_size);
-    std::copy_n(buffer.begin(), total_packet_size, temp_packet_buffer.begin());
+void BpgDecoder::dispatchView(const AppPacketView& view, const Sinks& sinks) {
+    if (sinks.view_packet && *sinks.view_packet) {
+        try { (*sinks.view_packet)(view); } catch(const std::exception& e) {
+             std::cerr << "[BPG ERR] Exception in packet_callback: " << e.what() << std::endl;
+         } catch(...) { std::cerr << "[BPG ERR] Unknown exception in packet_callback" << std::endl; }
+    }
+    addViewToGroup(view, sinks);
+}
 
-    // --- Step 5: Parse inner header + payload --- 
-    PacketHeader header;
-    HybridData hybrid_data;
+void BpgDecoder::addViewToGroup(const AppPacketView& view, const Sinks& sinks) {
+    if (!sinks.view_group || !*sinks.view_group) return;
 
-    if (!parseHeaderFromBuffer(temp_packet_buffer.data() + BPG_FRAME_PREFIX_SIZE, BPG_HEADER_SIZE, header)) {
-         std::cerr << "[BPG Decode ERR] Header parse failed on temp buffer." << std::endl;
-         buffer.erase(buffer.begin(), buffer.begin() + total_packet_size);
-         return true;
+    if (!view.is_end_of_group) {
+        ViewGroup& group = active_view_groups_.findOrInsert(view.group_id);
+        if (group.packets.empty()) noteGroupStarted(view.group_id);
+        group.packets.push_back(view);
+        views_pending_ = true;
+        return;
     }
-    if (header.data_length != data_length) {
-         std::cerr << "[BPG Decode ERR] Peeked data length (" << data_length
-                   << ") != Parsed data length (" << header.data_length << "). Corrupted header? Discarding." << std::endl;
-         buffer.erase(buffer.begin(), buffer.begin() + total_packet_size);
-         return true;
+
+    ViewGroup* group = active_view_groups_.find(view.group_id);
+    if (!group) {
+        // Single-packet group: nothing buffered, deliver the view directly
+        try { (*sinks.view_group)(view.group_id, &view, 1); } catch(const std::exception& e) {
+             std::cerr << "[BPG ERR] Exception in group_callback: " << e.what() << std::endl;
+         } catch(...) { std::cerr << "[BPG ERR] Unknown exception in group_callback" << std::endl; }
+        return;
     }
 
-    BpgError data_err = parseDataFromBuffer(header, temp_packet_buffer.data() + BPG_WIRE_HEADER_SIZE, hybrid_data);
+    group->packets.push_back(view);
+    try { (*sinks.view_group)(view.group_id, group->packets.data(), group->packets.size()); } catch(const std::exception& e) {
+         std::cerr << "[BPG ERR] Exception in group_callback: " << e.what() << std::endl;
+     } catch(...) { std::cerr << "[BPG ERR] Unknown exception in group_callback" << std::endl; }
+    // Slots the callback took over through pin() stay alive
+    for (uint32_t pin_id : group->pins) {
+        if (!pins_[pin_id - 1].user_owned) release(pin_id);
+    }
+    active_view_groups_.erase(view.group_id);
+    group_ages_.erase(view.group_id);
+}
 
-    // --- Step 6: Consume data from the main deque buffer --- 
-    buffer.erase(buffer.begin(), buffer.begin() + total_packet_size);
+// --- Decompression ---
+bool BpgDecoder::inflateBinary(const AppPacketView& view, Codec codec, std::vector<uint8_t>& out, size_t at) {
+    const ByteSpan& stored = view.content.binary;
+    if (stored.size < BPG_COMPRESSED_PREFIX_SIZE) {
+        std::cerr << "[BPG Decode ERR] Compressed binary too short for TL: " << std::string(view.tl, 2) << std::endl;
+        return false;
+    }
+    uint32_t raw_size_n;
+    std::memcpy(&raw_size_n, stored.data, sizeof(raw_size_n));
+    size_t raw_size = ntohl(raw_size_n);
+    size_t stream_size = stored.size - BPG_COMPRESSED_PREFIX_SIZE;
+    if (codec != Codec::Lz4) {
+        std::cerr << "[BPG Decode ERR] Unknown codec " << static_cast<int>(codec)
+                  << " for TL: " << std::string(view.tl, 2) << std::endl;
+        return false;
+    }
+    if (raw_size == 0 || raw_size > maxInflatedSize(codec, stream_size)) {
+        std::cerr << "[BPG Decode ERR] Implausible raw size " << raw_size << " for a " << stream_size
+                  << " byte stream, TL: " << std::string(view.tl, 2) << std::endl;
+        return false;
+    }
+    out.resize(at + raw_size); // keeps capacity from earlier packets
+    if (!lz4Decompress(stored.data + BPG_COMPRESSED_PREFIX_SIZE, stream_size, out.data() + at, raw_size)) {
+        std::cerr << "[BPG Decode ERR] Corrupt LZ4 stream for TL: " << std::string(view.tl, 2) << std::endl;
+        out.resize(at);
+        return false;
+    }
+    stats_.bytes_inflated += raw_size;
+    return true;
+}
 
-    // --- Step 7: Process the successfully parsed packet (if applicable) --- 
-    if (data_err == BpgError::Success) {
-        // Check the EG bit from the uint32_t prop field
-        bool is_end = (header.prop & BPG_PROP_EG_BIT_MASK) != 0;
+void BpgDecoder::dispatchInflated(AppPacketView view, Codec codec, const Sinks& sinks) {
+    uint32_t pin_id = acquirePin(false);
+    std::vector<uint8_t>& bytes = pins_[pin_id - 1].bytes;
+    size_t meta_size = view.content.metadata.size();
+    bytes.resize(meta_size);
+    if (meta_size) std::memcpy(bytes.data(), view.content.metadata.data(), meta_size);
+    stats_.bytes_copied += meta_size;
+    if (!inflateBinary(view, codec, bytes, meta_size)) {
+        release(pin_id);
+        return;
+    }
+    view.content.metadata = std::string_view(reinterpret_cast<const char*>(bytes.data()), meta_size);
+    view.content.binary.data = bytes.data() + meta_size;
+    view.content.binary.size = bytes.size() - meta_size;
+
+    dispatchView(view, sinks);
+    // A view waiting in its unfinished group is adopted by retainPendingViews()
+    bool pending = !view.is_end_of_group && sinks.view_group && *sinks.view_group;
+    if (!pending && !pins_[pin_id - 1].user_owned) release(pin_id);
+}
 
-        AppPacket app_packet;
-        app_packet.group_id = header.group_id;
-        app_packet.target_id = header.target_id;
-        std::memcpy(app_packet.tl, header.tl, sizeof(PacketType));
-        app_packet.is_end_of_group = is_end;
+// --- Forwarding ---
+void BpgDecoder::setPayloadForwarder(const PacketType tl, PayloadForwarder forwarder) {
+    clearPayloadForwarder();
+    std::memcpy(forward_tl_, tl, sizeof(PacketType));
+    forwarder_ = std::move(forwarder);
+    forwarding_ = true;
+}
 
-        app_packet.content = std::make_shared<HybridData>(std::move(hybrid_data));
+void BpgDecoder::clearPayloadForwarder() {
+    if (fill_.dst) {
+        // The rest of its binary is skipped while resynchronizing
+        abandonForward();
+        buffer_.clear();
+        read_pos_ = 0;
+    }
+    forwarding_ = false;
+    forwarder_ = PayloadForwarder();
+    forward_declined_ = false;
+}
 
-        if (!active_groups_.count(app_packet.group_id)) {
-            active_groups_[app_packet.group_id] = {};
-        }
-        active_groups_[app_packet.group_id].push_back(std::move(app_packet));
+size_t BpgDecoder::forwardHeadSize(const uint8_t* frame, size_t have) const {
+    if (!forwarding_ || have < FORWARD_PROBE_SIZE) return 0;
+    uint32_t magic_n;
+    std::memcpy(&magic_n, frame, sizeof(magic_n));
+    if (ntohl(magic_n) != BPG_FRAME_MAGIC) return 0;
+    PacketHeader header;
+    if (!parseHeaderFromBuffer(frame + BPG_FRAME_PREFIX_SIZE, BPG_HEADER_SIZE, header)) return 0;
+    if (std::memcmp(header.tl, forward_tl_, sizeof(PacketType)) != 0) return 0;
+    if (header.prop & BPG_PROP_COMPRESSED_BIT_MASK) return 0; // inflated by the decoder
+    uint32_t str_len_n;
+    std::memcpy(&str_len_n, frame + BPG_WIRE_HEADER_SIZE, sizeof(str_len_n));
+    uint64_t meta_end = sizeof(uint32_t) + static_cast<uint64_t>(ntohl(str_len_n));
+    if (meta_end >= header.data_length) return 0; // no binary (or malformed): decoded as usual
+    return BPG_WIRE_HEADER_SIZE + static_cast<size_t>(meta_end);
+}
+
+uint8_t* BpgDecoder::reserveForward(AppPacketView view, size_t size) {
+    if (!forwarder_.reserve) return nullptr;
+    view.content.binary = ByteSpan();
+    try {
+        return forwarder_.reserve(view, size);
+    } catch (const std::exception& e) {
+        std::cerr << "[BPG ERR] Exception in forwarder reserve: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[BPG ERR] Unknown exception in forwarder reserve" << std::endl;
+    }
+    return nullptr;
+}
 
-        const auto& stored_packet = active_groups_[header.group_id].back();
+bool BpgDecoder::beginForward(const Sinks& sinks) {
+    if (forward_declined_) return false;
+    const uint8_t* frame = buffer_.data() + read_pos_;
+    size_t head = forwardHeadSize(frame, buffered());
+    if (head == 0 || buffered() < head) return false;
+    forward_declined_ = true; // unless reserved below
+    if (buffered() != head || (!sinks.view_packet && !sinks.view_group)) return false;
 
-        if (packet_callback) {
-            try { packet_callback(stored_packet); } catch(const std::exception& e) {
-                 std::cerr << "[BPG ERR] Exception in packet_callback: " << e.what() << std::endl;
-             } catch(...) { std::cerr << "[BPG ERR] Unknown exception in packet_callback" << std::endl; }
-        }
+    PacketHeader header;
+    parseHeaderFromBuffer(frame + BPG_FRAME_PREFIX_SIZE, BPG_HEADER_SIZE, header);
+    AppPacketView view;
+    setViewHeader(view, header);
+    view.content.metadata = std::string_view(reinterpret_cast<const char*>(frame + FORWARD_PROBE_SIZE),
+                                             head - FORWARD_PROBE_SIZE);
+    size_t size = BPG_WIRE_HEADER_SIZE + header.data_length - head;
+    uint8_t* dst = reserveForward(view, size);
+    if (!dst) return false;
+    forward_declined_ = false;
+    fill_.dst = dst;
+    fill_.size = size;
+    fill_.filled = 0;
+    fill_.packet = view;
+    return true;
+}
+
+void BpgDecoder::fillForward(const uint8_t*& data, size_t& len, const Sinks& sinks) {
+    size_t take = std::min(len, fill_.size - fill_.filled);
+    std::memcpy(fill_.dst + fill_.filled, data, take);
+    stats_.bytes_copied += take;
+    stats_.bytes_forwarded += take;
+    fill_.filled += take;
+    data += take;
+    len -= take;
+    if (fill_.filled < fill_.size) return;
+
+    AppPacketView view = fill_.packet;
+    view.content.binary.data = fill_.dst;
+    view.content.binary.size = fill_.size;
+    fill_ = ForwardFill();
+    // Its metadata still points into the staged head
+    deliverForwarded(view, sinks);
+    retainPendingViews();
+    buffer_.clear();
+    read_pos_ = 0;
+    forward_declined_ = false;
+}
+
+void BpgDecoder::deliverForwarded(const AppPacketView& view, const Sinks& sinks) {
+    if (sinks.view_packet && *sinks.view_packet) {
+        try { (*sinks.view_packet)(view); } catch(const std::exception& e) {
+             std::cerr << "[BPG ERR] Exception in packet_callback: " << e.what() << std::endl;
+         } catch(...) { std::cerr << "[BPG ERR] Unknown exception in packet_callback" << std::endl; }
+    }
+    if (forwarder_.commit) {
+        try { forwarder_.commit(view, true); } catch(const std::exception& e) {
+             std::cerr << "[BPG ERR] Exception in forwarder commit: " << e.what() << std::endl;
+         } catch(...) { std::cerr << "[BPG ERR] Unknown exception in forwarder commit" << std::endl; }
+    }
+    // The binary belongs to the forwarder now
+    AppPacketView grouped = view;
+    grouped.content.binary = ByteSpan();
+    addViewToGroup(grouped, sinks);
+}
 
-        if (is_end && group_callback) {
-            auto group_iter = active_groups_.find(header.group_id);
-            if (group_iter != active_groups_.end()) {
-                 try { group_callback(header.group_id, std::move(group_iter->second)); } catch(const std::exception& e) {
-                     std::cerr << "[BPG ERR] Exception in group_callback: " << e.what() << std::endl;
-                 } catch(...) { std::cerr << "[BPG ERR] Unknown exception in group_callback" << std::endl; }
-                active_groups_.erase(group_iter);
+void BpgDecoder::abandonForward() {
+    if (!fill_.dst) return;
+    AppPacketView view = fill_.packet;
+    view.content.binary.data = fill_.dst;
+    view.content.binary.size = fill_.filled;
+    fill_ = ForwardFill();
+    if (!forwarder_.commit) return;
+    try { forwarder_.commit(view, false); } catch (...) {
+        std::cerr << "[BPG ERR] Exception in forwarder commit" << std::endl;
+    }
+}
+
+// --- Group expiry ---
+void BpgDecoder::noteGroupStarted(uint32_t group_id) {
+    group_ages_.findOrInsert(group_id).started = std::chrono::steady_clock::now();
+}
+
+size_t BpgDecoder::expireStaleGroups(std::chrono::milliseconds max_age) {
+    if (group_ages_.empty()) return 0;
+    auto cutoff = std::chrono::steady_clock::now() - max_age;
+    expired_.clear();
+    group_ages_.forEach([this, cutoff](uint32_t group_id, GroupAge& age) {
+        if (age.started < cutoff) expired_.push_back(group_id);
+    });
+    for (uint32_t group_id : expired_) {
+        active_groups_.erase(group_id);
+        if (ViewGroup* group = active_view_groups_.find(group_id)) {
+            for (uint32_t pin_id : group->pins) {
+                if (!pins_[pin_id - 1].user_owned) release(pin_id);
             }
+            active_view_groups_.erase(group_id);
         }
+        group_ages_.erase(group_id);
+    }
+    stats_.groups_expired += expired_.size();
+    return expired_.size();
+}
+
+// --- Pinning ---
+uint32_t BpgDecoder::acquirePin(bool user_owned) {
+    uint32_t pin_id;
+    if (!free_pins_.empty()) {
+        pin_id = free_pins_.back();
+        free_pins_.pop_back();
     } else {
-        std::cerr << "BPG Decoder: Error deserializing app data for packet type "
-                  << std::string(header.tl, 2) << " (Error code: " << static_cast<int>(data_err) << ")" << std::endl;
+        pins_.emplace_back();
+        pin_id = static_cast<uint32_t>(pins_.size());
     }
+    pins_[pin_id - 1].in_use = true;
+    pins_[pin_id - 1].user_owned = user_owned;
+    return pin_id;
+}
 
-    return true; 
+uint32_t BpgDecoder::pinCopy(AppPacketView& view, bool user_owned) {
+    uint32_t pin_id = acquirePin(user_owned);
+    PinSlot& slot = pins_[pin_id - 1];
+    size_t meta_size = view.content.metadata.size();
+    size_t binary_size = view.content.binary.size;
+    slot.bytes.resize(meta_size + binary_size); // keeps capacity from earlier pins
+    if (meta_size) std::memcpy(slot.bytes.data(), view.content.metadata.data(), meta_size);
+    if (binary_size) std::memcpy(slot.bytes.data() + meta_size, view.content.binary.data, binary_size);
+    stats_.bytes_copied += meta_size + binary_size;
+
+    view.content.metadata = std::string_view(reinterpret_cast<const char*>(slot.bytes.data()), meta_size);
+    view.content.binary.data = slot.bytes.data() + meta_size;
+    view.content.binary.size = binary_size;
+    return pin_id;
 }
 
-BpgError BpgDecoder::processData(const uint8_t* data, size_t len,
-                                 const AppPacketCallback& packet_callback,
-                                 const AppPacketGroupCallback& group_callback) {
-    if (!data || len == 0) {
-        return BpgError::Success;
+uint32_t BpgDecoder::findPin(const AppPacketView& view) const {
+    const uint8_t* start = view.content.binary.data;
+    if (!start) start = reinterpret_cast<const uint8_t*>(view.content.metadata.data());
+    if (!start) return 0;
+    for (size_t i = 0; i < pins_.size(); i++) {
+        const PinSlot& slot = pins_[i];
+        if (slot.in_use && !slot.bytes.empty() &&
+            start >= slot.bytes.data() && start < slot.bytes.data() + slot.bytes.size()) {
+            return static_cast<uint32_t>(i + 1);
+        }
     }
+    return 0;
+}
 
-    // Append incoming data to the internal buffer (deque insert)
-    // This copy handles the volatility of the input 'data' pointer
+uint32_t BpgDecoder::pin(AppPacketView& view) {
+    // A view the decoder already retained (or inflated) is handed over as is
+    if (uint32_t pin_id = findPin(view)) {
+        pins_[pin_id - 1].user_owned = true;
+        return pin_id;
+    }
     try {
-        internal_buffer_.insert(internal_buffer_.end(), data, data + len);
+        return pinCopy(view, true);
     } catch (const std::exception& e) {
-        std::cerr << "[BPG Decode ERR] Failed to insert data into deque buffer: " << e.what() << std::endl;
-        // Depending on severity, might want to clear buffer or just return error
-        // reset(); 
-        return BpgError::DecodingError; // Or a more specific error like BufferError
+        std::cerr << "[BPG Decode ERR] Failed to pin packet: " << e.what() << std::endl;
+        return 0;
     }
+}
+
+void BpgDecoder::release(uint32_t pin_id) {
+    if (pin_id == 0 || pin_id > pins_.size()) return;
+    PinSlot& slot = pins_[pin_id - 1];
+    if (!slot.in_use) return;
+    slot.in_use = false;
+    slot.user_owned = false;
+    free_pins_.push_back(pin_id);
+}
+
+void BpgDecoder::retainPendingViews() {
+    if (!views_pending_) return;
+    active_view_groups_.forEach([this](uint32_t, ViewGroup& group) {
+        for (; group.retained < group.packets.size(); group.retained++) {
+            // Inflated views already live in a decoder slot
+            AppPacketView& view = group.packets[group.retained];
+            uint32_t pin_id = findPin(view);
+            group.pins.push_back(pin_id ? pin_id : pinCopy(view, false));
+        }
+    });
+    views_pending_ = false;
+}
+
+BpgError BpgDecoder::processFrames(const uint8_t* data, size_t len, const Sinks& sinks) {
+    if (!data || len == 0) {
+        return BpgError::Success;
+    }
+    stats_.bytes_received += len;
+
+    try {
+        while (len > 0) {
+            if (fill_.dst) {
+                // The binary of a forwarded packet goes straight to the forwarder
+                fillForward(data, len, sinks);
+                continue;
+            }
 
+            if (buffered() == 0) {
+                // Fast path: parse straight out of the caller's memory and only
+                // stage the trailing partial frame (if any), or just its head
+                // when its binary is forwarded.
+                forward_declined_ = false;
+                size_t consumed = parseFrames(data, len, sinks);
+                retainPendingViews();
+                data += consumed;
+                len -= consumed;
+                size_t head = forwardHeadSize(data, len);
+                size_t take = head ? std::min(head, len) : len;
+                appendToBuffer(data, take);
+                data += take;
+                len -= take;
+                continue;
+            }
+
+            if (buffered() < BPG_FRAME_PREFIX_SIZE && !stagedMagicContinues(data, len)) {
+                // The staged tail was a false magic candidate
+                stats_.bytes_discarded += buffered();
+                buffer_.clear();
+                read_pos_ = 0;
+                continue;
+            }
 
-    // Process as many complete packets as possible
-    while (tryParsePacket(internal_buffer_, packet_callback, group_callback)) {
-        // Loop continues as long as tryParsePacket returns true (meaning it processed something)
+            // A partial frame is staged: top it up with just enough bytes to
+            // complete it, then continue in place on the rest of the input.
+            size_t take = std::min(bytesNeeded(), len);
+            appendToBuffer(data, take);
+            data += take;
+            len -= take;
+            // With a forwarded packet's head staged, its binary skips the buffer
+            if (beginForward(sinks)) continue;
+
+            read_pos_ += parseFrames(buffer_.data() + read_pos_, buffered(), sinks);
+            // Views into the staging buffer must be copied before it is reused
+            retainPendingViews();
+            if (buffered() == 0) {
+                buffer_.clear();
+                read_pos_ = 0;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[BPG Decode ERR] Failed to stage data in decoder buffer: " << e.what() << std::endl;
+        return BpgError::DecodingError;
     }
 
     return BpgError::Success;
 }
 
-} // namespace BPG 
\ No newline at end of file
+BpgError BpgDecoder::processData(const uint8_t* data, size_t len,
+                                 const AppPacketCallback& packet_callback,
+                                 const AppPacketGroupCallback& group_callback) {
+    Sinks sinks;
+    sinks.packet = &packet_callback;
+    sinks.group = &group_callback;
+    return processFrames(data, len, sinks);
+}
+
+BpgError BpgDecoder::processData(const uint8_t* data, size_t len,
+                                 const AppPacketViewCallback& packet_callback,
+                                 const AppPacketViewGroupCallback& group_callback) {
+    Sinks sinks;
+    sinks.view_packet = &packet_callback;
+    sinks.view_group = &group_callback;
+    return processFrames(data, len, sinks);
+}
+
+} // namespace BPG
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "bpg_types.h"
+#include "bpg_compress.h"
+#include "bpg_data_pool.h"
+#include "bpg_group_table.h"
 #include <vector>
+#include <chrono>
 #include <functional>
-#include <map>
-#include <deque>
+#include <memory>
 
 namespace BPG {
 
@@ -14,6 +17,44 @@ using AppPacketCallback = std::function<void(const AppPacket&)>;
 // Callback type for when a complete packet group (ending with EG) is decoded
 using AppPacketGroupCallback = std::function<void(uint32_t group_id, AppPacketGroup&& group)>; // Pass group by rvalue ref
 
+// Zero-copy variants: views point into the decoded bytes and are valid for the
+// duration of the callback (see BpgDecoder::pin to keep one longer).
+using AppPacketViewCallback = std::function<void(const AppPacketView&)>;
+using AppPacketViewGroupCallback = std::function<void(uint32_t group_id, const AppPacketView* packets, size_t count)>;
+
+// Forwarding (view mode): the binary part of one packet type is written
+// straight into memory the forwarder reserves, e.g. a slot in the Python IPC
+// request ring, instead of being handed to the caller in place or staged.
+// Its bytes are copied exactly once, even when the packet straddles
+// processData calls: only the header and metadata are staged then.
+struct PayloadForwarder {
+    // Room for `size` binary bytes of `packet` (header fields and metadata
+    // set, binary empty), or nullptr to deliver the packet as usual.
+    std::function<uint8_t*(const AppPacketView& packet, size_t size)> reserve;
+    // The binary is in place (`packet.content.binary` points at the reserved
+    // memory) and the packet callback has seen it. `complete` is false when
+    // the packet was abandoned by reset() or by replacing the forwarder;
+    // the reservation should be dropped.
+    std::function<void(const AppPacketView& packet, bool complete)> commit;
+};
+
+// Copy accounting for the decoder. bytes_copied counts every byte the
+// decoder moves: buffering a partial packet, compacting the buffer,
+// materializing payloads into HybridData and forwarding.
+struct DecoderStats {
+    uint64_t bytes_received = 0;
+    uint64_t bytes_copied = 0;
+    uint64_t bytes_forwarded = 0;  // binary bytes written into forwarder memory (part of bytes_copied)
+    uint64_t bytes_discarded = 0;  // skipped while resynchronizing on the frame magic
+    uint64_t bytes_inflated = 0;   // binary bytes produced by decompression (not part of bytes_copied)
+    uint64_t groups_expired = 0;   // unfinished groups dropped by expireStaleGroups()
+
+    // Bytes copied per byte received (1.0 means one copy, into HybridData)
+    double copiesPerByte() const {
+        return bytes_received ? static_cast<double>(bytes_copied) / bytes_received : 0.0;
+    }
+};
+
 class BpgDecoder {
 public:
     BpgDecoder();
@@ -32,29 +73,179 @@ public:
                          const AppPacketCallback& packet_callback,
                          const AppPacketGroupCallback& group_callback);
 
+    /**
+     * @brief Zero-copy overload of processData. Packets are delivered as views
+     *        into `data` (or into the decoder buffer for packets that straddled
+     *        calls), so no payload is copied or allocated.
+     *        Earlier packets of a group outlive their processData call, so the
+     *        decoder copies them into recycled storage before returning; the
+     *        group callback then sees views that are all valid.
+     */
+    BpgError processData(const uint8_t* data, size_t len,
+                         const AppPacketViewCallback& packet_callback,
+                         const AppPacketViewGroupCallback& group_callback);
+
+    /**
+     * @brief Keeps the bytes behind `view` valid after the callback returns.
+     *        The view is rebased onto decoder-owned storage (recycled between
+     *        pins, so steady-state pinning does not allocate).
+     *        Call only from inside a view callback.
+     * @return Pin id to pass to release(), or 0 on failure.
+     */
+    uint32_t pin(AppPacketView& view);
+
+    /**
+     * @brief Releases a pin; views rebased by it become invalid.
+     */
+    void release(uint32_t pin_id);
+
+    /**
+     * @brief Forwards the binary part of every `tl` packet through `forwarder`
+     *        (view overload of processData only). A forwarded packet reaches
+     *        the packet callback with its binary in the reserved memory; its
+     *        group sees it with an empty binary, since the bytes then belong
+     *        to the forwarder. Replacing or clearing the forwarder abandons a
+     *        packet being forwarded; the rest of its bytes are skipped.
+     *        Compressed packets (BPG_PROP_COMPRESSED_BIT_MASK) are not
+     *        forwarded: they are decompressed and delivered as usual.
+     */
+    void setPayloadForwarder(const PacketType tl, PayloadForwarder forwarder);
+    void clearPayloadForwarder();
+
+    /**
+     * @brief Drops unfinished groups whose first packet arrived more than
+     *        `max_age` ago (their EG packet was lost or the sender died).
+     *        Meant to run from a periodic host timer rather than per message.
+     * @return Number of groups dropped.
+     */
+    size_t expireStaleGroups(std::chrono::milliseconds max_age);
+
     /**
      * @brief Resets the internal state of the decoder (e.g., clears buffers).
      */
     void reset();
 
+    const DecoderStats& stats() const { return stats_; }
+    void resetStats() { stats_ = DecoderStats(); }
+
 private:
-    // Use std::deque for efficient front removal
-    std::deque<uint8_t> internal_buffer_;
-    std::map<uint32_t, AppPacketGroup> active_groups_;
-
-    // Helper to try parsing a complete packet from the internal buffer
-    // Takes non-const buffer reference if modification is needed internally
-    bool tryParsePacket(std::deque<uint8_t>& buffer, // Pass buffer by ref
-                        const AppPacketCallback& packet_callback,
-                        const AppPacketGroupCallback& group_callback);
-
-    // Helper to deserialize the header (reads from buffer)
-    bool deserializeHeader(const std::deque<uint8_t>& buffer, PacketHeader& out_header);
-
-    // Helper to deserialize application data
-    BpgError deserializeAppData(const PacketHeader& header, 
-                                std::deque<uint8_t>::const_iterator data_start,
-                                HybridData& out_data);
+    // Callbacks for one processData call; either the owning or the view pair
+    // is set.
+    struct Sinks {
+        const AppPacketCallback* packet = nullptr;
+        const AppPacketGroupCallback* group = nullptr;
+        const AppPacketViewCallback* view_packet = nullptr;
+        const AppPacketViewGroupCallback* view_group = nullptr;
+    };
+
+    // Decoder-owned copy of a pinned packet's payload, or the decompressed
+    // payload of a compressed one
+    struct PinSlot {
+        std::vector<uint8_t> bytes;
+        bool in_use = false;
+        bool user_owned = false;  // pinned through pin(), released by the caller
+    };
+
+    // Packets of an unfinished group in view mode. Views from index
+    // `retained` on still point into caller / staging memory.
+    struct ViewGroup {
+        std::vector<AppPacketView> packets;
+        std::vector<uint32_t> pins;
+        size_t retained = 0;
+
+        void clear() {
+            packets.clear();
+            pins.clear();
+            retained = 0;
+        }
+    };
+
+    // Forwarded packet whose binary is still arriving. Its header and
+    // metadata are staged; the binary is copied into `dst` as input comes in.
+    struct ForwardFill {
+        uint8_t* dst = nullptr;  // null when no packet is being filled
+        size_t size = 0;
+        size_t filled = 0;
+        AppPacketView packet{};
+    };
+
+    // When an unfinished group received its first packet
+    struct GroupAge {
+        std::chrono::steady_clock::time_point started{};
+
+        void clear() { started = {}; }
+    };
+
+    // Contiguous staging buffer for packets split across processData calls.
+    // Live bytes are [read_pos_, buffer_.size()); the consumed prefix is
+    // compacted away lazily instead of erasing after every packet.
+    std::vector<uint8_t> buffer_;
+    size_t read_pos_ = 0;
+    // Unfinished groups. Both tables and the HybridData pool recycle their
+    // storage, so steady-state decoding does not allocate.
+    FlatGroupTable<AppPacketGroup> active_groups_;
+    FlatGroupTable<ViewGroup> active_view_groups_;
+    FlatGroupTable<GroupAge> group_ages_;
+    std::vector<uint32_t> expired_;  // scratch for expireStaleGroups()
+    std::shared_ptr<HybridDataPool> data_pool_;
+    bool views_pending_ = false;
+    std::vector<PinSlot> pins_;
+    std::vector<uint32_t> free_pins_;
+    bool forwarding_ = false;
+    PacketType forward_tl_ = {0, 0};
+    PayloadForwarder forwarder_;
+    ForwardFill fill_;
+    bool forward_declined_ = false;  // the staged packet is decoded as usual
+    DecoderStats stats_;
+
+    size_t buffered() const { return buffer_.size() - read_pos_; }
+    BpgError processFrames(const uint8_t* data, size_t len, const Sinks& sinks);
+    void appendToBuffer(const uint8_t* data, size_t len);
+    void compactBuffer();
+
+    // Bytes the staging buffer still needs before parseFrames can make
+    // progress on it (the rest of the wire header, or of the packet).
+    size_t bytesNeeded() const;
+
+    // With less than the frame magic staged: drops staged bytes that cannot
+    // start a frame given the next input bytes. Returns false if none can.
+    bool stagedMagicContinues(const uint8_t* data, size_t len);
+
+    // Parses every complete frame in [data, data + len) in place and returns
+    // the number of bytes consumed. Stops at the first incomplete frame.
+    size_t parseFrames(const uint8_t* data, size_t len, const Sinks& sinks);
+
+    void noteGroupStarted(uint32_t group_id);
+    void dispatchPacket(const AppPacketView& view, Codec codec, const Sinks& sinks);
+    void dispatchView(const AppPacketView& view, const Sinks& sinks);
+    // Decompresses the binary of `view` into a decoder slot, delivers the
+    // rebased view and releases the slot unless its group or pin() kept it
+    void dispatchInflated(AppPacketView view, Codec codec, const Sinks& sinks);
+    // Resizes `out` to `at` + the raw size and decompresses the binary of
+    // `view` behind `at`. False (logged) on a corrupt stream.
+    bool inflateBinary(const AppPacketView& view, Codec codec, std::vector<uint8_t>& out, size_t at);
+    void addViewToGroup(const AppPacketView& view, const Sinks& sinks);
+
+    // Size of [wire header][str_length][metadata] of the frame at `frame` if
+    // its binary part is forwarded, else 0 (also while fewer than
+    // FORWARD_PROBE_SIZE bytes, the wire header and str_length, are known).
+    size_t forwardHeadSize(const uint8_t* frame, size_t have) const;
+    // Reserves forwarder memory for the packet whose head is staged.
+    // Returns false (and marks the packet declined) if it is decoded as usual.
+    bool beginForward(const Sinks& sinks);
+    uint8_t* reserveForward(AppPacketView view, size_t size);
+    void fillForward(const uint8_t*& data, size_t& len, const Sinks& sinks);
+    // Delivers a forwarded packet whose binary is in place, then commits it
+    void deliverForwarded(const AppPacketView& view, const Sinks& sinks);
+    void abandonForward();
+
+    // Copies the views of unfinished groups that still point into caller or
+    // staging memory into pin slots. Runs before that memory can change.
+    void retainPendingViews();
+    uint32_t acquirePin(bool user_owned);
+    uint32_t pinCopy(AppPacketView& view, bool user_owned);
+    // Slot the bytes of `view` already live in, or 0
+    uint32_t findPin(const AppPacketView& view) const;
 };
 
 } // namespace BPG 
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace BPG {
+
+// Open-addressing hash table from group_id to per-group state, used by the
+// decoder for groups that have not seen their EG packet yet.
+//
+// Values are never destroyed on erase: they are cleared (V::clear()) and stay
+// in the table, so vectors inside them keep their capacity for the next group.
+// Memory is only allocated when the table grows.
+template <typename V>
+class FlatGroupTable {
+public:
+    explicit FlatGroupTable(size_t initial_capacity = 16) {
+        size_t capacity = 8;
+        while (capacity < initial_capacity) capacity <<= 1;
+        slots_.resize(capacity);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    V* find(uint32_t key) {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = home(key); ; i = (i + 1) & mask) {
+            Slot& slot = slots_[i];
+            if (!slot.used) return nullptr;
+            if (slot.key == key) return &slot.value;
+        }
+    }
+
+    // Returns the value for `key`, inserting a cleared one if missing.
+    // References returned earlier are invalidated when the table grows.
+    V& findOrInsert(uint32_t key) {
+        if (V* value = find(key)) return *value;
+        if ((size_ + 1) * 2 > slots_.size()) grow();
+        size_t mask = slots_.size() - 1;
+        size_t i = home(key);
+        while (slots_[i].used) i = (i + 1) & mask;
+        slots_[i].used = true;
+        slots_[i].key = key;
+        size_++;
+        return slots_[i].value;
+    }
+
+    // Removes `key`. Uses backward-shift deletion (no tombstones); values are
+    // swapped rather than moved so their storage stays in the table.
+    void erase(uint32_t key) {
+        size_t mask = slots_.size() - 1;
+        size_t i = home(key);
+        for (; ; i = (i + 1) & mask) {
+            if (!slots_[i].used) return;
+            if (slots_[i].key == key) break;
+        }
+        slots_[i].value.clear();
+        for (size_t j = (i + 1) & mask; slots_[j].used; j = (j + 1) & mask) {
+            size_t h = home(slots_[j].key);
+            // Move j back into the hole at i if its probe path crosses i
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                slots_[i].key = slots_[j].key;
+                std::swap(slots_[i].value, slots_[j].value);
+                i = j;
+            }
+        }
+        slots_[i].used = false;
+        size_--;
+    }
+
+    template <typename F>
+    void forEach(F&& fn) {
+        for (Slot& slot : slots_) {
+            if (slot.used) fn(slot.key, slot.value);
+        }
+    }
+
+    void clear() {
+        for (Slot& slot : slots_) {
+            if (slot.used) slot.value.clear();
+            slot.used = false;
+        }
+        size_ = 0;
+    }
+
+private:
+    struct Slot {
+        uint32_t key = 0;
+        bool used = false;
+        V value;
+    };
+
+    size_t home(uint32_t key) const {
+        // Fibonacci hashing; group ids are usually sequential
+        return static_cast<size_t>((key * 0x9E3779B1u) >> 7) & (slots_.size() - 1);
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(slots_);
+        slots_.resize(old.size() * 2);
+        size_ = 0;
+        for (Slot& slot : old) {
+            if (slot.used) {
+                std::swap(findOrInsert(slot.key), slot.value);
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
+
+} // namespace BPG
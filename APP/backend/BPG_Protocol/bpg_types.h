@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstring> // For memcpy
 #include <numeric> // For std::accumulate (can be replaced if needed)
 #ifdef _WIN32
@@ -26,6 +27,7 @@ constexpr size_t BPG_FRAME_PREFIX_SIZE = 4;
 constexpr size_t BPG_HEADER_SIZE = 18;
 constexpr size_t BPG_WIRE_HEADER_SIZE = BPG_FRAME_PREFIX_SIZE + BPG_HEADER_SIZE;
 constexpr uint32_t BPG_PROP_EG_BIT_MASK = 0x00000001; // Mask for the EG bit (LSB of prop field)
+constexpr uint32_t BPG_PROP_BIN_META_BIT_MASK = 0x00000002; // metadata is a binary block (e.g. ImageMeta), not JSON
 
 // Two-letter packet type identifier
 typedef char PacketType[2];
@@ -77,6 +79,56 @@ struct PacketHeader {
 // Simple structure for holding raw binary data
 // using BinaryData = std::vector<uint8_t>;
 
+// --- Binary metadata ---
+// Fixed-layout alternative to a JSON metadata_str for common packet types,
+// sent when the BPG_PROP_BIN_META_BIT_MASK prop bit is set. A block starts
+// with its kind byte; multi-byte fields are Big Endian. Decoders ignore bytes
+// past the fields they know, so a kind can only grow at its end.
+enum class MetaKind : uint8_t { Image = 1 };
+// ImageMeta::format, the "format" string of the JSON form
+enum class ImageFormat : uint8_t { Unspecified = 0, Raw = 1, RawRgba = 2 };
+
+// [kind 1][format 1][channels 2][type 2][width 4][height 4]
+struct ImageMeta {
+    static constexpr size_t ENCODED_SIZE = 14; // fits std::string's inline buffer
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint16_t channels = 0;
+    uint16_t type = 0;         // OpenCV type, e.g. CV_8UC4
+    ImageFormat format = ImageFormat::Unspecified;
+
+    void encode(uint8_t* out) const {
+        uint16_t channels_n = htons(channels), type_n = htons(type);
+        uint32_t width_n = htonl(width), height_n = htonl(height);
+        out[0] = static_cast<uint8_t>(MetaKind::Image);
+        out[1] = static_cast<uint8_t>(format);
+        std::memcpy(out + 2, &channels_n, 2);
+        std::memcpy(out + 4, &type_n, 2);
+        std::memcpy(out + 6, &width_n, 4);
+        std::memcpy(out + 10, &height_n, 4);
+    }
+
+    // False unless `block` is an Image block of at least ENCODED_SIZE bytes
+    static bool decode(std::string_view block, ImageMeta& out) {
+        if (block.size() < ENCODED_SIZE || static_cast<uint8_t>(block[0]) != static_cast<uint8_t>(MetaKind::Image)) {
+            return false;
+        }
+        const char* in = block.data();
+        uint16_t channels_n, type_n;
+        uint32_t width_n, height_n;
+        std::memcpy(&channels_n, in + 2, 2);
+        std::memcpy(&type_n, in + 4, 2);
+        std::memcpy(&width_n, in + 6, 4);
+        std::memcpy(&height_n, in + 10, 4);
+        out.format = static_cast<ImageFormat>(static_cast<uint8_t>(in[1]));
+        out.channels = ntohs(channels_n);
+        out.type = ntohs(type_n);
+        out.width = ntohl(width_n);
+        out.height = ntohl(height_n);
+        return true;
+    }
+};
+
 // HybridData structure will now be used for ALL packet content types.
 // Format on the wire: str_length(4) + metadata_str(str_length) + binary_bytes(...)
 class HybridData {
@@ -84,6 +136,17 @@ class HybridData {
     std::string metadata_str; // Describes the binary data. UTF-8 encoded string.
     std::vector<uint8_t> internal_binary_bytes;//if empty, use binary_bytes2
     BufferWriter external_binary_bytes;
+    bool metadata_is_binary = false; // metadata_str holds a binary block (BPG_PROP_BIN_META_BIT_MASK)
+
+    // Replaces the metadata with a binary ImageMeta block
+    void setImageMeta(const ImageMeta& meta) {
+        metadata_str.resize(ImageMeta::ENCODED_SIZE);
+        meta.encode(reinterpret_cast<uint8_t*>(&metadata_str[0]));
+        metadata_is_binary = true;
+    }
+    bool imageMeta(ImageMeta& out) const {
+        return metadata_is_binary && ImageMeta::decode(metadata_str, out);
+    }
 
     // Calculates the size needed to encode this HybridData instance.
     virtual size_t calculateEncodedSize() const {
@@ -95,28 +158,20 @@ class HybridData {
         }
         return sizeof(uint32_t) + metadata_str.length() + binary_size;
     }
+    // Writes str_length + metadata + binary in one pass
     virtual BpgError encode(BufferWriter& writer) const {
         uint32_t json_len = static_cast<uint32_t>(metadata_str.length());
-        uint32_t json_len_n = htonl(json_len);
-        
-        size_t binary_size = calculateEncodedSize();
-
-
-        size_t required_size = sizeof(uint32_t) + json_len + binary_size;
-
-        if (!writer.canWrite(required_size)) {
+        if (!writer.canWrite(sizeof(uint32_t) + json_len)) {
             return BpgError::BufferTooSmall;
         }
 
         // Write JSON length
-        writer.write(&json_len_n, sizeof(json_len_n));
+        writer.append_uint32_network(json_len);
 
         // Write JSON string (if any)
-        writer.write(metadata_str.data(), json_len);
+        writer.append(metadata_str.data(), json_len);
 
-        encode_binary_to(writer);
-
-        return BPG::BpgError::Success;
+        return encode_binary_to(writer);
     }
 
     virtual BpgError encode_binary_to(BufferWriter& writer) const {
@@ -134,6 +189,45 @@ class HybridData {
     }
 
     HybridData() : external_binary_bytes(nullptr, 0) {}
+    virtual ~HybridData() = default;
+};
+
+// Non-owning view of a byte range (std::span stand-in for C++17)
+struct ByteSpan {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return size == 0; }
+    const uint8_t* begin() const { return data; }
+    const uint8_t* end() const { return data + size; }
+};
+
+// One piece of a scatter-gather write (iovec style)
+struct Fragment {
+    const void* data;
+    size_t size;
+};
+
+// Zero-copy counterpart of HybridData. Both fields point into the memory the
+// packet was decoded from (the caller's input or the decoder's buffer), so a
+// view is only valid inside the callback unless pinned (BpgDecoder::pin).
+struct HybridDataView {
+    std::string_view metadata;
+    ByteSpan binary;
+    bool metadata_is_binary = false; // see HybridData
+
+    bool imageMeta(ImageMeta& out) const {
+        return metadata_is_binary && ImageMeta::decode(metadata, out);
+    }
+};
+
+// Zero-copy counterpart of AppPacket, see HybridDataView for lifetime rules
+struct AppPacketView {
+    uint32_t group_id;
+    uint32_t target_id;
+    PacketType tl;
+    bool is_end_of_group;
+    HybridDataView content;
 };
 
 // Structure representing a packet at the application layer
@@ -212,64 +306,86 @@ struct AppPacket {
 
 
 
-    static BpgError s_encode(
+    // Single-pass packet encoder. Writes the wire header with a placeholder
+    // data_length, then str_length + metadata, then hands the writer to
+    // `write_binary`, and finally back-patches data_length from how much was
+    // written. Each payload byte is copied exactly once, straight into the
+    // destination (e.g. the buffer from BufferRequestCallback). On error the
+    // writer is rewound to where the packet started.
+    template <typename BinaryWriter>
+    static BpgError s_encode_with(
         uint32_t group_id, uint32_t target_id, const PacketType tl, uint32_t prop,
-        uint32_t strlength,const char* str,
-        uint32_t binary_length,uint8_t* binary,
-        BufferWriter& dst_writer) {
+        uint32_t strlength, const char* str,
+        BufferWriter& dst_writer, BinaryWriter&& write_binary) {
+        size_t packet_start = dst_writer.size();
         PacketHeader header;
         header.group_id = group_id;
         header.target_id = target_id;
         std::memcpy(header.tl, tl, sizeof(PacketType));
         header.prop = prop;
+        header.data_length = 0; // back-patched below
 
-        header.data_length = sizeof(uint32_t) + strlength+binary_length;
-
-        size_t total_required = BPG_WIRE_HEADER_SIZE + header.data_length;
-        if (!dst_writer.canWrite(total_required)) {
+        if (!dst_writer.canWrite(BPG_WIRE_HEADER_SIZE + sizeof(uint32_t) + strlength)) {
             return BpgError::BufferTooSmall;
         }
-
-        // 4. Encode Header
-        BpgError header_err = header.encode(dst_writer);
-        if (header_err != BpgError::Success) {
-            return header_err;
-        }
-
-
-        {
-            uint32_t strlength_n = htonl(strlength);
-            dst_writer.write(&strlength_n, sizeof(uint32_t));
-            dst_writer.write(str, strlength);
-
- 
+        header.encode(dst_writer);
+        dst_writer.append_uint32_network(strlength);
+        dst_writer.append(str, strlength);
+
+        BpgError binary_err = write_binary(dst_writer);
+        if (binary_err != BpgError::Success) {
+            dst_writer.rewind_to(packet_start);
+            return binary_err;
         }
 
+        size_t data_length = dst_writer.size() - packet_start - BPG_WIRE_HEADER_SIZE;
+        dst_writer.patch_uint32_network(packet_start + BPG_WIRE_HEADER_SIZE - sizeof(uint32_t),
+                                        static_cast<uint32_t>(data_length));
+        return BpgError::Success;
+    }
 
+    // Encodes one packet whose binary part is gathered from `fragments`
+    // (iovec style), so a payload split across buffers needs no staging copy.
+    static BpgError s_encode_fragments(
+        uint32_t group_id, uint32_t target_id, const PacketType tl, uint32_t prop,
+        uint32_t strlength, const char* str,
+        const Fragment* fragments, size_t fragment_count,
+        BufferWriter& dst_writer) {
+        return s_encode_with(group_id, target_id, tl, prop, strlength, str, dst_writer,
+            [fragments, fragment_count](BufferWriter& writer) {
+                for (size_t i = 0; i < fragment_count; i++) {
+                    if (fragments[i].size == 0) continue;
+                    if (!writer.append(fragments[i].data, fragments[i].size)) return BpgError::BufferTooSmall;
+                }
+                return BpgError::Success;
+            });
+    }
 
-        return BpgError::Success;
+    static BpgError s_encode(
+        uint32_t group_id, uint32_t target_id, const PacketType tl, uint32_t prop,
+        uint32_t strlength,const char* str,
+        uint32_t binary_length,const uint8_t* binary,
+        BufferWriter& dst_writer) {
+        Fragment fragment{binary, binary_length};
+        return s_encode_fragments(group_id, target_id, tl, prop, strlength, str, &fragment, 1, dst_writer);
     }
+
     // Encodes the entire AppPacket (header + content) into the BufferWriter.
+    // The binary part comes from content->encode_binary_to(), so subclasses
+    // (e.g. image data converted on the fly) write directly into the writer.
     BpgError encode(BufferWriter& writer) const {
+        uint32_t prop = is_end_of_group ? BPG_PROP_EG_BIT_MASK : 0;
         if (!content) {
-            printf("content is null\n");
-            uint32_t data_len = 0; 
-            PacketHeader header;
-            header.group_id = group_id;
-            header.target_id = target_id;
-            std::memcpy(header.tl, tl, sizeof(PacketType));
-            header.prop = is_end_of_group ? BPG_PROP_EG_BIT_MASK : 0;
-            header.data_length = data_len;
-            return header.encode(writer);
+            return s_encode_fragments(group_id, target_id, tl, prop, 0, nullptr, nullptr, 0, writer);
         }
-
-        return s_encode(
-            group_id, target_id, tl, is_end_of_group ? BPG_PROP_EG_BIT_MASK : 0, 
-            content->metadata_str.length(), 
-            content->metadata_str.data(), 
-            content->internal_binary_bytes.size(), 
-            content->internal_binary_bytes.data(), 
-            writer);
+        const HybridData* data = content.get();
+        if (data->metadata_is_binary) prop |= BPG_PROP_BIN_META_BIT_MASK;
+        return s_encode_with(
+            group_id, target_id, tl, prop,
+            static_cast<uint32_t>(data->metadata_str.length()),
+            data->metadata_str.data(),
+            writer,
+            [data](BufferWriter& binary_writer) { return data->encode_binary_to(binary_writer); });
     }
 };
 
@@ -278,4 +394,19 @@ struct AppPacket {
 // but still useful at the application layer for collecting related packets.
 using AppPacketGroup = std::vector<AppPacket>;
 
+// Encodes every packet of a group back to back in one traversal. The EG bit
+// comes from each packet's is_end_of_group. On error the writer is rewound to
+// where the group started, so nothing half-written is sent.
+inline BpgError encodeGroup(const AppPacketGroup& group, BufferWriter& writer) {
+    size_t group_start = writer.size();
+    for (const AppPacket& packet : group) {
+        BpgError err = packet.encode(writer);
+        if (err != BpgError::Success) {
+            writer.rewind_to(group_start);
+            return err;
+        }
+    }
+    return BpgError::Success;
+}
+
 } // namespace BPG 
\ No newline at end of file
@@ -127,6 +127,26 @@ public:
         return current_offset_;
     }
 
+    // Overwrites a network-order uint32_t at an already written offset
+    // (used to back-patch lengths after the data behind them is written)
+    bool patch_uint32_network(size_t offset, uint32_t value) {
+        if (!start_ptr_ || offset + sizeof(uint32_t) > current_offset_) {
+            return false;
+        }
+        uint32_t value_n = htonl(value);
+        std::memcpy(start_ptr_ + offset, &value_n, sizeof(value_n));
+        return true;
+    }
+
+    // Rewinds to an earlier offset, e.g. to drop a partially written packet
+    bool rewind_to(size_t offset) {
+        if (offset > current_offset_) {
+            return false;
+        }
+        current_offset_ = offset;
+        return true;
+    }
+
     bool backspace(size_t length){
         if(current_offset_ < length){
             return false;
@@ -0,0 +1,110 @@
+// Verifies that steady-state decoding does not touch the heap: after a
+// warm-up pass, decoding the same traffic again must not call operator new.
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "../bpg_decoder.h"
+#include "../bpg_types.h"
+
+static std::atomic<size_t> g_allocations{0};
+
+// The whole replaceable set is backed by malloc/free, so every new/delete
+// pairing matches whichever form the library picks
+static void* countedAlloc(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static void appendFrame(std::vector<uint8_t>& stream, uint32_t group_id, bool end,
+                        const std::string& meta, size_t binary_size) {
+    std::vector<uint8_t> binary(binary_size, static_cast<uint8_t>(group_id));
+    size_t start = stream.size();
+    stream.resize(start + BPG::BPG_WIRE_HEADER_SIZE + 4 + meta.size() + binary_size);
+    BPG::BufferWriter writer(stream.data() + start, stream.size() - start);
+    BPG::BpgError err = BPG::AppPacket::s_encode(group_id, 1, "IM", end ? BPG::BPG_PROP_EG_BIT_MASK : 0,
+        static_cast<uint32_t>(meta.size()), meta.data(),
+        static_cast<uint32_t>(binary_size), binary.data(), writer);
+    assert(err == BPG::BpgError::Success && writer.size() == stream.size() - start);
+    (void)err;
+}
+
+// Feeds the stream in fixed chunks so packets straddle calls
+static void feed(BPG::BpgDecoder& decoder, const std::vector<uint8_t>& stream, size_t chunk,
+                 const BPG::AppPacketCallback& on_packet, const BPG::AppPacketGroupCallback& on_group) {
+    for (size_t off = 0; off < stream.size(); off += chunk) {
+        decoder.processData(stream.data() + off, std::min(chunk, stream.size() - off), on_packet, on_group);
+    }
+}
+
+static void feedViews(BPG::BpgDecoder& decoder, const std::vector<uint8_t>& stream, size_t chunk,
+                      const BPG::AppPacketViewCallback& on_packet, const BPG::AppPacketViewGroupCallback& on_group) {
+    for (size_t off = 0; off < stream.size(); off += chunk) {
+        decoder.processData(stream.data() + off, std::min(chunk, stream.size() - off), on_packet, on_group);
+    }
+}
+
+int main() {
+    // Three interleaved groups of three packets, repeated
+    std::vector<uint8_t> stream;
+    for (uint32_t round = 0; round < 20; round++) {
+        for (int part = 0; part < 3; part++) {
+            for (uint32_t g = 0; g < 3; g++) {
+                appendFrame(stream, round * 3 + g, part == 2, "{\"part\":" + std::to_string(part) + "}", 1000 + 500 * g);
+            }
+        }
+    }
+
+    size_t packets = 0, groups = 0;
+    BPG::AppPacketCallback on_packet = [&](const BPG::AppPacket& packet) {
+        packets++;
+        assert(packet.content->internal_binary_bytes[0] == static_cast<uint8_t>(packet.group_id));
+    };
+    // Reads the group in place, leaving its storage to the decoder
+    BPG::AppPacketGroupCallback on_group = [&](uint32_t, BPG::AppPacketGroup&& group) {
+        groups++;
+        assert(group.size() == 3);
+    };
+    BPG::AppPacketViewCallback on_view = [&](const BPG::AppPacketView&) { packets++; };
+    BPG::AppPacketViewGroupCallback on_view_group = [&](uint32_t, const BPG::AppPacketView* views, size_t count) {
+        groups++;
+        assert(count == 3 && views[0].content.binary.size >= 1000);
+    };
+
+    BPG::BpgDecoder decoder;
+    for (size_t chunk : {stream.size(), static_cast<size_t>(4096), static_cast<size_t>(7)}) {
+        feed(decoder, stream, chunk, on_packet, on_group); // warm-up
+        size_t before = g_allocations.load();
+        packets = groups = 0;
+        feed(decoder, stream, chunk, on_packet, on_group);
+        size_t allocations = g_allocations.load() - before;
+        printf("AppPacket callbacks, chunk %zu: %zu packets, %zu groups, %zu allocations\n", chunk, packets, groups, allocations);
+        assert(packets == 180 && groups == 60);
+        assert(allocations == 0);
+    }
+
+    for (size_t chunk : {stream.size(), static_cast<size_t>(4096), static_cast<size_t>(7)}) {
+        feedViews(decoder, stream, chunk, on_view, on_view_group); // warm-up
+        size_t before = g_allocations.load();
+        packets = groups = 0;
+        feedViews(decoder, stream, chunk, on_view, on_view_group);
+        size_t allocations = g_allocations.load() - before;
+        printf("View callbacks, chunk %zu: %zu packets, %zu groups, %zu allocations\n", chunk, packets, groups, allocations);
+        assert(packets == 180 && groups == 60);
+        assert(allocations == 0);
+    }
+
+    printf("Allocation test PASSED.\n");
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Measures the payload compression stage per codec: wire bytes per raw byte
+// and encode / decode throughput (raw MB/s) of whole frames going through
+// encodeCompressed() and the view decoder. Three payloads bracket real
+// traffic: a camera-like frame (smooth gradient plus sensor noise), a solid
+// mask and random bytes, which the encoder must fall back to sending raw.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../bpg_compress.h"
+#include "../bpg_decoder.h"
+#include "../bpg_types.h"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<uint8_t> makePayload(const std::string& kind, size_t width, size_t height) {
+    std::vector<uint8_t> bytes(width * height * 3);
+    uint32_t state = 12345;
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            for (size_t c = 0; c < 3; c++) {
+                state = state * 1103515245u + 12345u;
+                uint8_t& px = bytes[(y * width + x) * 3 + c];
+                if (kind == "solid") {
+                    px = c == 1 ? 255 : 0;
+                } else if (kind == "random") {
+                    px = static_cast<uint8_t>(state >> 24);
+                } else {
+                    // Gradient with +-1 noise on a quarter of the pixels
+                    int noise = (state >> 29) == 0 ? 1 : (state >> 29) == 1 ? -1 : 0;
+                    px = static_cast<uint8_t>((x + y) / 8 + c * 40 + noise);
+                }
+            }
+        }
+    }
+    return bytes;
+}
+
+struct Result {
+    double ratio;
+    double encode_mbps;
+    double decode_mbps;
+};
+
+static Result run(BPG::Codec codec, const std::vector<uint8_t>& payload, size_t frames) {
+    BPG::CodecTable codecs;
+    codecs.set("IM", codec);
+    BPG::AppPacket packet;
+    packet.group_id = 1; packet.target_id = 1; std::memcpy(packet.tl, "IM", 2); packet.is_end_of_group = true;
+    auto content = std::make_shared<BPG::HybridData>();
+    content->metadata_str = "{\"format\":\"raw\"}";
+    content->external_binary_bytes = BPG::BufferWriter(const_cast<uint8_t*>(payload.data()), payload.size(),
+                                                       payload.size());
+    packet.content = content;
+    std::vector<uint8_t> wire(BPG::BPG_WIRE_HEADER_SIZE + 64 + BPG::lz4CompressBound(payload.size()) + 4);
+
+    BPG::BpgDecoder decoder;
+    uint64_t checksum = 0, decoded = 0;
+    BPG::AppPacketViewCallback on_packet = [&](const BPG::AppPacketView& view) {
+        checksum += view.content.binary.data[view.content.binary.size / 2];
+        decoded += view.content.binary.size;
+    };
+    BPG::AppPacketViewGroupCallback on_group;
+
+    double encode_s = 0, decode_s = 0;
+    size_t wire_bytes = 0;
+    for (size_t i = 0; i < frames; i++) {
+        auto start = std::chrono::steady_clock::now();
+        BPG::BufferWriter writer(wire.data(), wire.size());
+        if (BPG::encodeCompressed(packet, codecs, writer) != BPG::BpgError::Success) {
+            printf("FAILED: encode\n");
+            std::exit(1);
+        }
+        encode_s += seconds_since(start);
+        wire_bytes = writer.size();
+
+        start = std::chrono::steady_clock::now();
+        decoder.processData(wire.data(), writer.size(), on_packet, on_group);
+        decode_s += seconds_since(start);
+    }
+    if (decoded != payload.size() * frames || checksum != payload[payload.size() / 2] * frames) {
+        printf("FAILED: decoded %llu of %zu bytes\n", (unsigned long long)decoded, payload.size() * frames);
+        std::exit(1);
+    }
+    double mb = static_cast<double>(payload.size()) * frames / 1e6;
+    return {static_cast<double>(wire_bytes) / payload.size(), mb / encode_s, mb / decode_s};
+}
+
+int main(int argc, char** argv) {
+    size_t frames = argc > 1 ? std::stoul(argv[1]) : 100;
+    size_t width = argc > 2 ? std::stoul(argv[2]) : 1280;
+    size_t height = argc > 3 ? std::stoul(argv[3]) : 720;
+
+    printf("%zu frames of %zux%zu RGB (%zu bytes)\n", frames, width, height, width * height * 3);
+    printf("%-8s %-6s %10s %14s %14s\n", "payload", "codec", "ratio", "encode MB/s", "decode MB/s");
+    for (const char* kind : {"image", "solid", "random"}) {
+        std::vector<uint8_t> payload = makePayload(kind, width, height);
+        for (BPG::Codec codec : {BPG::Codec::None, BPG::Codec::Lz4}) {
+            run(codec, payload, frames / 10 + 1); // warm-up
+            Result r = run(codec, payload, frames);
+            printf("%-8s %-6s %10.3f %14.0f %14.0f\n", kind, codec == BPG::Codec::None ? "none" : "lz4",
+                   r.ratio, r.encode_mbps, r.decode_mbps);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+// Verifies payload compression: LZ4 packets selected per TL decode to the
+// original bytes in owning and view mode, whole or straddling processData
+// calls and inside groups; incompressible binaries go out raw, and a corrupt
+// stream is dropped without touching memory it does not own.
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../bpg_compress.h"
+#include "../bpg_decoder.h"
+#include "../bpg_types.h"
+
+// Image-like rows: smooth gradients with a little noise, so LZ4 finds
+// some matches but not all
+static std::vector<uint8_t> makeBinary(uint32_t seed, size_t size, bool random) {
+    std::vector<uint8_t> bytes(size);
+    uint32_t state = seed * 2654435761u + 1;
+    for (size_t i = 0; i < size; i++) {
+        state = state * 1103515245u + 12345u;
+        bytes[i] = random ? static_cast<uint8_t>(state >> 24)
+                          : static_cast<uint8_t>((i % 256) / 4 + ((state >> 28) == 0 ? 1 : 0));
+    }
+    return bytes;
+}
+
+static uint32_t propOf(const std::vector<uint8_t>& stream, size_t packet_start) {
+    uint32_t prop_n;
+    std::memcpy(&prop_n, stream.data() + packet_start + BPG::BPG_FRAME_PREFIX_SIZE + sizeof(BPG::PacketType),
+                sizeof(prop_n));
+    return ntohl(prop_n);
+}
+
+struct Sent {
+    uint32_t group_id;
+    std::string tl;
+    std::string meta;
+    std::vector<uint8_t> binary;
+    bool compressed;
+};
+
+static void checkCodec() {
+    // Every sequence shape: tiny inputs, long literal runs, overlapping matches
+    for (size_t size : {0, 1, 12, 13, 64, 1000, 70000}) {
+        for (int kind = 0; kind < 3; kind++) {
+            std::vector<uint8_t> raw = kind == 0 ? std::vector<uint8_t>(size, 0x5a)
+                                     : makeBinary(static_cast<uint32_t>(size), size, kind == 2);
+            std::vector<uint8_t> packed(BPG::lz4CompressBound(size));
+            size_t n = BPG::lz4Compress(raw.data(), raw.size(), packed.data(), packed.size());
+            assert(n > 0 && n <= packed.size());
+            std::vector<uint8_t> back(size);
+            assert(BPG::lz4Decompress(packed.data(), n, back.data(), back.size()));
+            assert(back == raw);
+            if (size > 0) {
+                // Wrong raw size, truncated stream
+                assert(!BPG::lz4Decompress(packed.data(), n, back.data(), back.size() - 1));
+                assert(!BPG::lz4Decompress(packed.data(), n - 1, back.data(), back.size()));
+            }
+        }
+    }
+    // A capacity below the output is refused, not overrun
+    std::vector<uint8_t> raw = makeBinary(7, 5000, true);
+    std::vector<uint8_t> packed(100);
+    assert(BPG::lz4Compress(raw.data(), raw.size(), packed.data(), packed.size()) == 0);
+    printf("LZ4 block codec OK\n");
+}
+
+int main() {
+    checkCodec();
+
+    BPG::CodecTable codecs;
+    codecs.set("IM", BPG::Codec::Lz4, 1024);
+
+    // Groups of a compressed IM, an incompressible IM, a small IM under the
+    // threshold and a TX end packet whose TL has no codec
+    std::vector<Sent> sent;
+    std::vector<uint8_t> stream(1 << 20);
+    BPG::BufferWriter writer(stream.data(), stream.size());
+    for (uint32_t g = 0; g < 12; g++) {
+        BPG::AppPacketGroup group;
+        const char* tls[] = {"IM", "IM", "IM", "TX"};
+        for (int part = 0; part < 4; part++) {
+            BPG::AppPacket packet;
+            packet.group_id = g;
+            packet.target_id = 1;
+            std::memcpy(packet.tl, tls[part], 2);
+            packet.is_end_of_group = part == 3;
+            auto content = std::make_shared<BPG::HybridData>();
+            content->metadata_str = "{\"group\":" + std::to_string(g) + ",\"part\":" + std::to_string(part) + "}";
+            size_t size = part == 0 ? 20000 + 1000 * g : part == 1 ? 3000 : part == 2 ? 500 : 2000;
+            content->internal_binary_bytes = makeBinary(g * 4 + part, size, part == 1);
+            packet.content = content;
+            group.push_back(packet);
+            sent.push_back({g, tls[part], content->metadata_str, content->internal_binary_bytes, part == 0});
+        }
+        size_t start = writer.size();
+        BPG::BpgError err = BPG::encodeGroup(group, codecs, writer);
+        assert(err == BPG::BpgError::Success);
+        (void)err;
+        // Only the compressible IM carries the bit and the codec id
+        size_t at = start;
+        for (int part = 0; part < 4; part++) {
+            uint32_t prop = propOf(stream, at);
+            assert(BPG::codecFromProp(prop) == (part == 0 ? BPG::Codec::Lz4 : BPG::Codec::None));
+            assert(((prop & BPG::BPG_PROP_EG_BIT_MASK) != 0) == (part == 3));
+            uint32_t data_length_n;
+            std::memcpy(&data_length_n, stream.data() + at + BPG::BPG_WIRE_HEADER_SIZE - 4, 4);
+            at += BPG::BPG_WIRE_HEADER_SIZE + ntohl(data_length_n);
+        }
+        assert(at == writer.size());
+    }
+    stream.resize(writer.size());
+    size_t raw_total = 0;
+    for (const Sent& s : sent) raw_total += BPG::BPG_WIRE_HEADER_SIZE + 4 + s.meta.size() + s.binary.size();
+    printf("Encoded %zu packets: %zu bytes on the wire, %zu raw\n", sent.size(), stream.size(), raw_total);
+    assert(stream.size() < raw_total);
+
+    for (size_t chunk : {stream.size(), static_cast<size_t>(4096), static_cast<size_t>(7)}) {
+        // Owning mode
+        BPG::BpgDecoder decoder;
+        size_t next = 0, groups = 0;
+        BPG::AppPacketCallback on_packet = [&](const BPG::AppPacket& packet) {
+            const Sent& s = sent[next++];
+            assert(packet.group_id == s.group_id && std::string(packet.tl, 2) == s.tl);
+            assert(packet.content->metadata_str == s.meta && packet.content->internal_binary_bytes == s.binary);
+        };
+        BPG::AppPacketGroupCallback on_group = [&](uint32_t, BPG::AppPacketGroup&& group) {
+            assert(group.size() == 4 && group[0].content->internal_binary_bytes == sent[next - 4].binary);
+            groups++;
+        };
+        for (size_t off = 0; off < stream.size(); off += chunk) {
+            decoder.processData(stream.data() + off, std::min(chunk, stream.size() - off), on_packet, on_group);
+        }
+        assert(next == sent.size() && groups == 12);
+
+        // View mode: groups see every view valid, including inflated ones
+        // that waited for their EG packet; a pinned one outlives its group
+        BPG::BpgDecoder view_decoder;
+        next = groups = 0;
+        uint32_t pin_id = 0;
+        BPG::AppPacketView pinned{};
+        BPG::AppPacketViewCallback on_view = [&](const BPG::AppPacketView& view) {
+            const Sent& s = sent[next++];
+            assert(view.group_id == s.group_id && view.content.metadata == s.meta);
+            assert(view.content.binary.size == s.binary.size() &&
+                   std::memcmp(view.content.binary.data, s.binary.data(), s.binary.size()) == 0);
+            if (!pin_id && s.compressed) {
+                pinned = view;
+                pin_id = view_decoder.pin(pinned);
+                assert(pin_id != 0);
+            }
+        };
+        BPG::AppPacketViewGroupCallback on_view_group = [&](uint32_t group_id, const BPG::AppPacketView* views, size_t count) {
+            assert(count == 4);
+            for (size_t i = 0; i < count; i++) {
+                const Sent& s = sent[group_id * 4 + i];
+                assert(views[i].content.metadata == s.meta && views[i].content.binary.size == s.binary.size() &&
+                       std::memcmp(views[i].content.binary.data, s.binary.data(), s.binary.size()) == 0);
+            }
+            groups++;
+        };
+        for (size_t off = 0; off < stream.size(); off += chunk) {
+            view_decoder.processData(stream.data() + off, std::min(chunk, stream.size() - off), on_view, on_view_group);
+        }
+        assert(next == sent.size() && groups == 12);
+        assert(pinned.content.binary.size == sent[0].binary.size() &&
+               std::memcmp(pinned.content.binary.data, sent[0].binary.data(), sent[0].binary.size()) == 0);
+        view_decoder.release(pin_id);
+        const BPG::DecoderStats& stats = view_decoder.stats();
+        printf("Chunk %zu: %llu bytes received, %llu inflated, %llu copied\n", chunk,
+               (unsigned long long)stats.bytes_received, (unsigned long long)stats.bytes_inflated,
+               (unsigned long long)stats.bytes_copied);
+        size_t inflated = 0;
+        for (const Sent& s : sent) inflated += s.compressed ? s.binary.size() : 0;
+        assert(stats.bytes_inflated == inflated);
+    }
+
+    // A corrupt stream drops its packet; the rest of the traffic still
+    // decodes. The first compressed binary claims one byte less than it
+    // inflates to (the decoder would overrun its buffer)...
+    std::vector<uint8_t> corrupt = stream;
+    size_t binary_at = BPG::BPG_WIRE_HEADER_SIZE + 4 + sent[0].meta.size();
+    uint32_t short_n = htonl(static_cast<uint32_t>(sent[0].binary.size() - 1));
+    std::memcpy(corrupt.data() + binary_at, &short_n, 4);
+    // ...and the second group's claims an absurd raw size
+    size_t second = 0;
+    for (int p = 0; p < 4; p++) {
+        uint32_t data_length_n;
+        std::memcpy(&data_length_n, stream.data() + second + BPG::BPG_WIRE_HEADER_SIZE - 4, 4);
+        second += BPG::BPG_WIRE_HEADER_SIZE + ntohl(data_length_n);
+    }
+    uint32_t huge_n = htonl(0xfffffff0u);
+    std::memcpy(corrupt.data() + second + BPG::BPG_WIRE_HEADER_SIZE + 4 + sent[4].meta.size(), &huge_n, 4);
+
+    BPG::BpgDecoder decoder;
+    size_t packets = 0, compressed_ok = 0;
+    BPG::AppPacketViewCallback on_view = [&](const BPG::AppPacketView& view) {
+        packets++;
+        if (view.group_id >= 2 && view.content.binary.size == sent[view.group_id * 4].binary.size()) compressed_ok++;
+    };
+    BPG::AppPacketViewGroupCallback on_view_group = [&](uint32_t, const BPG::AppPacketView*, size_t) {};
+    decoder.processData(corrupt.data(), corrupt.size(), on_view, on_view_group);
+    printf("Corrupt streams: %zu packets delivered, %zu compressed\n", packets, compressed_ok);
+    assert(packets == sent.size() - 2 && compressed_ok == 10);
+
+    printf("Compression test PASSED.\n");
+    return 0;
+}
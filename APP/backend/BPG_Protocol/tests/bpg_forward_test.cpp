@@ -0,0 +1,123 @@
+// Verifies payload forwarding: the binary of every TX packet lands in the
+// forwarder's memory after exactly one copy, whether the packet arrives in
+// one piece or straddles processData calls, and a declined reservation falls
+// back to normal delivery.
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../bpg_decoder.h"
+#include "../bpg_types.h"
+
+static void appendFrame(std::vector<uint8_t>& stream, uint32_t group_id, const char* tl, bool end,
+                        const std::string& meta, size_t binary_size) {
+    std::vector<uint8_t> binary(binary_size, static_cast<uint8_t>(group_id));
+    size_t start = stream.size();
+    stream.resize(start + BPG::BPG_WIRE_HEADER_SIZE + 4 + meta.size() + binary_size);
+    BPG::BufferWriter writer(stream.data() + start, stream.size() - start);
+    BPG::BpgError err = BPG::AppPacket::s_encode(group_id, 1, tl, end ? BPG::BPG_PROP_EG_BIT_MASK : 0,
+        static_cast<uint32_t>(meta.size()), meta.data(),
+        static_cast<uint32_t>(binary_size), binary.data(), writer);
+    assert(err == BPG::BpgError::Success && writer.size() == stream.size() - start);
+    (void)err;
+}
+
+static void feedViews(BPG::BpgDecoder& decoder, const std::vector<uint8_t>& stream, size_t chunk,
+                      const BPG::AppPacketViewCallback& on_packet, const BPG::AppPacketViewGroupCallback& on_group) {
+    for (size_t off = 0; off < stream.size(); off += chunk) {
+        decoder.processData(stream.data() + off, std::min(chunk, stream.size() - off), on_packet, on_group);
+    }
+}
+
+int main() {
+    // Groups of an IM packet, a TX packet with a binary and a metadata-only TX end
+    std::vector<uint8_t> stream;
+    size_t forwarded_payload = 0;
+    for (uint32_t g = 0; g < 30; g++) {
+        std::string meta = "{\"group\":" + std::to_string(g) + "}";
+        appendFrame(stream, g, "IM", false, meta, 200);
+        appendFrame(stream, g, "TX", false, meta, 1000 + 500 * (g % 3));
+        appendFrame(stream, g, "TX", true, meta, 0);
+        forwarded_payload += 1000 + 500 * (g % 3);
+    }
+
+    std::vector<uint8_t> slot;
+    bool decline = false;
+    size_t reserved = 0, committed = 0, abandoned = 0, packets = 0, groups = 0;
+    BPG::PayloadForwarder forwarder;
+    forwarder.reserve = [&](const BPG::AppPacketView& packet, size_t size) -> uint8_t* {
+        assert(std::memcmp(packet.tl, "TX", 2) == 0 && packet.content.binary.empty());
+        assert(packet.content.metadata == "{\"group\":" + std::to_string(packet.group_id) + "}");
+        if (decline) return nullptr;
+        reserved++;
+        slot.assign(size, 0);
+        return slot.data();
+    };
+    forwarder.commit = [&](const BPG::AppPacketView& packet, bool complete) {
+        assert(packet.content.binary.data == slot.data());
+        if (!complete) {
+            abandoned++;
+            return;
+        }
+        for (uint8_t byte : slot) assert(byte == static_cast<uint8_t>(packet.group_id));
+        committed++;
+    };
+    BPG::AppPacketViewCallback on_view = [&](const BPG::AppPacketView& packet) {
+        packets++;
+        bool tx = std::memcmp(packet.tl, "TX", 2) == 0;
+        if (tx && !decline && !packet.content.binary.empty()) {
+            assert(packet.content.binary.data == slot.data());
+        }
+    };
+    BPG::AppPacketViewGroupCallback on_view_group = [&](uint32_t, const BPG::AppPacketView* views, size_t count) {
+        groups++;
+        assert(count == 3 && views[0].content.binary.size == 200);
+        // The forwarder owns the binary of a forwarded packet
+        assert(views[1].content.binary.empty() == !decline);
+    };
+
+    BPG::BpgDecoder decoder;
+    decoder.setPayloadForwarder("TX", forwarder);
+    for (size_t chunk : {stream.size(), static_cast<size_t>(4096), static_cast<size_t>(7)}) {
+        // Declined reservations: every packet is delivered as usual
+        decline = true;
+        decoder.resetStats();
+        reserved = committed = packets = groups = 0;
+        feedViews(decoder, stream, chunk, on_view, on_view_group);
+        uint64_t declined_copied = decoder.stats().bytes_copied;
+        printf("Declined, chunk %zu: %zu packets, %zu groups, %llu bytes copied\n",
+               chunk, packets, groups, (unsigned long long)declined_copied);
+        assert(packets == 90 && groups == 30 && committed == 0);
+        assert(decoder.stats().bytes_forwarded == 0);
+
+        decline = false;
+        decoder.resetStats();
+        reserved = committed = packets = groups = 0;
+        feedViews(decoder, stream, chunk, on_view, on_view_group);
+        const BPG::DecoderStats& stats = decoder.stats();
+        printf("Forwarding, chunk %zu: %zu packets, %zu groups, %zu forwarded, %llu bytes forwarded, %llu bytes copied\n",
+               chunk, packets, groups, committed,
+               (unsigned long long)stats.bytes_forwarded, (unsigned long long)stats.bytes_copied);
+        assert(packets == 90 && groups == 30 && reserved == 30 && committed == 30);
+        assert(stats.bytes_forwarded == forwarded_payload);
+        if (chunk == stream.size()) {
+            // Nothing straddles: the forwarded binaries are the only copies
+            assert(stats.bytes_copied == stats.bytes_forwarded);
+        } else if (chunk == 7) {
+            // Everything straddles: the forwarded binaries are no longer staged
+            assert(stats.bytes_copied - stats.bytes_forwarded + forwarded_payload <= declined_copied);
+        }
+    }
+
+    // reset() in the middle of a forwarded binary drops its reservation
+    size_t first_tx = BPG::BPG_WIRE_HEADER_SIZE + 4 + std::string("{\"group\":0}").size() + 200;
+    decoder.reset();
+    decoder.processData(stream.data(), first_tx + 100, on_view, on_view_group);
+    decoder.reset();
+    printf("Reset while forwarding: %zu abandoned\n", abandoned);
+    assert(abandoned == 1);
+
+    printf("Forwarding test PASSED.\n");
+    return 0;
+}
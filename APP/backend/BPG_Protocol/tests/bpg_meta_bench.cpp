@@ -0,0 +1,123 @@
+// Compares the metadata cost of a small-ROI image stream: the JSON
+// metadata_str create_image_packet used to build (std::to_string
+// concatenation, then field lookup on the receiving side) against the
+// binary ImageMeta block (BPG_PROP_BIN_META_BIT_MASK). Each frame is encoded
+// into a buffer and decoded with view callbacks, like a 1000-fps stream.
+// The JSON side is read with a minimal key scan rather than a full parser,
+// so its cost here is a lower bound.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../bpg_decoder.h"
+#include "../bpg_types.h"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string json_meta(const BPG::ImageMeta& meta, const std::string& format) {
+    return "{\"width\":" + std::to_string(meta.width) +
+           ",\"height\":" + std::to_string(meta.height) +
+           ",\"channels\":" + std::to_string(meta.channels) +
+           ",\"type\":" + std::to_string(meta.type) +
+           ",\"format\":\"" + format + "\"}";
+}
+
+static unsigned long json_number(std::string_view json, const char* key) {
+    size_t at = json.find(key);
+    if (at == std::string_view::npos) return 0;
+    return std::strtoul(json.data() + at + std::strlen(key), nullptr, 10);
+}
+
+static bool parse_json_meta(std::string_view json, BPG::ImageMeta& out) {
+    out.width = static_cast<uint32_t>(json_number(json, "\"width\":"));
+    out.height = static_cast<uint32_t>(json_number(json, "\"height\":"));
+    out.channels = static_cast<uint16_t>(json_number(json, "\"channels\":"));
+    out.type = static_cast<uint16_t>(json_number(json, "\"type\":"));
+    out.format = json.find("\"format\":\"raw_rgba\"") != std::string_view::npos ? BPG::ImageFormat::RawRgba
+               : BPG::ImageFormat::Unspecified;
+    return out.width != 0;
+}
+
+struct Result {
+    double encode_ns;
+    double decode_ns;
+    size_t meta_bytes;
+};
+
+static Result run(bool binary, size_t frames, size_t roi_side) {
+    std::vector<uint8_t> roi(roi_side * roi_side * 4, 0x7f);
+    std::vector<uint8_t> wire(BPG::BPG_WIRE_HEADER_SIZE + 256 + roi.size());
+    BPG::AppPacket packet;
+    packet.group_id = 1; packet.target_id = 1; std::memcpy(packet.tl, "IM", 2); packet.is_end_of_group = true;
+    auto content = std::make_shared<BPG::HybridData>();
+    content->external_binary_bytes = BPG::BufferWriter(roi.data(), roi.size(), roi.size());
+    packet.content = content;
+
+    BPG::BpgDecoder decoder;
+    uint64_t checksum = 0, decoded = 0;
+    BPG::AppPacketViewCallback on_packet = [&](const BPG::AppPacketView& view) {
+        BPG::ImageMeta meta;
+        bool ok = binary ? view.content.imageMeta(meta) : parse_json_meta(view.content.metadata, meta);
+        if (ok && meta.format == BPG::ImageFormat::RawRgba) {
+            checksum += meta.width + meta.height + meta.channels + meta.type;
+            decoded++;
+        }
+    };
+    BPG::AppPacketViewGroupCallback on_group;
+
+    double encode_s = 0, decode_s = 0;
+    size_t meta_bytes = 0;
+    for (size_t i = 0; i < frames; i++) {
+        BPG::ImageMeta meta;
+        meta.width = static_cast<uint32_t>(roi_side + i % 7);
+        meta.height = static_cast<uint32_t>(roi_side);
+        meta.channels = 4;
+        meta.type = 24; // CV_8UC4
+        meta.format = BPG::ImageFormat::RawRgba;
+
+        auto start = std::chrono::steady_clock::now();
+        if (binary) {
+            content->setImageMeta(meta);
+        } else {
+            content->metadata_str = json_meta(meta, "raw_rgba");
+        }
+        BPG::BufferWriter writer(wire.data(), wire.size());
+        packet.encode(writer);
+        encode_s += seconds_since(start);
+        meta_bytes = content->metadata_str.size();
+
+        start = std::chrono::steady_clock::now();
+        decoder.processData(wire.data(), writer.size(), on_packet, on_group);
+        decode_s += seconds_since(start);
+    }
+    if (decoded != frames || checksum == 0) {
+        printf("FAILED: %s metadata decoded %llu of %zu frames\n", binary ? "binary" : "JSON",
+               (unsigned long long)decoded, frames);
+        std::exit(1);
+    }
+    return {encode_s * 1e9 / frames, decode_s * 1e9 / frames, meta_bytes};
+}
+
+int main(int argc, char** argv) {
+    size_t frames = argc > 1 ? std::stoul(argv[1]) : 200000;
+    size_t roi_side = argc > 2 ? std::stoul(argv[2]) : 32; // 32x32 RGBA ROI
+
+    run(false, frames / 10, roi_side); // warm-up
+    run(true, frames / 10, roi_side);
+    Result json = run(false, frames, roi_side);
+    Result bin = run(true, frames, roi_side);
+
+    printf("%zu frames, %zux%zu RGBA ROI (%zu bytes)\n", frames, roi_side, roi_side, roi_side * roi_side * 4);
+    printf("%-8s %10s %14s %14s %14s\n", "metadata", "bytes", "encode ns", "decode ns", "total ns");
+    printf("%-8s %10zu %14.0f %14.0f %14.0f\n", "JSON", json.meta_bytes, json.encode_ns, json.decode_ns,
+           json.encode_ns + json.decode_ns);
+    printf("%-8s %10zu %14.0f %14.0f %14.0f\n", "binary", bin.meta_bytes, bin.encode_ns, bin.decode_ns,
+           bin.encode_ns + bin.decode_ns);
+    printf("speedup  %10s %13.1fx %13.1fx %13.1fx\n", "", json.encode_ns / bin.encode_ns,
+           json.decode_ns / bin.decode_ns, (json.encode_ns + json.decode_ns) / (bin.encode_ns + bin.decode_ns));
+    return 0;
+}
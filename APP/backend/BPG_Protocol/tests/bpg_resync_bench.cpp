@@ -0,0 +1,87 @@
+// Measures how fast BpgDecoder skips garbage in front of a valid frame
+// (e.g. after a renderer reload mid-stream). Compares the decoder against a
+// byte-at-a-time magic scan, which is what resync used to cost.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "../bpg_decoder.h"
+#include "../bpg_types.h"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reference: check the 4-byte magic at every offset
+static size_t naive_scan(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i + BPG::BPG_FRAME_PREFIX_SIZE <= len; i++) {
+        uint32_t magic_n;
+        std::memcpy(&magic_n, data + i, sizeof(magic_n));
+        if (ntohl(magic_n) == BPG::BPG_FRAME_MAGIC) return i;
+    }
+    return len;
+}
+
+static std::vector<uint8_t> make_stream(size_t garbage_size, const std::string& kind) {
+    std::vector<uint8_t> stream(garbage_size);
+    if (kind == "random") {
+        std::mt19937 rng(42);
+        for (auto& b : stream) b = static_cast<uint8_t>(rng());
+    } else if (kind == "magic-byte") {
+        std::fill(stream.begin(), stream.end(), static_cast<uint8_t>(BPG::BPG_FRAME_MAGIC >> 24));
+    } // "zeros": left as is
+
+    std::vector<uint8_t> frame(256);
+    BPG::BufferWriter writer(frame.data(), frame.size());
+    BPG::AppPacket packet;
+    packet.group_id = 1; packet.target_id = 1; std::memcpy(packet.tl, "TX", 2); packet.is_end_of_group = true;
+    packet.content = std::make_shared<BPG::HybridData>();
+    packet.content->metadata_str = "{\"after\":\"garbage\"}";
+    packet.encode(writer);
+    stream.insert(stream.end(), frame.begin(), frame.begin() + writer.size());
+    return stream;
+}
+
+int main(int argc, char** argv) {
+    size_t garbage_mb = argc > 1 ? std::stoul(argv[1]) : 16;
+    const size_t chunk = 64 * 1024; // typical R2N message size
+    const int rounds = 5;
+
+    printf("%-11s %10s %14s %14s %8s\n", "garbage", "MB", "decoder MB/s", "naive MB/s", "speedup");
+    for (const char* kind : {"zeros", "random", "magic-byte"}) {
+        std::vector<uint8_t> stream = make_stream(garbage_mb * 1024 * 1024, kind);
+
+        double decoder_s = 0;
+        for (int r = 0; r < rounds; r++) {
+            BPG::BpgDecoder decoder;
+            int groups = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t off = 0; off < stream.size(); off += chunk) {
+                size_t n = std::min(chunk, stream.size() - off);
+                decoder.processData(stream.data() + off, n,
+                    BPG::AppPacketViewCallback(),
+                    [&](uint32_t, const BPG::AppPacketView*, size_t) { groups++; });
+            }
+            decoder_s += seconds_since(start);
+            if (groups != 1) {
+                printf("FAILED: frame after %s garbage not decoded\n", kind);
+                return 1;
+            }
+        }
+
+        double naive_s = 0;
+        volatile size_t sink = 0;
+        for (int r = 0; r < rounds; r++) {
+            auto start = std::chrono::steady_clock::now();
+            sink = naive_scan(stream.data(), stream.size());
+            naive_s += seconds_since(start);
+        }
+        (void)sink;
+
+        double mb = static_cast<double>(garbage_mb) * rounds;
+        printf("%-11s %10zu %14.0f %14.0f %7.1fx\n", kind, garbage_mb, mb / decoder_s, mb / naive_s, naive_s / decoder_s);
+    }
+    return 0;
+}
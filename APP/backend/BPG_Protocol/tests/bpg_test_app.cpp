@@ -14,6 +14,8 @@
 #include <algorithm> // for std::max
 #include <cctype> // for std::isprint, std::isspace
 #include <iomanip>
+#include <chrono>
+#include <thread>
 
 // --- Test Callbacks --- 
 std::map<uint32_t, BPG::AppPacketGroup> received_groups;
@@ -231,9 +233,198 @@ int testCase_SinglePacketGroup() {
     return 0;
 }
 
+// --- Test Case: Stream Split Into Small Chunks ---
+int testCase_ChunkedStream() {
+    std::cout << "\n--- Test Case: Chunked Stream --- " << std::endl;
+    received_groups.clear();
+    BPG::BpgDecoder decoder;
+
+    uint32_t group_id = 301;
+    std::vector<uint8_t> stream_vec(4096);
+    BPG::BufferWriter writer(stream_vec.data(), stream_vec.size());
+    for (int i = 0; i < 4; i++) {
+        BPG::AppPacket packet;
+        packet.group_id = group_id; packet.target_id = 11; std::memcpy(packet.tl, "TX", 2); packet.is_end_of_group = (i == 3);
+        packet.content = std::make_shared<BPG::HybridData>();
+        packet.content->metadata_str = "{\"part\":" + std::to_string(i) + "}";
+        BPG::BpgError encode_err = packet.encode(writer);
+        assert(encode_err == BPG::BpgError::Success);
+    }
+    size_t stream_size = writer.size();
+
+    // Feed 1..7 bytes at a time so headers and payloads straddle calls
+    size_t offset = 0;
+    for (size_t chunk = 1; offset < stream_size; chunk = chunk % 7 + 1) {
+        size_t n = std::min(chunk, stream_size - offset);
+        decoder.processData(stream_vec.data() + offset, n, testPacketCallback, testGroupCallback);
+        offset += n;
+    }
+
+    assert(received_groups.count(group_id));
+    const auto& received_group = received_groups[group_id];
+    assert(received_group.size() == 4);
+    for (int i = 0; i < 4; i++) {
+        assert(received_group[i].content->metadata_str == "{\"part\":" + std::to_string(i) + "}");
+    }
+    const BPG::DecoderStats& stats = decoder.stats();
+    std::cout << "Bytes received: " << stats.bytes_received << ", copied: " << stats.bytes_copied
+              << " (" << stats.copiesPerByte() << " copies/byte)" << std::endl;
+    assert(stats.bytes_received == stream_size);
+    std::cout << "Chunked Stream PASSED." << std::endl;
+    return 0;
+}
+
+// --- Test Case: Zero-copy View Callbacks ---
+int testCase_ViewCallbacks() {
+    std::cout << "\n--- Test Case: View Callbacks --- " << std::endl;
+    BPG::BpgDecoder decoder;
+
+    uint32_t group_id = 401;
+    std::vector<uint8_t> stream_vec(4096);
+    BPG::BufferWriter writer(stream_vec.data(), stream_vec.size());
+    for (int i = 0; i < 3; i++) {
+        BPG::AppPacket packet;
+        packet.group_id = group_id; packet.target_id = 12; std::memcpy(packet.tl, "TX", 2); packet.is_end_of_group = (i == 2);
+        packet.content = std::make_shared<BPG::HybridData>();
+        packet.content->metadata_str = "{\"part\":" + std::to_string(i) + "}";
+        BPG::BpgError encode_err = packet.encode(writer);
+        assert(encode_err == BPG::BpgError::Success);
+    }
+    size_t stream_size = writer.size();
+
+    size_t packet_count = 0;
+    size_t group_size = 0;
+    BPG::AppPacketView pinned_view;
+    uint32_t pin_id = 0;
+    BPG::AppPacketViewCallback on_packet = [&](const BPG::AppPacketView&) {
+        packet_count++;
+    };
+    BPG::AppPacketViewGroupCallback on_group = [&](uint32_t id, const BPG::AppPacketView* packets, size_t count) {
+        group_size = count;
+        for (size_t i = 0; i < count; i++) {
+            assert(packets[i].group_id == id);
+            assert(packets[i].content.metadata == "{\"part\":" + std::to_string(i) + "}");
+        }
+        pinned_view = packets[0];
+        pin_id = decoder.pin(pinned_view);
+    };
+
+    // Split mid-way so the first packets outlive their processData call
+    size_t half = stream_size / 2;
+    decoder.processData(stream_vec.data(), half, on_packet, on_group);
+    decoder.processData(stream_vec.data() + half, stream_size - half, on_packet, on_group);
+
+    assert(packet_count == 3);
+    assert(group_size == 3);
+    std::fill(stream_vec.begin(), stream_vec.end(), 0); // pinned view must not depend on the input
+    assert(pin_id != 0);
+    assert(pinned_view.content.metadata == "{\"part\":0}");
+    decoder.release(pin_id);
+    std::cout << "View Callbacks PASSED." << std::endl;
+    return 0;
+}
+
+// --- Test Case: Single-pass Encode Round Trip ---
+int testCase_EncodeRoundTrip() {
+    std::cout << "\n--- Test Case: Encode Round Trip --- " << std::endl;
+    received_groups.clear();
+    BPG::BpgDecoder decoder;
+
+    uint32_t group_id = 501;
+    std::vector<uint8_t> internal_bytes = {1, 2, 3, 4, 5};
+    std::vector<uint8_t> external_bytes = {9, 8, 7};
+    std::vector<uint8_t> head = {0xAA, 0xBB}, tail = {0xCC};
+
+    BPG::AppPacketGroup group_def(2);
+    group_def[0].group_id = group_id; group_def[0].target_id = 13; std::memcpy(group_def[0].tl, "IM", 2); group_def[0].is_end_of_group = false;
+    group_def[0].content = std::make_shared<BPG::HybridData>();
+    group_def[0].content->metadata_str = "{\"w\":5}";
+    group_def[0].content->internal_binary_bytes = internal_bytes;
+    group_def[1].group_id = group_id; group_def[1].target_id = 13; std::memcpy(group_def[1].tl, "EX", 2); group_def[1].is_end_of_group = false;
+    group_def[1].content = std::make_shared<BPG::HybridData>();
+    group_def[1].content->external_binary_bytes.init(external_bytes.data(), external_bytes.size(), external_bytes.size());
+
+    std::vector<uint8_t> stream_vec(1024);
+    BPG::BufferWriter writer(stream_vec.data(), stream_vec.size());
+    BPG::BpgError encode_err = BPG::encodeGroup(group_def, writer);
+    assert(encode_err == BPG::BpgError::Success);
+    // Binary gathered from two fragments, closing the group
+    BPG::Fragment fragments[] = {{head.data(), head.size()}, {tail.data(), tail.size()}};
+    encode_err = BPG::AppPacket::s_encode_fragments(group_id, 13, "FR", BPG::BPG_PROP_EG_BIT_MASK, 0, "", fragments, 2, writer);
+    assert(encode_err == BPG::BpgError::Success);
+
+    // A writer that is too small fails cleanly and keeps nothing
+    std::vector<uint8_t> small_vec(20);
+    BPG::BufferWriter small_writer(small_vec.data(), small_vec.size());
+    assert(BPG::encodeGroup(group_def, small_writer) == BPG::BpgError::BufferTooSmall);
+    assert(small_writer.size() == 0);
+
+    decoder.processData(stream_vec.data(), writer.size(), testPacketCallback, testGroupCallback);
+
+    assert(received_groups.count(group_id));
+    const auto& received_group = received_groups[group_id];
+    assert(received_group.size() == 3);
+    assert(received_group[0].content->metadata_str == "{\"w\":5}");
+    assert(received_group[0].content->internal_binary_bytes == internal_bytes);
+    assert(received_group[1].content->internal_binary_bytes == external_bytes);
+    assert(received_group[2].content->internal_binary_bytes == std::vector<uint8_t>({0xAA, 0xBB, 0xCC}));
+    assert(received_group[2].is_end_of_group);
+    std::cout << "Encode Round Trip PASSED." << std::endl;
+    return 0;
+}
+
+// --- Test Case: Stale Group Expiry ---
+int testCase_StaleGroupExpiry() {
+    std::cout << "\n--- Test Case: Stale Group Expiry --- " << std::endl;
+    received_groups.clear();
+    BPG::BpgDecoder decoder;
+
+    // Encodes one packet with a 3-byte binary payload
+    auto encodePacket = [](uint32_t group_id, bool end_of_group) {
+        BPG::AppPacket packet;
+        packet.group_id = group_id; packet.target_id = 1; std::memcpy(packet.tl, "TX", 2); packet.is_end_of_group = end_of_group;
+        auto data = std::make_shared<BPG::HybridData>();
+        data->internal_binary_bytes = {1, 2, 3};
+        packet.content = data;
+        std::vector<uint8_t> bytes(BPG::BPG_WIRE_HEADER_SIZE + data->calculateEncodedSize());
+        BPG::BufferWriter writer(bytes.data(), bytes.size());
+        BPG::BpgError err = packet.encode(writer);
+        assert(err == BPG::BpgError::Success);
+        bytes.resize(writer.size());
+        return bytes;
+    };
+
+    // Group 401 loses its EG packet; group 402 completes
+    std::vector<uint8_t> lost = encodePacket(401, false);
+    std::vector<uint8_t> head = encodePacket(402, false);
+    std::vector<uint8_t> tail = encodePacket(402, true);
+    decoder.processData(lost.data(), lost.size(), testPacketCallback, testGroupCallback);
+    decoder.processData(head.data(), head.size(), testPacketCallback, testGroupCallback);
+    decoder.processData(tail.data(), tail.size(), testPacketCallback, testGroupCallback);
+    assert(received_groups.count(402) && !received_groups.count(401));
+    assert(decoder.expireStaleGroups(std::chrono::milliseconds(50)) == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    std::vector<uint8_t> fresh = encodePacket(403, false);
+    decoder.processData(fresh.data(), fresh.size(), testPacketCallback, testGroupCallback);
+    assert(decoder.expireStaleGroups(std::chrono::milliseconds(50)) == 1);
+    assert(decoder.stats().groups_expired == 1);
+
+    // A late EG for the expired group arrives as a group of its own
+    std::vector<uint8_t> late = encodePacket(401, true);
+    decoder.processData(late.data(), late.size(), testPacketCallback, testGroupCallback);
+    assert(received_groups[401].size() == 1);
+    std::cout << "Stale Group Expiry PASSED." << std::endl;
+    return 0;
+}
+
 int main() {
     if (testCase_InterleavedGroups() != 0) return 1;
     if (testCase_SinglePacketGroup() != 0) return 1; // Renamed test
+    if (testCase_ChunkedStream() != 0) return 1;
+    if (testCase_ViewCallbacks() != 0) return 1;
+    if (testCase_EncodeRoundTrip() != 0) return 1;
+    if (testCase_StaleGroupExpiry() != 0) return 1;
 
     std::cout << "\n--------------------------\n";
     std::cout << "All test cases PASSED." << std::endl;
@@ -0,0 +1,471 @@
+#include "pixel_convert.h"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_CONVERT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || (defined(__ARM_NEON) && defined(__arm__))
+#define PIXEL_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang compile each x86 kernel for its own instruction set, so the file
+// needs no global -mavx2 and still runs on older CPUs. MSVC accepts the
+// intrinsics without flags.
+#if defined(PIXEL_CONVERT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PIXEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PIXEL_TARGET(isa)
+#endif
+
+namespace PixelConvert {
+
+namespace {
+
+// Fixed-point factor for u16 -> u8 normalization: (min(v, max) * k) >> 16.
+// Rounded up so that max_value itself maps to exactly 255.
+inline uint32_t u16_scale(uint16_t max_value) {
+    return (255u * 65536u + max_value - 1) / max_value;
+}
+
+// --- Scalar kernels (reference results and tails) ---
+
+void gray_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        uint8_t g = src[i];
+        dst[0] = g;
+        dst[1] = g;
+        dst[2] = g;
+        dst[3] = 255;
+        dst += 4;
+    }
+}
+
+void rgb_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+        src += 3;
+        dst += 4;
+    }
+}
+
+void bgr_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = 255;
+        src += 3;
+        dst += 4;
+    }
+}
+
+void u16_to_u8_scalar(const uint16_t* src, uint8_t* dst, size_t count, uint16_t max_value) {
+    uint32_t k = u16_scale(max_value);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = src[i] < max_value ? src[i] : max_value;
+        dst[i] = static_cast<uint8_t>((v * k) >> 16);
+    }
+}
+
+#if defined(PIXEL_CONVERT_X86)
+
+// --- SSE2 / SSSE3 kernels, 16 pixels per iteration ---
+
+PIXEL_TARGET("sse2")
+void gray_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i gg_lo = _mm_unpacklo_epi8(g, g);       // g0 g0 g1 g1 ...
+        __m128i gg_hi = _mm_unpackhi_epi8(g, g);
+        __m128i ga_lo = _mm_unpacklo_epi8(g, alpha);   // g0 FF g1 FF ...
+        __m128i ga_hi = _mm_unpackhi_epi8(g, alpha);
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(gg_lo, ga_lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gg_lo, ga_lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(gg_hi, ga_hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(gg_hi, ga_hi));
+    }
+    gray_to_rgba_scalar(src + i, dst + i * 4, pixels - i);
+}
+
+// 16 pixels = 48 source bytes, taken as four 4-pixel groups. The last group
+// is loaded from byte 32 (not 36) so no load reads past the block; its mask
+// is shifted by 4 instead.
+PIXEL_TARGET("ssse3")
+void rgb3_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t pixels, bool swap) {
+    const __m128i mask_keep = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i mask_keep_tail = _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    const __m128i mask_swap = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i mask_swap_tail = _mm_setr_epi8(6, 5, 4, -1, 9, 8, 7, -1, 12, 11, 10, -1, 15, 14, 13, -1);
+    const __m128i mask = swap ? mask_swap : mask_keep;
+    const __m128i mask_tail = swap ? mask_swap_tail : mask_keep_tail;
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const uint8_t* s = src + i * 3;
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 0));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 12));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 24));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+        _mm_storeu_si128(out + 0, _mm_or_si128(_mm_shuffle_epi8(a, mask), alpha));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(b, mask), alpha));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(c, mask), alpha));
+        _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(d, mask_tail), alpha));
+    }
+    if (swap) {
+        bgr_to_rgba_scalar(src + i * 3, dst + i * 4, pixels - i);
+    } else {
+        rgb_to_rgba_scalar(src + i * 3, dst + i * 4, pixels - i);
+    }
+}
+
+PIXEL_TARGET("ssse3")
+void rgb_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    rgb3_to_rgba_ssse3(src, dst, pixels, false);
+}
+
+PIXEL_TARGET("ssse3")
+void bgr_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    rgb3_to_rgba_ssse3(src, dst, pixels, true);
+}
+
+PIXEL_TARGET("sse2")
+void u16_to_u8_ssse3(const uint16_t* src, uint8_t* dst, size_t count, uint16_t max_value) {
+    uint32_t k = u16_scale(max_value);
+    if (k > 0xFFFF) { // max_value < 256: factor does not fit mulhi
+        u16_to_u8_scalar(src, dst, count, max_value);
+        return;
+    }
+    const __m128i maxv = _mm_set1_epi16(static_cast<short>(max_value));
+    const __m128i kv = _mm_set1_epi16(static_cast<short>(k));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        // unsigned min without SSE4.1: v - sat(v - max)
+        a = _mm_sub_epi16(a, _mm_subs_epu16(a, maxv));
+        b = _mm_sub_epi16(b, _mm_subs_epu16(b, maxv));
+        a = _mm_mulhi_epu16(a, kv);
+        b = _mm_mulhi_epu16(b, kv);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+    }
+    u16_to_u8_scalar(src + i, dst + i, count - i, max_value);
+}
+
+// --- AVX2 kernels, 32 / 16 pixels per iteration ---
+
+PIXEL_TARGET("avx2")
+void gray_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    const __m256i alpha = _mm256_set1_epi8(static_cast<char>(0xFF));
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        // Lane 0 gets pixels 0-7 and 16-23, lane 1 gets 8-15 and 24-31, so
+        // the in-lane unpacks below come out in pixel order.
+        g = _mm256_permute4x64_epi64(g, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i gg_lo = _mm256_unpacklo_epi8(g, g);
+        __m256i gg_hi = _mm256_unpackhi_epi8(g, g);
+        __m256i ga_lo = _mm256_unpacklo_epi8(g, alpha);
+        __m256i ga_hi = _mm256_unpackhi_epi8(g, alpha);
+        __m256i p0 = _mm256_unpacklo_epi16(gg_lo, ga_lo); // pixels 0-3 | 8-11
+        __m256i p1 = _mm256_unpackhi_epi16(gg_lo, ga_lo); // pixels 4-7 | 12-15
+        __m256i p2 = _mm256_unpacklo_epi16(gg_hi, ga_hi); // pixels 16-19 | 24-27
+        __m256i p3 = _mm256_unpackhi_epi16(gg_hi, ga_hi); // pixels 20-23 | 28-31
+        __m256i* out = reinterpret_cast<__m256i*>(dst + i * 4);
+        _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p0, p1, 0x31));
+        _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p2, p3, 0x20));
+        _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+    }
+    gray_to_rgba_ssse3(src + i, dst + i * 4, pixels - i);
+}
+
+PIXEL_TARGET("avx2")
+inline __m256i load_two_groups(const uint8_t* lo, const uint8_t* hi) {
+    __m256i v = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo)));
+    return _mm256_inserti128_si256(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)), 1);
+}
+
+// Same grouping as the SSSE3 kernel, two 4-pixel groups per 256-bit register
+PIXEL_TARGET("avx2")
+void rgb3_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t pixels, bool swap) {
+    const __m256i mask_keep = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i mask_keep_tail = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    const __m256i mask_swap = _mm256_setr_epi8(
+        2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+        2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m256i mask_swap_tail = _mm256_setr_epi8(
+        2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+        6, 5, 4, -1, 9, 8, 7, -1, 12, 11, 10, -1, 15, 14, 13, -1);
+    const __m256i mask = swap ? mask_swap : mask_keep;
+    const __m256i mask_tail = swap ? mask_swap_tail : mask_keep_tail;
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const uint8_t* s = src + i * 3;
+        __m256i* out = reinterpret_cast<__m256i*>(dst + i * 4);
+        __m256i ab = load_two_groups(s + 0, s + 12);
+        __m256i cd = load_two_groups(s + 24, s + 32);
+        _mm256_storeu_si256(out + 0, _mm256_or_si256(_mm256_shuffle_epi8(ab, mask), alpha));
+        _mm256_storeu_si256(out + 1, _mm256_or_si256(_mm256_shuffle_epi8(cd, mask_tail), alpha));
+    }
+    if (swap) {
+        bgr_to_rgba_scalar(src + i * 3, dst + i * 4, pixels - i);
+    } else {
+        rgb_to_rgba_scalar(src + i * 3, dst + i * 4, pixels - i);
+    }
+}
+
+PIXEL_TARGET("avx2")
+void rgb_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    rgb3_to_rgba_avx2(src, dst, pixels, false);
+}
+
+PIXEL_TARGET("avx2")
+void bgr_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    rgb3_to_rgba_avx2(src, dst, pixels, true);
+}
+
+PIXEL_TARGET("avx2")
+void u16_to_u8_avx2(const uint16_t* src, uint8_t* dst, size_t count, uint16_t max_value) {
+    uint32_t k = u16_scale(max_value);
+    if (k > 0xFFFF) {
+        u16_to_u8_scalar(src, dst, count, max_value);
+        return;
+    }
+    const __m256i maxv = _mm256_set1_epi16(static_cast<short>(max_value));
+    const __m256i kv = _mm256_set1_epi16(static_cast<short>(k));
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16));
+        a = _mm256_mulhi_epu16(_mm256_min_epu16(a, maxv), kv);
+        b = _mm256_mulhi_epu16(_mm256_min_epu16(b, maxv), kv);
+        // packus works per lane; restore pixel order afterwards
+        __m256i packed = _mm256_packus_epi16(a, b);
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    u16_to_u8_ssse3(src + i, dst + i, count - i, max_value);
+}
+
+#endif // PIXEL_CONVERT_X86
+
+#if defined(PIXEL_CONVERT_NEON)
+
+// --- NEON kernels, 16 pixels per iteration (interleaving loads/stores) ---
+
+void gray_to_rgba_neon(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    uint8x16x4_t rgba;
+    rgba.val[3] = vdupq_n_u8(255);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16_t g = vld1q_u8(src + i);
+        rgba.val[0] = g;
+        rgba.val[1] = g;
+        rgba.val[2] = g;
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    gray_to_rgba_scalar(src + i, dst + i * 4, pixels - i);
+}
+
+void rgb_to_rgba_neon(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    uint8x16x4_t rgba;
+    rgba.val[3] = vdupq_n_u8(255);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+        rgba.val[0] = rgb.val[0];
+        rgba.val[1] = rgb.val[1];
+        rgba.val[2] = rgb.val[2];
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    rgb_to_rgba_scalar(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void bgr_to_rgba_neon(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    uint8x16x4_t rgba;
+    rgba.val[3] = vdupq_n_u8(255);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x3_t bgr = vld3q_u8(src + i * 3);
+        rgba.val[0] = bgr.val[2];
+        rgba.val[1] = bgr.val[1];
+        rgba.val[2] = bgr.val[0];
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    bgr_to_rgba_scalar(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void u16_to_u8_neon(const uint16_t* src, uint8_t* dst, size_t count, uint16_t max_value) {
+    uint32_t k = u16_scale(max_value);
+    if (k > 0xFFFF) {
+        u16_to_u8_scalar(src, dst, count, max_value);
+        return;
+    }
+    const uint16x8_t maxv = vdupq_n_u16(max_value);
+    const uint16x4_t kv = vdup_n_u16(static_cast<uint16_t>(k));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t v = vminq_u16(vld1q_u16(src + i), maxv);
+        uint32x4_t lo = vmull_u16(vget_low_u16(v), kv);
+        uint32x4_t hi = vmull_u16(vget_high_u16(v), kv);
+        uint16x8_t scaled = vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+        vst1_u8(dst + i, vmovn_u16(scaled));
+    }
+    u16_to_u8_scalar(src + i, dst + i, count - i, max_value);
+}
+
+#endif // PIXEL_CONVERT_NEON
+
+// --- Dispatch ---
+
+struct Kernels {
+    void (*gray_to_rgba)(const uint8_t*, uint8_t*, size_t);
+    void (*rgb_to_rgba)(const uint8_t*, uint8_t*, size_t);
+    void (*bgr_to_rgba)(const uint8_t*, uint8_t*, size_t);
+    void (*u16_to_u8)(const uint16_t*, uint8_t*, size_t, uint16_t);
+};
+
+const Kernels SCALAR_KERNELS = {gray_to_rgba_scalar, rgb_to_rgba_scalar, bgr_to_rgba_scalar, u16_to_u8_scalar};
+#if defined(PIXEL_CONVERT_X86)
+const Kernels SSSE3_KERNELS = {gray_to_rgba_ssse3, rgb_to_rgba_ssse3, bgr_to_rgba_ssse3, u16_to_u8_ssse3};
+const Kernels AVX2_KERNELS = {gray_to_rgba_avx2, rgb_to_rgba_avx2, bgr_to_rgba_avx2, u16_to_u8_avx2};
+#endif
+#if defined(PIXEL_CONVERT_NEON)
+const Kernels NEON_KERNELS = {gray_to_rgba_neon, rgb_to_rgba_neon, bgr_to_rgba_neon, u16_to_u8_neon};
+#endif
+
+const Kernels* kernels_for(Isa isa) {
+    switch (isa) {
+#if defined(PIXEL_CONVERT_X86)
+        case Isa::SSSE3: return &SSSE3_KERNELS;
+        case Isa::AVX2: return &AVX2_KERNELS;
+#endif
+#if defined(PIXEL_CONVERT_NEON)
+        case Isa::NEON: return &NEON_KERNELS;
+#endif
+        default: return &SCALAR_KERNELS;
+    }
+}
+
+bool cpu_supports(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#if defined(PIXEL_CONVERT_X86)
+#if defined(__GNUC__) || defined(__clang__)
+        case Isa::SSSE3:
+            return __builtin_cpu_supports("ssse3");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+        case Isa::SSSE3: {
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+        }
+        case Isa::AVX2: {
+            int info[4];
+            __cpuid(info, 1);
+            bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+            __cpuidex(info, 7, 0);
+            return os_avx && (info[1] & (1 << 5)) != 0;
+        }
+#endif
+#endif
+#if defined(PIXEL_CONVERT_NEON)
+        case Isa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+std::atomic<int> g_isa{-1};
+
+const Kernels& kernels() {
+    int isa = g_isa.load(std::memory_order_relaxed);
+    if (isa < 0) {
+        isa = static_cast<int>(detect_isa());
+        g_isa.store(isa, std::memory_order_relaxed);
+    }
+    return *kernels_for(static_cast<Isa>(isa));
+}
+
+} // namespace
+
+Isa detect_isa() {
+    if (cpu_supports(Isa::AVX2)) return Isa::AVX2;
+    if (cpu_supports(Isa::SSSE3)) return Isa::SSSE3;
+    if (cpu_supports(Isa::NEON)) return Isa::NEON;
+    return Isa::Scalar;
+}
+
+Isa active_isa() {
+    kernels();
+    return static_cast<Isa>(g_isa.load(std::memory_order_relaxed));
+}
+
+bool set_isa(Isa isa) {
+    if (!cpu_supports(isa)) return false;
+    g_isa.store(static_cast<int>(isa), std::memory_order_relaxed);
+    return true;
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::SSSE3: return "ssse3";
+        case Isa::AVX2: return "avx2";
+        case Isa::NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+void gray_to_rgba(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    kernels().gray_to_rgba(src, dst, pixels);
+}
+
+void rgb_to_rgba(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    kernels().rgb_to_rgba(src, dst, pixels);
+}
+
+void bgr_to_rgba(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    kernels().bgr_to_rgba(src, dst, pixels);
+}
+
+void u16_to_u8(const uint16_t* src, uint8_t* dst, size_t count, uint16_t max_value) {
+    kernels().u16_to_u8(src, dst, count, max_value);
+}
+
+void gray16_to_rgba(const uint16_t* src, uint8_t* dst, size_t pixels, uint16_t max_value) {
+    // Normalize a cache-sized chunk, then expand it; both steps stay SIMD
+    const size_t CHUNK = 4096;
+    uint8_t gray[CHUNK];
+    const Kernels& k = kernels();
+    for (size_t i = 0; i < pixels; i += CHUNK) {
+        size_t n = pixels - i < CHUNK ? pixels - i : CHUNK;
+        k.u16_to_u8(src + i, gray, n, max_value);
+        k.gray_to_rgba(gray, dst + i * 4, n);
+    }
+}
+
+} // namespace PixelConvert
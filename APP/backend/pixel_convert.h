@@ -0,0 +1,51 @@
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel format conversion into RGBA (4 bytes per pixel, alpha = 255), used to
+// fill "raw_rgba" image payloads straight into a claimed BufferWriter span.
+//
+// Kernels exist for SSE2/SSSE3 and AVX2 on x86 and NEON on ARM; the best one
+// the CPU supports is picked at first use. Every kernel produces exactly the
+// same bytes as the scalar path. Source and destination must not overlap.
+namespace PixelConvert {
+
+enum class Isa {
+    Scalar = 0,
+    SSSE3,
+    AVX2,
+    NEON
+};
+
+// 1 byte gray -> RGBA (g, g, g, 255)
+void gray_to_rgba(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+// 3 bytes per pixel, channels kept in order -> RGBA (c0, c1, c2, 255)
+void rgb_to_rgba(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+// 3 bytes per pixel, first and third channel swapped -> RGBA (c2, c1, c0, 255)
+void bgr_to_rgba(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+// Normalizes 16-bit samples to 8 bits: values are clamped to max_value and
+// scaled so that max_value maps to 255. max_value must be > 0.
+void u16_to_u8(const uint16_t* src, uint8_t* dst, size_t count, uint16_t max_value);
+
+// 16-bit gray -> RGBA, normalized as in u16_to_u8
+void gray16_to_rgba(const uint16_t* src, uint8_t* dst, size_t pixels, uint16_t max_value);
+
+// Kernel set in use
+Isa active_isa();
+const char* isa_name(Isa isa);
+
+// Best kernel set this CPU supports
+Isa detect_isa();
+
+// Forces a kernel set (for benchmarks and tests). Returns false and leaves
+// the selection unchanged if the CPU does not support it.
+bool set_isa(Isa isa);
+
+} // namespace PixelConvert
+
+#endif // PIXEL_CONVERT_H
@@ -13,6 +13,7 @@ import numpy as np
 import cv2 # Assuming OpenCV is still needed for processing
 import struct
 import fcntl
+import select
 
 # --- Helper function to get hex preview of bytes (Python version) ---
 def bytesToHexPreview(bytes_data: bytes, max_bytes: int = 30) -> str:
@@ -76,65 +77,59 @@ except AttributeError:
      # Non-fatal, might still work but can't close FD
      c_close = None 
 
-# --- Shared Memory Structure Definition (Matches C++ Creator/Acceptor) --- 
-class SharedIPCBidirectional(ctypes.Structure):
-    _fields_ = [
-        # Creator -> Acceptor
-        ("c_to_a_command", ctypes.c_int32), 
-        ("c_to_a_data_len", ctypes.c_size_t),
-        # Acceptor -> Creator
-        ("a_to_c_status", ctypes.c_int32),  
-        ("a_to_c_data_len", ctypes.c_size_t),
-        # Defined sizes
-        ("defined_c2a_buffer_size", ctypes.c_size_t), 
-        ("defined_a2c_buffer_size", ctypes.c_size_t),
-        # Padding
-        ("_padding1", ctypes.c_char * (128 - ctypes.sizeof(ctypes.c_int32)*2 - ctypes.sizeof(ctypes.c_size_t)*4)),
-    ]
+# --- Shared memory layout: control block, rings and record header ---
+from python_ipc_ring import open_segment, RECORD_HEADER, IPC_STATUS_OK, IPC_STATUS_ERROR, SHM_ACCEPTOR_READY
 
 # Global variables
 shm_fd = -1       
 mmap_obj = None   
 shm_struct = None 
 running = True
-SHM_CONTROL_BLOCK_SIZE = ctypes.sizeof(SharedIPCBidirectional) # Should be 128
-# Actual buffer sizes read from SHM
-ACTUAL_C2A_BUFFER_SIZE = 0 
-ACTUAL_A2C_BUFFER_SIZE = 0 
+ring_c2a = None # requests from the Creator
+ring_a2c = None # our responses
+# Doorbell pipe ends passed by the Creator (-1 = old Creator, fall back to polling)
+DOORBELL_RX_FD = -1 # Creator rings this when it changes a flag
+DOORBELL_TX_FD = -1 # we ring this after changing a flag
+POLL_FALLBACK_S = 0.005
+IDLE_WAIT_S = 0.5 # upper bound on one wait, so signals are noticed
+
+def ring_creator():
+    """Tells the Creator to re-check the flags."""
+    if DOORBELL_TX_FD == -1:
+        return
+    try:
+        os.write(DOORBELL_TX_FD, b"\x01")
+    except BlockingIOError:
+        pass # Pipe full: a ring is already pending
+    except OSError as e:
+        print(f"[IPC Python Acceptor] Warning: Failed to ring Creator doorbell: {e}")
+
+def wait_for_creator(timeout):
+    """Sleeps until the Creator rings (or `timeout` seconds pass).
+    Callers re-check the flags afterwards; returns False once the Creator is gone."""
+    global running
+    if DOORBELL_RX_FD == -1:
+        time.sleep(min(timeout, POLL_FALLBACK_S))
+        return True
+    readable, _, _ = select.select([DOORBELL_RX_FD], [], [], timeout)
+    if readable:
+        if not os.read(DOORBELL_RX_FD, 64): # EOF: Creator closed its end (exited)
+            print("[IPC Python Acceptor] Creator closed the doorbell. Shutting down.")
+            running = False
+            return False
+    return True
 
 def signal_handler(sig, frame):
     global running
     print(f"[IPC Python] Received signal {sig}. Attempting graceful shutdown...")
     running = False # Signal main loop to stop
 
-def get_buffer_view(offset, length):
-    """Gets a memoryview slice of the mmap object."""
-    if mmap_obj and offset is not None and (offset + length) <= mmap_obj.size():
+def process_data_from_creator(input_bytes):
+    """Processes one request payload from the Creator (C++).
+    Returns (status, response bytes)."""
+    print(f"[IPC Python Acceptor] Received request: Process {len(input_bytes)} bytes from Creator.")
+    if len(input_bytes) > 0:
         try:
-            return mmap_obj[offset:offset+length]
-        except IndexError:
-             print(f"[IPC Python] Error: Buffer slice out of bounds - offset={offset}, length={length}, mmap_size={mmap_obj.size()}")
-             return None
-    else:
-        print(f"[IPC Python] Error: Invalid buffer access - mmap_obj={mmap_obj}, offset={offset}, length={length}, mmap_size={mmap_obj.size() if mmap_obj else 'N/A'}")
-        return None
-
-def process_data_from_creator(data_len):
-    """Processes data received from the Creator (C++)."""
-    print(f"[IPC Python Acceptor] Received command: Process {data_len} bytes from Creator.")
-    if data_len > 0:
-        # Check against the actual C2A buffer size
-        if data_len > ACTUAL_C2A_BUFFER_SIZE:
-             print(f"[IPC Python Acceptor] Error: data_len ({data_len}) > ACTUAL_C2A_BUFFER_SIZE ({ACTUAL_C2A_BUFFER_SIZE})")
-             return b"Error: Creator data too large"
-        try:
-            # Read from C2A buffer (offset is control block size)
-            c2a_buffer_offset = SHM_CONTROL_BLOCK_SIZE
-            c2a_buffer = get_buffer_view(c2a_buffer_offset, data_len)
-            if c2a_buffer is None:
-                 return b"Error: Failed to get C2A buffer view"
-            input_bytes = c2a_buffer
-            
             # --- Example Processing --- 
             width, height = 10, 10
             gray_image = np.zeros((height, width), dtype=np.uint8)
@@ -147,92 +142,58 @@ def process_data_from_creator(data_len):
             # -------------------------
 
             print(f"[IPC Python Acceptor] Processing complete. Response size: {len(response_data)} bytes.")
-            return response_data
+            return IPC_STATUS_OK, response_data
         except Exception as e:
             print(f"[IPC Python Acceptor] Error processing data: {e}")
             traceback.print_exc()
-            return b"Error during Python processing"
-    return b"Acknowledged empty Creator message" 
+            return IPC_STATUS_ERROR, b"Error during Python processing"
+    return IPC_STATUS_OK, b"Acknowledged empty Creator message" 
 
-def send_data_to_creator(data_bytes):
-    """Sends data back to the Creator (C++)."""
-    global shm_struct, mmap_obj, ACTUAL_C2A_BUFFER_SIZE, ACTUAL_A2C_BUFFER_SIZE 
-    if not shm_struct or not mmap_obj:
+def send_response_to_creator(request_id, status, data_bytes):
+    """Queues the response to `request_id` in the A2C ring (waits while full)."""
+    if ring_a2c is None:
         print("[IPC Python Acceptor] Error: Cannot send data, IPC not initialized.")
         return False
 
-    data_len = len(data_bytes)
-    
-    # Calculate offset using the actual C2A size read from SHM
-    a2c_buffer_offset = SHM_CONTROL_BLOCK_SIZE + ACTUAL_C2A_BUFFER_SIZE 
-    print(f"[IPC Python Acceptor] Calculated A2C offset: {a2c_buffer_offset}") 
-
-    # Check size against the actual A2C size read from SHM
-    if data_len > ACTUAL_A2C_BUFFER_SIZE:
-        print(f"[IPC Python Acceptor] Error: Response data size ({data_len}) exceeds ACTUAL_A2C_BUFFER_SIZE ({ACTUAL_A2C_BUFFER_SIZE}). Signaling error.")
-        while shm_struct.a_to_c_status != 0 and running: time.sleep(0.005) 
-        if not running: return False
-        shm_struct.a_to_c_data_len = 0
-        shm_struct.a_to_c_status = -1
-        return False
+    if RECORD_HEADER.size + len(data_bytes) > ring_a2c.max_payload():
+        print(f"[IPC Python Acceptor] Error: Response data size ({len(data_bytes)}) exceeds the A2C ring limit "
+              f"({ring_a2c.max_payload() - RECORD_HEADER.size}). Sending error instead.")
+        status, data_bytes = IPC_STATUS_ERROR, b"Response too large for the A2C ring"
 
-    # --- Busy-wait for Creator to be ready --- 
+    parts = (RECORD_HEADER.pack(request_id, status), data_bytes)
+    # --- Wait for Creator to free ring space (woken by its doorbell) --- 
     wait_start_time = time.time()
-    while shm_struct.a_to_c_status != 0:
+    while not ring_a2c.try_push(parts):
         if not running: print("[IPC Python Acceptor] Shutdown requested while waiting to send."); return False
-        if time.time() - wait_start_time > 5.0: print("[IPC Python Acceptor] Error: Timeout waiting for Creator ack."); return False
-        time.sleep(0.005) 
+        remaining = 5.0 - (time.time() - wait_start_time)
+        if remaining <= 0: print("[IPC Python Acceptor] Error: Timeout waiting for A2C ring space."); return False
+        ring_creator() # let it drain what is already queued
+        wait_for_creator(remaining)
     # ---------------------------------------
-
-    try:
-        # Write data using mmap seek and write at the corrected offset
-        if mmap_obj.size() < a2c_buffer_offset + data_len:
-            print(f"[IPC Python Acceptor] Error: Calculated write position ({a2c_buffer_offset + data_len}) exceeds mmap size ({mmap_obj.size()}).")
-            return False
-            
-        # --- Log data hex preview BEFORE writing ---
-        hex_preview_before_write = bytesToHexPreview(data_bytes)
-        print(f"[IPC Python Acceptor] PRE-WRITE Hex Preview: {hex_preview_before_write}")
-        # -------------------------------------------
-
-        mmap_obj.seek(a2c_buffer_offset)
-        bytes_written = mmap_obj.write(data_bytes)
-
-        if bytes_written != data_len:
-             print(f"[IPC Python Acceptor] Warning: mmap.write wrote {bytes_written} bytes, expected {data_len}.")
-
-        # Flush changes
-        try:
-            mmap_obj.flush() 
-        except OSError as e:
-            print(f"[IPC Python Acceptor] Warning: mmap.flush failed: {e}") 
-
-        # Set length first, then status
-        shm_struct.a_to_c_data_len = data_len 
-        shm_struct.a_to_c_status = 1
-
-        print(f"[IPC Python Acceptor] Response ({data_len} bytes) written to A2C buffer (mmap @{a2c_buffer_offset}). Status set to 1.")
-        return True
-
-    except Exception as e:
-        print(f"[IPC Python Acceptor] Error sending data to Creator (mmap): {e}")
-        traceback.print_exc()
-        # Attempt to signal error if possible
-        try:
-            wait_start_time = time.time()
-            while shm_struct.a_to_c_status != 0:
-                 if not running: break
-                 if time.time() - wait_start_time > 0.5: break 
-                 time.sleep(0.005)
-            if running and shm_struct.a_to_c_status == 0:
-                 shm_struct.a_to_c_data_len = 0
-                 shm_struct.a_to_c_status = -1 
-        except Exception as e_inner:
-             print(f"[IPC Python Acceptor] Error trying to signal send error: {e_inner}")
-        return False
+    return True
+
+def serve_pending_requests():
+    """Answers every request queued in the C2A ring; returns how many."""
+    served = 0
+    while running:
+        record = ring_c2a.peek()
+        if record is None:
+            break
+        if len(record) < RECORD_HEADER.size:
+            print(f"[IPC Python Acceptor] Error: Creator record of {len(record)} bytes has no header. Skipping.")
+            ring_c2a.release()
+            continue
+        request_id, _ = RECORD_HEADER.unpack_from(record)
+        status, response_bytes = process_data_from_creator(record[RECORD_HEADER.size:])
+        record.release()
+        ring_c2a.release() # frees the request before the response is queued
+        send_response_to_creator(request_id, status, response_bytes)
+        ring_creator() # response queued and request space freed
+        served += 1
+    return served
 
 def main_loop(shm_name):
-    global mmap_obj, shm_struct, running, ACTUAL_C2A_BUFFER_SIZE, ACTUAL_A2C_BUFFER_SIZE, shm_fd
+    global mmap_obj, shm_struct, running, shm_fd, ring_c2a, ring_a2c
     print(f"[IPC Python Acceptor] Script started. PID: {os.getpid()}")
     print(f"[IPC Python Acceptor] Using SHM name: {shm_name}")
 
@@ -263,11 +224,7 @@ def main_loop(shm_name):
     try:
         fstat_info = os.fstat(shm_fd)
         reported_shm_size = fstat_info.st_size
-        print(f"[IPC Python Acceptor] Obtained SHM size via fstat: {reported_shm_size} bytes (Expected: {SHM_CONTROL_BLOCK_SIZE + ACTUAL_C2A_BUFFER_SIZE + ACTUAL_A2C_BUFFER_SIZE}).")
-        # Optional: Check if reported size is at least the expected size
-        if reported_shm_size < SHM_CONTROL_BLOCK_SIZE + ACTUAL_C2A_BUFFER_SIZE + ACTUAL_A2C_BUFFER_SIZE:
-             print(f"[IPC Python Acceptor] Warning: fstat size ({reported_shm_size}) is less than expected size ({SHM_CONTROL_BLOCK_SIZE + ACTUAL_C2A_BUFFER_SIZE + ACTUAL_A2C_BUFFER_SIZE}). Potential issue.")
-             # Decide whether to proceed or exit
+        print(f"[IPC Python Acceptor] Obtained SHM size via fstat: {reported_shm_size} bytes (the Creator sized it at init).")
     except Exception as e:
         print(f"[IPC Python Acceptor] Error getting SHM size via fstat(fd={shm_fd}): {e}. Exiting.")
         if c_close and shm_fd != -1: c_close(shm_fd)
@@ -284,45 +241,15 @@ def main_loop(shm_name):
          sys.exit(1)
     # ------------------------------------ 
 
-    # --- Map Control Structure --- 
-    try:
-        # Map the control block part first
-        shm_struct = SharedIPCBidirectional.from_buffer(mmap_obj) 
-        print("[IPC Python Acceptor] Successfully mapped control structure using from_buffer.")
-    except TypeError as e:
-         print(f"[IPC Python Acceptor] Warning: from_buffer failed ({e}). Trying from_buffer_copy...")
-         try:
-              shm_struct = SharedIPCBidirectional.from_buffer_copy(mmap_obj[:SHM_CONTROL_BLOCK_SIZE])
-              print("[IPC Python Acceptor] Successfully mapped struct using from_buffer_copy.")
-         except Exception as e_copy:
-             # Ensure this block uses consistent spacing (e.g., 4 spaces per level)
-             print(f"[IPC Python Acceptor] Error creating ctypes structure from mmap buffer copy: {e_copy}. Exiting.")
-             # Cleanup ONLY if from_buffer_copy fails
-             if mmap_obj:
-                 mmap_obj.close()
-             if c_close and shm_fd != -1:
-                 c_close(shm_fd)
-             sys.exit(1)
-        
-    # --- Read Defined Buffer Sizes from SHM --- 
+    # --- Map the Header and Rings (sizes and offsets come from the Creator) --- 
     try:
-        ACTUAL_C2A_BUFFER_SIZE = shm_struct.defined_c2a_buffer_size # Use renamed field
-        ACTUAL_A2C_BUFFER_SIZE = shm_struct.defined_a2c_buffer_size # Use renamed field
-        if ACTUAL_C2A_BUFFER_SIZE <= 0 or ACTUAL_A2C_BUFFER_SIZE <= 0:
-            raise ValueError("Buffer sizes read from SHM are zero or invalid.")
-        print(f"[IPC Python Acceptor] Read defined buffer sizes from SHM: C2A={ACTUAL_C2A_BUFFER_SIZE}, A2C={ACTUAL_A2C_BUFFER_SIZE}")
-        expected_total = SHM_CONTROL_BLOCK_SIZE + ACTUAL_C2A_BUFFER_SIZE + ACTUAL_A2C_BUFFER_SIZE
-        print(f"          (Control Size: {SHM_CONTROL_BLOCK_SIZE})")
-        if expected_total > mmap_obj.size():
-             print(f"[IPC Python Acceptor] Warning: Sum of control block and defined buffer sizes ({expected_total}) exceeds mapped size ({mmap_obj.size()}).")
-             # Decide whether to proceed or exit
-    except AttributeError:
-         print("[IPC Python Acceptor] Error: Failed to read defined buffer sizes from SHM struct. Structure mismatch?")
-         if mmap_obj: mmap_obj.close()
-         if c_close and shm_fd != -1: c_close(shm_fd)
-         sys.exit(1)
-    except ValueError as e:
-         print(f"[IPC Python Acceptor] Error: {e}")
+        shm_struct, ring_c2a, ring_a2c = open_segment(mmap_obj)
+        print(f"[IPC Python Acceptor] Read SHM layout: C2A ring {shm_struct.c2a_size} bytes @ {shm_struct.c2a_offset}, "
+              f"A2C ring {shm_struct.a2c_size} bytes @ {shm_struct.a2c_offset}, flags {shm_struct.flags:#x}")
+        print(f"          (max request {ring_c2a.max_payload() - RECORD_HEADER.size} bytes, max response {ring_a2c.max_payload() - RECORD_HEADER.size} bytes)")
+    except (TypeError, ValueError) as e:
+         print(f"[IPC Python Acceptor] Error: Cannot use the SHM segment: {e}. Exiting.")
+         shm_struct = None
          if mmap_obj: mmap_obj.close()
          if c_close and shm_fd != -1: c_close(shm_fd)
          sys.exit(1)
@@ -332,40 +259,36 @@ def main_loop(shm_name):
     signal.signal(signal.SIGINT, signal_handler)
     signal.signal(signal.SIGTERM, signal_handler)
 
-    print("[IPC Python Acceptor] Initialization complete. Polling for Creator commands...")
+    # --- Tell the Creator we are ready (it waits for this before init returns) --- 
+    shm_struct.acceptor_state = SHM_ACCEPTOR_READY
+    ring_creator()
+
+    if DOORBELL_RX_FD == -1:
+        print("[IPC Python Acceptor] Initialization complete. Polling for Creator requests (no doorbell)...")
+    else:
+        print(f"[IPC Python Acceptor] Initialization complete. Waiting on doorbell fd {DOORBELL_RX_FD}...")
 
-    # --- Main Polling Loop --- 
+    # --- Main Loop --- 
     try:
         while running:
             try:
                 # Check command from Creator
                 command = shm_struct.c_to_a_command # Use c_to_a
 
-                if command == 1: # Data Ready from Creator
-                    data_len = shm_struct.c_to_a_data_len # Use c_to_a
-                    response_bytes = process_data_from_creator(data_len) # Call renamed func
-                    
-                    if response_bytes is not None:
-                        send_data_to_creator(response_bytes) # Call renamed func
-                    else:
-                         send_data_to_creator(b"Error during Creator data processing in Acceptor") 
-                    
-                    # Acknowledge Creator command 
-                    shm_struct.c_to_a_command = 0 
-                    print("[IPC Python Acceptor] Acknowledged Creator command (set c_to_a_command = 0). Waiting...")
-
-                elif command == 99: # Shutdown command from Creator
+                if command == 99: # Shutdown command from Creator
                     print("[IPC Python Acceptor] Received shutdown command (99). Acknowledging and exiting.")
                     shm_struct.c_to_a_command = 0 # Acknowledge
+                    ring_creator()
                     running = False
                     break 
-
-                elif command == 0: # Idle
-                    time.sleep(0.005) 
-                else:
+                elif command != 0:
                     print(f"[IPC Python Acceptor] Warning: Unknown command {command} received from Creator. Resetting.")
                     shm_struct.c_to_a_command = 0 
-                    time.sleep(0.01) 
+                    ring_creator()
+
+                # Answer everything queued, then sleep until the Creator rings
+                if serve_pending_requests() == 0:
+                    wait_for_creator(IDLE_WAIT_S)
 
             except Exception as e:
                  print(f"[IPC Python Acceptor] Error in main loop: {e}")
@@ -373,6 +296,7 @@ def main_loop(shm_name):
                  if shm_struct: 
                      try:
                          shm_struct.c_to_a_command = 0
+                         ring_creator()
                      except Exception:
                          pass
                  time.sleep(1) 
@@ -396,9 +320,12 @@ def main_loop(shm_name):
 
 
 if __name__ == "__main__":
-    if len(sys.argv) != 2:
-        print(f"Usage: python {sys.argv[0]} <shm_name>")
+    if len(sys.argv) not in (2, 4):
+        print(f"Usage: python {sys.argv[0]} <shm_name> [<doorbell_rx_fd> <doorbell_tx_fd>]")
         sys.exit(1)
     
     shm_name_arg = sys.argv[1]
+    if len(sys.argv) == 4:
+        DOORBELL_RX_FD = int(sys.argv[2])
+        DOORBELL_TX_FD = int(sys.argv[3])
     main_loop(shm_name_arg) 
\ No newline at end of file
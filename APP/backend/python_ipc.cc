@@ -1,32 +1,193 @@
 #include "python_ipc.h"
+#include "include/spsc_ring.h"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <atomic>
+#include <memory>        // For std::unique_ptr
 #include <thread>        // For std::this_thread::sleep_for
 #include <chrono>        // For std::chrono::milliseconds, system_clock
 #include <mutex> // For protecting send access
+#include <condition_variable> // For waiting on Acceptor acknowledgements
 #include <sstream>   // For string streams
 #include <iomanip>   // For setfill, setw
-#include <algorithm> // For std::min
+#include <algorithm> // For std::min, std::max
+#include <unordered_map> // Pending requests
 
 // POSIX IPC includes
 #include <fcntl.h>       // For O_* constants
 #include <sys/mman.h>    // For mmap, shm_open, shm_unlink
 #include <sys/stat.h>    // For mode constants
-#include <unistd.h>      // For ftruncate, close
+#include <unistd.h>      // For ftruncate, close, pipe2
+#include <poll.h>        // For poll
 #include <signal.h>      // For kill
-#include <cstdlib>       // For system(), WEXITSTATUS, WIFEXITED etc.
-#include <cstring>       // For memcpy, memset
+#include <spawn.h>       // For posix_spawnp, posix_spawn_file_actions_*
+#include <sys/wait.h>    // For waitpid, WIFEXITED etc.
+#include <cstring>       // For memcpy, strerror
 #include <cerrno>        // For errno
 
+// Requests sent but not answered yet, by request_id
+struct PendingRequest {
+    uint64_t tag;
+    std::chrono::steady_clock::time_point sent;
+};
+
+// One Acceptor process with its own segment, rings, doorbells and listener
+struct AcceptorWorker {
+    uint32_t index = 0;
+    std::string shm_name;
+    int shm_fd = -1;
+    SharedIPCBidirectional* shm = nullptr; // segment start (header)
+    size_t shm_size = 0;
+    bool huge_pages = false;
+    std::thread listener;                  // Thread to listen for Acceptor messages
+
+    std::mutex send_mutex; // one producer on the C->A ring
+    SpscRing ring_c2a;     // producer: senders (under send_mutex)
+    // A reserved request (reserve_acceptor_request) outlives the lock, which
+    // may be released on another thread: senders wait for it on reserve_cv
+    bool reserved = false;  // under send_mutex
+    uint64_t launches = 0;  // under send_mutex; a slot from an earlier launch is dropped
+    std::condition_variable reserve_cv;
+    SpscRing ring_a2c;     // consumer: listener thread
+
+    // Doorbell pipes: [0] is the read end, [1] the write end
+    int doorbell_c2a[2] = {-1, -1};    // we ring [1], the Acceptor waits on [0]
+    int doorbell_a2c[2] = {-1, -1};    // the Acceptor rings [1], the listener waits on [0]
+    int listener_wakeup[2] = {-1, -1}; // stops the listener's poll() on shutdown
+    std::atomic<bool> connected{false}; // false once the Acceptor's doorbell closed
+    std::atomic<size_t> in_flight{0};   // for least-loaded dispatch
+    // Signalled by the listener on every doorbell, for senders waiting for ring
+    // space or for c_to_a_command to be acknowledged
+    std::mutex ack_mutex;
+    std::condition_variable ack_cv;
+    uint64_t doorbell_generation = 0; // under ack_mutex; bumped per wakeup
+
+    // Supervisor state. The Acceptor is (re)launched by init and by the
+    // listener thread, both under send_mutex, so no sender sees the rings mid-reset.
+    pid_t pid = 0;
+    bool supervising = false; // under send_mutex; false once shutdown started
+
+    std::mutex pending_mutex;
+    std::unordered_map<uint32_t, PendingRequest> pending; // under pending_mutex
+    AcceptorIpcStats stats;                                // under pending_mutex
+    std::chrono::steady_clock::time_point launched;        // under pending_mutex
+    bool awaiting_ready = false;                           // under pending_mutex
+    bool awaiting_first_response = false;                  // under pending_mutex
+};
+
 // Global variables for Bi-directional IPC
-static int shm_fd_bi = -1;
-static SharedIPCBidirectional* shm_ptr_bi = nullptr;
-static std::thread listener_thread;    // Thread to listen for Acceptor messages
+static std::vector<std::unique_ptr<AcceptorWorker>> workers;
 static std::atomic<bool> keep_listener_running(false);
 static AcceptorDataCallback data_callback = nullptr; // Use renamed callback type
-static std::mutex send_mutex; 
+static AcceptorDispatch dispatch_policy = ACCEPTOR_DISPATCH_LEAST_LOADED;
+static std::atomic<uint32_t> next_request_id(1);
+static std::atomic<uint32_t> next_worker(0); // dispatch cursor
+// Bumped per initialize call; with the pid it keeps segment names unique, so
+// an instance being torn down during a reload only unlinks its own
+static std::atomic<uint32_t> init_generation(0);
+static std::string acceptor_executable_path;
+static std::string acceptor_script_full_path;
+static const auto ACK_TIMEOUT = std::chrono::seconds(5);
+static const auto SHUTDOWN_ACK_TIMEOUT = std::chrono::milliseconds(500);
+static const auto ACCEPTOR_READY_TIMEOUT = std::chrono::seconds(10);
+static const auto ACCEPTOR_EXIT_GRACE = std::chrono::milliseconds(1000); // before SIGKILL
+static const auto RESTART_BACKOFF_MIN = std::chrono::milliseconds(100);
+static const auto RESTART_BACKOFF_MAX = std::chrono::milliseconds(5000);
+static const auto ACCEPTOR_STABLE_AFTER = std::chrono::seconds(10); // a later exit is not a quick crash
+
+extern char** environ;
+
+static void close_fd(int& fd) {
+    if (fd != -1) { close(fd); fd = -1; }
+}
+
+static void close_pipe(int (&fds)[2]) {
+    close_fd(fds[0]);
+    close_fd(fds[1]);
+}
+
+// Pipe whose write end never blocks (a full pipe already holds a pending
+// ring). Both ends are close-on-exec from the start, so a process forked
+// elsewhere in Node can never inherit one; the Acceptor gets its two ends
+// through dup2 file actions in launch_acceptor().
+static bool open_doorbell(int (&fds)[2]) {
+    if (pipe2(fds, O_CLOEXEC | O_NONBLOCK) == -1) { fds[0] = fds[1] = -1; return false; }
+    return true;
+}
+
+static void ring_doorbell(int fd) {
+    if (fd == -1) return;
+    uint8_t bell = 1;
+    ssize_t n;
+    do { n = write(fd, &bell, 1); } while (n == -1 && errno == EINTR);
+}
+
+// Consumes pending rings; returns false once the other end is closed
+static bool drain_doorbell(int fd) {
+    uint8_t bells[64];
+    while (true) {
+        ssize_t n = read(fd, bells, sizeof(bells));
+        if (n > 0) continue;
+        if (n == 0) return false;
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+}
+
+static void notify_senders(AcceptorWorker& w) {
+    {
+        std::lock_guard<std::mutex> lock(w.ack_mutex);
+        w.doorbell_generation++;
+    }
+    w.ack_cv.notify_all();
+}
+
+// Waits until the Acceptor has acknowledged c_to_a_command
+static bool wait_for_acceptor_ack(AcceptorWorker& w, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(w.ack_mutex);
+    return w.ack_cv.wait_for(lock, timeout, [&w] {
+        return w.shm->c_to_a_command.load() == 0 || !w.connected.load();
+    }) && w.shm->c_to_a_command.load() == 0;
+}
+
+static uint64_t micros_since(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+static size_t round_up(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+// Maps the segment at an `align`-aligned address so each ring region can be
+// covered by huge pages
+static uint8_t* map_segment(int fd, size_t size, size_t align, size_t page_size) {
+    if (align <= page_size) {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        return p == MAP_FAILED ? nullptr : static_cast<uint8_t*>(p);
+    }
+    // Reserve size + align of address space, then map the segment over its aligned part
+    void* span = mmap(nullptr, size + align, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (span == MAP_FAILED) return nullptr;
+    uint8_t* base = static_cast<uint8_t*>(span);
+    uint8_t* start = reinterpret_cast<uint8_t*>(round_up(reinterpret_cast<uintptr_t>(base), align));
+    if (start > base) munmap(base, start - base);
+    munmap(start + size, (base + size + align) - (start + size));
+    void* p = mmap(start, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (p == MAP_FAILED) { munmap(start, size); return nullptr; }
+    return start;
+}
+
+// Asks for transparent huge pages on both rings; false if the kernel refused
+static bool advise_huge_pages(uint8_t* base, const SharedIPCBidirectional& layout) {
+#ifdef MADV_HUGEPAGE
+    return madvise(base + layout.c2a_offset, layout.c2a_size, MADV_HUGEPAGE) == 0 &&
+           madvise(base + layout.a2c_offset, layout.a2c_size, MADV_HUGEPAGE) == 0;
+#else
+    (void)base; (void)layout;
+    return false;
+#endif
+}
 
 // --- Helper function for Hex Preview ---
 std::string bytes_to_hex_preview_cpp(const uint8_t* data, size_t length, size_t max_bytes = 30) {
@@ -53,226 +214,718 @@ std::string bytes_to_hex_preview_cpp(const uint8_t* data, size_t length, size_t
     return ss.str();
 }
 
-// --- Listener Thread Function (Busy-Wait Version) ---
-void acceptor_listener_thread_func() { // Renamed function
-    std::cout << "[IPC C++ Listener] Listener thread for Acceptor started (polling mode)." << std::endl;
+static void invoke_callback(const AcceptorResponse& response) {
+    if (data_callback) {
+        try {
+            data_callback(response);
+        } catch (const std::exception& e) {
+            std::cerr << "[IPC C++ Listener] Exception in data_callback: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "[IPC C++ Listener] Unknown exception in data_callback." << std::endl;
+        }
+    } else {
+        std::cerr << "[IPC C++ Listener] Warning: No data callback registered." << std::endl;
+    }
+}
+
+// Hands one response to the callback, matched with its pending request
+static void dispatch_response(AcceptorWorker& w, const uint8_t* record, uint32_t record_len) {
+    if (record_len < sizeof(IpcRecordHeader)) {
+        std::cerr << "[IPC C++ Listener " << w.index << "] Error: Acceptor record of " << record_len << " bytes has no header." << std::endl;
+        return;
+    }
+    IpcRecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    AcceptorResponse response;
+    response.request_id = header.request_id;
+    response.worker = w.index;
+    response.status = header.status;
+    response.data = record + sizeof(header);
+    response.length = record_len - sizeof(header);
+    {
+        std::lock_guard<std::mutex> lock(w.pending_mutex);
+        auto it = w.pending.find(header.request_id);
+        if (it == w.pending.end()) {
+            w.stats.unmatched++;
+            std::cerr << "[IPC C++ Listener " << w.index << "] Warning: Response for unknown request " << header.request_id << ", dropped." << std::endl;
+            return;
+        }
+        response.tag = it->second.tag;
+        response.round_trip_us = micros_since(it->second.sent);
+        w.pending.erase(it);
+        w.in_flight.fetch_sub(1);
+        w.stats.responses++;
+        if (w.awaiting_first_response) {
+            w.stats.first_response_us = micros_since(w.launched);
+            w.awaiting_first_response = false;
+        }
+    }
+    if (response.status != IPC_STATUS_OK) {
+        std::cerr << "[IPC C++ Listener " << w.index << "] Acceptor reported an error for request " << response.request_id << ": "
+                  << std::string(reinterpret_cast<const char*>(response.data), response.length) << std::endl;
+    }
+    invoke_callback(response);
+}
+
+// Answers every pending request of the worker with IPC_STATUS_ERROR and `reason`
+static void fail_pending_requests(AcceptorWorker& w, const std::string& reason) {
+    std::unordered_map<uint32_t, PendingRequest> failed;
+    {
+        std::lock_guard<std::mutex> lock(w.pending_mutex);
+        failed.swap(w.pending);
+        w.in_flight.fetch_sub(failed.size());
+        w.stats.failed_requests += failed.size();
+    }
+    for (const auto& entry : failed) {
+        AcceptorResponse response;
+        response.request_id = entry.first;
+        response.worker = w.index;
+        response.tag = entry.second.tag;
+        response.status = IPC_STATUS_ERROR;
+        response.data = reinterpret_cast<const uint8_t*>(reason.data());
+        response.length = reason.size();
+        response.round_trip_us = micros_since(entry.second.sent);
+        invoke_callback(response);
+    }
+}
+
+// Records the launch -> READY time once the Acceptor reports it
+static void note_acceptor_ready(AcceptorWorker& w) {
+    if (!w.shm || w.shm->acceptor_state.load() != SHM_ACCEPTOR_READY) return;
+    std::lock_guard<std::mutex> lock(w.pending_mutex);
+    if (!w.awaiting_ready) return;
+    w.stats.ready_us = micros_since(w.launched);
+    w.awaiting_ready = false;
+}
+
+// Opens fresh doorbells, resets the rings and the header, and spawns the
+// Acceptor. Caller holds w.send_mutex.
+static bool launch_acceptor(AcceptorWorker& w) {
+    close_pipe(w.doorbell_c2a);
+    close_pipe(w.doorbell_a2c);
+    if (!open_doorbell(w.doorbell_c2a) || !open_doorbell(w.doorbell_a2c)) {
+        perror("[IPC C++] pipe failed");
+        close_pipe(w.doorbell_c2a); close_pipe(w.doorbell_a2c);
+        return false;
+    }
+    // The Acceptor blocks in its reads; only our ends stay non-blocking
+    fcntl(w.doorbell_c2a[0], F_SETFL, fcntl(w.doorbell_c2a[0], F_GETFL) & ~O_NONBLOCK);
+
+    // Both rings start empty (attach() writes only the indices); the Acceptor binds to them without resetting
+    uint8_t* base = reinterpret_cast<uint8_t*>(w.shm);
+    w.launches++;
+    w.ring_c2a.attach(base + w.shm->c2a_offset, w.shm->c2a_size);
+    w.ring_a2c.attach(base + w.shm->a2c_offset, w.shm->a2c_size);
+    w.shm->c_to_a_command.store(0);
+    w.shm->acceptor_state.store(SHM_ACCEPTOR_STARTING);
+
+    // Only the Acceptor's ends (c2a read, a2c write) survive into its process:
+    // dup2 copies them to fresh numbers above both sources (so neither
+    // clobbers the other) without FD_CLOEXEC; everything else closes on exec
+    int child_rx = std::max(w.doorbell_c2a[0], w.doorbell_a2c[1]) + 1;
+    int child_tx = child_rx + 1;
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, w.doorbell_c2a[0], child_rx);
+    posix_spawn_file_actions_adddup2(&actions, w.doorbell_a2c[1], child_tx);
+
+    std::string rx_fd = std::to_string(child_rx);
+    std::string tx_fd = std::to_string(child_tx);
+    std::string shm_name = w.shm_name;
+    std::string unbuffered = "-u";
+    char* argv[] = {
+        &acceptor_executable_path[0], &unbuffered[0], &acceptor_script_full_path[0],
+        &shm_name[0], &rx_fd[0], &tx_fd[0], nullptr
+    };
+    std::cout << "[IPC C++] Launching Acceptor " << w.index << ": " << acceptor_executable_path << " -u "
+              << acceptor_script_full_path << " " << shm_name << " " << rx_fd << " " << tx_fd << std::endl;
+    pid_t pid = 0;
+    auto launched = std::chrono::steady_clock::now();
+    int err = posix_spawnp(&pid, acceptor_executable_path.c_str(), &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    // The Acceptor holds its own copies now; closing ours lets either side see EOF when the other exits
+    close_fd(w.doorbell_c2a[0]);
+    close_fd(w.doorbell_a2c[1]);
+    if (err != 0) {
+        std::cerr << "[IPC C++] Error: posix_spawnp(" << acceptor_executable_path << ") failed: " << strerror(err) << std::endl;
+        close_pipe(w.doorbell_c2a); close_pipe(w.doorbell_a2c);
+        return false;
+    }
+    w.pid = pid;
+    {
+        std::lock_guard<std::mutex> lock(w.pending_mutex);
+        w.launched = launched;
+        w.awaiting_ready = true;
+        w.awaiting_first_response = true;
+        w.stats.acceptor_pid = pid;
+        w.stats.ready_us = 0;
+        w.stats.first_response_us = 0;
+    }
+    w.connected.store(true);
+    return true;
+}
+
+// Waits up to `grace` for the Acceptor to exit, then kills it. Returns the
+// raw waitpid() status.
+static int reap_acceptor(AcceptorWorker& w, std::chrono::milliseconds grace) {
+    if (w.pid <= 0) return 0;
+    int status = 0;
+    auto deadline = std::chrono::steady_clock::now() + grace;
+    pid_t done;
+    // Its doorbell is closed, so it is already on its way out
+    while ((done = waitpid(w.pid, &status, WNOHANG)) == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (done == 0) {
+        std::cerr << "[IPC C++] Acceptor " << w.index << " (pid " << w.pid << ") did not exit, killing it." << std::endl;
+        kill(w.pid, SIGKILL);
+        done = waitpid(w.pid, &status, 0);
+    }
+    if (done == -1) status = 0; // reaped elsewhere
+    w.pid = 0;
+    {
+        std::lock_guard<std::mutex> lock(w.pending_mutex);
+        w.stats.acceptor_pid = 0;
+        w.stats.last_exit_status = status;
+    }
+    return status;
+}
+
+static std::string describe_exit(int status) {
+    if (WIFEXITED(status)) return "exit code " + std::to_string(WEXITSTATUS(status));
+    if (WIFSIGNALED(status)) return "signal " + std::to_string(WTERMSIG(status));
+    return "status " + std::to_string(status);
+}
+
+// Sleeps on the Acceptor's doorbell until it reports READY. Returns false if
+// it exited first; a start that runs past `deadline` only logs a warning.
+static bool wait_for_acceptor_ready(AcceptorWorker& w, std::chrono::steady_clock::time_point deadline) {
+    while (w.shm->acceptor_state.load() != SHM_ACCEPTOR_READY) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0) {
+            std::cerr << "[IPC C++] Warning: Acceptor " << w.index << " not ready in time, continuing." << std::endl;
+            return true;
+        }
+        struct pollfd fds = {w.doorbell_a2c[0], POLLIN, 0};
+        int ready = poll(&fds, 1, static_cast<int>(left.count()));
+        if (ready == -1 && errno != EINTR) return false;
+        if (ready > 0 && !drain_doorbell(w.doorbell_a2c[0])) return false; // exited
+    }
+    note_acceptor_ready(w);
+    return true;
+}
+
+// Called on the worker's listener thread once its Acceptor's doorbell closed:
+// reaps it, fails what it left unanswered and launches a new one after a
+// backoff. Returns false when the channel is shutting down or the Acceptor
+// keeps crashing.
+static bool restart_acceptor(AcceptorWorker& w, int& quick_crashes) {
+    std::chrono::steady_clock::time_point launched;
+    {
+        std::lock_guard<std::mutex> lock(w.pending_mutex);
+        launched = w.launched;
+    }
+    bool quick = std::chrono::steady_clock::now() - launched < ACCEPTOR_STABLE_AFTER;
+    int status = reap_acceptor(w, ACCEPTOR_EXIT_GRACE);
+    std::cerr << "[IPC C++ Supervisor] Acceptor " << w.index << " exited (" << describe_exit(status) << ") after "
+              << micros_since(launched) / 1000 << " ms." << std::endl;
+    fail_pending_requests(w, "Acceptor exited before answering");
+    quick_crashes = quick ? quick_crashes + 1 : 1;
+
+    while (true) {
+        if (quick_crashes > ACCEPTOR_MAX_QUICK_RESTARTS) {
+            std::cerr << "[IPC C++ Supervisor] Error: Acceptor " << w.index << " crashed " << ACCEPTOR_MAX_QUICK_RESTARTS
+                      << " times in a row, giving up. Requests go to the other workers from now on." << std::endl;
+            return false;
+        }
+        auto backoff = std::min<std::chrono::milliseconds>(RESTART_BACKOFF_MAX,
+            RESTART_BACKOFF_MIN * (1 << std::min(quick_crashes - 1, 16)));
+        // Sleep through the backoff unless shutdown wakes us
+        struct pollfd wake = {w.listener_wakeup[0], POLLIN, 0};
+        if (poll(&wake, 1, static_cast<int>(backoff.count())) > 0) return false;
+
+        std::lock_guard<std::mutex> lock(w.send_mutex);
+        if (!w.supervising) return false;
+        if (launch_acceptor(w)) {
+            std::lock_guard<std::mutex> stats_lock(w.pending_mutex);
+            w.stats.restarts++;
+            return true;
+        }
+        quick_crashes++;
+    }
+}
+
+// --- Listener Thread Function ---
+// One per worker. Sleeps in poll() on the Acceptor's doorbell. On every ring
+// it drains the A->C ring (the callback reads each response in place), rings
+// back so an Acceptor waiting for ring space continues, and wakes waiting
+// senders. The ring is checked before every wait, so a ring that arrives
+// while responses are being handled is not lost. When the Acceptor's
+// doorbell closes, the listener supervises its restart (restart_acceptor()).
+void acceptor_listener_thread_func(AcceptorWorker* worker) { // Renamed function
+    AcceptorWorker& w = *worker;
+    std::cout << "[IPC C++ Listener " << w.index << "] Listener thread for Acceptor started (doorbell mode)." << std::endl;
+    bool acceptor_open = true;
+    int quick_crashes = 0;
     while (keep_listener_running.load()) {
-        if (!shm_ptr_bi) { 
-            std::cerr << "[IPC C++ Listener] Error: Shared memory pointer is null. Exiting thread." << std::endl;
-            keep_listener_running.store(false);
-            break;
+        // --- Drain responses ---
+        size_t drained = 0;
+        uint32_t record_len = 0;
+        while (const uint8_t* record = w.ring_a2c.peek(&record_len)) {
+            dispatch_response(w, record, record_len);
+            w.ring_a2c.release();
+            drained++;
+        }
+        if (drained > 0) ring_doorbell(w.doorbell_c2a[1]);
+        if (!acceptor_open) {
+            // Responses it sent before exiting are handled; replace it
+            if (!keep_listener_running.load() || !restart_acceptor(w, quick_crashes)) break;
+            acceptor_open = true;
+            continue;
         }
 
-        // --- Poll status from Acceptor --- 
-        int32_t a_status = shm_ptr_bi->a_to_c_status.load(); // Use a_to_c_status
-
-        if (a_status == 1) { // Data Ready from Acceptor
-            size_t data_len = shm_ptr_bi->a_to_c_data_len.load(); // Use a_to_c_data_len
-            std::cout << "[IPC C++ Listener] Received Status=1 from Acceptor, Data Len=" << data_len << std::endl; 
-            std::this_thread::sleep_for(std::chrono::microseconds(500)); // Keep delay for now
-
-            // Check received length against the defined A->C (RX) buffer size
-            if (data_len <= shm_ptr_bi->defined_a2c_buffer_size && data_len > 0) { // Use defined_a2c_buffer_size
-                const uint8_t* acceptor_buffer_ptr = reinterpret_cast<const uint8_t*>(shm_ptr_bi->buffer_a_to_c); // Use buffer_a_to_c
-                std::string hex_preview = bytes_to_hex_preview_cpp(acceptor_buffer_ptr, data_len);
-                std::cout << "[IPC C++ Listener] Acceptor SHM Buffer Preview (after delay): " << hex_preview << std::endl;
-                if (data_callback) {
-                    try {
-                        data_callback(acceptor_buffer_ptr, data_len); 
-                    } catch (const std::exception& e) {
-                        std::cerr << "[IPC C++ Listener] Exception in data_callback: " << e.what() << std::endl;
-                    } catch (...) {
-                        std::cerr << "[IPC C++ Listener] Unknown exception in data_callback." << std::endl;
-                    }
-                } else {
-                    std::cerr << "[IPC C++ Listener] Warning: No data callback registered." << std::endl;
-                }
+        // --- Idle: sleep until the Acceptor or shutdown rings ---
+        struct pollfd fds[2] = {
+            {w.doorbell_a2c[0], POLLIN, 0},
+            {w.listener_wakeup[0], POLLIN, 0},
+        };
+        int ready = poll(fds, 2, -1);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            perror("[IPC C++ Listener] poll failed");
+            break;
+        }
+        if (fds[1].revents) break; // shutdown
+        if (fds[0].revents) {
+            acceptor_open = drain_doorbell(w.doorbell_a2c[0]);
+            if (!acceptor_open) {
+                std::cerr << "[IPC C++ Listener " << w.index << "] Acceptor closed its doorbell (process exited)." << std::endl;
+                w.connected.store(false);
             } else {
-                 std::cerr << "[IPC C++ Listener] Error: Acceptor reported data size (" << data_len
-                           << ") invalid or larger than defined A->C buffer (" 
-                           << shm_ptr_bi->defined_a2c_buffer_size << ")." << std::endl; // Use defined_a2c_buffer_size
+                note_acceptor_ready(w);
             }
-            // Acknowledge processing by resetting Acceptor's status
-            shm_ptr_bi->a_to_c_status.store(0); // Use a_to_c_status
-            std::cout << "[IPC C++ Listener] Acknowledged Acceptor (set a_to_c_status = 0)." << std::endl;
-
-        } else if (a_status == -1) { // Error status from Acceptor
-            std::cerr << "[IPC C++ Listener] Received Error Status (-1) from Acceptor." << std::endl;
-            shm_ptr_bi->a_to_c_status.store(0); // Use a_to_c_status
-             std::cout << "[IPC C++ Listener] Acknowledged Acceptor Error (set a_to_c_status = 0)." << std::endl;
-
-        } else if (a_status == 0) { // Idle status from Acceptor
-            std::this_thread::sleep_for(std::chrono::microseconds(500)); 
-        } else { // Unknown status
-             std::cerr << "[IPC C++ Listener] Warning: Unknown Acceptor status code: " << a_status << ". Resetting." << std::endl;
-             shm_ptr_bi->a_to_c_status.store(0); // Use a_to_c_status
-             std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // The ring may have freed C->A space or acknowledged a command
+            notify_senders(w);
         }
     }
-    std::cout << "[IPC C++ Listener] Listener thread exiting." << std::endl;
+    std::cout << "[IPC C++ Listener " << w.index << "] Listener thread exiting." << std::endl;
+}
+
+// Creates, sizes and maps the worker's segment and writes its header
+static bool create_segment(AcceptorWorker& w, const AcceptorIpcOptions& options) {
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t align = options.huge_pages ? std::max(page_size, SHM_HUGE_PAGE_SIZE) : page_size;
+    SharedIPCBidirectional layout = {};
+    layout.header_size = sizeof(SharedIPCBidirectional);
+    layout.c2a_offset = round_up(sizeof(SharedIPCBidirectional), align);
+    layout.c2a_size = round_up(options.c2a_ring_size, align);
+    layout.a2c_offset = layout.c2a_offset + layout.c2a_size;
+    layout.a2c_size = round_up(options.a2c_ring_size, align);
+    layout.total_size = layout.a2c_offset + layout.a2c_size;
+
+    // --- Create/Open Shared Memory ---
+    // The name is ours alone; a leftover only exists if a process that had
+    // our pid crashed without unlinking it
+    shm_unlink(w.shm_name.c_str());
+    w.shm_fd = shm_open(w.shm_name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (w.shm_fd == -1) {
+        perror("[IPC C++] shm_open failed");
+        return false;
+    }
+    // A fresh tmpfs file is sparse: pages are allocated as the rings touch them
+    if (ftruncate(w.shm_fd, static_cast<off_t>(layout.total_size)) == -1) {
+        perror("[IPC C++] ftruncate failed");
+        return false;
+    }
+    uint8_t* base = map_segment(w.shm_fd, layout.total_size, align, page_size);
+    if (!base) {
+        perror("[IPC C++] mmap failed");
+        return false;
+    }
+    if (options.huge_pages) {
+        if (advise_huge_pages(base, layout)) {
+            layout.flags |= SHM_IPC_FLAG_HUGE_PAGES;
+        } else {
+            std::cerr << "[IPC C++] Warning: Huge pages unavailable for the SHM rings, using normal pages." << std::endl;
+        }
+    }
+    w.shm = reinterpret_cast<SharedIPCBidirectional*>(base);
+    w.shm_size = layout.total_size;
+    w.huge_pages = (layout.flags & SHM_IPC_FLAG_HUGE_PAGES) != 0;
+
+    // --- Initialize the header (no clearing: the file reads as zeros) ---
+    w.shm->version = SHM_IPC_VERSION;
+    w.shm->header_size = layout.header_size;
+    w.shm->flags = layout.flags;
+    new (&w.shm->c_to_a_command) std::atomic<int32_t>(0); // Use c_to_a
+    new (&w.shm->acceptor_state) std::atomic<int32_t>(SHM_ACCEPTOR_STARTING);
+    w.shm->total_size = layout.total_size;
+    w.shm->c2a_offset = layout.c2a_offset;
+    w.shm->c2a_size = layout.c2a_size;
+    w.shm->a2c_offset = layout.a2c_offset;
+    w.shm->a2c_size = layout.a2c_size;
+    std::atomic_thread_fence(std::memory_order_release);
+    w.shm->magic = SHM_IPC_MAGIC;
+    std::cout << "[IPC C++] SHM " << w.shm_name << ": total " << layout.total_size << " bytes, C2A ring "
+              << layout.c2a_size << " @ " << layout.c2a_offset << ", A2C ring "
+              << layout.a2c_size << " @ " << layout.a2c_offset
+              << (w.huge_pages ? ", huge pages." : ".") << std::endl;
+    return true;
+}
+
+// Unmaps and unlinks the worker's segment and closes its pipes
+static void release_worker(AcceptorWorker& w) {
+    w.ring_c2a.detach();
+    w.ring_a2c.detach();
+    close_pipe(w.doorbell_c2a);
+    close_pipe(w.doorbell_a2c);
+    close_pipe(w.listener_wakeup);
+    w.connected.store(false);
+    if (w.shm) {
+        munmap(w.shm, w.shm_size);
+        w.shm = nullptr;
+    }
+    if (w.shm_fd != -1) {
+        close_fd(w.shm_fd);
+        shm_unlink(w.shm_name.c_str());
+    }
+}
+
+// Picks the worker for the next request; nullptr if no Acceptor is running.
+// Both policies start from a rotating cursor, so ties spread evenly.
+static AcceptorWorker* pick_worker() {
+    size_t count = workers.size();
+    if (count == 0) return nullptr;
+    uint32_t start = next_worker.fetch_add(1, std::memory_order_relaxed);
+    AcceptorWorker* best = nullptr;
+    size_t best_load = 0;
+    for (size_t k = 0; k < count; k++) {
+        AcceptorWorker* w = workers[(start + k) % count].get();
+        if (!w->connected.load()) continue;
+        if (dispatch_policy == ACCEPTOR_DISPATCH_ROUND_ROBIN) return w;
+        size_t load = w->in_flight.load();
+        if (!best || load < best_load) { best = w; best_load = load; }
+    }
+    return best;
 }
 
-// --- Implementation of Public Functions --- 
+// --- Implementation of Public Functions ---
 
 bool init_acceptor_ipc_bidirectional( // Renamed function
     const std::string& acceptor_executable,
     const std::string& acceptor_script_path,
-    AcceptorDataCallback callback)
+    AcceptorDataCallback callback,
+    const AcceptorIpcOptions& options)
 {
-    std::cout << "[IPC C++] Initializing Bi-directional IPC with Acceptor..." << std::endl;
-    data_callback = callback; 
-    shm_unlink(SHM_NAME_BI);
-
-    // --- Create/Open Shared Memory --- 
-    size_t control_block_size = 128; 
-    size_t total_shm_size = control_block_size + SHM_C2A_BUFFER_MAX_SIZE + SHM_A2C_BUFFER_MAX_SIZE; // Use renamed constants 
-    std::cout << "[IPC C++] Calculated total SHM allocation size: " << total_shm_size << " bytes." << std::endl;
-    std::cout << "          Control Block Size: " << control_block_size << std::endl;
-    std::cout << "          Max C2A Size: " << SHM_C2A_BUFFER_MAX_SIZE << std::endl; // Use renamed constants 
-    std::cout << "          Max A2C Size: " << SHM_A2C_BUFFER_MAX_SIZE << std::endl; // Use renamed constants 
-
-    shm_fd_bi = shm_open(SHM_NAME_BI, O_CREAT | O_RDWR, 0666);
-    if (shm_fd_bi == -1) {
-        perror("[IPC C++] shm_open failed");
+    std::cout << "[IPC C++] Initializing Bi-directional IPC with " << options.workers << " Acceptor(s)..." << std::endl;
+    if (options.c2a_ring_size < SHM_MIN_RING_SIZE || options.c2a_ring_size > SHM_MAX_RING_SIZE ||
+        options.a2c_ring_size < SHM_MIN_RING_SIZE || options.a2c_ring_size > SHM_MAX_RING_SIZE) {
+        std::cerr << "[IPC C++] Error: Ring sizes must be between " << SHM_MIN_RING_SIZE << " and "
+                  << SHM_MAX_RING_SIZE << " bytes (got C2A=" << options.c2a_ring_size
+                  << ", A2C=" << options.a2c_ring_size << ")." << std::endl;
         return false;
     }
-    if (ftruncate(shm_fd_bi, total_shm_size) == -1) {
-        perror("[IPC C++] ftruncate failed");
-        close(shm_fd_bi); shm_unlink(SHM_NAME_BI); return false;
+    if (options.workers < 1 || options.workers > ACCEPTOR_MAX_WORKERS) {
+        std::cerr << "[IPC C++] Error: Worker count must be between 1 and " << ACCEPTOR_MAX_WORKERS
+                  << " (got " << options.workers << ")." << std::endl;
+        return false;
     }
-    shm_ptr_bi = (SharedIPCBidirectional*)mmap(0, total_shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_bi, 0);
-    if (shm_ptr_bi == MAP_FAILED) {
-        perror("[IPC C++] mmap failed");
-        close(shm_fd_bi); shm_unlink(SHM_NAME_BI); return false;
-    }
-    std::cout << "[IPC C++] Bi-directional SHM created/opened and mapped." << std::endl;
-    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Keep delay for safety
-
-    // --- Initialize Shared Memory Control Block --- 
-    new (&shm_ptr_bi->c_to_a_command) std::atomic<int32_t>(0); // Use c_to_a
-    new (&shm_ptr_bi->c_to_a_data_len) std::atomic<size_t>(0); // Use c_to_a
-    new (&shm_ptr_bi->a_to_c_status) std::atomic<int32_t>(0);  // Use a_to_c
-    new (&shm_ptr_bi->a_to_c_data_len) std::atomic<size_t>(0);  // Use a_to_c
-    
-    // Set the defined buffer sizes using the specific constants
-    shm_ptr_bi->defined_c2a_buffer_size = SHM_C2A_BUFFER_MAX_SIZE; // Use renamed constants & fields
-    shm_ptr_bi->defined_a2c_buffer_size = SHM_A2C_BUFFER_MAX_SIZE; // Use renamed constants & fields
-    std::cout << "[IPC C++] Set defined buffer sizes in SHM: C2A=" 
-              << shm_ptr_bi->defined_c2a_buffer_size << ", A2C=" 
-              << shm_ptr_bi->defined_a2c_buffer_size << std::endl;
-
-    // Zero out padding and buffers using their specific max sizes
-    memset(shm_ptr_bi->_padding1, 0, sizeof(shm_ptr_bi->_padding1));
-    memset(shm_ptr_bi->buffer_c_to_a, 0, SHM_C2A_BUFFER_MAX_SIZE); // Use renamed buffer & constant
-    memset(shm_ptr_bi->buffer_a_to_c, 0, SHM_A2C_BUFFER_MAX_SIZE); // Use renamed buffer & constant
-    std::cout << "[IPC C++] Bi-directional SHM control block initialized." << std::endl;
-
-    // --- Launch Acceptor Script --- 
-    std::string full_script_path = "APP/backend/" + acceptor_script_path; // Construct path relative to project root
-    std::string command = acceptor_executable + " -u " + full_script_path + " " 
-                         + SHM_NAME_BI + " &"; 
-    std::cout << "[IPC C++] Launching Acceptor script: " << command << std::endl;
-    int result = system(command.c_str());
-     if (result != 0) {
-        // Note: system() return value is complex to interpret reliably for background processes.
-        // We might not get a useful error code here if the script fails later.
-        std::cerr << "[IPC C++] Warning: system() call for Acceptor script returned non-zero or error. Check script output/logs." << std::endl;
-        // Consider adding a short delay and then checking if Acceptor is alive, 
-        // or having Acceptor create a small pid/status file on successful startup.
-    }
-
-    // --- Start Listener Thread --- 
+    if (!workers.empty()) {
+        std::cerr << "[IPC C++] Error: Bi-directional IPC is already initialized." << std::endl;
+        return false;
+    }
+    data_callback = callback;
+    dispatch_policy = options.dispatch;
+    acceptor_executable_path = acceptor_executable;
+    acceptor_script_full_path = "APP/backend/" + acceptor_script_path; // Construct path relative to project root
+
+    // Stops and releases whatever was set up so far
+    auto abort_init = [] {
+        for (auto& w : workers) {
+            {
+                std::lock_guard<std::mutex> lock(w->send_mutex);
+                w->supervising = false;
+            }
+            if (w->pid > 0) {
+                close_pipe(w->doorbell_c2a); // an Acceptor on its way up exits on EOF
+                reap_acceptor(*w, ACCEPTOR_EXIT_GRACE);
+            }
+            release_worker(*w);
+        }
+        workers.clear();
+        data_callback = nullptr;
+        return false;
+    };
+
+    // --- Map every segment and launch every Acceptor, then wait for all ---
+    std::string name_prefix = std::string(SHM_NAME_BI) + "_" + std::to_string(getpid()) + "_" +
+                              std::to_string(init_generation.fetch_add(1)) + "_";
+    for (size_t i = 0; i < options.workers; i++) {
+        workers.emplace_back(new AcceptorWorker());
+        AcceptorWorker& w = *workers.back();
+        w.index = static_cast<uint32_t>(i);
+        w.shm_name = name_prefix + std::to_string(i);
+        if (!create_segment(w, options)) return abort_init();
+        if (!open_doorbell(w.listener_wakeup)) {
+            perror("[IPC C++] pipe failed");
+            return abort_init();
+        }
+        std::lock_guard<std::mutex> lock(w.send_mutex);
+        w.supervising = true;
+        if (!launch_acceptor(w)) return abort_init();
+    }
+    std::cout << "[IPC C++] Bi-directional SHM rings ready (max request "
+              << max_acceptor_request_size() << " bytes, max response "
+              << workers[0]->ring_a2c.max_payload() - sizeof(IpcRecordHeader) << " bytes)." << std::endl;
+
+    // The Acceptors start in parallel, so one deadline covers them all
+    auto ready_deadline = std::chrono::steady_clock::now() + ACCEPTOR_READY_TIMEOUT;
+    for (auto& w : workers) {
+        if (!wait_for_acceptor_ready(*w, ready_deadline)) {
+            w->connected.store(false);
+            int status = reap_acceptor(*w, ACCEPTOR_EXIT_GRACE);
+            std::cerr << "[IPC C++] Error: Acceptor " << w->index << " exited before it was ready ("
+                      << describe_exit(status) << ")." << std::endl;
+            return abort_init();
+        }
+        std::lock_guard<std::mutex> lock(w->pending_mutex);
+        std::cout << "[IPC C++] Acceptor " << w->index << " (pid " << w->pid << ") ready after "
+                  << w->stats.ready_us << " us." << std::endl;
+    }
+
+    // --- Start Listener Threads ---
     keep_listener_running.store(true);
-    listener_thread = std::thread(acceptor_listener_thread_func); // Call renamed listener
-    std::cout << "[IPC C++] Listener thread starting." << std::endl;
+    for (auto& w : workers) {
+        w->listener = std::thread(acceptor_listener_thread_func, w.get()); // Call renamed listener
+    }
+    std::cout << "[IPC C++] " << workers.size() << " listener thread(s) starting." << std::endl;
 
     std::cout << "[IPC C++] Bi-directional IPC Initialization complete." << std::endl;
     return true;
 }
 
 void shutdown_acceptor_ipc_bidirectional() { // Renamed function
-    std::cout << "[IPC C++] Shutting down Bi-directional IPC with Acceptor..." << std::endl;
-
-    // --- Stop Listener Thread --- 
-    if (keep_listener_running.load()) {
-        keep_listener_running.store(false);
-        if (listener_thread.joinable()) {
-            listener_thread.join();
-             std::cout << "[IPC C++] Listener thread joined." << std::endl;
+    std::cout << "[IPC C++] Shutting down Bi-directional IPC with " << workers.size() << " Acceptor(s)..." << std::endl;
+
+    // --- Signal every Acceptor to shut down via its SHM flag ---
+    // The listeners still run here: their doorbell wakeups deliver the acknowledgements
+    for (auto& w : workers) {
+        // No restarts from here on; the doorbell is not swapped under us
+        std::lock_guard<std::mutex> lock(w->send_mutex);
+        w->supervising = false;
+        w->shm->c_to_a_command.store(99); // Use c_to_a_command
+        ring_doorbell(w->doorbell_c2a[1]);
+    }
+    for (auto& w : workers) {
+        // Wait briefly for the Acceptor to acknowledge shutdown
+        if (w->connected.load() && wait_for_acceptor_ack(*w, SHUTDOWN_ACK_TIMEOUT)) {
+             std::cout << "[IPC C++] Acceptor " << w->index << " acknowledged shutdown command." << std::endl;
+        } else {
+             std::cerr << "[IPC C++] Warning: Timeout waiting for Acceptor " << w->index << " to acknowledge shutdown command." << std::endl;
         }
     }
 
-    // --- Signal Acceptor process to shut down via SHM flag --- 
-    if (shm_ptr_bi) {
-        std::cout << "[IPC C++] Sending Shutdown command (99) to Acceptor..." << std::endl;
-        shm_ptr_bi->c_to_a_command.store(99); // Use c_to_a_command
-
-        // Optional: Wait briefly for Acceptor to acknowledge shutdown
-        auto shutdown_start = std::chrono::steady_clock::now();
-        while (shm_ptr_bi->c_to_a_command.load() == 99) { // Use c_to_a_command
-            if (std::chrono::steady_clock::now() - shutdown_start > std::chrono::milliseconds(500)) {
-                 std::cerr << "[IPC C++] Warning: Timeout waiting for Acceptor to acknowledge shutdown command." << std::endl;
-                 break;
-            }
-             std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
-        if (shm_ptr_bi->c_to_a_command.load() == 0) { // Use c_to_a_command
-             std::cout << "[IPC C++] Acceptor acknowledged shutdown command." << std::endl;
+    // --- Stop Listener Threads ---
+    keep_listener_running.store(false);
+    for (auto& w : workers) {
+        ring_doorbell(w->listener_wakeup[1]);
+        if (w->listener.joinable()) {
+            w->listener.join();
         }
-
-        // Calculate total size for munmap using the MAX constants
-        size_t control_block_size = 128;
-        size_t total_shm_size = control_block_size + SHM_C2A_BUFFER_MAX_SIZE + SHM_A2C_BUFFER_MAX_SIZE;
-        munmap(shm_ptr_bi, total_shm_size);
-        shm_ptr_bi = nullptr;
-         std::cout << "[IPC C++] Shared memory unmapped." << std::endl;
     }
+    std::cout << "[IPC C++] Listener threads joined." << std::endl;
 
-    // --- Cleanup Resources (SHM only) --- 
-    if (shm_fd_bi != -1) {
-        close(shm_fd_bi); shm_fd_bi = -1;
-        shm_unlink(SHM_NAME_BI);
-         std::cout << "[IPC C++] Shared memory unlinked." << std::endl;
+    for (auto& w : workers) {
+        if (w->pid > 0) {
+            // Closing its doorbell as well tells an Acceptor that missed the command
+            close_pipe(w->doorbell_c2a);
+            int status = reap_acceptor(*w, ACCEPTOR_EXIT_GRACE);
+            std::cout << "[IPC C++] Acceptor " << w->index << " exited (" << describe_exit(status) << ")." << std::endl;
+        }
+        {
+            std::lock_guard<std::mutex> lock(w->pending_mutex);
+            if (!w->pending.empty()) {
+                std::cerr << "[IPC C++] " << w->pending.size() << " request(s) to Acceptor " << w->index
+                          << " were never answered." << std::endl;
+            }
+        }
+        // --- Cleanup Resources (SHM only) ---
+        release_worker(*w);
     }
+    workers.clear();
+    std::cout << "[IPC C++] Shared memory unmapped and unlinked." << std::endl;
 
     data_callback = nullptr; // Clear callback
     std::cout << "[IPC C++] Bi-directional IPC Shutdown complete." << std::endl;
 }
 
-bool send_data_to_acceptor_async(const uint8_t* input_data, size_t input_len) { // Renamed function
-     std::lock_guard<std::mutex> lock(send_mutex);
-     if (!shm_ptr_bi) { return false; }
-     
-     // Check input length against the defined C->A (TX) buffer size
-     if (input_len > shm_ptr_bi->defined_c2a_buffer_size) { // Use defined_c2a_buffer_size
-         std::cerr << "[IPC C++] Error: Input data size (" << input_len
-                   << ") exceeds defined C->A buffer size (" << shm_ptr_bi->defined_c2a_buffer_size << ")." << std::endl;
+bool reserve_acceptor_request(size_t length, AcceptorRequestSlot* slot) {
+     *slot = AcceptorRequestSlot();
+     // Check input length against what one C->A record can hold
+     if (length > max_acceptor_request_size()) {
+         std::cerr << "[IPC C++] Error: Input data size (" << length
+                   << ") exceeds the largest C->A request (" << max_acceptor_request_size() << ")." << std::endl;
         return false;
      }
+     AcceptorWorker* worker = keep_listener_running.load() ? pick_worker() : nullptr;
+     if (!worker) {
+         std::cerr << "[IPC C++] Aborting send: No Acceptor is running." << std::endl;
+         return false;
+     }
+     AcceptorWorker& w = *worker;
+     std::unique_lock<std::mutex> lock(w.send_mutex);
+     auto deadline = std::chrono::steady_clock::now() + ACK_TIMEOUT;
+     // One request at a time is being built in the ring
+     if (!w.reserve_cv.wait_until(lock, deadline, [&w] { return !w.reserved; })) {
+         std::cerr << "[IPC C++] Error: Timeout waiting for the pending request of Acceptor " << w.index
+                   << " to be committed. Sending failed." << std::endl;
+         return false;
+     }
+     if (!w.ring_c2a.attached() || !w.connected.load()) {
+         std::cerr << "[IPC C++] Aborting send: Acceptor " << w.index << " is not running." << std::endl;
+         return false;
+     }
 
-     // --- Busy-wait for Acceptor to be ready --- 
-     auto wait_start_time = std::chrono::steady_clock::now();
-     while (shm_ptr_bi->c_to_a_command.load() != 0) { // Use c_to_a_command
-         if (!keep_listener_running.load()) { 
-             std::cerr << "[IPC C++] Aborting send: Shutdown in progress." << std::endl;
-             return false;
+     // --- Reserve a record; wait for the Acceptor to free space if full ---
+     uint32_t record_len = static_cast<uint32_t>(sizeof(IpcRecordHeader) + length);
+     bool waited = false;
+     uint8_t* record = nullptr;
+     while (true) {
+         uint64_t generation;
+         {
+             std::lock_guard<std::mutex> ack_lock(w.ack_mutex);
+             generation = w.doorbell_generation;
          }
-         if (std::chrono::steady_clock::now() - wait_start_time > std::chrono::seconds(5)) { 
-             std::cerr << "[IPC C++] Error: Timeout waiting for Acceptor to acknowledge previous C->A command (" 
-                       << shm_ptr_bi->c_to_a_command.load() << "). Sending failed." << std::endl;
-             return false; 
+         record = w.ring_c2a.try_reserve(record_len);
+         if (record) break;
+         waited = true;
+         std::unique_lock<std::mutex> ack_lock(w.ack_mutex);
+         bool woke = w.ack_cv.wait_until(ack_lock, deadline, [&w, generation] {
+             return w.doorbell_generation != generation || !w.connected.load();
+         });
+         if (!woke || !w.connected.load()) {
+             std::cerr << "[IPC C++] Error: " << (w.connected.load() ? "Timeout waiting for" : "Acceptor exited before freeing")
+                       << " C->A ring space of Acceptor " << w.index << ". Sending failed." << std::endl;
+             return false;
          }
-         std::this_thread::sleep_for(std::chrono::microseconds(500)); 
      }
      // ---------------------------------------
 
-     // Write data to C->A buffer
-     memcpy(shm_ptr_bi->buffer_c_to_a, input_data, input_len); // Use buffer_c_to_a
-     shm_ptr_bi->c_to_a_data_len.store(input_len); // Use c_to_a_data_len
-     shm_ptr_bi->c_to_a_command.store(1); // Use c_to_a_command
-     std::cout << "[IPC C++] Data written to C->A SHM (" << input_len << " bytes). Command set to 1." << std::endl;
+     w.reserved = true;
+     slot->data = record + sizeof(IpcRecordHeader);
+     slot->length = length;
+     slot->worker = &w;
+     slot->record = record;
+     slot->launch = w.launches;
+     slot->waited = waited;
      return true;
 }
 
-// Remove the old synchronous function
-// int process_data_with_python_sync(...) { ... } 
\ No newline at end of file
+// Stamps the reserved record with a new request_id, registers it as pending
+// and publishes it. `copied` tells the stats who wrote the payload.
+static uint32_t publish_request(AcceptorRequestSlot* slot, size_t length, uint64_t tag, bool copied) {
+     if (!slot->worker) return 0;
+     AcceptorWorker& w = *static_cast<AcceptorWorker*>(slot->worker);
+     std::lock_guard<std::mutex> lock(w.send_mutex);
+     w.reserved = false;
+     w.reserve_cv.notify_one();
+     if (slot->launch != w.launches) {
+         // The rings were reset under the slot when the Acceptor was restarted
+         std::cerr << "[IPC C++] Error: Acceptor " << w.index << " restarted while a request was being built. Sending failed." << std::endl;
+         *slot = AcceptorRequestSlot();
+         return 0;
+     }
+     length = std::min(length, slot->length);
+     uint32_t record_len = static_cast<uint32_t>(sizeof(IpcRecordHeader) + length);
+
+     uint32_t request_id = next_request_id.fetch_add(1);
+     if (request_id == 0) request_id = next_request_id.fetch_add(1); // 0 means failure
+     IpcRecordHeader header = {request_id, IPC_STATUS_OK};
+     memcpy(slot->record, &header, sizeof(header));
+     {
+         // Registered before publishing: the response may come back at once
+         std::lock_guard<std::mutex> pending_lock(w.pending_mutex);
+         w.pending[request_id] = {tag, std::chrono::steady_clock::now()};
+         w.in_flight.fetch_add(1);
+         w.stats.requests++;
+         if (slot->waited) w.stats.ring_full_waits++;
+         (copied ? w.stats.bytes_copied : w.stats.bytes_in_place) += length;
+     }
+     w.ring_c2a.commit(record_len);
+     ring_doorbell(w.doorbell_c2a[1]);
+     *slot = AcceptorRequestSlot();
+     return request_id;
+}
+
+uint32_t commit_acceptor_request(AcceptorRequestSlot* slot, size_t length, uint64_t tag) {
+    return publish_request(slot, length, tag, false);
+}
+
+void abort_acceptor_request(AcceptorRequestSlot* slot) {
+    if (!slot->worker) return;
+    AcceptorWorker& w = *static_cast<AcceptorWorker*>(slot->worker);
+    std::lock_guard<std::mutex> lock(w.send_mutex);
+    if (slot->launch == w.launches) w.ring_c2a.commit(0); // abandons the reservation
+    w.reserved = false;
+    w.reserve_cv.notify_one();
+    *slot = AcceptorRequestSlot();
+}
+
+uint32_t send_request_to_acceptor(const uint8_t* input_data, size_t input_len, uint64_t tag) {
+     AcceptorRequestSlot slot;
+     if (!reserve_acceptor_request(input_len, &slot)) return 0;
+     memcpy(slot.data, input_data, input_len);
+     return publish_request(&slot, input_len, tag, true);
+}
+
+bool send_data_to_acceptor_async(const uint8_t* input_data, size_t input_len) { // Renamed function
+    return send_request_to_acceptor(input_data, input_len, 0) != 0;
+}
+
+size_t max_acceptor_request_size() {
+    // All workers' rings have the same size
+    size_t max_payload = !workers.empty() && workers[0]->ring_c2a.attached() ? workers[0]->ring_c2a.max_payload() : 0;
+    return max_payload > sizeof(IpcRecordHeader) ? max_payload - sizeof(IpcRecordHeader) : 0;
+}
+
+size_t acceptor_worker_count() {
+    return workers.size();
+}
+
+AcceptorIpcStats get_acceptor_worker_stats(size_t worker) {
+    if (worker >= workers.size()) return AcceptorIpcStats();
+    AcceptorWorker& w = *workers[worker];
+    std::lock_guard<std::mutex> lock(w.pending_mutex);
+    AcceptorIpcStats stats = w.stats;
+    stats.workers = 1;
+    stats.in_flight = w.pending.size();
+    stats.segment_size = w.shm ? w.shm_size : 0;
+    stats.huge_pages = w.huge_pages;
+    return stats;
+}
+
+AcceptorIpcStats get_acceptor_ipc_stats() {
+    AcceptorIpcStats total;
+    for (size_t i = 0; i < workers.size(); i++) {
+        AcceptorIpcStats s = get_acceptor_worker_stats(i);
+        if (i == 0) {
+            total.acceptor_pid = s.acceptor_pid;
+            total.last_exit_status = s.last_exit_status;
+            total.huge_pages = s.huge_pages;
+        }
+        total.workers++;
+        total.requests += s.requests;
+        total.responses += s.responses;
+        total.unmatched += s.unmatched;
+        total.ring_full_waits += s.ring_full_waits;
+        total.bytes_copied += s.bytes_copied;
+        total.bytes_in_place += s.bytes_in_place;
+        total.in_flight += s.in_flight;
+        total.segment_size += s.segment_size;
+        total.restarts += s.restarts;
+        total.failed_requests += s.failed_requests;
+        total.ready_us = std::max(total.ready_us, s.ready_us);
+        total.first_response_us = std::max(total.first_response_us, s.first_response_us);
+    }
+    return total;
+}
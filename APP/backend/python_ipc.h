@@ -4,68 +4,175 @@
 #include <string>
 #include <vector>
 #include <atomic>
-#include <cstddef> // For size_t
+#include <cstddef> // For size_t, offsetof
 #include <cstdint> // For int32_t
 #include <functional> // For callback type
 
 // --- Configuration ---
-// Name for the shared memory segment (must match Python script)
+// Name prefix of the shared memory segments; worker i of an initialization
+// uses SHM_NAME_BI "_<pid>_<generation>_<i>" and passes the full name to its
+// Acceptor.
 #define SHM_NAME_BI "/electron_python_shm_bi_123" // Bi-directional
+const size_t ACCEPTOR_MAX_WORKERS = 64;
 
-// MAX size definitions for EACH buffer direction
-const size_t SHM_C2A_BUFFER_MAX_SIZE = 1024;           // Creator -> Acceptor (TX)
-const size_t SHM_A2C_BUFFER_MAX_SIZE = 1024 * 1024 * 2; // Acceptor -> Creator (RX)
+// Default size of each ring region (64-byte ring header + records). A ring
+// keeps up to half of its records area free for wrapping, so the largest
+// message is about half the region (see max_acceptor_request_size()).
+// AcceptorIpcOptions picks the sizes per channel at init.
+const size_t SHM_C2A_DEFAULT_RING_SIZE = 256 * 1024;      // Creator -> Acceptor (TX)
+const size_t SHM_A2C_DEFAULT_RING_SIZE = 1024 * 1024 * 4; // Acceptor -> Creator (RX)
+const size_t SHM_MIN_RING_SIZE = 4096;
+const size_t SHM_MAX_RING_SIZE = size_t(1) << 30;         // ring indices are int32
+const size_t SHM_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// --- Doorbells ---
+// Each direction is an SPSC ring (include/spsc_ring.h) in the segment; a pipe
+// per direction wakes the other side when its ring changes, so neither side
+// polls. The Creator passes the Acceptor its ends as two extra arguments
+// after the SHM name: <c2a_read_fd> <a2c_write_fd>. A doorbell byte carries
+// no meaning beyond "re-check the rings and flags"; several rings may
+// coalesce into one wakeup. Each side rings after it published records AND
+// after it consumed some, so a producer waiting for space wakes up too.
+
+// --- Workers ---
+// The channel runs a pool of N Acceptor processes (AcceptorIpcOptions::workers),
+// each with its own segment, rings, doorbells and listener thread, all started
+// at init. Every request goes to one worker (round-robin, or the one with the
+// fewest requests in flight) and its response carries the worker index.
+// Request ids are unique across the pool.
+
+// --- Supervision ---
+// Per worker: the Creator starts the Acceptor with posix_spawn() and keeps its pid. init
+// returns once the Acceptor reports SHM_ACCEPTOR_READY (or fails if it exits
+// first). When the Acceptor dies later (its doorbell closes), the listener
+// reaps it, answers every pending request with IPC_STATUS_ERROR and starts a
+// new one after a backoff that doubles per quick crash. After
+// ACCEPTOR_MAX_QUICK_RESTARTS crashes in a row it gives up and sends fail.
+const int ACCEPTOR_MAX_QUICK_RESTARTS = 8;
+
+// --- Records ---
+// Every ring record starts with this header (host byte order). A response
+// carries the request_id of the request it answers; several requests may be
+// in flight, and the Acceptor answers them in order.
+struct IpcRecordHeader {
+    uint32_t request_id;
+    uint32_t status;      // responses: IPC_STATUS_OK or IPC_STATUS_ERROR (payload = message)
+};
+const uint32_t IPC_STATUS_OK = 0;
+const uint32_t IPC_STATUS_ERROR = 1;
+
+// --- Shared Memory Layout ---
+// [header, 128 bytes][pad][C->A ring][A->C ring]
+// The Creator sizes the segment at init and describes it in the header; the
+// Acceptor finds the rings through the offsets and refuses a segment whose
+// magic or version it does not know. Ring regions start on a page boundary
+// (a 2 MB boundary with huge pages). Nothing is cleared up front: a fresh
+// segment reads as zeros and pages are backed only once a ring reaches them.
+// IMPORTANT: Keep in sync with the ctypes definition in python_ipc_ring.py.
+const uint32_t SHM_IPC_MAGIC = 0x43504950u;   // "PIPC"
+const uint32_t SHM_IPC_VERSION = 3;
+const uint32_t SHM_IPC_FLAG_HUGE_PAGES = 1u << 0; // rings were advised into transparent huge pages
+// acceptor_state: the Creator resets it before every launch; the Acceptor
+// sets READY once it has bound the rings and rings its doorbell
+const int32_t SHM_ACCEPTOR_STARTING = 0;
+const int32_t SHM_ACCEPTOR_READY = 1;
 
-// --- Shared Memory Structure ---
-// IMPORTANT: Ensure total size and layout (including padding) EXACTLY 
-// matches the Python ctypes.Structure definition.
 struct SharedIPCBidirectional {
-    // --- Control block --- 
-    // Atomics for status/commands
-    std::atomic<int32_t> c_to_a_command;  // 0: Idle, 1: Data Ready, 99: Shutdown
-    std::atomic<size_t>  c_to_a_data_len;
-    std::atomic<int32_t> a_to_c_status;   // 0: Idle, 1: Data Ready, -1: Error
-    std::atomic<size_t>  a_to_c_data_len;
-    // Defined buffer sizes (set by Creator, read by Acceptor)
-    size_t defined_c2a_buffer_size; // Actual usable size for buffer_c_to_a
-    size_t defined_a2c_buffer_size; // Actual usable size for buffer_a_to_c
-    
-    // Padding to ensure alignment and consistent control block size.
-    // Let's pad to 128 bytes for potential cache alignment benefits.
-    // Calculation assumes atomic<int32> is 4, atomic<size_t> is 8, size_t is 8.
-    // Current size = 4*2 + 8*2 + 8*2 = 8 + 16 + 16 = 40 bytes.
-    // Padding needed = 128 - 40 = 88 bytes.
-    char _padding1[128 - sizeof(std::atomic<int32_t>)*2 - sizeof(std::atomic<size_t>)*2 - sizeof(size_t)*2]; 
-    // --- End Control Block (Total 128 bytes) ---
-
-    // Data Buffers (Allocated based on MAX size constants)
-    char buffer_c_to_a[SHM_C2A_BUFFER_MAX_SIZE]; // Use TX max size
-    char buffer_a_to_c[SHM_A2C_BUFFER_MAX_SIZE]; // Use RX max size
+    uint32_t magic;           // SHM_IPC_MAGIC, written last
+    uint32_t version;         // SHM_IPC_VERSION
+    uint32_t header_size;     // sizeof(SharedIPCBidirectional)
+    uint32_t flags;           // SHM_IPC_FLAG_*
+    std::atomic<int32_t> c_to_a_command;  // 0: Running, 99: Shutdown (Acceptor resets to 0 to acknowledge)
+    std::atomic<int32_t> acceptor_state;  // SHM_ACCEPTOR_*, written by the Acceptor
+    uint64_t total_size;      // whole segment
+    uint64_t c2a_offset;      // request ring region, from the segment start
+    uint64_t c2a_size;
+    uint64_t a2c_offset;      // response ring region
+    uint64_t a2c_size;
+    char _padding[64];
 };
 
-// Ensure the struct size calculation reflects the padding goal
-static_assert(sizeof(SharedIPCBidirectional::_padding1) == (128 - sizeof(std::atomic<int32_t>)*2 - sizeof(std::atomic<size_t>)*2 - sizeof(size_t)*2),
-              "Padding calculation error in SharedIPCBidirectional");
+static_assert(sizeof(SharedIPCBidirectional) == 128,
+              "SharedIPCBidirectional header must be 128 bytes");
+static_assert(offsetof(SharedIPCBidirectional, total_size) == 24,
+              "SharedIPCBidirectional layout must match python_ipc_ring.py");
 
-// --- Callback Type for Received Data ---
-// This callback will be invoked by the C++ listener thread when data arrives from Python.
-// It needs to handle copying the data and likely forwarding it to the JS layer.
-// IMPORTANT: This runs in a separate thread, ensure thread safety in the callback implementation!
-typedef std::function<void(const uint8_t* data, size_t length)> AcceptorDataCallback;
+enum AcceptorDispatch {
+    ACCEPTOR_DISPATCH_ROUND_ROBIN,   // next worker in turn
+    ACCEPTOR_DISPATCH_LEAST_LOADED,  // fewest requests in flight, ties in turn
+};
+
+struct AcceptorIpcOptions {
+    size_t c2a_ring_size = SHM_C2A_DEFAULT_RING_SIZE; // rounded up to whole pages
+    size_t a2c_ring_size = SHM_A2C_DEFAULT_RING_SIZE;
+    // Align the rings to 2 MB and madvise(MADV_HUGEPAGE) them (Linux). POSIX
+    // shm lives on tmpfs, where MAP_HUGETLB is refused, so this relies on
+    // shmem THP (/sys/kernel/mm/transparent_hugepage/shmem_enabled set to
+    // "advise" or above); otherwise the segment falls back to normal pages.
+    bool huge_pages = false;
+    size_t workers = 1;       // Acceptor processes, 1..ACCEPTOR_MAX_WORKERS
+    AcceptorDispatch dispatch = ACCEPTOR_DISPATCH_LEAST_LOADED;
+};
+
+// --- Callback Type for Responses ---
+// Invoked on a worker's listener thread for every response from its Acceptor.
+// `data` points into the shared ring and is only valid during the call.
+// IMPORTANT: With several workers the callback runs on several threads at once,
+// ensure thread safety in the callback implementation!
+struct AcceptorResponse {
+    uint32_t request_id;
+    uint32_t worker;       // index of the Acceptor that answered
+    uint64_t tag;          // as passed to send_request_to_acceptor()
+    uint32_t status;       // IPC_STATUS_*
+    const uint8_t* data;
+    size_t length;
+    uint64_t round_trip_us; // request queued -> response received
+};
+typedef std::function<void(const AcceptorResponse& response)> AcceptorDataCallback;
+
+// get_acceptor_ipc_stats() sums the counters over all workers; the per-launch
+// fields (acceptor_pid, last_exit_status) are worker 0's, ready_us and
+// first_response_us the slowest worker's.
+struct AcceptorIpcStats {
+    size_t workers = 0;
+    uint64_t requests = 0;
+    uint64_t responses = 0;
+    uint64_t unmatched = 0;   // responses whose request_id was not pending
+    uint64_t ring_full_waits = 0; // sends that waited for ring space
+    uint64_t bytes_copied = 0;   // request payload send_request_to_acceptor() copied into a ring
+    uint64_t bytes_in_place = 0; // request payload written in place (commit_acceptor_request())
+    size_t in_flight = 0;
+    size_t segment_size = 0;  // bytes mapped (all workers), 0 when the channel is down
+    bool huge_pages = false;  // SHM_IPC_FLAG_HUGE_PAGES was set
+    // Supervisor
+    int acceptor_pid = 0;     // running Acceptor, 0 if none
+    uint64_t restarts = 0;    // launches after the first one
+    uint64_t failed_requests = 0; // pending when the Acceptor died, answered with IPC_STATUS_ERROR
+    int last_exit_status = 0; // raw waitpid() status of the last Acceptor that exited
+    uint64_t ready_us = 0;    // last launch -> Acceptor READY
+    uint64_t first_response_us = 0; // last launch -> first response
+};
 
 // --- IPC Management Functions ---
 
 /**
- * @brief Initializes the Bi-directional IPC channel using busy-wait flags.
+ * @brief Initializes the Bi-directional IPC channel (SHM rings + pipe doorbells)
+ * and starts options.workers Acceptor processes.
  * @param python_executable Path to the python executable.
  * @param script_path Path to the python_bidirectional_ipc_script.py.
- * @param callback The function to call when data is received from Python.
- * @return True on success, false on failure.
+ * @param callback The function to call for every response from Python.
+ * @param options Ring sizes per direction (per worker), huge page use, worker count and dispatch.
+ * @return True once every Acceptor is running (READY, or still starting after
+ * 10 s), false on failure: ring sizes outside
+ * SHM_MIN_RING_SIZE..SHM_MAX_RING_SIZE, a worker count outside
+ * 1..ACCEPTOR_MAX_WORKERS, spawn failure, or an Acceptor that exited before
+ * it was ready.
  */
 bool init_acceptor_ipc_bidirectional(
     const std::string& acceptor_executable,
     const std::string& acceptor_script_path,
-    AcceptorDataCallback callback
+    AcceptorDataCallback callback,
+    const AcceptorIpcOptions& options = AcceptorIpcOptions()
 );
 
 /**
@@ -74,13 +181,64 @@ bool init_acceptor_ipc_bidirectional(
 void shutdown_acceptor_ipc_bidirectional();
 
 /**
- * @brief Sends data asynchronously to the Python process. (Non-blocking)
- * Writes data to the C->P buffer and signals Python via semaphore.
- * Does NOT wait for a response. Responses arrive via the PythonDataCallback.
+ * @brief Queues one request for a worker chosen by the dispatch policy and
+ * returns without waiting for the response, which arrives through the
+ * AcceptorDataCallback with the same request_id and `tag`. Several requests
+ * may be in flight. Blocks (up to 5s) only while that worker's C->A ring is full.
  * @param input_data Pointer to the input data buffer.
- * @param input_len Length of the input data.
- * @return True if data was successfully written and signaled, false otherwise.
+ * @param input_len Length of the input data (at most max_acceptor_request_size()).
+ * @param tag Opaque value handed back with the response (e.g. the BPG group/target).
+ * @return The request_id (never 0), or 0 if the request could not be queued.
+ */
+uint32_t send_request_to_acceptor(const uint8_t* input_data, size_t input_len, uint64_t tag);
+
+/**
+ * @brief send_request_to_acceptor() with tag 0.
+ * @return True if the request was queued.
  */
 bool send_data_to_acceptor_async(const uint8_t* input_data, size_t input_len);
 
+/**
+ * @brief A request being built in place in a worker's C->A ring; see
+ * reserve_acceptor_request().
+ */
+struct AcceptorRequestSlot {
+    uint8_t* data = nullptr; // room for `length` payload bytes
+    size_t length = 0;
+    // Internal
+    void* worker = nullptr;
+    uint8_t* record = nullptr;
+    uint64_t launch = 0;
+    bool waited = false;
+};
+
+/**
+ * @brief Reserves room for a `length`-byte request in the ring of the worker
+ * the dispatch policy picks, so the caller writes the payload straight into
+ * shared memory instead of handing send_request_to_acceptor() a buffer to
+ * copy. Other requests to that worker wait until commit_acceptor_request()
+ * or abort_acceptor_request() ends the reservation; either may run on another
+ * thread. Waits (up to 5s) while the ring is full, like a send.
+ * @return True with slot->data set, false if no room could be reserved.
+ */
+bool reserve_acceptor_request(size_t length, AcceptorRequestSlot* slot);
+
+/**
+ * @brief Publishes the first `length` bytes (at most the reserved length) of a
+ * reserved request. Its response arrives like that of send_request_to_acceptor().
+ * @return The request_id, or 0 if the slot was not reserved or its Acceptor
+ * was restarted in the meantime.
+ */
+uint32_t commit_acceptor_request(AcceptorRequestSlot* slot, size_t length, uint64_t tag);
+
+/**
+ * @brief Drops a reserved request without sending anything.
+ */
+void abort_acceptor_request(AcceptorRequestSlot* slot);
+
+size_t max_acceptor_request_size();
+AcceptorIpcStats get_acceptor_ipc_stats();
+size_t acceptor_worker_count();
+AcceptorIpcStats get_acceptor_worker_stats(size_t worker); // zeroed for an unknown worker
+
 #endif // PYTHON_IPC_H 
\ No newline at end of file
@@ -0,0 +1,149 @@
+# Shared memory layout of the Python IPC segment (python_ipc.h): the header,
+# the SPSC rings (include/spsc_ring.h) and the record header.
+# Used by python_bidirectional_ipc_script.py and tests/python_ipc_stub_acceptor.py.
+import ctypes
+import mmap
+import struct
+
+# --- Segment header (Matches SharedIPCBidirectional) ---
+SHM_IPC_MAGIC = 0x43504950 # "PIPC"
+SHM_IPC_VERSION = 3
+SHM_IPC_FLAG_HUGE_PAGES = 1
+SHM_ACCEPTOR_STARTING = 0
+SHM_ACCEPTOR_READY = 1 # set once the rings are bound, then ring the Creator
+
+class SharedIPCBidirectional(ctypes.Structure):
+    _fields_ = [
+        ("magic", ctypes.c_uint32),
+        ("version", ctypes.c_uint32),
+        ("header_size", ctypes.c_uint32),
+        ("flags", ctypes.c_uint32),
+        # Creator -> Acceptor: 0 running, 99 shutdown (reset to 0 to acknowledge)
+        ("c_to_a_command", ctypes.c_int32), 
+        ("acceptor_state", ctypes.c_int32), # SHM_ACCEPTOR_*
+        ("total_size", ctypes.c_uint64),
+        # Ring regions, offsets from the segment start
+        ("c2a_offset", ctypes.c_uint64),
+        ("c2a_size", ctypes.c_uint64),
+        ("a2c_offset", ctypes.c_uint64),
+        ("a2c_size", ctypes.c_uint64),
+        ("_padding", ctypes.c_char * 64),
+    ]
+
+def open_segment(mm):
+    """Maps the header of the segment in `mm` and binds both rings.
+    Returns (header, c2a_ring, a2c_ring); raises ValueError for a segment
+    this side cannot read (wrong magic/version, rings outside the mapping)."""
+    header = SharedIPCBidirectional.from_buffer(mm)
+    if header.magic != SHM_IPC_MAGIC or header.version != SHM_IPC_VERSION:
+        raise ValueError(f"unsupported SHM segment (magic {header.magic:#x}, version {header.version})")
+    if header.header_size != ctypes.sizeof(SharedIPCBidirectional):
+        raise ValueError(f"SHM header is {header.header_size} bytes, expected {ctypes.sizeof(SharedIPCBidirectional)}")
+    for offset, size in ((header.c2a_offset, header.c2a_size), (header.a2c_offset, header.a2c_size)):
+        if size <= ShmRing.HEADER_SIZE or offset + size > len(mm):
+            raise ValueError(f"SHM ring at {offset} (+{size}) lies outside the {len(mm)}-byte mapping")
+    if header.flags & SHM_IPC_FLAG_HUGE_PAGES and hasattr(mmap, "MADV_HUGEPAGE"):
+        # Offsets are 2 MB aligned; the kernel ignores the advice where it cannot apply it
+        try:
+            mm.madvise(mmap.MADV_HUGEPAGE, header.c2a_offset, header.c2a_size + header.a2c_size)
+        except (OSError, ValueError):
+            pass
+    return (header,
+            ShmRing(mm, header.c2a_offset, header.c2a_size),
+            ShmRing(mm, header.a2c_offset, header.a2c_size))
+
+# --- Ring records (Matches IpcRecordHeader in python_ipc.h) ---
+RECORD_HEADER = struct.Struct("=II") # request_id, status
+IPC_STATUS_OK = 0
+IPC_STATUS_ERROR = 1
+
+class ShmRing:
+    """SPSC ring of variable-length records in the mmap, same layout and
+    algorithm as include/spsc_ring.h (the Creator resets both indices):
+      [0..3] write index, [32..35] read index, records from byte 64,
+      record = [length u32][payload][pad to 4], length 0xFFFFFFFF = wrap to 0."""
+    HEADER_SIZE = 64
+    WRAP_MARKER = 0xFFFFFFFF
+    U32 = struct.Struct("=I")
+    I32 = struct.Struct("=i")
+
+    def __init__(self, mm, offset, size):
+        self.mm = mm
+        self.write_at = offset
+        self.read_at = offset + 32
+        self.records = offset + self.HEADER_SIZE
+        self.capacity = (size - self.HEADER_SIZE) & ~3
+        self.peek_pos = 0
+        self.peek_length = 0
+
+    @staticmethod
+    def record_size(length):
+        return (4 + length + 3) & ~3
+
+    def max_payload(self):
+        return ((self.capacity // 2) & ~3) - 8
+
+    def _load(self, at):
+        return self.I32.unpack_from(self.mm, at)[0]
+
+    def _store(self, at, value):
+        self.I32.pack_into(self.mm, at, value)
+
+    # --- Consumer side ---
+    def peek(self):
+        """Returns the oldest record as a memoryview, or None if empty."""
+        r = self._load(self.read_at)
+        w = self._load(self.write_at)
+        for _ in range(2):
+            if r == w:
+                return None
+            if self.capacity - r < 4:
+                r = 0
+                continue
+            length = self.U32.unpack_from(self.mm, self.records + r)[0]
+            if length == self.WRAP_MARKER:
+                r = 0
+                continue
+            if self.record_size(length) > self.capacity - r:
+                return None # corrupted record
+            self.peek_pos = r
+            self.peek_length = length
+            start = self.records + r + 4
+            return memoryview(self.mm)[start:start + length]
+        return None
+
+    def release(self):
+        nxt = self.peek_pos + self.record_size(self.peek_length)
+        self._store(self.read_at, 0 if nxt == self.capacity else nxt)
+
+    # --- Producer side ---
+    def try_push(self, parts):
+        """Writes the byte strings in `parts` as one record; False when full."""
+        length = sum(len(p) for p in parts)
+        if length > self.max_payload():
+            return False
+        need = self.record_size(length)
+        w = self._load(self.write_at)
+        r = self._load(self.read_at)
+        if w >= r:
+            tail = self.capacity - w
+            if need < tail or (need == tail and r != 0):
+                pos = w
+            elif need < r:
+                if tail >= 4:
+                    self.U32.pack_into(self.mm, self.records + w, self.WRAP_MARKER)
+                pos = 0
+            else:
+                return False
+        elif need < r - w:
+            pos = w
+        else:
+            return False
+        at = self.records + pos + 4
+        for part in parts:
+            self.mm[at:at + len(part)] = part
+            at += len(part)
+        self.U32.pack_into(self.mm, self.records + pos, length)
+        nxt = pos + need
+        self._store(self.write_at, 0 if nxt == self.capacity else nxt)
+        return True
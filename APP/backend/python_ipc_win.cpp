@@ -5,7 +5,8 @@
 bool init_acceptor_ipc_bidirectional(
     const std::string& /*acceptor_executable*/,
     const std::string& /*acceptor_script_path*/,
-    AcceptorDataCallback /*callback*/)
+    AcceptorDataCallback /*callback*/,
+    const AcceptorIpcOptions& /*options*/)
 {
     std::cerr << "[IPC C++] Bi-directional Python IPC is not available on Windows (POSIX shm only).\n";
     return false;
@@ -13,7 +14,30 @@ bool init_acceptor_ipc_bidirectional(
 
 void shutdown_acceptor_ipc_bidirectional() {}
 
+uint32_t send_request_to_acceptor(const uint8_t* /*input_data*/, size_t /*input_len*/, uint64_t /*tag*/)
+{
+    return 0;
+}
+
 bool send_data_to_acceptor_async(const uint8_t* /*input_data*/, size_t /*input_len*/)
 {
     return false;
 }
+
+bool reserve_acceptor_request(size_t /*length*/, AcceptorRequestSlot* slot)
+{
+    *slot = AcceptorRequestSlot();
+    return false;
+}
+
+uint32_t commit_acceptor_request(AcceptorRequestSlot* /*slot*/, size_t /*length*/, uint64_t /*tag*/) { return 0; }
+
+void abort_acceptor_request(AcceptorRequestSlot* /*slot*/) {}
+
+size_t max_acceptor_request_size() { return 0; }
+
+AcceptorIpcStats get_acceptor_ipc_stats() { return AcceptorIpcStats(); }
+
+size_t acceptor_worker_count() { return 0; }
+
+AcceptorIpcStats get_acceptor_worker_stats(size_t /*worker*/) { return AcceptorIpcStats(); }
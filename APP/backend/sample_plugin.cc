@@ -3,6 +3,7 @@
 #endif
 #include "include/plugin_interface.h"
 #include <cstring>
+#include <cstdio>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -10,6 +11,9 @@
 #include <opencv2/opencv.hpp>
 #include <iomanip>
 #include <memory>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 
 // Include BPG Protocol headers
 #include "BPG_Protocol/bpg_decoder.h"
@@ -18,6 +22,8 @@
 
 // Include our Python IPC header
 #include "python_ipc.h"
+#include "pixel_convert.h"
+#include "tile_pool.h"
 
 BPG::AppPacket create_string_packet(uint32_t group_id, uint32_t target_id,std::string TL, std::string str);
 
@@ -25,11 +31,27 @@ static MessageCallback g_send_message = nullptr;
 static BufferRequestCallback g_buffer_request_callback = nullptr;
 static BufferSendCallback g_buffer_send_callback = nullptr;
 static BPG::BpgDecoder g_bpg_decoder; // Decoder instance for this plugin
+static constexpr std::chrono::milliseconds GROUP_TIMEOUT(5000); // unfinished groups older than this are dropped
+
+// Worker pool for encoding large images in row tiles (null on single-core hosts)
+static std::unique_ptr<TilePool> g_tile_pool;
+static constexpr size_t TILED_ENCODE_MIN_BYTES = 4 * 1024 * 1024; // smaller payloads are encoded inline
+static constexpr size_t TILED_ENCODE_TILE_BYTES = 256 * 1024;     // output bytes per tile (rounded to rows)
+// Python IPC rings: a TX request up to half the ring goes out in one record
+// (a 4K RGB frame is ~25 MB). Pages are only backed once a ring reaches them.
+static constexpr size_t PYTHON_REQUEST_RING_BYTES = 64 * 1024 * 1024;
+static constexpr size_t PYTHON_RESPONSE_RING_BYTES = 16 * 1024 * 1024;
+// Python processes sharing the requests; each gets its own pair of rings
+static constexpr size_t PYTHON_WORKERS = 2;
+// TX binaries are decoded straight into a request reserved in a Python ring
+// (the one copy between the host buffer and Python)
+static AcceptorRequestSlot g_tx_request;
 
 class HybridData_cvMat:public BPG::HybridData{
     public:
     cv::Mat img;
     std::string img_format;
+    uint16_t max_value_16u = 65535; // CV_16UC1 samples at this value map to 255
     HybridData_cvMat(cv::Mat img,std::string img_format):img(img),img_format(img_format){
         printf("HybridData_cvMat: %zu <<format: %s\n",calculateBinarySize(),img_format.c_str());
     }
@@ -57,91 +79,127 @@ class HybridData_cvMat:public BPG::HybridData{
              return BPG::BpgError::BufferTooSmall; // Or another appropriate error
         }
         
-        if(img_format=="raw"){
-            std::memcpy(buffer, img.data, img.total()*img.elemSize());
-            return BPG::BpgError::Success;
+        if(img_format!="raw" && img_format!="raw_rgba"){
+            return BPG::BpgError::EncodingError;
         }
-        if(img_format=="raw_rgba"){
+        if(img_format=="raw_rgba" && !isRgbaConvertible(img.type())){
+            return BPG::BpgError::EncodingError;
+        }
+
+        // Large frames are split into row tiles that land in disjoint parts of
+        // the claimed span, so the pool threads never touch the same bytes
+        size_t row_bytes = calculateBinarySize() / std::max(img.rows, 1);
+        if(g_tile_pool && calculateBinarySize() >= TILED_ENCODE_MIN_BYTES && row_bytes > 0){
+            size_t rows = static_cast<size_t>(img.rows);
+            size_t rows_per_tile = std::max<size_t>(1, TILED_ENCODE_TILE_BYTES / row_bytes);
+            size_t tiles = (rows + rows_per_tile - 1) / rows_per_tile;
+            g_tile_pool->run(tiles, [&](size_t tile) {
+                size_t row_begin = tile * rows_per_tile;
+                encodeRows(buffer, row_begin, std::min(rows, row_begin + rows_per_tile));
+            });
+        } else {
+            encodeRows(buffer, 0, static_cast<size_t>(img.rows));
+        }
+        return BPG::BpgError::Success;
+    }
 
+    static bool isRgbaConvertible(int type) {
+        return type == CV_8UC1 || type == CV_8UC3 || type == CV_8UC4 || type == CV_16UC1;
+    }
+
+    // Writes rows [row_begin, row_end) to their place in `buffer`. Row by row,
+    // so non-continuous Mats (ROIs) work too.
+    void encodeRows(uint8_t* buffer, size_t row_begin, size_t row_end) const {
+        size_t cols = static_cast<size_t>(img.cols);
+        if(img_format=="raw"){
+            size_t row_bytes = cols * img.elemSize();
+            for (size_t row = row_begin; row < row_end; row++) {
+                std::memcpy(buffer + row * row_bytes, img.ptr<uint8_t>(static_cast<int>(row)), row_bytes);
+            }
+            return;
+        }
+        for (size_t row = row_begin; row < row_end; row++) {
+            const uint8_t* src = img.ptr<uint8_t>(static_cast<int>(row));
+            uint8_t* dst = buffer + row * cols * 4;
             switch(img.type()){
                 case CV_8UC1:
-                {
-                    uint8_t* img_data = img.data;
-                    uint8_t* buffer_ptr = buffer;
-                    for(int i=0;i<img.total();i++){
-                        uint8_t pixel = *img_data++;
-                        *buffer_ptr++=pixel;
-                        *buffer_ptr++=pixel;
-                        *buffer_ptr++=pixel;
-                        *buffer_ptr++=255;
-                    }
-                }
+                    PixelConvert::gray_to_rgba(src, dst, cols);
                     break;
                 case CV_8UC3:
-                {
-                    uint8_t* img_data = img.data;
-                    uint8_t* buffer_ptr = buffer;
-                    for(int i=0;i<img.total();i++){
-                        *buffer_ptr++=*img_data++;
-                        *buffer_ptr++=*img_data++;
-                        *buffer_ptr++=*img_data++;
-                        *buffer_ptr++=255;
-                    }
-                }
+                    // Channel order is passed through unchanged, as before
+                    PixelConvert::rgb_to_rgba(src, dst, cols);
                     break;
                 case CV_8UC4:
-                {
-                    memcpy(buffer,img.data,img.total()*4);
-                }
+                    std::memcpy(dst, src, cols * 4);
+                    break;
+                case CV_16UC1:
+                    PixelConvert::gray16_to_rgba(reinterpret_cast<const uint16_t*>(src), dst, cols, max_value_16u);
                     break;
             }
-            return BPG::BpgError::Success;
         }
-        return BPG::BpgError::EncodingError;
     }
 };
 
 // --- BPG Callbacks --- 
 
-// Callback for data received FROM Python via the listener thread
-static void handle_python_data(const uint8_t* data, size_t length) {
-    std::cout << "[SamplePlugin PythonCallback] Received " << length << " bytes from Python listener." << std::endl;
-    
-    // TODO: Need context (like original group_id, target_id) to send a proper response.
-    // For now, just create a generic BPG packet with the received data.
-    // A more robust solution would involve associating requests with responses, 
-    // perhaps using a map or storing context when send_data_to_python_async is called.
-    uint32_t response_group_id = 999; // Placeholder group ID
-    uint32_t response_target_id = 1;   // Placeholder target ID
-    
-    BPG::AppPacketGroup response_group;
-    BPG::AppPacket resp_packet = create_string_packet(response_group_id, response_target_id, "PR", ""); // "PR" = Python Response
-    
-    // Check if data length exceeds capacity (shouldn't if SHM sizes match)
-    if (length > resp_packet.content->internal_binary_bytes.max_size()) {
-         std::cerr << "[SamplePlugin PythonCallback] Error: Received data length (" << length 
-                   << ") exceeds BPG packet binary buffer capacity." << std::endl;
-         // Optionally send an error status back to JS?
-         return;
+// Requests to Python carry the BPG group/target they came from as their tag
+static uint64_t make_python_request_tag(uint32_t group_id, uint32_t target_id) {
+    return (static_cast<uint64_t>(group_id) << 32) | target_id;
+}
+
+// Quotes arbitrary text (e.g. a Python exception message) as a JSON string
+static std::string json_string(const char* text, size_t length) {
+    std::string out = "\"";
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
     }
+    out += '"';
+    return out;
+}
+
+// Callback for responses FROM Python via the listener thread
+static void handle_python_data(const AcceptorResponse& response) {
+    const uint8_t* data = response.data;
+    size_t length = response.length;
+    // Answer the group/target of the TX packet this request came from
+    uint32_t response_group_id = static_cast<uint32_t>(response.tag >> 32);
+    uint32_t response_target_id = static_cast<uint32_t>(response.tag);
+    std::cout << "[SamplePlugin PythonCallback] Received " << length << " bytes for request " << response.request_id
+              << " from worker " << response.worker << " (Group " << response_group_id << ", " << response.round_trip_us << " us)." << std::endl;
     
-    // Copy data into the BPG packet
-    resp_packet.content->internal_binary_bytes.assign(data, data + length); 
-    
-    response_group.push_back(resp_packet);
-    response_group.back().is_end_of_group = true;
-    
-    // Send the response group using the buffer callbacks
+    // Send the response packet using the buffer callbacks
     uint8_t* buffer = nullptr;
     uint32_t buffer_size = 0;
-    // Use a reasonable buffer size estimate
-    size_t estimated_size = BPG::BPG_HEADER_SIZE + resp_packet.content->calculateEncodedSize(); 
 
     // Request buffer - Ensure callbacks are valid
     if (g_buffer_request_callback && g_buffer_send_callback) {
-        if (g_buffer_request_callback(estimated_size, &buffer, &buffer_size) == 0 && buffer != nullptr) {
+        if (g_buffer_request_callback(1000, &buffer, &buffer_size) == 0 && buffer != nullptr) {
+            // "PR" = Python Response; the payload is copied once, straight into the send buffer.
+            // A failed request (e.g. the Python process died) is answered with the reason as metadata.
+            std::string error_meta;
+            if (response.status != IPC_STATUS_OK) {
+                error_meta = "{\"error\":" + json_string(reinterpret_cast<const char*>(data), length) + "}";
+                data = nullptr;
+                length = 0;
+            }
             BPG::BufferWriter stream_writer(buffer, buffer_size);
-            BPG::BpgError encode_err = response_group[0].encode(stream_writer);
+            BPG::BpgError encode_err = BPG::AppPacket::s_encode(
+                response_group_id, response_target_id, "PR", BPG::BPG_PROP_EG_BIT_MASK,
+                static_cast<uint32_t>(error_meta.size()), error_meta.c_str(),
+                static_cast<uint32_t>(length), data,
+                stream_writer);
             if (encode_err == BPG::BpgError::Success) {
                 g_buffer_send_callback(stream_writer.size());
                 std::cout << "   Sent Python result back via BPG (Group " << response_group_id << ")." << std::endl;
@@ -151,61 +209,61 @@ static void handle_python_data(const uint8_t* data, size_t length) {
             }
         } else {
              std::cerr << "   Failed to get buffer for sending Python result." << std::endl;
-             g_buffer_send_callback(0); // Indicate error
         }
     } else {
          std::cerr << "[SamplePlugin PythonCallback] Error: Buffer callbacks not available!" << std::endl;
     }
 }
 
-// Example function to handle a fully decoded application packet
-static void handle_decoded_packet(const BPG::AppPacket& packet) {
+// Example function to handle a fully decoded application packet.
+// The view points into the host's shared buffer and is only valid during this call.
+static void handle_decoded_packet(const BPG::AppPacketView& packet) {
     std::cout << "[SamplePlugin BPG] Decoded Packet - Group: " << packet.group_id
               << ", Target: " << packet.target_id
               << ", Type: " << std::string(packet.tl, 2) << std::endl;
 
-    if (!packet.content) {
-        std::cout << "    Content: <null>" << std::endl;
-        return; 
+    const BPG::HybridDataView& content = packet.content;
+    BPG::ImageMeta image_meta;
+    if (content.imageMeta(image_meta)) {
+        std::cout << "    Meta: image " << image_meta.width << "x" << image_meta.height
+                  << ", " << image_meta.channels << " channels (binary)" << std::endl;
+    } else {
+        std::cout << "    Meta: " << (content.metadata_is_binary ? std::string_view("<binary>")
+                                : content.metadata.empty() ? std::string_view("<empty>") : content.metadata) << std::endl;
     }
-    
-    std::cout << "    Meta: " << (packet.content->metadata_str.empty() ? "<empty>" : packet.content->metadata_str) << std::endl;
-    std::cout << "    Binary Size: " << packet.content->calculateEncodedSize() - sizeof(uint32_t) - packet.content->metadata_str.length() << std::endl; // Approx binary size
+    std::cout << "    Binary Size: " << content.binary.size << std::endl;
 
     // Print binary content hex preview (up to 64 bytes)
-    if (!packet.content->internal_binary_bytes.empty()) {
+    if (!content.binary.empty()) {
         std::cout << "    Binary Hex: ";
-        size_t print_len = std::min(packet.content->internal_binary_bytes.size(), (size_t)64);
+        size_t print_len = std::min(content.binary.size, (size_t)64);
         for (size_t i = 0; i < print_len; ++i) {
-            std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(packet.content->internal_binary_bytes[i]) << " ";
+            std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(content.binary.data[i]) << " ";
         }
-        if (packet.content->internal_binary_bytes.size() > 64) {
+        if (content.binary.size > 64) {
             std::cout << "...";
         }
         std::cout << std::dec << std::endl; // Reset stream to decimal
     }
 
     // --- Process TX packet via Python IPC (Now Asynchronous) ---
-    if (strncmp(packet.tl, "TX", 2) == 0 && packet.content && !packet.content->internal_binary_bytes.empty()) {
+    if (strncmp(packet.tl, "TX", 2) == 0 && !content.binary.empty() && content.binary.data == g_tx_request.data) {
+        // Already in the ring; forward_tx_request() publishes it after this call
+        std::cout << "    -> TX packet content decoded straight into a Python IPC request." << std::endl;
+    } else if (strncmp(packet.tl, "TX", 2) == 0 && !content.binary.empty()) {
         std::cout << "    -> Forwarding TX packet content to Python IPC (Async)..." << std::endl;
         
-        // Send data asynchronously. The response will arrive via handle_python_data callback.
-        bool send_success = send_data_to_acceptor_async(
-            packet.content->internal_binary_bytes.data(),
-            packet.content->internal_binary_bytes.size()
-        );
+        // Send data asynchronously. The response will arrive via handle_python_data callback,
+        // tagged with this packet's group/target; several requests may be in flight.
+        uint32_t request_id = send_request_to_acceptor(content.binary.data, content.binary.size,
+                                                       make_python_request_tag(packet.group_id, packet.target_id));
 
-        if (!send_success) {
+        if (request_id == 0) {
             std::cerr << "    <- Error sending data to Python IPC via send_data_to_python_async." << std::endl;
             // Optionally send an immediate error back via BPG or log it
         } else {
-             std::cout << "    <- Data sent to Python asynchronously." << std::endl;
+             std::cout << "    <- Data sent to Python asynchronously (request " << request_id << ")." << std::endl;
         }
-        // --- Remove the old synchronous result handling block ---
-        // std::vector<uint8_t> python_result;
-        // int ipc_ret = process_data_with_python_sync(...);
-        // if (ipc_ret == 0) { ... } else { ... }
-        // -----------------------------------------------------
     }
     // -----------------------------------------
 
@@ -214,6 +272,26 @@ static void handle_decoded_packet(const BPG::AppPacket& packet) {
     }
 }
 
+// Forwarder for TX binaries: the decoder copies them into g_tx_request
+static uint8_t* reserve_tx_request(const BPG::AppPacketView&, size_t size) {
+    // Declining delivers the packet as usual (send_request_to_acceptor)
+    return reserve_acceptor_request(size, &g_tx_request) ? g_tx_request.data : nullptr;
+}
+
+static void forward_tx_request(const BPG::AppPacketView& packet, bool complete) {
+    if (!complete) {
+        abort_acceptor_request(&g_tx_request);
+        return;
+    }
+    uint32_t request_id = commit_acceptor_request(&g_tx_request, packet.content.binary.size,
+                                                  make_python_request_tag(packet.group_id, packet.target_id));
+    if (request_id == 0) {
+        std::cerr << "    <- Error committing the TX request to Python IPC." << std::endl;
+    } else {
+        std::cout << "    <- Data sent to Python asynchronously (request " << request_id << ")." << std::endl;
+    }
+}
+
 
 BPG::AppPacket create_image_packet(uint32_t group_id, uint32_t target_id, const cv::Mat& img, std::string img_format="") {
     BPG::AppPacket img_packet;
@@ -225,16 +303,19 @@ BPG::AppPacket create_image_packet(uint32_t group_id, uint32_t target_id, const
     // Create the derived object using make_shared
     auto img_hybrid_data_ptr = std::make_shared<HybridData_cvMat>(img, img_format);
     
-    // Set metadata on the object via the pointer
-    img_hybrid_data_ptr->metadata_str = 
-        "{\"width\":"+std::to_string(img.cols)+
-        ",\"height\":"+std::to_string(img.rows)+
-        ",\"channels\":"+std::to_string(img.channels())+
-        ",\"type\":"+std::to_string(img.type())+
-        ",\"format\":\""+img_format+"\"}";
-    
-
-    printf("metadata_str: %s\n",img_hybrid_data_ptr->metadata_str.c_str());
+    // Binary metadata block instead of a JSON string (see BPG.md, Binary Metadata)
+    BPG::ImageMeta meta;
+    meta.width = static_cast<uint32_t>(img.cols);
+    meta.height = static_cast<uint32_t>(img.rows);
+    meta.channels = static_cast<uint16_t>(img.channels());
+    meta.type = static_cast<uint16_t>(img.type());
+    meta.format = img_format == "raw" ? BPG::ImageFormat::Raw
+                : img_format == "raw_rgba" ? BPG::ImageFormat::RawRgba
+                : BPG::ImageFormat::Unspecified;
+    img_hybrid_data_ptr->setImageMeta(meta);
+
+    printf("image meta: %ux%u, %u channels, type %u, format %s\n",
+           meta.width, meta.height, meta.channels, meta.type, img_format.c_str());
     // Assign the shared_ptr to content
     img_packet.content = img_hybrid_data_ptr;
     return img_packet;
@@ -299,51 +380,27 @@ static bool send_acknowledgement_group(uint32_t group_id, uint32_t target_id) {
     //set last packet as end of group
     group_to_send.back().is_end_of_group = true;
 
-    // --- Calculate Size and Create Buffer/Writer ---
-    size_t total_estimated_size = 0;
-    for(const auto& packet : group_to_send) {
-        if (packet.content) { 
-            // printf("packet.content->calculateEncodedSize(): %zu\n",packet.content->calculateEncodedSize());
-            total_estimated_size += BPG::BPG_HEADER_SIZE + packet.content->calculateEncodedSize();
-        } else {
-            total_estimated_size += BPG::BPG_HEADER_SIZE; 
-        }
-    }
-
     // --- Request Buffer ---
     uint8_t* buffer = nullptr;
     uint32_t buffer_size = 0;
-    g_buffer_request_callback(1000,&buffer, &buffer_size);
+    if (g_buffer_request_callback(1000, &buffer, &buffer_size) != 0 || buffer == nullptr) {
+        std::cerr << "[SamplePlugin BPG] Error: no send buffer available for ACK group." << std::endl;
+        return false;
+    }
 
+    // --- Encode the Group straight into the leased buffer (single pass) ---
     BPG::BufferWriter stream_writer(buffer, buffer_size);
-
-
-
-    // --- Encode the Group into the Writer ---
-    // write packets back to back
-    bool success = true;
-    for (const auto& packet : group_to_send) { 
-        uint8_t* buffer_ptr = stream_writer.raw_data()+stream_writer.currentPosition();
-        memset(buffer_ptr,0,200);
-        printf("encoding packet: %s, group_id: %d\n",std::string(packet.tl, 2).c_str(),packet.group_id);
-        BPG::BpgError encode_err = packet.encode(stream_writer);
-
-
-        if (encode_err != BPG::BpgError::Success) {
-            std::cerr << "[SamplePlugin BPG] Error encoding ACK packet: " << static_cast<int>(encode_err) << std::endl;
-            success = false;
-            break; // Exit loop on error
-        }
-    }
+    BPG::BpgError encode_err = BPG::encodeGroup(group_to_send, stream_writer);
+    bool success = (encode_err == BPG::BpgError::Success);
 
     // --- Send the Entire Buffer ---
     if (success) {
          std::cout << "  Sending ACK Group (ID: " << group_id << "), Total Size: " << stream_writer.size() << std::endl;
-        //  g_send_message(stream_writer.data(), stream_writer.size());
         g_buffer_send_callback(stream_writer.size());
     }
     else
     {
+        std::cerr << "[SamplePlugin BPG] Error encoding ACK group: " << static_cast<int>(encode_err) << std::endl;
         g_buffer_send_callback(0);
     }
 
@@ -351,24 +408,22 @@ static bool send_acknowledgement_group(uint32_t group_id, uint32_t target_id) {
 }
 
 // Example function to handle a completed packet group
-static void handle_decoded_group(uint32_t group_id, BPG::AppPacketGroup&& group) {
+static void handle_decoded_group(uint32_t group_id, const BPG::AppPacketView* packets, size_t count) {
      std::cout << "[SamplePlugin BPG] Decoded COMPLETE Group - ID: " << group_id 
-               << ", Packet Count: " << group.size() << std::endl;
+               << ", Packet Count: " << count << std::endl;
     
     // --- TODO: Add application logic for the complete group --- 
-    for(const auto& packet : group) {
+    for (size_t i = 0; i < count; i++) {
+         const BPG::AppPacketView& packet = packets[i];
          std::cout << "    - Packet Type in Group: " << std::string(packet.tl, 2) << std::endl;
-         if (packet.content) {
-             std::cout << "      Meta: " << (packet.content->metadata_str.empty() ? "<empty>" : packet.content->metadata_str) << std::endl;
-             std::cout << "      Binary Size: " << packet.content->calculateEncodedSize() - sizeof(uint32_t) - packet.content->metadata_str.length() << std::endl; // Approx binary size
-         } else {
-             std::cout << "      Content: <null>" << std::endl;
-         }
+         std::cout << "      Meta: " << (packet.content.metadata_is_binary ? std::string_view("<binary>")
+                                  : packet.content.metadata.empty() ? std::string_view("<empty>") : packet.content.metadata) << std::endl;
+         std::cout << "      Binary Size: " << packet.content.binary.size << std::endl;
     }
 
     // --- Echo Back Logic --- 
-    if (!group.empty()) {
-        uint32_t original_target_id = group[0].target_id; // Assuming target_id is same for the group
+    if (count > 0) {
+        uint32_t original_target_id = packets[0].target_id; // Assuming target_id is same for the group
         uint32_t response_target_id = original_target_id;
         send_acknowledgement_group(group_id, response_target_id); // Send ACK back
     } else {
@@ -391,6 +446,11 @@ static PluginStatus initialize(MessageCallback send_message,
     g_buffer_request_callback = buffer_request_callback;
     g_buffer_send_callback = buffer_send_callback;
     g_bpg_decoder.reset(); // Reset decoder state on initialization
+
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores > 1 && !g_tile_pool) {
+        g_tile_pool = std::make_unique<TilePool>(cores - 1);
+    }
     
     printf("Sample Plugin Initializing...\n");
 
@@ -402,10 +462,15 @@ static PluginStatus initialize(MessageCallback send_message,
     
     // Initialize Python IPC Channel (Bidirectional)
     // Pass the handle_python_data callback
-    if (!init_acceptor_ipc_bidirectional(python_executable, script_path, handle_python_data)) {
+    AcceptorIpcOptions ipc_options;
+    ipc_options.c2a_ring_size = PYTHON_REQUEST_RING_BYTES;
+    ipc_options.a2c_ring_size = PYTHON_RESPONSE_RING_BYTES;
+    ipc_options.workers = PYTHON_WORKERS;
+    if (!init_acceptor_ipc_bidirectional(python_executable, script_path, handle_python_data, ipc_options)) {
         std::cerr << "FATAL: Failed to initialize Bi-directional Python IPC channel." << std::endl;
         return PLUGIN_ERROR_INITIALIZATION; // Use appropriate error code
     }
+    g_bpg_decoder.setPayloadForwarder("TX", {reserve_tx_request, forward_tx_request});
     
     std::cout << "Sample Plugin Initialized Successfully (with Bi-directional Python IPC)." << std::endl;
     return PLUGIN_SUCCESS;
@@ -414,8 +479,11 @@ static PluginStatus initialize(MessageCallback send_message,
 static void shutdown() {
     std::cout << "Sample plugin shutting down..." << std::endl;
     
+    // Drop a TX request still being decoded before its ring goes away
+    g_bpg_decoder.clearPayloadForwarder();
     // Shutdown Bi-directional Python IPC Channel
     shutdown_acceptor_ipc_bidirectional();
+    g_tile_pool.reset();
     
     // Reset callbacks
     g_send_message = nullptr;
@@ -428,7 +496,7 @@ static void shutdown() {
 static void process_message(const uint8_t* data, size_t length) {
     std::cout << "Sample plugin received raw data length: " << length << std::endl;
     
-    // Feed data into the BPG decoder
+    // Feed data into the BPG decoder (zero-copy views into the host buffer)
     BPG::BpgError decode_err = g_bpg_decoder.processData(
         data, 
         length, 
@@ -444,8 +512,12 @@ static void process_message(const uint8_t* data, size_t length) {
 }
 
 static void update() {
-    // Called periodically by the host
-    // Could potentially check for timeouts on incomplete BPG groups here if needed
+    // Called every updateIntervalMs, never at the same time as process_message()
+    size_t expired = g_bpg_decoder.expireStaleGroups(GROUP_TIMEOUT);
+    if (expired > 0) {
+        std::cerr << "[SamplePlugin BPG] Dropped " << expired << " unfinished group(s) after "
+                  << GROUP_TIMEOUT.count() << " ms" << std::endl;
+    }
 }
 
 // Plugin interface instance
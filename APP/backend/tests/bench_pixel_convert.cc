@@ -0,0 +1,106 @@
+// Microbenchmark for pixel_convert: checks every kernel set against the
+// scalar path, then reports throughput (GB/s of RGBA/8-bit output) on a 4K
+// frame for each kernel set the CPU supports.
+//
+// Usage: bench_pixel_convert [width height]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "../pixel_convert.h"
+
+using PixelConvert::Isa;
+
+struct Case {
+    const char* name;
+    size_t src_bytes_per_pixel;
+    size_t dst_bytes_per_pixel;
+    void (*run)(const uint8_t* src, uint8_t* dst, size_t pixels);
+};
+
+static void run_gray16(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    PixelConvert::gray16_to_rgba(reinterpret_cast<const uint16_t*>(src), dst, pixels, 4095);
+}
+static void run_u16(const uint8_t* src, uint8_t* dst, size_t pixels) {
+    PixelConvert::u16_to_u8(reinterpret_cast<const uint16_t*>(src), dst, pixels, 4095);
+}
+
+static const Case CASES[] = {
+    {"gray->rgba", 1, 4, PixelConvert::gray_to_rgba},
+    {"rgb->rgba", 3, 4, PixelConvert::rgb_to_rgba},
+    {"bgr->rgba", 3, 4, PixelConvert::bgr_to_rgba},
+    {"u16->u8", 2, 1, run_u16},
+    {"gray16->rgba", 2, 4, run_gray16},
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Compares a kernel set with the scalar path on odd sizes (tails included)
+static bool verify(Isa isa) {
+    std::mt19937 rng(7);
+    for (const Case& c : CASES) {
+        for (size_t pixels : {0, 1, 15, 16, 17, 31, 33, 100, 1000, 4099}) {
+            std::vector<uint8_t> src(pixels * c.src_bytes_per_pixel + 1);
+            for (auto& b : src) b = static_cast<uint8_t>(rng());
+            std::vector<uint8_t> expected(pixels * c.dst_bytes_per_pixel + 1, 0xEE);
+            std::vector<uint8_t> actual(expected.size(), 0xEE);
+            PixelConvert::set_isa(Isa::Scalar);
+            c.run(src.data(), expected.data(), pixels);
+            PixelConvert::set_isa(isa);
+            c.run(src.data(), actual.data(), pixels);
+            if (expected != actual) {
+                printf("MISMATCH: %s with %s at %zu pixels\n", c.name, PixelConvert::isa_name(isa), pixels);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t width = argc > 2 ? std::strtoul(argv[1], nullptr, 10) : 3840;
+    size_t height = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2160;
+    size_t pixels = width * height;
+    const int rounds = 20;
+
+    std::vector<Isa> isas;
+    for (Isa isa : {Isa::Scalar, Isa::SSSE3, Isa::AVX2, Isa::NEON}) {
+        if (PixelConvert::set_isa(isa)) isas.push_back(isa);
+    }
+    printf("Detected kernel set: %s\n", PixelConvert::isa_name(PixelConvert::detect_isa()));
+
+    for (Isa isa : isas) {
+        if (!verify(isa)) return 1;
+    }
+
+    std::vector<uint8_t> src(pixels * 3);
+    std::vector<uint8_t> dst(pixels * 4);
+    for (size_t i = 0; i < src.size(); i++) src[i] = static_cast<uint8_t>(i * 7);
+
+    printf("%zux%zu frame, %d rounds, GB/s of output\n", width, height, rounds);
+    printf("%-14s", "");
+    for (Isa isa : isas) printf("%10s", PixelConvert::isa_name(isa));
+    printf("%10s\n", "speedup");
+
+    for (const Case& c : CASES) {
+        printf("%-14s", c.name);
+        double scalar_gbps = 0, best_gbps = 0;
+        for (Isa isa : isas) {
+            PixelConvert::set_isa(isa);
+            c.run(src.data(), dst.data(), pixels); // warm up
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < rounds; r++) c.run(src.data(), dst.data(), pixels);
+            double gbps = static_cast<double>(pixels * c.dst_bytes_per_pixel) * rounds / seconds_since(start) / 1e9;
+            if (isa == Isa::Scalar) scalar_gbps = gbps;
+            if (gbps > best_gbps) best_gbps = gbps;
+            printf("%10.2f", gbps);
+        }
+        printf("%9.1fx\n", scalar_gbps > 0 ? best_gbps / scalar_gbps : 0.0);
+    }
+    return 0;
+}
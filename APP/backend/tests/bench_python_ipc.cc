@@ -0,0 +1,193 @@
+// Python IPC channel benchmark against tests/python_ipc_stub_acceptor.py,
+// which echoes every request back under its request_id:
+//  - round-trip latency of one request at a time
+//  - throughput with 1..32 requests in flight (pipeline depth)
+//  - cold start (launch -> READY -> first response) and the supervisor's
+//    restart after the Acceptor is killed
+//  - throughput of 1, 2, 4.. workers when every request costs the Acceptor
+//    WORK_US of CPU (IPC_STUB_WORK_US); it only scales with free cores
+// Every response is checked against the request it answers. Both rings are
+// sized to hold a few payloads, so multi-MB requests go through unsplit.
+// Run from the repository root (the channel launches the Acceptor from
+// APP/backend/).
+//
+// Usage: bench_python_ipc [python [requests [payload_bytes [huge [max_workers]]]]]
+//   huge: 1 = ask for huge pages on the rings
+//   max_workers: largest pool in the worker scaling run (default 4)
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include "../python_ipc.h"
+
+static std::mutex reply_mutex;
+static std::condition_variable reply_cv;
+static size_t replies = 0;
+static size_t mismatches = 0;
+static std::vector<double> rtt_us;
+static const unsigned WORK_US = 1000;
+
+static void on_response(const AcceptorResponse& response) {
+    uint64_t index = 0;
+    if (response.length >= sizeof(index)) memcpy(&index, response.data, sizeof(index));
+    std::lock_guard<std::mutex> lock(reply_mutex);
+    if (response.status != IPC_STATUS_OK || index != response.tag) mismatches++;
+    rtt_us.push_back(static_cast<double>(response.round_trip_us));
+    replies++;
+    reply_cv.notify_all();
+}
+
+static size_t completed() {
+    std::lock_guard<std::mutex> lock(reply_mutex);
+    return replies;
+}
+
+// Sends `count` requests keeping at most `depth` in flight; returns seconds
+static double run(size_t count, size_t depth, std::vector<uint8_t>& message) {
+    size_t base = completed();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        {
+            std::unique_lock<std::mutex> lock(reply_mutex);
+            if (!reply_cv.wait_for(lock, std::chrono::seconds(5), [&] { return i - (replies - base) < depth; })) {
+                fprintf(stderr, "timed out waiting for responses\n");
+                return -1;
+            }
+        }
+        // The tag is the request index; the echoed payload starts with it too
+        memcpy(message.data(), &i, sizeof(i));
+        if (send_request_to_acceptor(message.data(), message.size(), i) == 0) {
+            fprintf(stderr, "send failed\n");
+            return -1;
+        }
+    }
+    std::unique_lock<std::mutex> lock(reply_mutex);
+    if (!reply_cv.wait_for(lock, std::chrono::seconds(5), [&] { return replies - base == count; })) return -1;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::string python = argc > 1 ? argv[1] : "python3";
+    size_t requests = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    size_t payload = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+    payload = std::max(payload, sizeof(size_t));
+    AcceptorIpcOptions options;
+    options.c2a_ring_size = std::max(options.c2a_ring_size, 4 * (payload + sizeof(IpcRecordHeader)));
+    options.a2c_ring_size = std::max(options.a2c_ring_size, 4 * (payload + sizeof(IpcRecordHeader)));
+    options.huge_pages = argc > 4 && std::atoi(argv[4]) != 0;
+    size_t max_workers = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 4;
+
+    // The channel logs setup and errors; keep that out of the output
+    std::ostringstream sink;
+    std::streambuf* stdout_buf = std::cout.rdbuf(sink.rdbuf());
+
+    bool ok = init_acceptor_ipc_bidirectional(python, "tests/python_ipc_stub_acceptor.py", on_response, options);
+    if (!ok || payload > max_acceptor_request_size()) {
+        std::cout.rdbuf(stdout_buf);
+        fprintf(stderr, "failed to start the IPC channel (or payload over %zu bytes)\n", max_acceptor_request_size());
+        return 1;
+    }
+
+    std::vector<uint8_t> message(payload, 0x5A);
+    run(std::min<size_t>(requests / 10, 100), 1, message); // warm up
+    {
+        std::lock_guard<std::mutex> lock(reply_mutex);
+        rtt_us.clear();
+    }
+
+    std::cout.rdbuf(stdout_buf);
+    AcceptorIpcStats layout = get_acceptor_ipc_stats();
+    printf("%zu requests of %zu bytes per depth via %s (segment %zu bytes%s)\n", requests, payload,
+           python.c_str(), layout.segment_size, layout.huge_pages ? ", huge pages" : "");
+    bool failed = false;
+    for (size_t depth = 1; depth <= 32; depth *= 2) {
+        std::cout.rdbuf(sink.rdbuf());
+        double seconds = run(requests, depth, message);
+        std::cout.rdbuf(stdout_buf);
+        if (seconds < 0) { failed = true; break; }
+        std::vector<double> sorted;
+        {
+            std::lock_guard<std::mutex> lock(reply_mutex);
+            sorted.swap(rtt_us);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        printf("  depth %2zu: %9.0f req/s  round trip p50 %7.1f us  p99 %7.1f us\n",
+               depth, requests / seconds, sorted[sorted.size() / 2],
+               sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)]);
+    }
+
+    // Supervisor: kill the Acceptor, wait for its replacement to answer
+    AcceptorIpcStats before = get_acceptor_ipc_stats();
+    printf("cold start: READY after %.1f ms, first response after %.1f ms\n",
+           before.ready_us / 1000.0, before.first_response_us / 1000.0);
+    if (!failed) {
+        auto killed = std::chrono::steady_clock::now();
+        kill(before.acceptor_pid, SIGKILL);
+        AcceptorIpcStats after;
+        do {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            after = get_acceptor_ipc_stats();
+        } while ((after.restarts == before.restarts || after.ready_us == 0) &&
+                 std::chrono::steady_clock::now() - killed < std::chrono::seconds(10));
+        std::cout.rdbuf(sink.rdbuf());
+        bool answered = after.restarts > before.restarts && run(10, 1, message) >= 0;
+        std::cout.rdbuf(stdout_buf);
+        double back_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - killed).count();
+        if (answered) {
+            printf("restart after SIGKILL: pid %d -> %d, READY %.1f ms after launch, answering %.1f ms after the kill\n",
+                   before.acceptor_pid, after.acceptor_pid, after.ready_us / 1000.0, back_ms);
+        } else {
+            printf("restart after SIGKILL failed\n");
+            failed = true;
+        }
+    }
+
+    std::cout.rdbuf(sink.rdbuf());
+    AcceptorIpcStats stats = get_acceptor_ipc_stats();
+    shutdown_acceptor_ipc_bidirectional();
+    std::cout.rdbuf(stdout_buf);
+    printf("responses %llu, unmatched %llu, mismatched %zu, ring-full waits %llu\n",
+           static_cast<unsigned long long>(stats.responses), static_cast<unsigned long long>(stats.unmatched),
+           mismatches, static_cast<unsigned long long>(stats.ring_full_waits));
+    failed = failed || mismatches || stats.unmatched;
+
+    // Workers: the same CPU-bound load on growing pools, 4 requests in flight per worker
+    size_t work_requests = std::max<size_t>(requests / 10, 50);
+    printf("%zu requests costing %u us of Acceptor CPU each, %u cores online\n",
+           work_requests, WORK_US, std::thread::hardware_concurrency());
+    setenv("IPC_STUB_WORK_US", std::to_string(WORK_US).c_str(), 1);
+    double base_rate = 0;
+    for (size_t workers = 1; workers <= max_workers && !failed; workers *= 2) {
+        options.workers = workers;
+        std::cout.rdbuf(sink.rdbuf());
+        bool started = init_acceptor_ipc_bidirectional(python, "tests/python_ipc_stub_acceptor.py", on_response, options);
+        double seconds = started ? run(work_requests, 4 * workers, message) : -1;
+        std::ostringstream shares;
+        for (size_t i = 0; i < acceptor_worker_count(); i++) {
+            shares << (i ? "/" : "") << get_acceptor_worker_stats(i).responses;
+        }
+        stats = get_acceptor_ipc_stats();
+        if (started) shutdown_acceptor_ipc_bidirectional();
+        std::cout.rdbuf(stdout_buf);
+        if (seconds < 0) {
+            printf("  %zu workers: failed\n", workers);
+            failed = true;
+            break;
+        }
+        double rate = work_requests / seconds;
+        if (workers == 1) base_rate = rate;
+        printf("  %zu workers: %7.0f req/s  %.2fx  (responses per worker %s)\n",
+               workers, rate, rate / base_rate, shares.str().c_str());
+        failed = failed || mismatches || stats.unmatched;
+    }
+    unsetenv("IPC_STUB_WORK_US");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+// Scaling benchmark for tiled image encoding: converts an 8K 3-channel frame
+// into RGBA with TilePool at 1..N threads, the same way HybridData_cvMat
+// encodes large raw_rgba payloads, and checks every run against the serial
+// output.
+//
+// Usage: bench_tiled_encode [max_threads [width height]]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../pixel_convert.h"
+#include "../tile_pool.h"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : hw;
+    size_t width = argc > 3 ? std::strtoul(argv[2], nullptr, 10) : 7680;
+    size_t height = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4320;
+    const size_t tile_bytes = 256 * 1024; // same as TILED_ENCODE_TILE_BYTES
+    const int rounds = 10;
+
+    std::vector<uint8_t> src(width * height * 3);
+    std::mt19937 rng(3);
+    for (auto& b : src) b = static_cast<uint8_t>(rng());
+
+    std::vector<uint8_t> expected(width * height * 4);
+    PixelConvert::rgb_to_rgba(src.data(), expected.data(), width * height);
+
+    size_t row_bytes = width * 4;
+    size_t rows_per_tile = std::max<size_t>(1, tile_bytes / row_bytes);
+    size_t tiles = (height + rows_per_tile - 1) / rows_per_tile;
+    printf("%zux%zu rgb->rgba, %zu tiles of %zu rows, kernel set %s, %zu hardware threads\n",
+           width, height, tiles, rows_per_tile, PixelConvert::isa_name(PixelConvert::active_isa()), hw);
+
+    std::vector<uint8_t> dst(expected.size());
+    double base_seconds = 0;
+    for (size_t threads = 1; threads <= max_threads; threads++) {
+        TilePool pool(threads - 1);
+        auto encode = [&](size_t tile) {
+            size_t row_begin = tile * rows_per_tile;
+            size_t row_end = std::min(height, row_begin + rows_per_tile);
+            PixelConvert::rgb_to_rgba(src.data() + row_begin * width * 3, dst.data() + row_begin * row_bytes,
+                                      (row_end - row_begin) * width);
+        };
+
+        std::memset(dst.data(), 0, dst.size());
+        pool.run(tiles, encode);
+        if (dst != expected) {
+            printf("MISMATCH at %zu threads\n", threads);
+            return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) pool.run(tiles, encode);
+        double seconds = seconds_since(start) / rounds;
+        if (threads == 1) base_seconds = seconds;
+        printf("  %2zu threads: %7.2f ms  %6.2f GB/s  speedup %.2fx  steals %llu\n",
+               threads, seconds * 1e3, dst.size() / seconds / 1e9, base_seconds / seconds,
+               static_cast<unsigned long long>(pool.steals()));
+    }
+    return 0;
+}
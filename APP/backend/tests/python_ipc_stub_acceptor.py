@@ -0,0 +1,81 @@
+# Minimal Acceptor for bench_python_ipc: echoes every request back as the
+# response with the same request_id. Speaks the same SHM ring + doorbell
+# protocol as python_bidirectional_ipc_script.py without its numpy/OpenCV
+# dependencies or per-message logging. IPC_STUB_WORK_US=<n> makes it spin for
+# n microseconds per request, standing in for CPU-bound Python work.
+#
+# Usage: python tests/python_ipc_stub_acceptor.py <shm_name> [<doorbell_rx_fd> <doorbell_tx_fd>]
+import ctypes
+import mmap
+import os
+import select
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+from python_ipc_ring import open_segment, RECORD_HEADER, IPC_STATUS_OK, SHM_ACCEPTOR_READY
+
+POLL_FALLBACK_S = 0.005
+WORK_S = int(os.environ.get("IPC_STUB_WORK_US", "0")) / 1e6
+
+def main():
+    shm_name = sys.argv[1]
+    rx_fd = int(sys.argv[2]) if len(sys.argv) == 4 else -1
+    tx_fd = int(sys.argv[3]) if len(sys.argv) == 4 else -1
+
+    libc = ctypes.CDLL(None, use_errno=True)
+    libc.shm_open.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_int]
+    fd = -1
+    for _ in range(50):
+        fd = libc.shm_open(shm_name.encode(), os.O_RDWR, 0o666)
+        if fd != -1:
+            break
+        time.sleep(0.01)
+    if fd == -1:
+        sys.exit(f"stub acceptor: cannot open {shm_name}")
+    shm = mmap.mmap(fd, os.fstat(fd).st_size, access=mmap.ACCESS_WRITE, flags=mmap.MAP_SHARED)
+    ctl, requests, responses = open_segment(shm)
+
+    def ring():
+        if tx_fd != -1:
+            try:
+                os.write(tx_fd, b"\x01")
+            except BlockingIOError:
+                pass
+
+    def wait():
+        if rx_fd == -1:
+            time.sleep(POLL_FALLBACK_S)
+            return True
+        if select.select([rx_fd], [], [], 0.5)[0]:
+            return bool(os.read(rx_fd, 64))  # EOF: Creator is gone
+        return True
+
+    ctl.acceptor_state = SHM_ACCEPTOR_READY
+    ring()
+    while True:
+        if ctl.c_to_a_command == 99:
+            ctl.c_to_a_command = 0
+            ring()
+            return
+        record = requests.peek()
+        if record is None:
+            if not wait():
+                return
+            continue
+        request_id, _ = RECORD_HEADER.unpack_from(record)
+        payload = bytes(record[RECORD_HEADER.size:])
+        record.release()
+        requests.release()
+        if WORK_S:
+            done = time.perf_counter() + WORK_S
+            while time.perf_counter() < done:
+                pass
+        while not responses.try_push((RECORD_HEADER.pack(request_id, IPC_STATUS_OK), payload)):
+            ring()
+            if not wait():
+                return
+        ring()
+
+if __name__ == "__main__":
+    main()
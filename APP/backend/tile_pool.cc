@@ -0,0 +1,114 @@
+#include "tile_pool.h"
+
+TilePool::TilePool(size_t workers) {
+    for (size_t i = 0; i <= workers; i++) {
+        lanes_.push_back(std::make_unique<Lane>());
+    }
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+        workers_.emplace_back(&TilePool::workerLoop, this, i);
+    }
+}
+
+TilePool::~TilePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void TilePool::run(size_t tiles, const std::function<void(size_t)>& fn) {
+    if (tiles == 0) return;
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+    // Contiguous blocks per lane keep neighbouring rows on one core
+    size_t lanes = lanes_.size();
+    for (size_t i = 0; i < lanes; i++) {
+        size_t begin = tiles * i / lanes;
+        size_t end = tiles * (i + 1) / lanes;
+        std::lock_guard<std::mutex> lock(lanes_[i]->mutex);
+        for (size_t tile = begin; tile < end; tile++) {
+            lanes_[i]->tiles.push_back(tile);
+        }
+    }
+    remaining_.store(tiles, std::memory_order_relaxed);
+
+    if (!workers_.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fn_ = &fn;
+            generation_++;
+        }
+        wake_cv_.notify_all();
+    }
+
+    work(lanes - 1, fn);
+
+    if (!workers_.empty()) {
+        // Also wait for workers to leave the job, so none of them can pick up
+        // a tile of the next run() with this run's fn
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] {
+            return remaining_.load(std::memory_order_acquire) == 0 && active_ == 0;
+        });
+        fn_ = nullptr;
+    }
+}
+
+void TilePool::workerLoop(size_t lane) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+        if (!fn_) continue; // woke up after that job already finished
+        const std::function<void(size_t)>* fn = fn_;
+        active_++;
+        lock.unlock();
+
+        work(lane, *fn);
+
+        lock.lock();
+        active_--;
+        if (active_ == 0) done_cv_.notify_all();
+    }
+}
+
+void TilePool::work(size_t lane, const std::function<void(size_t)>& fn) {
+    size_t tile;
+    while (popOwn(lane, &tile) || steal(lane, &tile)) {
+        fn(tile);
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1 && !workers_.empty()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_cv_.notify_all();
+        }
+    }
+}
+
+bool TilePool::popOwn(size_t lane, size_t* tile) {
+    Lane& own = *lanes_[lane];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.tiles.empty()) return false;
+    *tile = own.tiles.front();
+    own.tiles.pop_front();
+    return true;
+}
+
+bool TilePool::steal(size_t lane, size_t* tile) {
+    size_t lanes = lanes_.size();
+    for (size_t offset = 1; offset < lanes; offset++) {
+        Lane& victim = *lanes_[(lane + offset) % lanes];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tiles.empty()) continue;
+        *tile = victim.tiles.back();
+        victim.tiles.pop_back();
+        steals_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,67 @@
+#ifndef TILE_POOL_H
+#define TILE_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads for splitting one large job into tiles, e.g.
+// converting the rows of an 8K image into a claimed N->R buffer.
+//
+// run() hands each participant (the workers plus the calling thread) a
+// contiguous block of tile indices in its own lane. A participant works from
+// the front of its lane and, once it is empty, steals from the back of the
+// other lanes, so uneven tiles still finish together. run() returns after
+// every tile has been processed; one job runs at a time.
+class TilePool {
+public:
+    // `workers` extra threads; the caller of run() always participates too
+    explicit TilePool(size_t workers);
+    ~TilePool();
+
+    TilePool(const TilePool&) = delete;
+    TilePool& operator=(const TilePool&) = delete;
+
+    // Threads that take part in run() (workers + caller)
+    size_t concurrency() const { return workers_.size() + 1; }
+
+    // Calls fn(tile) for every tile in [0, tiles). fn must not call run().
+    void run(size_t tiles, const std::function<void(size_t)>& fn);
+
+    // Tiles that were executed by a participant other than their lane owner
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Lane {
+        std::mutex mutex;
+        std::deque<size_t> tiles;
+    };
+
+    void workerLoop(size_t lane);
+    void work(size_t lane, const std::function<void(size_t)>& fn);
+    bool popOwn(size_t lane, size_t* tile);
+    bool steal(size_t lane, size_t* tile);
+
+    std::vector<std::unique_ptr<Lane>> lanes_; // one per participant, caller last
+    std::vector<std::thread> workers_;
+
+    std::mutex run_mutex_;                      // serializes run()
+    std::mutex mutex_;                          // guards the fields below
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(size_t)>* fn_ = nullptr;
+    uint64_t generation_ = 0;
+    size_t active_ = 0;                         // workers currently inside a job
+    bool stop_ = false;
+
+    std::atomic<size_t> remaining_{0};
+    std::atomic<uint64_t> steals_{0};
+};
+
+#endif // TILE_POOL_H
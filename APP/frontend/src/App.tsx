@@ -2,7 +2,7 @@ import React, { useEffect, useState, useRef, useCallback } from 'react';
 import { SharedMemoryChannel } from './lib/SharedMemoryChannel';
 import { nativeAddon } from './lib/nativeAddon';
 // Import BPG Types needed for the App component
-import { AppPacket, AppPacketGroup } from './lib/BPG_Protocol';
+import { AppPacket, AppPacketGroup, bpgImageMeta } from './lib/BPG_Protocol';
 // Import the custom hook
 import { useBPGProtocol, BPGPacketDescriptor, UseBPGProtocolOptions } from './hooks/useBPGProtocol';
 import './App.css';
@@ -360,10 +360,13 @@ function App() {
              }
 
              // --- Handle "IM" packets ---
-             if (packet.tl === 'IM' && packet.content.metadata_str && packet.content.binary_bytes.length > 0) {
+             if (packet.tl === 'IM' && (packet.content.metadata_str || packet.content.metadata_bin) && packet.content.binary_bytes.length > 0) {
                  try {
-                     const metadata = JSON.parse(packet.content.metadata_str);
-                     if (metadata.format === 'raw_rgba' && metadata.width > 0 && metadata.height > 0) {
+                     // Binary ImageMeta block, or the JSON metadata of older senders
+                     const metadata = bpgImageMeta(packet.content);
+                     if (!metadata) {
+                          contentPreview += ` (IM packet without image metadata)`;
+                     } else if (metadata.format === 'raw_rgba' && metadata.width > 0 && metadata.height > 0) {
                          const width = metadata.width;
                          const height = metadata.height;
                          // Ensure binary data length matches expected RGBA size
@@ -9,6 +9,8 @@ export interface PacketHeader {
 export interface HybridData {
     metadata_str: string; 
     binary_bytes: Uint8Array;
+    /** Binary metadata block (prop bit {@link PROP_BIN_META_BIT_MASK}), e.g. from {@link bpgEncodeImageMeta}. Sent instead of metadata_str; set (with metadata_str "") when decoding such a packet. */
+    metadata_bin?: Uint8Array;
 }
 
 export interface AppPacket {
@@ -32,14 +34,18 @@ export const HEADER_SIZE = 18;
 export const WIRE_HEADER_SIZE = FRAME_PREFIX_SIZE + HEADER_SIZE;
 
 export const PROP_EG_BIT_MASK = 0x00000001;
+export const PROP_BIN_META_BIT_MASK = 0x00000002;
+export const PROP_COMPRESSED_BIT_MASK = 0x00000004;
+export const PROP_CODEC_SHIFT = 16;
 export const PROP_VERSION_SHIFT = 8;
 export const BPG_PROTOCOL_VERSION = 1;
 export const BPG_SUPPORTED_PROTOCOL_VERSION_MAX = 1;
 
 const STR_LENGTH_SIZE = 4;
 
-export function bpgMakeProp(isEndOfGroup: boolean, protocolVersion: number = BPG_PROTOCOL_VERSION): number {
-    return ((protocolVersion & 0xff) << PROP_VERSION_SHIFT) | (isEndOfGroup ? PROP_EG_BIT_MASK : 0);
+export function bpgMakeProp(isEndOfGroup: boolean, protocolVersion: number = BPG_PROTOCOL_VERSION, binaryMetadata: boolean = false): number {
+    return ((protocolVersion & 0xff) << PROP_VERSION_SHIFT) | (isEndOfGroup ? PROP_EG_BIT_MASK : 0) |
+        (binaryMetadata ? PROP_BIN_META_BIT_MASK : 0);
 }
 
 export function bpgEffectiveProtocolVersion(prop: number): number {
@@ -47,12 +53,140 @@ export function bpgEffectiveProtocolVersion(prop: number): number {
     return v === 0 ? 1 : v;
 }
 
+// --- Binary metadata ---
+// Fixed-layout blocks mirroring bpg_types.h. A block starts with its kind
+// byte; fields are Big Endian; bytes past the known fields are ignored.
+// Image: [kind 1][format 1][channels 2][type 2][width 4][height 4]
+
+export const META_KIND_IMAGE = 1;
+export const IMAGE_META_SIZE = 14;
+/** ImageMeta format codes, indexed like BPG::ImageFormat; the strings match the JSON "format". */
+export const IMAGE_META_FORMATS = ['', 'raw', 'raw_rgba'];
+
+export interface ImageMeta {
+    width: number;
+    height: number;
+    channels: number;
+    type: number;   // OpenCV type, e.g. CV_8UC4 = 24
+    format: string; // one of IMAGE_META_FORMATS
+}
+
+export function bpgEncodeImageMeta(meta: ImageMeta): Uint8Array {
+    const block = new Uint8Array(IMAGE_META_SIZE);
+    const dv = new DataView(block.buffer);
+    block[0] = META_KIND_IMAGE;
+    block[1] = Math.max(0, IMAGE_META_FORMATS.indexOf(meta.format));
+    dv.setUint16(2, meta.channels, false);
+    dv.setUint16(4, meta.type, false);
+    dv.setUint32(6, meta.width, false);
+    dv.setUint32(10, meta.height, false);
+    return block;
+}
+
+/**
+ * Image metadata of a packet: read from its binary block when it has one,
+ * otherwise parsed from a JSON metadata_str. Null if neither holds one.
+ */
+export function bpgImageMeta(content: HybridData): ImageMeta | null {
+    const block = content.metadata_bin;
+    if (block) {
+        if (block.length < IMAGE_META_SIZE || block[0] !== META_KIND_IMAGE) return null;
+        const dv = new DataView(block.buffer, block.byteOffset, block.byteLength);
+        return {
+            format: IMAGE_META_FORMATS[block[1]] ?? '',
+            channels: dv.getUint16(2, false),
+            type: dv.getUint16(4, false),
+            width: dv.getUint32(6, false),
+            height: dv.getUint32(10, false),
+        };
+    }
+    if (!content.metadata_str) return null;
+    try {
+        const json = JSON.parse(content.metadata_str);
+        if (typeof json !== 'object' || json === null || typeof json.width !== 'number') return null;
+        return { width: json.width, height: json.height, channels: json.channels, type: json.type, format: json.format ?? '' };
+    } catch {
+        return null;
+    }
+}
+
+// --- Payload compression ---
+// A packet with PROP_COMPRESSED_BIT_MASK carries its binary as
+// [raw_size 4 BE][codec stream], codec id in prop bits 16..23 (bpg_compress.h).
+// The decoder inflates it; binary_bytes always holds the raw bytes.
+
+export const CODEC_NONE = 0;
+export const CODEC_LZ4 = 1;
+
+export function bpgCodecFromProp(prop: number): number {
+    return (prop & PROP_COMPRESSED_BIT_MASK) ? (prop >>> PROP_CODEC_SHIFT) & 0xff : CODEC_NONE;
+}
+
+/** Decompresses one LZ4 block that must expand to exactly rawSize bytes; null if malformed. */
+export function bpgLz4Decompress(src: Uint8Array, rawSize: number): Uint8Array | null {
+    const out = new Uint8Array(rawSize);
+    let ip = 0;
+    let op = 0;
+    const readLength = (length: number): number => {
+        let byte: number;
+        do {
+            if (ip >= src.length) return -1;
+            byte = src[ip++];
+            length += byte;
+        } while (byte === 255);
+        return length;
+    };
+    while (ip < src.length) {
+        const token = src[ip++];
+        let literalLength = token >> 4;
+        if (literalLength === 15 && (literalLength = readLength(literalLength)) < 0) return null;
+        if (literalLength > src.length - ip || literalLength > rawSize - op) return null;
+        if (literalLength < 32) {
+            // Typed-array views cost more than the copy for short runs
+            for (let i = 0; i < literalLength; i++) out[op + i] = src[ip + i];
+        } else {
+            out.set(src.subarray(ip, ip + literalLength), op);
+        }
+        ip += literalLength;
+        op += literalLength;
+        if (ip === src.length) break; // the last sequence has no match
+
+        if (src.length - ip < 2) return null;
+        const offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        if (offset === 0 || offset > op) return null;
+        let matchLength = token & 15;
+        if (matchLength === 15 && (matchLength = readLength(matchLength)) < 0) return null;
+        matchLength += 4;
+        if (matchLength > rawSize - op) return null;
+        if (offset >= matchLength && matchLength >= 32) {
+            out.copyWithin(op, op - offset, op - offset + matchLength);
+        } else {
+            for (let i = 0; i < matchLength; i++) out[op + i] = out[op + i - offset];
+        }
+        op += matchLength;
+    }
+    return op === rawSize ? out : null;
+}
+
+function inflateBinary(codec: number, stored: Uint8Array): Uint8Array | null {
+    if (codec !== CODEC_LZ4 || stored.length < 4) return null;
+    const rawSize = new DataView(stored.buffer, stored.byteOffset, 4).getUint32(0, false);
+    const streamSize = stored.length - 4;
+    if (rawSize === 0 || rawSize > streamSize * 255 + 16) return null;
+    return bpgLz4Decompress(stored.subarray(4), rawSize);
+}
+
+function metadataBytes(data: HybridData): Uint8Array {
+    return data.metadata_bin ?? new TextEncoder().encode(data.metadata_str);
+}
+
 // --- Encoder --- 
 
 export class BpgEncoder {
 
     private calculateHybridDataSize(data: HybridData): number {
-        const strBytes = new TextEncoder().encode(data.metadata_str); 
+        const strBytes = metadataBytes(data);
         return STR_LENGTH_SIZE + strBytes.length + data.binary_bytes.length;
     }
 
@@ -77,7 +211,7 @@ export class BpgEncoder {
         packetBytes[offset++] = packet.tl.charCodeAt(1);
         
         const ver = packet.protocol_version ?? BPG_PROTOCOL_VERSION;
-        dataView.setUint32(offset, bpgMakeProp(packet.is_end_of_group, ver), false); 
+        dataView.setUint32(offset, bpgMakeProp(packet.is_end_of_group, ver, packet.content.metadata_bin !== undefined), false); 
         offset += 4;
 
         // Target ID (4 bytes, Big Endian)
@@ -93,7 +227,7 @@ export class BpgEncoder {
         offset += 4;
         
         // --- Data (HybridData) ---
-        const strBytes = new TextEncoder().encode(packet.content.metadata_str); 
+        const strBytes = metadataBytes(packet.content);
         const strLength = strBytes.length;
         
         // String Length 
@@ -212,14 +346,30 @@ export class BpgDecoder {
             if (strLength > 0) {
                  if(dataOffset + strLength > totalPacketSize) { console.error("Incomplete metadata"); break; }
                 const strBytes = this.internal_buffer.slice(dataOffset, dataOffset + strLength);
-                hybridData.metadata_str = new TextDecoder().decode(strBytes); 
+                if (propValue & PROP_BIN_META_BIT_MASK) {
+                    hybridData.metadata_bin = strBytes;
+                } else {
+                    hybridData.metadata_str = new TextDecoder().decode(strBytes); 
+                }
                 dataOffset += strLength;
             }
 
             // Binary bytes
             if (binaryBytesLength > 0) {
                  if(dataOffset + binaryBytesLength > totalPacketSize) { console.error("Incomplete binary data"); break; }
-                hybridData.binary_bytes = this.internal_buffer.slice(dataOffset, dataOffset + binaryBytesLength);
+                const stored = this.internal_buffer.subarray(dataOffset, dataOffset + binaryBytesLength);
+                const codec = bpgCodecFromProp(propValue);
+                if (codec !== CODEC_NONE) {
+                    const inflated = inflateBinary(codec, stored);
+                    if (!inflated) {
+                        console.error(`BPG Decoder: Corrupt or unsupported compressed binary (codec ${codec}) for TL ${tl}. Skipping packet.`);
+                        this.internal_buffer = this.internal_buffer.slice(totalPacketSize);
+                        continue;
+                    }
+                    hybridData.binary_bytes = inflated;
+                } else {
+                    hybridData.binary_bytes = stored.slice();
+                }
                 // dataOffset += binaryBytesLength; // Not strictly needed as it's the last part
             }
 
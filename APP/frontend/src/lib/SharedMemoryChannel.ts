@@ -1,5 +1,7 @@
 import { Throttle } from './throttle';
 import { nativeAddon } from './nativeAddon';
+import { SpscRing } from './SpscRing';
+import { SlabReader } from './SlabPool';
 
 // Constants for control array indices
 const R2N_SIGNAL = 0;
@@ -11,6 +13,35 @@ const N2R_LENGTH = 3;
 const UNLOCKED = 0;
 const LOCKED = 1;
 
+/**
+ * Data region layout negotiated with the native side.
+ *  - 'mailbox': one message in flight per direction (default).
+ *  - 'ring':    each data region is an SpscRing, so several messages can be in
+ *               flight; R2N_SIGNAL / N2R_SIGNAL act as doorbells.
+ */
+export type ChannelLayout = 'mailbox' | 'ring';
+
+export interface SharedMemoryChannelOptions {
+    layout?: ChannelLayout;
+    /**
+     * Split the N2R region into this many slabs that native threads lease,
+     * fill and commit independently (overrides the N2R side of `layout`).
+     */
+    n2rSlabs?: number;
+    /** Leases held longer than this are reclaimed (native default 1000ms, 0 = never). */
+    n2rLeaseTimeoutMs?: number;
+    /**
+     * Plugin worker threads behind the R2N dispatch queue. 0 (default) calls the
+     * plugin on the receive thread; with more than 1 the plugin sees messages
+     * concurrently and out of order.
+     */
+    dispatchWorkers?: number;
+    /** Messages the dispatch queue holds before the receive thread stops releasing R2N (native default 64). */
+    dispatchQueueDepth?: number;
+    /** Period of the plugin's update() on the native timer thread (native default 10ms, 0 = never). */
+    updateIntervalMs?: number;
+}
+
 // --- Debugging ---
 // Set this flag to true to enable detailed logging
 const DEBUG_ENABLED = false; 
@@ -23,6 +54,13 @@ export class SharedMemoryChannel {
     private control: Int32Array | null;
     private dataR2N: Uint8Array | null;
     private dataN2R: Uint8Array | null;
+    private requestedLayout: ChannelLayout;
+    public layout: ChannelLayout;
+    private r2nRing: SpscRing | null;
+    private n2rRing: SpscRing | null;
+    private n2rSlabs: SlabReader | null;
+    private slabOptions: { n2rSlabs?: number; n2rLeaseTimeoutMs?: number };
+    private dispatchOptions: { dispatchWorkers?: number; dispatchQueueDepth?: number; updateIntervalMs?: number };
     
     // --- Send Queue State ---
     private isProcessingSendQueue: boolean; // Tracks if the _processSendQueue loop is active
@@ -53,10 +91,21 @@ export class SharedMemoryChannel {
         }
     }
 
-    constructor(rendererToNativeSize = 1024, nativeToRendererSize = 1024) {
+    constructor(rendererToNativeSize = 1024, nativeToRendererSize = 1024, options: SharedMemoryChannelOptions = {}) {
         this.DBG("Constructor called");
         this.RENDERER_TO_NATIVE_SIZE = rendererToNativeSize;
         this.NATIVE_TO_RENDERER_SIZE = nativeToRendererSize;
+        this.requestedLayout = options.layout ?? 'mailbox';
+        this.layout = 'mailbox';
+        this.r2nRing = null;
+        this.n2rRing = null;
+        this.n2rSlabs = null;
+        this.slabOptions = { n2rSlabs: options.n2rSlabs, n2rLeaseTimeoutMs: options.n2rLeaseTimeoutMs };
+        this.dispatchOptions = {
+            dispatchWorkers: options.dispatchWorkers,
+            dispatchQueueDepth: options.dispatchQueueDepth,
+            updateIntervalMs: options.updateIntervalMs,
+        };
         
         this.messageQueue = [];
         this.isProcessingSendQueue = false;
@@ -86,8 +135,15 @@ export class SharedMemoryChannel {
         this.sharedBuffer = new ArrayBuffer(controlSizeBytes + this.RENDERER_TO_NATIVE_SIZE + this.NATIVE_TO_RENDERER_SIZE);
 
         // Initialize the addon with the shared buffer and sizes
-        // Make sure the native addon expects the control block at the start
-        nativeAddon.setSharedBuffer(this.sharedBuffer, this.RENDERER_TO_NATIVE_SIZE, this.NATIVE_TO_RENDERER_SIZE);
+        // Make sure the native addon expects the control block at the start.
+        // The native side answers with the layout it actually set up.
+        const negotiated = nativeAddon.setSharedBuffer(
+            this.sharedBuffer, this.RENDERER_TO_NATIVE_SIZE, this.NATIVE_TO_RENDERER_SIZE,
+            { layout: this.requestedLayout, ...this.slabOptions, ...this.dispatchOptions });
+        this.layout = negotiated === 'ring' ? 'ring' : 'mailbox';
+        if (this.layout !== this.requestedLayout) {
+            console.warn(`SharedMemoryChannel: requested layout '${this.requestedLayout}', native side set up '${this.layout}'.`);
+        }
 
         // Set up a potential native callback (example, adapt as needed)
         // nativeAddon.setMessageCallback((buffer: ArrayBuffer) => {
@@ -106,7 +162,37 @@ export class SharedMemoryChannel {
         // Create views for the data regions
         this.dataR2N = new Uint8Array(this.sharedBuffer, controlSizeBytes, this.RENDERER_TO_NATIVE_SIZE);
         this.dataN2R = new Uint8Array(this.sharedBuffer, controlSizeBytes + this.RENDERER_TO_NATIVE_SIZE, this.NATIVE_TO_RENDERER_SIZE);
-        this.DBG("Initialization complete.");
+        if (this.layout === 'ring') {
+            this.r2nRing = new SpscRing(this.sharedBuffer, controlSizeBytes, this.RENDERER_TO_NATIVE_SIZE);
+            this.n2rRing = new SpscRing(this.sharedBuffer, controlSizeBytes + this.RENDERER_TO_NATIVE_SIZE, this.NATIVE_TO_RENDERER_SIZE);
+        }
+        if (this.slabOptions.n2rSlabs) {
+            // Slabs replace whatever the layout put in the N2R region
+            this.n2rRing = null;
+            this.n2rSlabs = new SlabReader(this.sharedBuffer, controlSizeBytes + this.RENDERER_TO_NATIVE_SIZE, this.NATIVE_TO_RENDERER_SIZE);
+        }
+        this.DBG(`Initialization complete (layout: ${this.layout}).`);
+    }
+
+    /** Largest message that can be sent to the native side with the active layout. */
+    public get maxSendSize(): number {
+        return this.r2nRing ? this.r2nRing.maxPayload : this.RENDERER_TO_NATIVE_SIZE;
+    }
+
+    /** Raises the R2N doorbell (ring layout) after one or more records were committed. */
+    private ringR2NDoorbell() {
+        Atomics.store(this.control!, R2N_SIGNAL, 1);
+        this.wakeNative();
+    }
+
+    /**
+     * Wakes the native receive thread after R2N_SIGNAL was raised.
+     * Atomics.notify only reaches JS waiters; the native thread blocks on a
+     * kernel futex, which the addon wakes in notifyNative().
+     */
+    private wakeNative() {
+        Atomics.notify(this.control!, R2N_SIGNAL);
+        nativeAddon.notifyNative();
     }
 
     // --- Synchronization Helper ---
@@ -145,8 +231,8 @@ export class SharedMemoryChannel {
         if (!this.sharedBuffer || !this.control || !this.dataR2N) {
             throw new Error("SharedMemoryChannel not initialized or already cleaned up.");
         }
-        if (messageBytes.length > this.RENDERER_TO_NATIVE_SIZE) {
-            throw new Error(`Message too long (${messageBytes.length} bytes). Maximum size is ${this.RENDERER_TO_NATIVE_SIZE} bytes.`);
+        if (messageBytes.length > this.maxSendSize) {
+            throw new Error(`Message too long (${messageBytes.length} bytes). Maximum size is ${this.maxSendSize} bytes.`);
         }
 
         this.DBG("send_direct: Attempting to acquire R2N Lock...");
@@ -154,6 +240,20 @@ export class SharedMemoryChannel {
         this.DBG("send_direct: Acquired R2N Lock");
 
         try {
+            if (this.r2nRing) {
+                // Ring layout: wait only until there is room for this record
+                const startTime = Date.now();
+                while (!this.r2nRing.tryPush(messageBytes)) {
+                    if (Date.now() - startTime > wait_ms) {
+                        console.error("send_direct timeout: R2N ring stayed full.");
+                        throw new Error(`send_direct timeout: R2N ring full after ${wait_ms}ms.`);
+                    }
+                    await new Promise(resolve => setTimeout(resolve, 1)); // 1ms delay
+                }
+                this.ringR2NDoorbell();
+                return;
+            }
+
             // Wait for the native side to signal it's ready (R2N_SIGNAL == 0)
             const startTime = Date.now();
             // Consider using Atomics.waitAsync in the future if available/suitable
@@ -177,7 +277,7 @@ export class SharedMemoryChannel {
             // Signal native side that data is ready
             this.DBG(`send_direct: Setting R2N_SIGNAL to 1 (Length: ${messageBytes.length})`);
             Atomics.store(this.control, R2N_SIGNAL, 1);
-            Atomics.notify(this.control, R2N_SIGNAL); // Notify waiters if native uses Atomics.wait
+            this.wakeNative();
 
         } finally {
             this.DBG("send_direct: Releasing R2N Lock");
@@ -199,9 +299,9 @@ export class SharedMemoryChannel {
             return;
              // throw new Error("SharedMemoryChannel not initialized or already cleaned up.");
         }
-        if (messageBytes.length > this.RENDERER_TO_NATIVE_SIZE) {
+        if (messageBytes.length > this.maxSendSize) {
             // It's better to throw here to signal the error to the caller
-            throw new Error(`Message too long (${messageBytes.length} bytes) for queue. Maximum size is ${this.RENDERER_TO_NATIVE_SIZE} bytes.`);
+            throw new Error(`Message too long (${messageBytes.length} bytes) for queue. Maximum size is ${this.maxSendSize} bytes.`);
         }
 
         this.messageQueue.push(messageBytes);
@@ -246,8 +346,20 @@ export class SharedMemoryChannel {
 
         let processedMessage = false;
         try {
-            // Check if the native side is ready AFTER acquiring the lock
-            if (Atomics.load(this.control, R2N_SIGNAL) === 0) {
+            if (this.r2nRing) {
+                // Ring layout: commit as many queued messages as fit, then ring once
+                let pushed = 0;
+                while (this.messageQueue.length > 0 && this.r2nRing.tryPush(this.messageQueue[0])) {
+                    this.messageQueue.shift();
+                    pushed++;
+                }
+                if (pushed > 0) {
+                    this.DBG(`_processSendQueue: Pushed ${pushed} records into R2N ring, ${this.messageQueue.length} remaining.`);
+                    this.ringR2NDoorbell();
+                }
+                processedMessage = pushed > 0;
+            } else if (Atomics.load(this.control, R2N_SIGNAL) === 0) {
+                // Mailbox layout: the native side is ready (checked AFTER acquiring the lock)
                 this.DBG("_processSendQueue: Native Ready. Processing message from queue.");
                 // Native side is ready, process one message (or potentially stack them)
 
@@ -285,7 +397,7 @@ export class SharedMemoryChannel {
                 // Signal native side that data is ready
                 this.DBG(`_processSendQueue: Setting R2N_SIGNAL to 1 (Length: ${this.control[R2N_LENGTH]})`);
                 Atomics.store(this.control, R2N_SIGNAL, 1);
-                 Atomics.notify(this.control, R2N_SIGNAL); // Notify waiters
+                this.wakeNative();
 
                 processedMessage = true;
 
@@ -339,6 +451,11 @@ export class SharedMemoryChannel {
              try { callback(rawData); } catch(e) { console.error("Error in onMessageCallback:", e); }
          };
         this.isReceiving = true;
+        // The native side rings this right after publishing N2R data, so the
+        // timer loop below is only a fallback.
+        nativeAddon.setN2RDoorbell(() => {
+            if (this.isReceiving) this._checkReceive();
+        });
         // Use setTimeout to start the loop asynchronously
         setTimeout(this.binded_processReceiveQueue, this.recv_slow_check_interval);
     }
@@ -349,6 +466,7 @@ export class SharedMemoryChannel {
     public stopReceiving() {
          this.DBG("stopReceiving: Stopping receive loop.");
         this.isReceiving = false;
+        nativeAddon.setN2RDoorbell(null);
         // No need to clear onMessageCallback immediately, _processReceiveQueue checks isReceiving
     }
 
@@ -363,13 +481,67 @@ export class SharedMemoryChannel {
              this.DBG("_processReceiveQueue: Loop stopped.");
             return; // Stop the loop if isReceiving is false
         }
+
+        const received = this._checkReceive();
+        const nextCheckInterval = received ? this.recv_fast_check_interval : this.recv_slow_check_interval;
+
+        // Schedule the next check if still receiving
+        if (this.isReceiving) {
+            // this.DBG(`_processReceiveQueue: Scheduling next check in ${nextCheckInterval}ms`);
+            setTimeout(this.binded_processReceiveQueue, nextCheckInterval);
+        }
+    }
+
+    /**
+     * Consumes whatever the native side has published. Called from the timer
+     * loop and from the native N2R doorbell.
+     * @returns true if at least one message was delivered.
+     */
+    private _checkReceive(): boolean {
         if (!this.sharedBuffer || !this.control || !this.dataN2R) {
-             console.warn("_processReceiveQueue: Aborting, channel not initialized.");
+             console.warn("_checkReceive: Aborting, channel not initialized.");
             this.isReceiving = false; // Stop if channel disappears
-            return;
+            return false;
+        }
+
+        let received = false;
+
+        if (this.n2rSlabs) {
+            // Slab pool: lower the doorbell first, then hand back every READY slab in order
+            if (Atomics.load(this.control, N2R_SIGNAL) === 1 || this.n2rSlabs.hasReady()) {
+                Atomics.store(this.control, N2R_SIGNAL, 0);
+                const delivered = this.n2rSlabs.drain((message) => {
+                    if (this.onMessageCallback) {
+                        this.onMessageCallback(message);
+                    }
+                });
+                if (delivered > 0) {
+                    nativeAddon.notifyNative(); // Wakes native threads waiting for a free slab
+                    received = true;
+                }
+            }
+            return received;
         }
 
-        let nextCheckInterval = this.recv_slow_check_interval;
+        if (this.n2rRing) {
+            // Ring layout: lower the doorbell first, then drain every committed record
+            if (Atomics.load(this.control, N2R_SIGNAL) === 1 || !this.n2rRing.isEmpty()) {
+                Atomics.store(this.control, N2R_SIGNAL, 0);
+                let record: Uint8Array | null;
+                let popped = 0;
+                while ((record = this.n2rRing.tryPop()) !== null) {
+                    popped++;
+                    if (this.onMessageCallback) {
+                        this.onMessageCallback(record);
+                    }
+                }
+                if (popped > 0) {
+                    nativeAddon.notifyNative(); // Wakes a native sender waiting for ring space
+                }
+                received = true;
+            }
+            return received;
+        }
 
         // Check if native side has sent a message (N2R_SIGNAL == 1)
         // Use Atomics.load for thread safety
@@ -389,6 +561,7 @@ export class SharedMemoryChannel {
                  this.DBG("_processReceiveQueue: Setting N2R_SIGNAL to 0.");
                 Atomics.store(this.control, N2R_SIGNAL, 0);
                  Atomics.notify(this.control, N2R_SIGNAL); // Notify native if it's waiting
+                nativeAddon.notifyNative(); // Wakes a native sender blocked on the kernel futex
 
                 // Process the received data
                 if (this.onMessageCallback) {
@@ -396,13 +569,14 @@ export class SharedMemoryChannel {
                     this.onMessageCallback(dataCopy);
                 }
                  // Check faster next time as we just received a message
-                nextCheckInterval = this.recv_fast_check_interval;
+                received = true;
             } else if (length > this.NATIVE_TO_RENDERER_SIZE) {
                  console.error(`_processReceiveQueue: Received message length ${length} exceeds buffer size ${this.NATIVE_TO_RENDERER_SIZE}. Data lost.`);
                  // Signal native side we are done, even though data was bad
                  this.DBG("_processReceiveQueue: Setting N2R_SIGNAL to 0 after oversized message.");
                  Atomics.store(this.control, N2R_SIGNAL, 0);
                  Atomics.notify(this.control, N2R_SIGNAL);
+                 nativeAddon.notifyNative();
             } else {
                  // Length is 0 or negative, likely indicates an issue or just an empty signal
                  console.warn(`_processReceiveQueue: Received signal but length is ${length}. Ignoring.`);
@@ -410,17 +584,11 @@ export class SharedMemoryChannel {
                  this.DBG(`_processReceiveQueue: Setting N2R_SIGNAL to 0 after invalid length ${length}.`);
                  Atomics.store(this.control, N2R_SIGNAL, 0);
                  Atomics.notify(this.control, N2R_SIGNAL);
+                 nativeAddon.notifyNative();
             }
-        } else {
-             // No message waiting, use the slow interval
-             nextCheckInterval = this.recv_slow_check_interval;
         }
 
-        // Schedule the next check if still receiving
-        if (this.isReceiving) {
-            // this.DBG(`_processReceiveQueue: Scheduling next check in ${nextCheckInterval}ms`);
-            setTimeout(this.binded_processReceiveQueue, nextCheckInterval);
-        }
+        return received;
     }
 
     // --- Cleanup ---
@@ -471,6 +639,9 @@ export class SharedMemoryChannel {
         this.control = null;
         this.dataR2N = null;
         this.dataN2R = null;
+        this.r2nRing = null;
+        this.n2rRing = null;
+        this.n2rSlabs = null;
          this.DBG("SharedMemoryChannel: Cleanup complete.");
     }
 } 
\ No newline at end of file
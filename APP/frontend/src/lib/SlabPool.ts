@@ -0,0 +1,85 @@
+// Renderer side of the N->R slab pool. Byte layout mirrors native/slab_pool.h:
+//
+//   [ 0.. 3]  slab count   (written by native)
+//   [ 4.. 7]  slab size    (written by native)
+//   [64.. ]   descriptors, 16 bytes per slab: state, length, seq, reserved
+//   [dataOffset(count) ..]  slab data, `slab size` bytes each
+//
+// Native moves FREE -> LEASED -> READY; the renderer moves READY -> FREE.
+
+export const SLAB_POOL_HEADER_SIZE = 64;
+const SLAB_DESCRIPTOR_SIZE = 16;
+const SLAB_ALIGN = 64;
+
+export const SLAB_FREE = 0;
+export const SLAB_LEASED = 1;
+export const SLAB_READY = 2;
+
+function dataOffset(slabCount: number): number {
+    const end = SLAB_POOL_HEADER_SIZE + slabCount * SLAB_DESCRIPTOR_SIZE;
+    return (end + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+}
+
+export class SlabReader {
+    private words: Int32Array;
+    private bytes: Uint8Array;
+    private dataStart: number;
+    private expectedSeq: number;
+    public readonly slabCount: number;
+    public readonly slabSize: number;
+
+    /**
+     * Wraps the N2R region after the native side has set up the pool.
+     * @param buffer The shared buffer.
+     * @param byteOffset Start of the N2R region.
+     * @param byteLength Size of the N2R region in bytes.
+     */
+    constructor(buffer: ArrayBuffer, byteOffset: number, byteLength: number) {
+        this.words = new Int32Array(buffer, byteOffset, byteLength >> 2);
+        this.bytes = new Uint8Array(buffer, byteOffset, byteLength);
+        this.slabCount = Atomics.load(this.words, 0);
+        this.slabSize = Atomics.load(this.words, 1);
+        this.dataStart = dataOffset(this.slabCount);
+        this.expectedSeq = 0;
+    }
+
+    private descriptor(index: number, word: number): number {
+        return (SLAB_POOL_HEADER_SIZE + index * SLAB_DESCRIPTOR_SIZE) / 4 + word;
+    }
+
+    /** True if at least one slab is waiting to be read. */
+    hasReady(): boolean {
+        for (let i = 0; i < this.slabCount; i++) {
+            if (Atomics.load(this.words, this.descriptor(i, 0)) === SLAB_READY) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Delivers committed slabs in commit order, handing each one back to the
+     * native side right after copying it out.
+     * @returns the number of messages delivered.
+     */
+    drain(onMessage: (message: Uint8Array) => void): number {
+        let delivered = 0;
+        for (;;) {
+            let found = -1;
+            for (let i = 0; i < this.slabCount; i++) {
+                if (Atomics.load(this.words, this.descriptor(i, 0)) === SLAB_READY &&
+                    Atomics.load(this.words, this.descriptor(i, 2)) === this.expectedSeq) {
+                    found = i;
+                    break;
+                }
+            }
+            if (found < 0) return delivered;
+
+            const length = Atomics.load(this.words, this.descriptor(found, 1));
+            const start = this.dataStart + found * this.slabSize;
+            const message = this.bytes.slice(start, start + Math.min(length, this.slabSize));
+            Atomics.store(this.words, this.descriptor(found, 0), SLAB_FREE);
+            this.expectedSeq = (this.expectedSeq + 1) | 0;
+            delivered++;
+            onMessage(message);
+        }
+    }
+}
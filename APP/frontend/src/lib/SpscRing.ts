@@ -0,0 +1,120 @@
+// Single-producer / single-consumer ring of variable-length records inside one
+// data region of the shared buffer. Byte layout mirrors native/spsc_ring.h:
+//
+//   [ 0.. 3]  write index (Int32, owned by the producer)
+//   [32..35]  read index  (Int32, owned by the consumer)
+//   [64.. ]   record area (capacity = region size - 64, rounded down to 4)
+//
+// Record: [length u32 little endian][payload][pad to 4 bytes].
+// A length of RING_WRAP_MARKER means "continue at offset 0".
+
+export const RING_HEADER_SIZE = 64;
+export const RING_WRAP_MARKER = 0xFFFFFFFF;
+const RECORD_HEADER_SIZE = 4;
+const WRITE_INDEX = 0;         // Int32 slot of the write index
+const READ_INDEX = 32 / 4;     // Int32 slot of the read index
+
+function recordSize(length: number): number {
+    return (RECORD_HEADER_SIZE + length + 3) & ~3;
+}
+
+export class SpscRing {
+    private indices: Int32Array;
+    private records: Uint8Array;
+    private recordView: DataView;
+    public readonly capacity: number;
+
+    /**
+     * Wraps an existing region. The native side resets the indices when the
+     * layout is negotiated, so this does not touch them.
+     * @param buffer The shared buffer.
+     * @param byteOffset Start of the region (must be 4-byte aligned).
+     * @param byteLength Size of the region in bytes.
+     */
+    constructor(buffer: ArrayBuffer, byteOffset: number, byteLength: number) {
+        this.indices = new Int32Array(buffer, byteOffset, RING_HEADER_SIZE / 4);
+        this.capacity = (byteLength - RING_HEADER_SIZE) & ~3;
+        this.records = new Uint8Array(buffer, byteOffset + RING_HEADER_SIZE, this.capacity);
+        this.recordView = new DataView(buffer, byteOffset + RING_HEADER_SIZE, this.capacity);
+    }
+
+    /** Largest payload guaranteed to fit once the consumer has drained the ring. */
+    get maxPayload(): number {
+        return ((Math.floor(this.capacity / 2)) & ~3) - 2 * RECORD_HEADER_SIZE;
+    }
+
+    isEmpty(): boolean {
+        return Atomics.load(this.indices, READ_INDEX) === Atomics.load(this.indices, WRITE_INDEX);
+    }
+
+    // --- Producer side ---
+
+    /**
+     * Copies one message into the ring.
+     * @returns false if there is currently not enough room.
+     */
+    tryPush(message: Uint8Array): boolean {
+        const length = message.length;
+        if (length > this.maxPayload) return false;
+        const need = recordSize(length);
+        const w = Atomics.load(this.indices, WRITE_INDEX);
+        const r = Atomics.load(this.indices, READ_INDEX);
+
+        let pos: number;
+        if (w >= r) {
+            const tail = this.capacity - w;
+            if (need < tail || (need === tail && r !== 0)) {
+                pos = w;
+            } else if (need < r) {
+                if (tail >= RECORD_HEADER_SIZE) {
+                    this.recordView.setUint32(w, RING_WRAP_MARKER, true);
+                }
+                pos = 0;
+            } else {
+                return false;
+            }
+        } else if (need < r - w) {
+            pos = w;
+        } else {
+            return false;
+        }
+
+        this.records.set(message, pos + RECORD_HEADER_SIZE);
+        this.recordView.setUint32(pos, length, true);
+        let next = pos + need;
+        if (next === this.capacity) next = 0;
+        Atomics.store(this.indices, WRITE_INDEX, next); // publish
+        return true;
+    }
+
+    // --- Consumer side ---
+
+    /**
+     * Removes the oldest record and returns a copy of its payload,
+     * or null if the ring is empty.
+     */
+    tryPop(): Uint8Array | null {
+        let r = Atomics.load(this.indices, READ_INDEX);
+        const w = Atomics.load(this.indices, WRITE_INDEX);
+
+        for (let hops = 0; hops < 2; hops++) {
+            if (r === w) return null;
+            if (this.capacity - r < RECORD_HEADER_SIZE) {
+                r = 0;
+                continue;
+            }
+            const length = this.recordView.getUint32(r, true);
+            if (length === RING_WRAP_MARKER) {
+                r = 0;
+                continue;
+            }
+            if (recordSize(length) > this.capacity - r) return null; // corrupted record
+            const payload = this.records.slice(r + RECORD_HEADER_SIZE, r + RECORD_HEADER_SIZE + length);
+            let next = r + recordSize(length);
+            if (next === this.capacity) next = 0;
+            Atomics.store(this.indices, READ_INDEX, next); // release the space
+            return payload;
+        }
+        return null;
+    }
+}
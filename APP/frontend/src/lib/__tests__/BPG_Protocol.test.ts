@@ -11,6 +11,17 @@ import {
     BPG_SUPPORTED_PROTOCOL_VERSION_MAX,
     bpgMakeProp,
     bpgEffectiveProtocolVersion,
+    bpgEncodeImageMeta,
+    bpgImageMeta,
+    ImageMeta,
+    IMAGE_META_SIZE,
+    PROP_BIN_META_BIT_MASK,
+    PROP_COMPRESSED_BIT_MASK,
+    PROP_CODEC_SHIFT,
+    CODEC_LZ4,
+    CODEC_NONE,
+    bpgCodecFromProp,
+    bpgLz4Decompress,
 } from '../BPG_Protocol';
 
 function makePacket(overrides: Partial<AppPacket> = {}): AppPacket {
@@ -450,4 +461,122 @@ describe('BPG Protocol', () => {
             expect(bpgEffectiveProtocolVersion(bpgMakeProp(false, 1))).toBe(1);
         });
     });
+
+    describe('binary metadata', () => {
+        const meta: ImageMeta = { width: 640, height: 480, channels: 4, type: 24, format: 'raw_rgba' };
+
+        it('round-trips an ImageMeta block and sets the prop bit', () => {
+            const packet = makePacket({
+                tl: 'IM',
+                content: { metadata_str: '', metadata_bin: bpgEncodeImageMeta(meta), binary_bytes: new Uint8Array([1, 2, 3]) },
+            });
+            const encoded = encoder.encodePacket(packet);
+            const w = new DataView(encoded.buffer, encoded.byteOffset, encoded.byteLength);
+            expect(w.getUint32(4 + 2, false) & PROP_BIN_META_BIT_MASK).toBe(PROP_BIN_META_BIT_MASK);
+            expect(w.getUint32(WIRE_HEADER_SIZE, false)).toBe(IMAGE_META_SIZE);
+
+            const decoded = roundTrip(packet);
+            expect(decoded.content.metadata_str).toBe('');
+            expect(decoded.content.metadata_bin).toEqual(bpgEncodeImageMeta(meta));
+            expect(decoded.content.binary_bytes).toEqual(new Uint8Array([1, 2, 3]));
+            expect(bpgImageMeta(decoded.content)).toEqual(meta);
+        });
+
+        it('matches the C++ ImageMeta layout', () => {
+            expect(Array.from(bpgEncodeImageMeta(meta))).toEqual([
+                1, 2,           // kind image, format raw_rgba
+                0, 4, 0, 24,    // channels, type
+                0, 0, 2, 128,   // width 640
+                0, 0, 1, 224,   // height 480
+            ]);
+        });
+
+        it('bpgImageMeta falls back to JSON metadata', () => {
+            const content = { metadata_str: JSON.stringify(meta), binary_bytes: new Uint8Array(0) };
+            expect(bpgImageMeta(content)).toEqual(meta);
+            expect(bpgImageMeta({ metadata_str: '{"received":true}', binary_bytes: new Uint8Array(0) })).toBeNull();
+            expect(bpgImageMeta({ metadata_str: 'not json', binary_bytes: new Uint8Array(0) })).toBeNull();
+        });
+
+        it('bpgImageMeta rejects unknown kinds and short blocks', () => {
+            const block = bpgEncodeImageMeta(meta);
+            block[0] = 99;
+            expect(bpgImageMeta({ metadata_str: '', metadata_bin: block, binary_bytes: new Uint8Array(0) })).toBeNull();
+            expect(bpgImageMeta({ metadata_str: '', metadata_bin: block.slice(0, 8), binary_bytes: new Uint8Array(0) })).toBeNull();
+        });
+
+        it('leaves JSON packets without the prop bit', () => {
+            const decoded = roundTrip(makePacket());
+            expect(decoded.content.metadata_bin).toBeUndefined();
+            expect(decoded.content.metadata_str).toBe('{"key":"value"}');
+        });
+    });
+
+    describe('compressed payloads', () => {
+        const ascii = (text: string) => new TextEncoder().encode(text);
+        // LZ4 blocks as the C++ encoder (and liblz4) produce them
+        const shortBlock = new Uint8Array([0x35, ...ascii('abc'), 3, 0, 0x50, ...ascii('hello')]);
+        const shortRaw = ascii('abcabcabcabchello');
+        const longBlock = new Uint8Array([0xf0, 5, ...ascii('0123456789ABCDEFGHIJ'), 20, 0, 0xc0, ...ascii('!'.repeat(12))]);
+        const longRaw = ascii('0123456789ABCDEFGHIJ0123' + '!'.repeat(12));
+
+        // Encodes a packet whose binary is [raw_size][block] and sets the compressed bit
+        function compressedPacket(block: Uint8Array, rawSize: number, groupId = 1): Uint8Array {
+            const stored = new Uint8Array(4 + block.length);
+            new DataView(stored.buffer).setUint32(0, rawSize, false);
+            stored.set(block, 4);
+            const encoded = encoder.encodePacket(makePacket({ group_id: groupId, tl: 'IM', content: { metadata_str: '{"format":"raw"}', binary_bytes: stored } }));
+            const w = new DataView(encoded.buffer, encoded.byteOffset, encoded.byteLength);
+            w.setUint32(4 + 2, w.getUint32(4 + 2, false) | PROP_COMPRESSED_BIT_MASK | (CODEC_LZ4 << PROP_CODEC_SHIFT), false);
+            return encoded;
+        }
+
+        function decodeAll(bytes: Uint8Array): AppPacket[] {
+            const packets: AppPacket[] = [];
+            decoder.processData(bytes, (p) => packets.push(p), () => {});
+            return packets;
+        }
+
+        it('decompresses LZ4 blocks with overlapping matches and long literals', () => {
+            expect(bpgLz4Decompress(shortBlock, shortRaw.length)).toEqual(shortRaw);
+            expect(bpgLz4Decompress(longBlock, longRaw.length)).toEqual(longRaw);
+        });
+
+        it('rejects a wrong raw size or a truncated block', () => {
+            expect(bpgLz4Decompress(shortBlock, shortRaw.length - 1)).toBeNull();
+            expect(bpgLz4Decompress(shortBlock, shortRaw.length + 1)).toBeNull();
+            expect(bpgLz4Decompress(shortBlock.slice(0, 5), shortRaw.length)).toBeNull();
+            // Offset pointing before the start of the output
+            expect(bpgLz4Decompress(new Uint8Array([0x10, 0x61, 9, 0, 0x00]), 5)).toBeNull();
+        });
+
+        it('reads the codec from the prop', () => {
+            expect(bpgCodecFromProp(bpgMakeProp(true))).toBe(CODEC_NONE);
+            expect(bpgCodecFromProp(PROP_COMPRESSED_BIT_MASK | (CODEC_LZ4 << PROP_CODEC_SHIFT))).toBe(CODEC_LZ4);
+            // The codec id is ignored without the compressed bit
+            expect(bpgCodecFromProp(CODEC_LZ4 << PROP_CODEC_SHIFT)).toBe(CODEC_NONE);
+        });
+
+        it('delivers the raw bytes of a compressed packet', () => {
+            const packets = decodeAll(compressedPacket(longBlock, longRaw.length));
+            expect(packets).toHaveLength(1);
+            expect(packets[0].content.metadata_str).toBe('{"format":"raw"}');
+            expect(packets[0].content.binary_bytes).toEqual(longRaw);
+        });
+
+        it('skips a corrupt compressed packet and keeps decoding', () => {
+            const errSpy = vi.spyOn(console, 'error').mockImplementation(() => {});
+            const bad = compressedPacket(shortBlock, shortRaw.length + 3, 1);
+            const good = compressedPacket(shortBlock, shortRaw.length, 2);
+            const both = new Uint8Array(bad.length + good.length);
+            both.set(bad, 0);
+            both.set(good, bad.length);
+            const packets = decodeAll(both);
+            expect(packets).toHaveLength(1);
+            expect(packets[0].group_id).toBe(2);
+            expect(packets[0].content.binary_bytes).toEqual(shortRaw);
+            expect(errSpy).toHaveBeenCalled();
+            errSpy.mockRestore();
+        });
+    });
 });
@@ -12,6 +12,141 @@ function getAddonPath() {
 
 let addon: any;
 
+export interface LatencyStats {
+    count: number;
+    meanUs: number;
+    p50Us: number;
+    p99Us: number;
+    maxUs: number;
+    /** buckets[i] counts samples below 2^i microseconds. */
+    buckets: number[];
+}
+
+export interface ChannelStats {
+    layout: 'mailbox' | 'ring';
+    spinWakeups: number;
+    futexWakeups: number;
+    waitTimeouts: number;
+    nativeNotifies: number;
+    /** R2N ring records that could not be valid; the native side dropped the ring up to the write index. */
+    corruptRecords: number;
+    r2nWakeLatency: LatencyStats;
+    n2rDoorbellLatency: LatencyStats;
+    /** 0 unless the N2R region is split into leasable slabs. */
+    n2rSlabs: number;
+    n2rSlabSize: number;
+    leasesGranted: number;
+    leaseTimeouts: number;
+    leaseFailures: number;
+    expiredCommits: number;
+    /** Time req_available_buffer spent waiting for a free slab. */
+    leaseWait: LatencyStats;
+    dispatch: DispatchStats;
+    timers: TimerStats;
+}
+
+/** Native timer thread that runs plugin update() and v2 plugin timers. */
+export interface TimerStats {
+    active: number;
+    /** Times the timer thread woke up; stays flat while nothing is due. */
+    wakeups: number;
+    fired: number;
+    /** Deadline -> callback started. */
+    lateness: LatencyStats;
+}
+
+/** R->N dispatch queue between the receive thread and the plugin workers. */
+export interface DispatchStats {
+    /** 0 when messages are handed to the plugin on the receive thread. */
+    workers: number;
+    capacity: number;
+    depth: number;
+    maxDepth: number;
+    enqueued: number;
+    processed: number;
+    /** Times the receive thread found the queue full and held the message back. */
+    backpressureStalls: number;
+    copyFailures: number;
+    /** Queued buffers a v2 plugin kept past process_batch. */
+    retained: number;
+    /** Queued -> plugin process_message called. */
+    queueLatency: LatencyStats;
+    backpressureWait: LatencyStats;
+}
+
+export interface DeliveryStats {
+    zeroCopy: boolean;
+    messages: number;
+    bytes: number;
+    copiesMade: number;
+    /** Payload copies saved compared to the legacy vector + Buffer::Copy path. */
+    copiesAvoided: number;
+    /** Messages copied because the runtime refused an external ArrayBuffer. */
+    externalFallbacks: number;
+    explicitReleases: number;
+    dropped: number;
+    poolHits: number;
+    poolMisses: number;
+    poolOutstanding: number;
+    /** Queued on the native side -> JS callback invoked. */
+    latency: LatencyStats;
+}
+
+/** Which R->N messages a registered plugin claims (by BPG frame header). */
+export interface PluginRouteOptions {
+    /** BPG target_ids routed to this plugin. */
+    targets?: number[];
+    /** Two-character BPG packet types (TL) routed to this plugin. */
+    tl?: string[];
+    /** Receive everything no other plugin claims. */
+    default?: boolean;
+    /** Messages queued for the plugin before the receive thread waits (default 64). */
+    queueDepth?: number;
+}
+
+/** Hot-reload counters of one plugin slot. Times are in microseconds. */
+export interface ReloadStats {
+    /** Negotiated plugin API version (1 or 2), 0 when nothing is loaded. */
+    apiVersion: number;
+    generation: number;
+    /** A replaced build is still being drained and unloaded. */
+    retiring: boolean;
+    reloads: number;
+    reloadFailures: number;
+    /** Open + initialize() of the last build. */
+    lastLoadUs: number;
+    /** Publishing it to the dispatch threads. */
+    lastSwapUs: number;
+    /** Grace period + shutdown() + close of the build it replaced. */
+    lastDrainUs: number;
+}
+
+export interface ReloadResult {
+    generation: number;
+    loadUs: number;
+    swapUs: number;
+}
+
+export interface PluginStats extends ReloadStats {
+    name: string;
+    path: string;
+    targets: number[];
+    tl: string[];
+    default: boolean;
+    messages: number;
+    bytes: number;
+    dropped: number;
+    backpressureStalls: number;
+    retained: number;
+    depth: number;
+    maxDepth: number;
+    capacity: number;
+    /** Routed -> plugin process_message called. */
+    queueLatency: LatencyStats;
+    /** Time spent per process_batch call. */
+    processTime: LatencyStats;
+}
+
 try {
     addon = require(getAddonPath());
     // addon = window.get_nativeApi.get();
@@ -27,6 +162,16 @@ try {
         cleanup: () => console.log('Mock: cleanup called'),
         loadPlugin: () => console.log('Mock: loadPlugin called'),
         unloadPlugin: () => console.log('Mock: unloadPlugin called'),
+        registerPlugin: () => false,
+        unregisterPlugin: () => false,
+        getPluginStats: () => [],
+        reloadPlugin: () => undefined,
+        getReloadStats: () => undefined,
+        notifyNative: () => {},
+        setN2RDoorbell: () => {},
+        getChannelStats: () => undefined,
+        releaseMessageBuffer: () => false,
+        getDeliveryStats: () => undefined,
     };
 }
 
@@ -34,11 +179,35 @@ export const nativeAddon = {
     setSharedBuffer: (
         buffer: ArrayBuffer,
         rendererToNativeSize: number,
-        nativeToRendererSize: number
-    ) => addon.setSharedBuffer(buffer, rendererToNativeSize, nativeToRendererSize),
+        nativeToRendererSize: number,
+        options?: {
+            layout?: 'mailbox' | 'ring';
+            n2rSlabs?: number;
+            n2rLeaseTimeoutMs?: number;
+            dispatchWorkers?: number;
+            dispatchQueueDepth?: number;
+            updateIntervalMs?: number;
+            /** Re-check period for writers that never call notifyNative() (default 0 = never). */
+            pollFallbackMs?: number;
+        }
+    ): string | undefined => addon.setSharedBuffer(buffer, rendererToNativeSize, nativeToRendererSize, options),
 
-    setMessageCallback: (callback: (buffer: ArrayBuffer) => void) => 
-        addon.setMessageCallback(callback),
+    /**
+     * Registers the callback for plugin output. With `zeroCopy`, plugin messages
+     * bypass the shared buffer and arrive as ArrayBuffers backed by pooled native
+     * memory; pass them to releaseMessageBuffer() once done to recycle them early.
+     */
+    setMessageCallback: (
+        callback: (buffer: ArrayBuffer) => void,
+        options?: { zeroCopy?: boolean; maxMessageSize?: number }
+    ) => addon.setMessageCallback(callback, options),
+
+    /** Returns a zero-copy message buffer to the native pool and detaches it. */
+    releaseMessageBuffer: (buffer: ArrayBuffer): boolean =>
+        addon.releaseMessageBuffer ? addon.releaseMessageBuffer(buffer) : false,
+
+    /** Counters and latency histogram of the zero-copy delivery path. */
+    getDeliveryStats: (): DeliveryStats | undefined => addon.getDeliveryStats?.(),
 
     startSendingData: (interval: number) => addon.startSendingData(interval),
 
@@ -48,7 +217,40 @@ export const nativeAddon = {
 
     cleanup: () => addon.cleanup(),
 
+    /** Wakes native threads blocked on control[0] / control[2] after the renderer changed them. */
+    notifyNative: () => addon.notifyNative?.(),
+
+    /** Callback fired right after the native side publishes N2R data (null removes it). */
+    setN2RDoorbell: (callback: (() => void) | null) => addon.setN2RDoorbell?.(callback),
+
+    /** Wakeup counters and latency histograms (log2 microsecond buckets). */
+    getChannelStats: (): ChannelStats | undefined => addon.getChannelStats?.(),
+
+    /** Loads a plugin; with one already running, hot-swaps it (see reloadPlugin). */
     loadPlugin: (pluginPath: string) => addon.loadPlugin(pluginPath),
 
+    /**
+     * Hot-swaps the loadPlugin() plugin, or the registered plugin `name`,
+     * without dropping messages. Throws if the new build fails to load.
+     */
+    reloadPlugin: (pluginPath: string, name?: string): ReloadResult | undefined =>
+        name === undefined ? addon.reloadPlugin?.(pluginPath) : addon.reloadPlugin?.(pluginPath, name),
+
+    getReloadStats: (): (ReloadStats & { loaded: boolean; path: string }) | undefined =>
+        addon.getReloadStats?.(),
+
     unloadPlugin: () => addon.unloadPlugin(),
+
+    /**
+     * Loads an additional plugin on its own worker thread. Throws if the
+     * library cannot be loaded or a route is already taken.
+     */
+    registerPlugin: (name: string, pluginPath: string, options?: PluginRouteOptions): boolean =>
+        addon.registerPlugin(name, pluginPath, options),
+
+    /** Drains and unloads a registered plugin; false if the name is unknown. */
+    unregisterPlugin: (name: string): boolean => addon.unregisterPlugin(name),
+
+    /** Per-plugin throughput counters and latency histograms. */
+    getPluginStats: (): PluginStats[] => addon.getPluginStats?.() ?? [],
 }; 
\ No newline at end of file
@@ -4,7 +4,10 @@
       "target_name": "addon",
       "sources": [ 
         "native/addon.cc",
-        "native/plugin_loader.cc"
+        "native/plugin_loader.cc",
+        "native/plugin_host.cc",
+        "native/plugin_registry.cc",
+        "native/timer_wheel.cc"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
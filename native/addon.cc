@@ -5,31 +5,33 @@
 #include <cstring>
 #include <vector>
 #include <functional>
-#include "plugin_loader.h"
-#include "thread_safe_queue.h"
+#include <mutex>
+#include <unordered_map>
+#include "plugin_host.h"
+#include "plugin_registry.h"
+#include "timer_wheel.h"
+#include "mpsc_queue.h"
+#include "spsc_ring.h"
+#include "futex_wait.h"
+#include "latency_histogram.h"
+#include "buffer_pool.h"
+#include "slab_pool.h"
 
 // Forward declare our async helper
 void schedule_async_callback(Napi::Env env, std::function<void()> callback);
 
-// Global plugin loader instance
-PluginLoader g_plugin_loader;
+// The loadPlugin() plugin; loading again hot-swaps it
+PluginHost g_plugin_host;
+
+// Plugins registered with registerPlugin(); routed by BPG target_id / TL.
+// Messages none of them claims go to g_plugin_host as before.
+PluginRegistry g_plugin_registry;
 
 Napi::FunctionReference messageCallback;
 void setMessageCallback(const Napi::Function& callback) {
     messageCallback = Napi::Persistent(callback);
 }
 
-Napi::Value SetMessageCallback(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    
-    if (info.Length() < 1 || !info[0].IsFunction()) {
-        Napi::TypeError::New(env, "Expected a function argument").ThrowAsJavaScriptException();
-        return env.Undefined();
-    }
-
-    setMessageCallback(info[0].As<Napi::Function>());
-    return env.Undefined();
-}
 
 // Helper function to execute callbacks in the Node.js event loop
 void schedule_async_callback(Napi::Env env, std::function<void()> callback) {
@@ -61,8 +63,285 @@ void schedule_async_callback(Napi::Env env, std::function<void()> callback) {
     napi_queue_async_work(env, async_data->work);
 }
 
+// Zero-copy N->R delivery: messages travel in pooled native buffers that JS
+// receives as external ArrayBuffers. A buffer goes back to the pool when its
+// ArrayBuffer is garbage collected or passed to releaseMessageBuffer().
+// Runtimes that refuse external buffers (Electron's V8 memory cage) get a
+// single copy instead.
+
+struct DeliveryStats {
+    std::atomic<uint64_t> messages;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> copiesMade;        // host-side payload copies
+    std::atomic<uint64_t> copiesAvoided;     // vs. the two copies of the legacy path
+    std::atomic<uint64_t> externalFallbacks; // runtime refused an external ArrayBuffer
+    std::atomic<uint64_t> explicitReleases;
+    std::atomic<uint64_t> dropped;           // could not be queued
+    LatencyHistogram latency;                // queued -> JS callback invoked
+
+    void reset() {
+        messages = 0;
+        bytes = 0;
+        copiesMade = 0;
+        copiesAvoided = 0;
+        externalFallbacks = 0;
+        explicitReleases = 0;
+        dropped = 0;
+        latency.reset();
+    }
+};
+
+// Copies of a message on the legacy path (std::vector + Buffer::Copy)
+static const uint64_t LEGACY_DELIVERY_COPIES = 2;
+static const size_t DEFAULT_MAX_MESSAGE_SIZE = 4 * 1024 * 1024;
+
+// Buffer a plugin thread obtained through req_available_buffer and has not sent yet
+static thread_local PooledBuffer* t_pendingDelivery = nullptr;
+
+// PluginTxSlot.kind of slots handed out by the v2 acquire_tx
+static const uint32_t TX_KIND_SHARED = 1;   // single N2R buffer / ring reservation, one at a time
+static const uint32_t TX_KIND_SLAB = 2;     // handle = generation << 32 | slab index
+static const uint32_t TX_KIND_DELIVERY = 3; // handle = PooledBuffer*
+
+class MessageDelivery {
+public:
+    MessageDelivery() : isActive(false), tsfnValid(false), maxMessageSize(DEFAULT_MAX_MESSAGE_SIZE) {
+        stats.reset();
+    }
+
+    bool active() const { return isActive.load(std::memory_order_acquire); }
+    bool has_pending() const { return t_pendingDelivery != nullptr; }
+
+    void start(Napi::Env env, const Napi::Function& callback, size_t maxSize) {
+        stop();
+        Napi::ThreadSafeFunction fn = Napi::ThreadSafeFunction::New(
+            env, callback, "ZeroCopyDelivery", 0, 1,
+            [this](Napi::Env) { onFinalized(); });
+        // Do not keep the event loop alive just for the callback
+        fn.Unref(env);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        tsfn = fn;
+        tsfnValid = true;
+        maxMessageSize = maxSize;
+        stats.reset();
+        isActive.store(true, std::memory_order_release);
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        isActive.store(false, std::memory_order_release);
+        if (tsfnValid) {
+            tsfn.Release();
+            tsfnValid = false;
+        }
+    }
+
+    // MessageCallback path: one copy into a pooled buffer
+    int deliver_copy(const uint8_t* data, size_t length) {
+        if (data == nullptr || length == 0 || length > maxMessageSize) return -1;
+        PooledBuffer* buf = pool.acquire(length);
+        if (!buf) return -2;
+        memcpy(buf->data, data, length);
+        buf->length = length;
+        stats.copiesMade++;
+        stats.copiesAvoided += LEGACY_DELIVERY_COPIES - 1;
+        return enqueue(buf);
+    }
+
+    // BufferRequestCallback path: the plugin writes straight into the pooled buffer
+    int req_buffer(uint8_t** buffer, uint32_t* buffer_space) {
+        if (t_pendingDelivery) {
+            // Previous request was never sent
+            pool.release(t_pendingDelivery);
+            t_pendingDelivery = nullptr;
+        }
+        PooledBuffer* buf = pool.acquire(maxMessageSize);
+        if (!buf) return -2;
+        t_pendingDelivery = buf;
+        *buffer = buf->data;
+        *buffer_space = buf->capacity > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(buf->capacity);
+        return 0;
+    }
+
+    int send_current(uint32_t data_length) {
+        PooledBuffer* buf = t_pendingDelivery;
+        t_pendingDelivery = nullptr;
+        return send_pooled(buf, data_length);
+    }
+
+    // acquire_tx path: several buffers per call, owned through the slot handle
+    int acquire_slots(PluginTxSlot* slots, uint32_t count) {
+        uint32_t acquired = 0;
+        for (; acquired < count; acquired++) {
+            PooledBuffer* buf = pool.acquire(maxMessageSize);
+            if (!buf) break;
+            slots[acquired].data = buf->data;
+            slots[acquired].capacity = buf->capacity > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(buf->capacity);
+            slots[acquired].kind = TX_KIND_DELIVERY;
+            slots[acquired].handle = reinterpret_cast<uint64_t>(buf);
+        }
+        return acquired > 0 ? static_cast<int>(acquired) : -2;
+    }
+
+    int commit_slot(const PluginTxSlot* slot, uint32_t data_length) {
+        PooledBuffer* buf = reinterpret_cast<PooledBuffer*>(slot->handle);
+        if (data_length == 0) {
+            pool.release(buf);
+            return 0;
+        }
+        return send_pooled(buf, data_length);
+    }
+
+    int send_pooled(PooledBuffer* buf, uint32_t data_length) {
+        if (!buf) return -1;
+        if (data_length == 0 || data_length > buf->capacity) {
+            pool.release(buf);
+            return -1;
+        }
+        buf->length = data_length;
+        stats.copiesAvoided += LEGACY_DELIVERY_COPIES;
+        return enqueue(buf);
+    }
+
+    // JS thread: returns the buffer behind `arrayBuffer` to the pool right
+    // away and detaches the ArrayBuffer so the memory cannot be touched again.
+    bool release_js(napi_env env, napi_value arrayBuffer) {
+        void* data = nullptr;
+        size_t length = 0;
+        if (napi_get_arraybuffer_info(env, arrayBuffer, &data, &length) != napi_ok || data == nullptr) {
+            return false;
+        }
+        PooledBuffer* buf = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(leaseMutex);
+            auto it = leases.find(data);
+            if (it == leases.end()) return false;
+            it->second->released = true;
+            buf = it->second->buffer;
+            leases.erase(it);
+        }
+        napi_detach_arraybuffer(env, arrayBuffer);
+        pool.release(buf);
+        stats.explicitReleases++;
+        return true;
+    }
+
+    const DeliveryStats& get_stats() const { return stats; }
+    BufferPool& get_pool() { return pool; }
+
+private:
+    struct Lease {
+        PooledBuffer* buffer;
+        bool released;  // guarded by leaseMutex
+    };
+
+    int enqueue(PooledBuffer* buf) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!isActive.load(std::memory_order_acquire) || !tsfnValid) {
+            pool.release(buf);
+            stats.dropped++;
+            return -1;
+        }
+        buf->enqueue_ns = LatencyHistogram::now_ns();
+        napi_status status = tsfn.NonBlockingCall(buf, [this](Napi::Env env, Napi::Function jsCallback, PooledBuffer* msg) {
+            callJs(env, jsCallback, msg);
+        });
+        if (status != napi_ok) {
+            pool.release(buf);
+            stats.dropped++;
+            return -1;
+        }
+        return 0;
+    }
+
+    void callJs(Napi::Env env, Napi::Function jsCallback, PooledBuffer* buf) {
+        if (static_cast<napi_env>(env) == nullptr) {
+            // Function is being torn down with messages still queued
+            pool.release(buf);
+            return;
+        }
+        stats.latency.record_since(buf->enqueue_ns);
+        stats.messages++;
+        stats.bytes += buf->length;
+
+        Napi::HandleScope scope(env);
+        napi_value arrayBuffer = toArrayBuffer(env, buf);
+        if (arrayBuffer == nullptr) return;
+        jsCallback.Call({arrayBuffer});
+    }
+
+    napi_value toArrayBuffer(napi_env env, PooledBuffer* buf) {
+        napi_value result = nullptr;
+        Lease* lease = new Lease{buf, false};
+        {
+            std::lock_guard<std::mutex> lock(leaseMutex);
+            leases[buf->data] = lease;
+        }
+        if (napi_create_external_arraybuffer(env, buf->data, buf->length, finalizeExternal, lease, &result) == napi_ok) {
+            return result;
+        }
+        {
+            std::lock_guard<std::mutex> lock(leaseMutex);
+            leases.erase(buf->data);
+        }
+        delete lease;
+
+        // External buffers not allowed here: fall back to a single copy
+        stats.externalFallbacks++;
+        stats.copiesMade++;
+        stats.copiesAvoided--;
+        void* dst = nullptr;
+        if (napi_create_arraybuffer(env, buf->length, &dst, &result) == napi_ok) {
+            memcpy(dst, buf->data, buf->length);
+        } else {
+            result = nullptr;
+        }
+        pool.release(buf);
+        return result;
+    }
+
+    static void finalizeExternal(napi_env env, void* data, void* hint);
+
+    void onFinalized() {
+        std::lock_guard<std::mutex> lock(mutex);
+        isActive.store(false, std::memory_order_release);
+        tsfnValid = false;
+    }
+
+    std::mutex mutex;                   // guards tsfn / tsfnValid
+    std::atomic<bool> isActive;
+    Napi::ThreadSafeFunction tsfn;
+    bool tsfnValid;
+    size_t maxMessageSize;
+    BufferPool pool;
+    std::mutex leaseMutex;
+    std::unordered_map<const void*, Lease*> leases;  // ArrayBuffers handed to JS
+    DeliveryStats stats;
+};
+
+MessageDelivery g_delivery;
+
+void MessageDelivery::finalizeExternal(napi_env env, void* data, void* hint) {
+    Lease* lease = static_cast<Lease*>(hint);
+    PooledBuffer* buf = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_delivery.leaseMutex);
+        if (!lease->released) {
+            buf = lease->buffer;
+            g_delivery.leases.erase(data);
+        }
+    }
+    if (buf) g_delivery.pool.release(buf);
+    delete lease;
+}
+
 // Callback from plugin to Node.js
 void plugin_message_callback(const uint8_t* data, size_t length) {
+    if (g_delivery.active()) {
+        g_delivery.deliver_copy(data, length);
+        return;
+    }
     if (!messageCallback.IsEmpty()) {
         // Create a copy of the data for the callback
         std::vector<uint8_t> data_copy(data, data + length);
@@ -87,21 +366,364 @@ void plugin_message_callback(const uint8_t* data, size_t length) {
     }
 }
 
+// setMessageCallback(fn[, { zeroCopy: boolean, maxMessageSize: number }])
+// With zeroCopy, plugin output is delivered to fn as (ArrayBuffer) through the
+// pool instead of going through the shared buffer.
+Napi::Value SetMessageCallback(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Expected a function argument").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    bool zeroCopy = false;
+    size_t maxMessageSize = DEFAULT_MAX_MESSAGE_SIZE;
+    if (info.Length() >= 2 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("zeroCopy")) {
+            zeroCopy = options.Get("zeroCopy").ToBoolean();
+        }
+        if (options.Has("maxMessageSize") && options.Get("maxMessageSize").IsNumber()) {
+            maxMessageSize = options.Get("maxMessageSize").As<Napi::Number>().Uint32Value();
+            if (maxMessageSize == 0) {
+                Napi::RangeError::New(env, "maxMessageSize must be positive").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+        }
+    }
+
+    if (zeroCopy) {
+        messageCallback.Reset();
+        g_delivery.start(env, info[0].As<Napi::Function>(), maxMessageSize);
+    } else {
+        g_delivery.stop();
+        setMessageCallback(info[0].As<Napi::Function>());
+    }
+    return env.Undefined();
+}
+
+// Data region layouts negotiated through setSharedBuffer.
+//  Mailbox: one message in flight per direction (control[0..3] signal/length).
+//  Ring:    dataR2N and dataN2R each hold an SpscRing; control[0]/control[2]
+//           become doorbells that are raised after one or more records are committed.
+enum class ChannelLayout {
+    Mailbox = 0,
+    Ring = 1
+};
+
+static const char* channel_layout_name(ChannelLayout layout) {
+    return layout == ChannelLayout::Ring ? "ring" : "mailbox";
+}
+
+// recvThreadFunc spins this many times before blocking on control[0]
+static const int RECV_SPIN_COUNT = 1024;
+// Native channel threads sleep until notifyNative() wakes them. Writers that
+// raise a signal without calling it need the pollFallbackMs option, which
+// makes every wait re-check at that period instead (0 = never).
+static const uint32_t DEFAULT_POLL_FALLBACK_MS = 0;
+
+static const uint32_t DEFAULT_LEASE_TIMEOUT_MS = 1000;
+
+// Period of the host timer that calls the loadPlugin() plugin's update()
+static const uint32_t DEFAULT_UPDATE_INTERVAL_MS = 10;
+
+// Slab a plugin thread leased through req_available_buffer and has not committed yet
+static thread_local SlabLease t_slabLease = {-1, 0};
+
+struct ChannelStats {
+    std::atomic<uint64_t> spinWakeups;     // signal seen while spinning
+    std::atomic<uint64_t> futexWakeups;    // signal seen after a futex wait
+    std::atomic<uint64_t> waitTimeouts;    // futex waits that ended without a signal
+    std::atomic<uint64_t> nativeNotifies;  // notifyNative() calls that issued a wake
+    std::atomic<uint64_t> corruptRecords;  // R2N ring resyncs after a record that cannot be valid
+    LatencyHistogram r2nWakeLatency;       // notifyNative() -> recv thread running
+    LatencyHistogram n2rDoorbellLatency;   // N2R signal raised -> JS doorbell callback
+    LatencyHistogram leaseWait;            // req_available_buffer waiting for a free slab
+
+    void reset() {
+        spinWakeups = 0;
+        futexWakeups = 0;
+        waitTimeouts = 0;
+        nativeNotifies = 0;
+        corruptRecords = 0;
+        r2nWakeLatency.reset();
+        n2rDoorbellLatency.reset();
+        leaseWait.reset();
+    }
+};
+
+// Hands one R->N message to the loaded plugin (or logs it without one)
+static void forward_to_plugin(const uint8_t* data, size_t length) {
+    if (!g_plugin_host.process_message(data, length)) {
+        // Original message handling
+        printf("Data from renderer: ");
+        for (size_t i = 0; i < length && i < 32; i++) {
+            printf("%02x ", data[i]);
+        }
+        if (length > 32) printf("...");
+        printf(" (length: %zu)\n", length);
+    }
+}
+
+// Hands queued messages to the loaded plugin in one call. Messages stay
+// retainable (token = PooledBuffer*); the caller releases the rest.
+static void forward_batch_to_plugin(PluginMessage* batch, size_t count) {
+    if (g_plugin_host.process_batch(batch, count)) return;
+    for (size_t i = 0; i < count; i++) forward_to_plugin(batch[i].data, batch[i].length);
+}
+
+static const uint32_t DEFAULT_DISPATCH_QUEUE_DEPTH = 64;
+
+struct DispatchStats {
+    std::atomic<uint64_t> enqueued;
+    std::atomic<uint64_t> processed;
+    std::atomic<uint64_t> backpressureStalls;  // receive thread found the queue full
+    std::atomic<uint64_t> copyFailures;        // no pooled buffer; handled inline instead
+    std::atomic<uint64_t> retained;            // buffers a v2 plugin kept past process_batch
+    std::atomic<uint32_t> maxDepth;
+    LatencyHistogram queueLatency;             // enqueued -> plugin called
+    LatencyHistogram backpressureWait;         // receive thread blocked on a full queue
+
+    void reset() {
+        enqueued = 0;
+        processed = 0;
+        backpressureStalls = 0;
+        copyFailures = 0;
+        retained = 0;
+        maxDepth = 0;
+        queueLatency.reset();
+        backpressureWait.reset();
+    }
+};
+
+// Staged R->N pipeline: the receive thread copies each message into a pooled
+// buffer, releases the shared buffer right away and pushes the copy into a
+// bounded queue that plugin worker threads drain. When the queue is full the
+// receive thread waits for room before it releases the next message, so a
+// slow plugin pushes back on the renderer instead of growing memory.
+//
+// A plugin without PLUGIN_CAP_CONCURRENT (every v1 plugin) gets one batch at
+// a time in queue order however many workers there are: a worker keeps its
+// turn on the queue until the plugin returns. Only a plugin that declares it
+// is called from several workers at once, and then out of order.
+class PluginDispatcher {
+public:
+    PluginDispatcher() : running(false), updateDue(false), queue(nullptr), itemsSeq(0), spaceSeq(0),
+        sleepingWorkers(0), producerWaiting(false) {
+        stats.reset();
+    }
+
+    ~PluginDispatcher() { stop(); }
+
+    bool active() const { return running.load(std::memory_order_acquire); }
+
+    void start(uint32_t workerCount, uint32_t depth) {
+        stop();
+        queue = new BoundedMpscQueue<PooledBuffer*>(depth);
+        stats.reset();
+        // Leave work for the other workers of a concurrent plugin instead of
+        // one grabbing the whole queue
+        batchLimit = PluginLoader::DEFAULT_MAX_BATCH;
+        if (workerCount > 1 && queue->capacity() / workerCount < batchLimit) {
+            batchLimit = queue->capacity() / workerCount > 0 ? queue->capacity() / workerCount : 1;
+        }
+        running.store(true, std::memory_order_release);
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(&PluginDispatcher::workerFunc, this);
+        }
+    }
+
+    // Lets the workers finish what is queued, then joins them
+    void stop() {
+        if (!queue) return;
+        running.store(false, std::memory_order_release);
+        itemsSeq.fetch_add(1, std::memory_order_seq_cst);
+        futex_wake(&itemsSeq, INT32_MAX);
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+
+        PooledBuffer* buf;
+        while (queue->try_pop(buf)) pool.release(buf);
+        delete queue;
+        queue = nullptr;
+    }
+
+    // Receive thread. Returns once the message is queued (or was handled
+    // inline), or false if `operating` dropped while waiting for room.
+    bool dispatch(const uint8_t* data, size_t length, const std::atomic<bool>& operating) {
+        PooledBuffer* buf = pool.acquire(length);
+        if (!buf) {
+            stats.copyFailures++;
+            forward_to_plugin(data, length);
+            return true;
+        }
+        memcpy(buf->data, data, length);
+        buf->length = length;
+        buf->enqueue_ns = LatencyHistogram::now_ns();
+
+        if (!push(buf, operating)) {
+            pool.release(buf);
+            return false;
+        }
+        stats.enqueued++;
+        uint32_t depth = static_cast<uint32_t>(queue->size());
+        uint32_t prev = stats.maxDepth.load(std::memory_order_relaxed);
+        while (depth > prev && !stats.maxDepth.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {}
+
+        itemsSeq.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+            futex_wake(&itemsSeq, 1);
+        }
+        return true;
+    }
+
+    // Update timer: the next free worker calls the plugin's update()
+    void requestUpdate() {
+        updateDue.store(true, std::memory_order_seq_cst);
+        itemsSeq.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+            futex_wake(&itemsSeq, 1);
+        }
+    }
+
+    size_t depth() const { return queue ? queue->size() : 0; }
+    size_t capacity() const { return queue ? queue->capacity() : 0; }
+    size_t workerCount() const { return workers.size(); }
+    const DispatchStats& get_stats() const { return stats; }
+
+private:
+    bool push(PooledBuffer* buf, const std::atomic<bool>& operating) {
+        if (queue->try_push(buf)) return true;
+
+        stats.backpressureStalls++;
+        uint64_t waitStart = LatencyHistogram::now_ns();
+        while (true) {
+            int32_t seq = spaceSeq.load(std::memory_order_seq_cst);
+            producerWaiting.store(true, std::memory_order_seq_cst);
+            bool pushed = queue->try_push(buf);
+            if (!pushed && operating && active()) {
+                futex_wait(&spaceSeq, seq, FUTEX_WAIT_FOREVER);
+                pushed = queue->try_push(buf);
+            }
+            producerWaiting.store(false, std::memory_order_seq_cst);
+            if (pushed) break;
+            if (!operating || !active()) {
+                stats.backpressureWait.record_since(waitStart);
+                return false;
+            }
+        }
+        stats.backpressureWait.record_since(waitStart);
+        return true;
+    }
+
+    void workerFunc() {
+        PooledBuffer* bufs[PluginLoader::DEFAULT_MAX_BATCH];
+        PluginMessage batch[PluginLoader::DEFAULT_MAX_BATCH];
+        while (true) {
+            if (updateDue.load(std::memory_order_relaxed) && updateDue.exchange(false)) {
+                g_plugin_host.update();
+            }
+            bool concurrent = (g_plugin_host.capabilities() & PLUGIN_CAP_CONCURRENT) != 0;
+            size_t limit = concurrent ? batchLimit : PluginLoader::DEFAULT_MAX_BATCH;
+            // The queue has a single consumer side; workers take turns on it
+            std::unique_lock<std::mutex> turn(popMutex);
+            size_t count = 0;
+            while (count < limit && queue->try_pop(bufs[count])) count++;
+            if (count == 0) {
+                turn.unlock();
+                if (!active()) return;
+                waitForItems();
+                continue;
+            }
+            // Only a concurrent plugin lets the next worker pop while this batch runs
+            if (concurrent) turn.unlock();
+
+            for (size_t i = 0; i < count; i++) {
+                stats.queueLatency.record_since(bufs[i]->enqueue_ns);
+                batch[i] = {bufs[i]->data, bufs[i]->length, reinterpret_cast<uint64_t>(bufs[i]),
+                            PLUGIN_MSG_RETAINABLE, 0};
+            }
+            forward_batch_to_plugin(batch, count);
+            for (size_t i = 0; i < count; i++) {
+                if (batch[i].flags & PLUGIN_MSG_RETAINED) {
+                    stats.retained++;  // the plugin calls PluginHostApi.release()
+                } else {
+                    pool.release(bufs[i]);
+                }
+            }
+            stats.processed += count;
+            if (turn.owns_lock()) turn.unlock();
+
+            spaceSeq.fetch_add(1, std::memory_order_seq_cst);
+            if (producerWaiting.load(std::memory_order_seq_cst)) {
+                futex_wake(&spaceSeq, 1);
+            }
+        }
+    }
+
+    void waitForItems() {
+        for (int i = 0; i < RECV_SPIN_COUNT; i++) {
+            if (!queue->empty() || !active() || updateDue) return;
+            cpu_relax();
+        }
+        int32_t seq = itemsSeq.load(std::memory_order_seq_cst);
+        sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        if (queue->empty() && active() && !updateDue) {
+            futex_wait(&itemsSeq, seq, FUTEX_WAIT_FOREVER);
+        }
+        sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    std::atomic<bool> running;
+    std::atomic<bool> updateDue;
+    BoundedMpscQueue<PooledBuffer*>* queue;
+    size_t batchLimit = PluginLoader::DEFAULT_MAX_BATCH;
+    std::vector<std::thread> workers;
+    std::mutex popMutex;
+    BufferPool pool;
+
+    // Futex words: bumped after every push / pop
+    std::atomic<int32_t> itemsSeq;
+    std::atomic<int32_t> spaceSeq;
+    std::atomic<int32_t> sleepingWorkers;
+    std::atomic<bool> producerWaiting;
+    DispatchStats stats;
+};
 
 class SharedMemoryChannel {
 public:
     SharedMemoryChannel() : isChannelOperating(true),
         recvThread(nullptr),
         control(nullptr), dataR2N(nullptr), dataN2R(nullptr),
-        r2nBufferSize(0), n2rBufferSize(0) {}
+        r2nBufferSize(0), n2rBufferSize(0), layout(ChannelLayout::Mailbox),
+        pollFallbackUs(0), recvSeq(0), recvWaiting(false), n2rSpaceSeq(0), sendersWaiting(0), r2nNotifyNs(0),
+        n2rDoorbellActive(false), n2rDoorbellPending(false), n2rDoorbellNs(0) {
+        stats.reset();
+    }
 
     ~SharedMemoryChannel() {
         cleanup();
     }
 
-    void initialize(Napi::ArrayBuffer& sab, size_t r2nSize, size_t n2rSize) {
+    // n2rSlabCount > 0 splits dataN2R into that many leasable slabs,
+    // whatever the layout of dataR2N. dispatchWorkers > 0 hands R->N messages
+    // to that many plugin threads through a queue of dispatchQueueDepth.
+    // The plugin's update() runs every updateIntervalMs (0 = never) on the
+    // thread that dispatches to it: the receive thread, or a dispatch worker.
+    // The host timer only marks it due. pollFallbackMs > 0 bounds every wait
+    // for the renderer, for writers that never call notifyNative().
+    ChannelLayout initialize(Napi::ArrayBuffer& sab, size_t r2nSize, size_t n2rSize,
+                             ChannelLayout requestedLayout = ChannelLayout::Mailbox,
+                             uint32_t n2rSlabCount = 0,
+                             uint32_t leaseTimeoutMs = DEFAULT_LEASE_TIMEOUT_MS,
+                             uint32_t dispatchWorkers = 0,
+                             uint32_t dispatchQueueDepth = DEFAULT_DISPATCH_QUEUE_DEPTH,
+                             uint32_t updateIntervalMs = DEFAULT_UPDATE_INTERVAL_MS,
+                             uint32_t pollFallbackMs = DEFAULT_POLL_FALLBACK_MS) {
         cleanup(); // Cleanup existing resources first
 
+        pollFallbackUs = static_cast<uint64_t>(pollFallbackMs) * 1000;
         r2nBufferSize = r2nSize;
         n2rBufferSize = n2rSize;
 
@@ -119,10 +741,35 @@ public:
             control[i].store(0, std::memory_order_seq_cst);
         }
 
+        // Fall back to the mailbox if either region cannot host a ring
+        layout = ChannelLayout::Mailbox;
+        if (requestedLayout == ChannelLayout::Ring) {
+            if (r2nRing.attach(dataR2N, r2nBufferSize) && n2rRing.attach(dataN2R, n2rBufferSize)) {
+                layout = ChannelLayout::Ring;
+            } else {
+                r2nRing.detach();
+                n2rRing.detach();
+            }
+        }
+        if (n2rSlabCount > 0) {
+            n2rRing.detach();
+            n2rSlabs.attach(dataN2R, n2rBufferSize, n2rSlabCount, leaseTimeoutMs);
+        }
+
+        stats.reset();
+
         // Start threads
         isChannelOperating = true;
+        if (dispatchWorkers > 0) {
+            dispatcher.start(dispatchWorkers, dispatchQueueDepth);
+        }
         recvThread = new std::thread(&SharedMemoryChannel::recvThreadFunc, this);
+        if (updateIntervalMs > 0) {
+            uint64_t period_us = static_cast<uint64_t>(updateIntervalMs) * 1000;
+            updateTimer = TimerWheel::global().schedule(period_us, period_us, [this] { requestUpdate(); }, this);
+        }
 
+        return layout;
     }
 
     void cleanup() {
@@ -130,7 +777,16 @@ public:
         // This will interrupt wait_and_pop in the sending thread
         isChannelOperating = false;
         
-        
+        // Cut pending futex waits short
+        if (control) {
+            wakeRecvThread();
+            wakeSenders();
+        }
+
+        if (updateTimer) {
+            TimerWheel::global().cancel(updateTimer);
+            updateTimer = 0;
+        }
 
         // Cleanup native thread
         if (recvThread) {
@@ -138,9 +794,15 @@ public:
             delete recvThread;
             recvThread = nullptr;
         }
+        // Workers finish the messages already queued before the buffer goes away
+        dispatcher.stop();
 
 
         // Reset pointers
+        r2nRing.detach();
+        n2rRing.detach();
+        n2rSlabs.detach();
+        layout = ChannelLayout::Mailbox;
         control = nullptr;
         dataR2N = nullptr;
         dataN2R = nullptr;
@@ -158,18 +820,73 @@ public:
         if (!messageCallback.IsEmpty()) {
             messageCallback.Reset();
         }
+        g_delivery.stop();
 
+        setN2RDoorbell(nullptr);
+    }
+
+    // Called by the renderer right after it raised control[0] or cleared
+    // control[2]. JS Atomics.notify cannot wake a kernel futex, so the wake is
+    // issued from here, and only when a native thread is actually blocked.
+    void notify_native() {
+        if (!control) return;
+        if (recvWaiting.load(std::memory_order_seq_cst)) {
+            r2nNotifyNs.store(LatencyHistogram::now_ns(), std::memory_order_relaxed);
+        }
+        if (wakeRecvThread()) stats.nativeNotifies++;
+        if (wakeSenders()) stats.nativeNotifies++;
     }
 
+    // Installs (or with nullptr removes) the JS callback fired when N2R data is
+    // published. Several publishes before the callback runs fire it once.
+    void setN2RDoorbell(const Napi::ThreadSafeFunction* tsfn) {
+        std::lock_guard<std::mutex> lock(doorbellMutex);
+        if (n2rDoorbellActive) {
+            n2rDoorbell.Release();
+            n2rDoorbellActive = false;
+        }
+        n2rDoorbellPending = false;
+        if (tsfn) {
+            n2rDoorbell = *tsfn;
+            n2rDoorbellActive = true;
+        }
+    }
+
+    // The doorbell's finalizer ran (env teardown); never touch it again
+    void onN2RDoorbellFinalized() {
+        std::lock_guard<std::mutex> lock(doorbellMutex);
+        n2rDoorbellActive = false;
+    }
+
+    const ChannelStats& get_stats() const { return stats; }
+    const SlabPool& get_slabs() const { return n2rSlabs; }
+    const PluginDispatcher& get_dispatcher() const { return dispatcher; }
+    ChannelLayout get_layout() const { return layout; }
+
     int req_available_buffer(uint32_t wait_ms,uint8_t**ret_buffer,uint32_t *ret_buffer_sapce) {
+        if (n2rSlabs.attached()) {
+            return lease_slab(wait_ms, ret_buffer, ret_buffer_sapce);
+        }
         send_buffer_mutex.lock();
-        int isLineBusy=1;
-        for (uint32_t i = 0; i < wait_ms; i++) {
-            isLineBusy=control[2].load(std::memory_order_seq_cst);
-            if(isLineBusy==0)break;
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (layout == ChannelLayout::Ring) {
+            // Hand out the largest contiguous chunk once a max-size message
+            // fits. The renderer calls notifyNative() after draining records.
+            uint8_t* slot = nullptr;
+            uint32_t space = 0;
+            if (!waitForN2RSpace(wait_ms, [&] {
+                    slot = n2rRing.try_reserve_contiguous(n2rRing.max_payload(), &space);
+                    return slot != nullptr;
+                })) {
+                send_buffer_mutex.unlock();
+                return -2;
+            }
+            *ret_buffer = slot;
+            *ret_buffer_sapce = space;
+            return 0;
         }
-        if(isLineBusy==1)
+
+        // Wait until the renderer acknowledges the previous message
+        if (!waitForN2RSpace(wait_ms, [this] { return control[2].load(std::memory_order_seq_cst) != 1; }))
         {
             send_buffer_mutex.unlock();
             return -2;
@@ -181,20 +898,84 @@ public:
     }
 
     int send_current_buffer(uint32_t data_length) {
+        if (n2rSlabs.attached()) {
+            return commit_slab(data_length);
+        }
         if(data_length==0)
         {
+            if (layout == ChannelLayout::Ring) n2rRing.commit(0);
             send_buffer_mutex.unlock();
             return -1;
         }
+        if (layout == ChannelLayout::Ring) {
+            if (!n2rRing.commit(data_length)) {
+                send_buffer_mutex.unlock();
+                return -1;
+            }
+            control[2].store(1, std::memory_order_seq_cst);//doorbell
+            ringN2RDoorbell();
+            send_buffer_mutex.unlock();
+            return 0;
+        }
         control[3].store(data_length, std::memory_order_seq_cst);
         control[2].store(1, std::memory_order_seq_cst);//send
+        ringN2RDoorbell();
 
         send_buffer_mutex.unlock();
         return 0;
     }
 
+    // v2 acquire_tx. Slabs can be held several at a time; the single buffer
+    // and the ring hand out one slot and keep the send lock until it is
+    // committed.
+    int acquire_tx(uint32_t wait_ms, PluginTxSlot* slots, uint32_t count) {
+        if (n2rSlabs.attached()) {
+            SlabLease lease;
+            uint8_t* slab = nullptr;
+            int ret = wait_for_slab(wait_ms, &lease, &slab);
+            if (ret != 0) return ret;
+            uint32_t acquired = 0;
+            do {
+                slots[acquired].data = slab;
+                slots[acquired].capacity = static_cast<uint32_t>(n2rSlabs.slab_size());
+                slots[acquired].kind = TX_KIND_SLAB;
+                slots[acquired].handle = (static_cast<uint64_t>(lease.generation) << 32) | static_cast<uint32_t>(lease.index);
+                acquired++;
+            } while (acquired < count && n2rSlabs.try_lease(&lease, &slab));
+            return static_cast<int>(acquired);
+        }
+
+        uint8_t* buffer = nullptr;
+        uint32_t space = 0;
+        int ret = req_available_buffer(wait_ms, &buffer, &space);
+        if (ret != 0) return ret;
+        slots[0].data = buffer;
+        slots[0].capacity = space;
+        slots[0].kind = TX_KIND_SHARED;
+        slots[0].handle = 0;
+        return 1;
+    }
+
+    int commit_tx(const PluginTxSlot* slot, uint32_t data_length) {
+        if (slot->kind == TX_KIND_SLAB) {
+            SlabLease lease = {static_cast<int32_t>(slot->handle & 0xffffffffu), static_cast<uint32_t>(slot->handle >> 32)};
+            if (data_length == 0) {
+                n2rSlabs.abandon(lease);
+                return 0;
+            }
+            int ret = n2rSlabs.commit(lease, data_length);
+            if (ret != 0) return ret;
+            control[2].store(1, std::memory_order_seq_cst);//doorbell
+            ringN2RDoorbell();
+            return 0;
+        }
+        if (slot->kind != TX_KIND_SHARED) return -1;
+        int ret = send_current_buffer(data_length);
+        return data_length == 0 ? 0 : ret;
+    }
+
     int send_buffer(const uint8_t* data, size_t length,uint32_t wait_ms) {
-        if (length <= 0 || length > n2rBufferSize || data==nullptr)return -1;
+        if (length <= 0 || length > max_n2r_message() || data==nullptr)return -1;
 
         uint8_t* buffer=nullptr;
         uint32_t buffer_sapce=0;
@@ -205,48 +986,231 @@ public:
         ret=send_current_buffer(length);
         return ret;
     }
+
+    // Largest single N->R message for the active layout
+    size_t max_n2r_message() const {
+        if (n2rSlabs.attached()) return n2rSlabs.slab_size();
+        return layout == ChannelLayout::Ring ? n2rRing.max_payload() : n2rBufferSize;
+    }
     
 private:
 
 
+    // Host timer thread. Plugins on their own timers are left alone.
+    void requestUpdate() {
+        if (!g_plugin_host.wants_update()) return;
+        if (dispatcher.active()) {
+            dispatcher.requestUpdate();
+            return;
+        }
+        updateDue.store(true, std::memory_order_seq_cst);
+        wakeRecvThread();
+    }
+
+    // The wait words are bumped before every wake, so a thread that read the
+    // old value and is only about to block returns at once instead of
+    // missing it. Return whether a sleeping thread was woken.
+    bool wakeRecvThread() {
+        recvSeq.fetch_add(1, std::memory_order_seq_cst);
+        if (!recvWaiting.load(std::memory_order_seq_cst)) return false;
+        futex_wake(&recvSeq);
+        return true;
+    }
+
+    bool wakeSenders() {
+        n2rSpaceSeq.fetch_add(1, std::memory_order_seq_cst);
+        if (sendersWaiting.load(std::memory_order_seq_cst) == 0) return false;
+        futex_wake(&n2rSpaceSeq, INT32_MAX);
+        return true;
+    }
+
+    // Timeout for one wait with remaining_us left: the pollFallbackMs period if set
+    uint32_t waitTimeoutUs(uint64_t remaining_us = FUTEX_WAIT_FOREVER) const {
+        uint64_t limit = pollFallbackUs > 0 ? pollFallbackUs : FUTEX_WAIT_FOREVER;
+        return static_cast<uint32_t>(remaining_us < limit ? remaining_us : limit);
+    }
+
+    // Sender side: waits up to wait_ms for ready(), which claims N2R space.
+    // The renderer frees space and then calls notifyNative().
+    template <typename Ready>
+    bool waitForN2RSpace(uint32_t wait_ms, Ready ready) {
+        if (ready()) return true;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+        while (true) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline || !isChannelOperating) return false;
+            uint64_t remaining_us = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+            int32_t seq = n2rSpaceSeq.load(std::memory_order_seq_cst);
+            sendersWaiting.fetch_add(1, std::memory_order_seq_cst);
+            bool done = ready();
+            if (!done) futex_wait(&n2rSpaceSeq, seq, waitTimeoutUs(remaining_us));
+            sendersWaiting.fetch_sub(1, std::memory_order_seq_cst);
+            if (done || ready()) return true;
+        }
+    }
+
+    // Receive thread, when it dispatches to the plugin itself
+    void runDueUpdate() {
+        if (updateDue.load(std::memory_order_relaxed) && updateDue.exchange(false)) {
+            g_plugin_host.update();
+        }
+    }
+
     void recvThreadFunc() {
         while (isChannelOperating) {
-            // Update plugin if loaded
-            if (g_plugin_loader.is_loaded()) {
-                g_plugin_loader.update();
-            }
-
-            int wait_time = 1;
+            runDueUpdate();
             // Wait for Renderer → Native
-            while (control && control[0].load(std::memory_order_seq_cst) != 1) {
-                std::this_thread::sleep_for(std::chrono::microseconds(wait_time));
-                wait_time++;
-                if(wait_time > 1000) {
-                    wait_time = 1000;
+            if (!waitForRendererSignal()) return;
+
+            if (layout == ChannelLayout::Ring) {
+                // Lower the doorbell before draining so a record committed
+                // during the drain rings it again.
+                control[0] = 0;
+                uint32_t length = 0;
+                const uint8_t* record;
+                while ((record = r2nRing.peek(&length)) != nullptr) {
+                    handleRendererMessage(record, length);
+                    r2nRing.release();
+                    if (!isChannelOperating) return;
                 }
-                if (!isChannelOperating) return;
+                if (r2nRing.corrupt() && !resyncRendererRing()) return;
+                continue;
             }
 
             size_t length = static_cast<size_t>(control[1]);
             if (length > 0 && length <= r2nBufferSize) {
-                // Forward to plugin if loaded
-                if (g_plugin_loader.is_loaded()) {
-                    g_plugin_loader.process_message(dataR2N, length);
-                } else {
-                    // Original message handling
-                    printf("Data from renderer: ");
-                    for (size_t i = 0; i < length && i < 32; i++) {
-                        printf("%02x ", dataR2N[i]);
-                    }
-                    if (length > 32) printf("...");
-                    printf(" (length: %zu)\n", length);
-                }
-                
+                handleRendererMessage(dataR2N, length);
                 control[0] = 0;  // Reset R→N signal
             }
         }
     }
 
+    // The ring stays non-empty behind a corrupt record, so without this the
+    // loop would spin on it. Drops what the renderer queued so far; if even
+    // the write index is out of range, stops the channel and returns false.
+    bool resyncRendererRing() {
+        stats.corruptRecords++;
+        int64_t dropped = r2nRing.resync();
+        if (dropped < 0) {
+            fprintf(stderr, "R2N ring: write index out of range, channel stopped\n");
+            isChannelOperating = false;
+            wakeSenders();
+            return false;
+        }
+        fprintf(stderr, "R2N ring: corrupt record, dropped %lld queued bytes\n", static_cast<long long>(dropped));
+        return true;
+    }
+
+    bool rendererSignalled() {
+        return control[0].load(std::memory_order_seq_cst) == 1 ||
+               (layout == ChannelLayout::Ring && !r2nRing.empty());
+    }
+
+    // Spins briefly, then blocks on control[0] until the renderer raises it.
+    // Returns false once the channel stops operating.
+    bool waitForRendererSignal() {
+        for (int i = 0; i < RECV_SPIN_COUNT; i++) {
+            if (rendererSignalled()) {
+                stats.spinWakeups++;
+                return true;
+            }
+            if (!isChannelOperating) return false;
+            cpu_relax();
+        }
+
+        while (isChannelOperating) {
+            // Publish that we are about to sleep before the last check, so a
+            // notify_native() racing with us either sees the flag or we see the signal.
+            int32_t seq = recvSeq.load(std::memory_order_seq_cst);
+            recvWaiting.store(true, std::memory_order_seq_cst);
+            if (!rendererSignalled() && !updateDue && isChannelOperating) {
+                futex_wait(&recvSeq, seq, waitTimeoutUs());
+            }
+            recvWaiting.store(false, std::memory_order_seq_cst);
+            runDueUpdate();
+
+            uint64_t notifiedAt = r2nNotifyNs.exchange(0, std::memory_order_relaxed);
+            if (rendererSignalled()) {
+                stats.futexWakeups++;
+                if (notifiedAt != 0) stats.r2nWakeLatency.record_since(notifiedAt);
+                return true;
+            }
+            stats.waitTimeouts++;
+        }
+        return false;
+    }
+
+    // Leases a free N2R slab for the calling thread. Unlike the mailbox, no
+    // lock is held until the commit, so several threads can fill slabs at once.
+    int lease_slab(uint32_t wait_ms, uint8_t** ret_buffer, uint32_t* ret_buffer_space) {
+        if (t_slabLease.index >= 0) {
+            // The previous lease was never committed
+            n2rSlabs.abandon(t_slabLease);
+            t_slabLease.index = -1;
+        }
+
+        SlabLease lease;
+        uint8_t* slab = nullptr;
+        int ret = wait_for_slab(wait_ms, &lease, &slab);
+        if (ret != 0) return ret;
+        t_slabLease = lease;
+        *ret_buffer = slab;
+        *ret_buffer_space = n2rSlabs.slab_size();
+        return 0;
+    }
+
+    // Leases one free slab, waiting at most wait_ms for the renderer to hand one back
+    int wait_for_slab(uint32_t wait_ms, SlabLease* out, uint8_t** out_slab) {
+        uint64_t waitStart = LatencyHistogram::now_ns();
+        SlabLease lease;
+        uint8_t* slab = nullptr;
+        // The renderer calls notifyNative() after handing slabs back
+        if (!waitForN2RSpace(wait_ms, [&] { return n2rSlabs.try_lease(&lease, &slab); })) {
+            n2rSlabs.count_failure();
+            stats.leaseWait.record_since(waitStart);
+            return -2;
+        }
+        stats.leaseWait.record_since(waitStart);
+        *out = lease;
+        *out_slab = slab;
+        return 0;
+    }
+
+    int commit_slab(uint32_t data_length) {
+        SlabLease lease = t_slabLease;
+        t_slabLease.index = -1;
+        if (lease.index < 0) return -1;
+        int ret = n2rSlabs.commit(lease, data_length);
+        if (ret != 0) return ret;
+        control[2].store(1, std::memory_order_seq_cst);//doorbell
+        ringN2RDoorbell();
+        return 0;
+    }
+
+    // Fires the JS doorbell callback, coalescing while one is still queued
+    void ringN2RDoorbell() {
+        std::lock_guard<std::mutex> lock(doorbellMutex);
+        if (!n2rDoorbellActive || n2rDoorbellPending.exchange(true)) return;
+        n2rDoorbellNs.store(LatencyHistogram::now_ns(), std::memory_order_relaxed);
+        napi_status status = n2rDoorbell.NonBlockingCall([this](Napi::Env env, Napi::Function jsCallback) {
+            n2rDoorbellPending = false;
+            stats.n2rDoorbellLatency.record_since(n2rDoorbellNs.load(std::memory_order_relaxed));
+            jsCallback.Call({});
+        });
+        if (status != napi_ok) n2rDoorbellPending = false;
+    }
+
+    void handleRendererMessage(const uint8_t* data, size_t length) {
+        if (!g_plugin_registry.empty() && g_plugin_registry.dispatch(data, length, isChannelOperating)) {
+            return;
+        }
+        if (dispatcher.active()) {
+            dispatcher.dispatch(data, length, isChannelOperating);
+            return;
+        }
+        forward_to_plugin(data, length);
+    }
+
     //lock
     std::mutex send_buffer_mutex;
     std::atomic<bool> isChannelOperating;
@@ -259,6 +1223,27 @@ private:
     size_t r2nBufferSize;
     size_t n2rBufferSize;
 
+    ChannelLayout layout;
+    SpscRing r2nRing;
+    SpscRing n2rRing;
+    SlabPool n2rSlabs;
+
+    // Wakeup state
+    uint64_t pollFallbackUs;              // longest native wait, 0 = until woken
+    std::atomic<int32_t> recvSeq;         // recv thread's futex word, bumped by every wake
+    std::atomic<bool> recvWaiting;        // recv thread is (about to be) blocked in futex_wait
+    std::atomic<int32_t> n2rSpaceSeq;     // senders' futex word, bumped when the renderer frees N2R space
+    std::atomic<int32_t> sendersWaiting;  // senders blocked on n2rSpaceSeq
+    std::atomic<uint64_t> r2nNotifyNs;    // timestamp of the last notify_native() wake
+    std::mutex doorbellMutex;
+    Napi::ThreadSafeFunction n2rDoorbell;
+    bool n2rDoorbellActive;
+    std::atomic<bool> n2rDoorbellPending;
+    std::atomic<uint64_t> n2rDoorbellNs;
+    ChannelStats stats;
+    PluginDispatcher dispatcher;
+    uint64_t updateTimer = 0;
+    std::atomic<bool> updateDue{false};   // set by the update timer, run by the receive thread
 };
 
 // Global instance of SharedMemoryChannel
@@ -266,16 +1251,76 @@ SharedMemoryChannel channel;
 
 
 
+// Host callbacks handed to plugins. While a zero-copy message callback is
+// registered, plugin output goes through g_delivery instead of the shared buffer.
 void memcpy_to_shared_buffer(const uint8_t* data, size_t length) {
+    if (g_delivery.active()) {
+        g_delivery.deliver_copy(data, length);
+        return;
+    }
     channel.send_buffer(data,length,1000);
 }
 int req_available_buffer(uint32_t wait_ms,uint8_t** buffer, uint32_t* buffer_sapce) {
+    if (g_delivery.active()) {
+        return g_delivery.req_buffer(buffer, buffer_sapce);
+    }
     return channel.req_available_buffer(wait_ms,buffer,buffer_sapce);
 }
 int send_current_buffer(uint32_t data_length) {
+    if (g_delivery.has_pending()) {
+        return g_delivery.send_current(data_length);
+    }
     return channel.send_current_buffer(data_length);
 }
 
+// API v2 host callbacks
+int acquire_tx(const PluginHostApi* self, uint32_t wait_ms, PluginTxSlot* slots, uint32_t count) {
+    if (self == nullptr || slots == nullptr || count == 0) return -1;
+    // PluginHost clears the bit in the copy of a plugin without PLUGIN_CAP_MULTI_TX
+    if (!(self->capabilities & PLUGIN_HOST_CAP_MULTI_TX)) count = 1;
+    if (g_delivery.active()) {
+        return g_delivery.acquire_slots(slots, count);
+    }
+    return channel.acquire_tx(wait_ms, slots, count);
+}
+int commit_tx(const PluginTxSlot* slot, uint32_t data_length) {
+    if (slot == nullptr) return -1;
+    if (slot->kind == TX_KIND_DELIVERY) {
+        return g_delivery.commit_slot(slot, data_length);
+    }
+    return channel.commit_tx(slot, data_length);
+}
+uint64_t add_timer(const PluginHostApi* self, uint32_t delay_ms, uint32_t period_ms,
+                   PluginTimerCallback callback, void* user) {
+    if (self == nullptr || callback == nullptr) return 0;
+    return TimerWheel::global().schedule(static_cast<uint64_t>(delay_ms) * 1000, static_cast<uint64_t>(period_ms) * 1000,
+                                         [callback, user] { callback(user); }, self);
+}
+int cancel_timer(const PluginHostApi* self, uint64_t timer_id) {
+    // A plugin may only cancel its own timers
+    return TimerWheel::global().cancel(timer_id, self) ? 0 : -1;
+}
+// Token of a retained R->N message is its PooledBuffer
+void release_message(uint64_t token) {
+    PooledBuffer* buf = reinterpret_cast<PooledBuffer*>(token);
+    if (buf) buf->pool->release(buf);
+}
+
+static const PluginHostApi g_host_api = {
+    PLUGIN_API_VERSION_2,
+    PLUGIN_HOST_CAP_RETAIN | PLUGIN_HOST_CAP_MULTI_TX | PLUGIN_HOST_CAP_TIMERS,
+    memcpy_to_shared_buffer,
+    acquire_tx,
+    commit_tx,
+    release_message,
+    add_timer,
+    cancel_timer
+};
+
+static const PluginHostCallbacks g_host_callbacks = {
+    memcpy_to_shared_buffer, req_available_buffer, send_current_buffer, &g_host_api
+};
+
 
 Napi::String Hello(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -286,7 +1331,7 @@ Napi::Value SetSharedBuffer(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     if (info.Length() < 3 || !info[0].IsArrayBuffer() || !info[1].IsNumber() || !info[2].IsNumber()) {
-        Napi::TypeError::New(env, "Expected (ArrayBuffer, Number, Number)").ThrowAsJavaScriptException();
+        Napi::TypeError::New(env, "Expected (ArrayBuffer, Number, Number[, Object])").ThrowAsJavaScriptException();
         return env.Undefined();
     }
 
@@ -302,8 +1347,59 @@ Napi::Value SetSharedBuffer(const Napi::CallbackInfo& info) {
         return env.Undefined();
     }
 
-    channel.initialize(sab, r2nSize, n2rSize);
-    return env.Undefined();
+    // Optional 4th argument: { layout: "mailbox" | "ring", n2rSlabs: N, n2rLeaseTimeoutMs: ms,
+    //                         dispatchWorkers: N, dispatchQueueDepth: N, updateIntervalMs: ms,
+    //                         pollFallbackMs: ms }
+    ChannelLayout requestedLayout = ChannelLayout::Mailbox;
+    uint32_t n2rSlabCount = 0;
+    uint32_t leaseTimeoutMs = DEFAULT_LEASE_TIMEOUT_MS;
+    uint32_t dispatchWorkers = 0;
+    uint32_t dispatchQueueDepth = DEFAULT_DISPATCH_QUEUE_DEPTH;
+    uint32_t updateIntervalMs = DEFAULT_UPDATE_INTERVAL_MS;
+    uint32_t pollFallbackMs = DEFAULT_POLL_FALLBACK_MS;
+    if (info.Length() >= 4 && info[3].IsObject()) {
+        Napi::Object options = info[3].As<Napi::Object>();
+        if (options.Has("n2rSlabs") && options.Get("n2rSlabs").IsNumber()) {
+            n2rSlabCount = options.Get("n2rSlabs").As<Napi::Number>().Uint32Value();
+            if (n2rSlabCount > 0 && SlabPool::slab_size_for(n2rSize, n2rSlabCount) == 0) {
+                Napi::RangeError::New(env, "n2rSlabs does not fit in the N2R buffer").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+        }
+        if (options.Has("n2rLeaseTimeoutMs") && options.Get("n2rLeaseTimeoutMs").IsNumber()) {
+            leaseTimeoutMs = options.Get("n2rLeaseTimeoutMs").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Has("dispatchWorkers") && options.Get("dispatchWorkers").IsNumber()) {
+            dispatchWorkers = options.Get("dispatchWorkers").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Has("dispatchQueueDepth") && options.Get("dispatchQueueDepth").IsNumber()) {
+            dispatchQueueDepth = options.Get("dispatchQueueDepth").As<Napi::Number>().Uint32Value();
+            if (dispatchQueueDepth == 0) {
+                Napi::RangeError::New(env, "dispatchQueueDepth must be positive").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+        }
+        if (options.Has("updateIntervalMs") && options.Get("updateIntervalMs").IsNumber()) {
+            updateIntervalMs = options.Get("updateIntervalMs").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Has("pollFallbackMs") && options.Get("pollFallbackMs").IsNumber()) {
+            pollFallbackMs = options.Get("pollFallbackMs").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Has("layout") && options.Get("layout").IsString()) {
+            std::string layoutName = options.Get("layout").As<Napi::String>().Utf8Value();
+            if (layoutName == "ring") {
+                requestedLayout = ChannelLayout::Ring;
+            } else if (layoutName != "mailbox") {
+                Napi::TypeError::New(env, "Unknown layout (expected \"mailbox\" or \"ring\")").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+        }
+    }
+
+    ChannelLayout layout = channel.initialize(sab, r2nSize, n2rSize, requestedLayout, n2rSlabCount, leaseTimeoutMs,
+                                              dispatchWorkers, dispatchQueueDepth, updateIntervalMs, pollFallbackMs);
+    // Report the negotiated layout; the renderer must use the same one
+    return Napi::String::New(env, channel_layout_name(layout));
 }
 
 Napi::Value Cleanup(const Napi::CallbackInfo& info) {
@@ -314,14 +1410,151 @@ Napi::Value Cleanup(const Napi::CallbackInfo& info) {
 Napi::Value TriggerTestCallback(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
+    // triggerTestCallback(size): behave like a plugin that encodes `size`
+    // bytes straight into the buffer obtained from req_available_buffer
+    if (info.Length() >= 1 && info[0].IsNumber()) {
+        uint32_t size = info[0].As<Napi::Number>().Uint32Value();
+        uint8_t* buffer = nullptr;
+        uint32_t space = 0;
+        int ret = req_available_buffer(1000, &buffer, &space);
+        if (ret != 0) return Napi::Number::New(env, ret);
+        if (size > space) {
+            send_current_buffer(0);
+            return Napi::Number::New(env, -1);
+        }
+        for (uint32_t i = 0; i < size; i++) buffer[i] = static_cast<uint8_t>(i);
+        return Napi::Number::New(env, send_current_buffer(size));
+    }
+
     std::string testMessage = "Test callback from native code!";
 
 
-    channel.send_buffer((uint8_t*)testMessage.c_str(),testMessage.size(),1000);
+    memcpy_to_shared_buffer((uint8_t*)testMessage.c_str(),testMessage.size());
   
     return env.Undefined();
 }
 
+Napi::Value NotifyNative(const Napi::CallbackInfo& info) {
+    channel.notify_native();
+    return info.Env().Undefined();
+}
+
+Napi::Value SetN2RDoorbell(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || info[0].IsUndefined() || info[0].IsNull()) {
+        channel.setN2RDoorbell(nullptr);
+        return env.Undefined();
+    }
+    if (!info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Expected a function, null or undefined").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+        env, info[0].As<Napi::Function>(), "N2RDoorbell", 0, 1,
+        [](Napi::Env) { channel.onN2RDoorbellFinalized(); });
+    // Do not keep the event loop alive just for the doorbell
+    tsfn.Unref(env);
+    channel.setN2RDoorbell(&tsfn);
+    return env.Undefined();
+}
+
+static Napi::Object histogram_to_object(Napi::Env env, const LatencyHistogram& h) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("count", Napi::Number::New(env, static_cast<double>(h.count())));
+    obj.Set("meanUs", Napi::Number::New(env, h.mean_us()));
+    obj.Set("p50Us", Napi::Number::New(env, h.percentile_us(50)));
+    obj.Set("p99Us", Napi::Number::New(env, h.percentile_us(99)));
+    obj.Set("maxUs", Napi::Number::New(env, h.max_ns() / 1000.0));
+    // buckets[i] counts samples below 2^i us (and above the previous bucket)
+    Napi::Array buckets = Napi::Array::New(env, LatencyHistogram::BUCKET_COUNT);
+    for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+        buckets.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(h.bucket(i))));
+    }
+    obj.Set("buckets", buckets);
+    return obj;
+}
+
+Napi::Value GetChannelStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const ChannelStats& stats = channel.get_stats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("layout", Napi::String::New(env, channel_layout_name(channel.get_layout())));
+    result.Set("spinWakeups", Napi::Number::New(env, static_cast<double>(stats.spinWakeups.load())));
+    result.Set("futexWakeups", Napi::Number::New(env, static_cast<double>(stats.futexWakeups.load())));
+    result.Set("waitTimeouts", Napi::Number::New(env, static_cast<double>(stats.waitTimeouts.load())));
+    result.Set("nativeNotifies", Napi::Number::New(env, static_cast<double>(stats.nativeNotifies.load())));
+    result.Set("corruptRecords", Napi::Number::New(env, static_cast<double>(stats.corruptRecords.load())));
+    result.Set("r2nWakeLatency", histogram_to_object(env, stats.r2nWakeLatency));
+    result.Set("n2rDoorbellLatency", histogram_to_object(env, stats.n2rDoorbellLatency));
+
+    const SlabPool& slabs = channel.get_slabs();
+    result.Set("n2rSlabs", Napi::Number::New(env, slabs.slab_count()));
+    result.Set("n2rSlabSize", Napi::Number::New(env, slabs.slab_size()));
+    result.Set("leasesGranted", Napi::Number::New(env, static_cast<double>(slabs.leases_granted())));
+    result.Set("leaseTimeouts", Napi::Number::New(env, static_cast<double>(slabs.lease_timeouts())));
+    result.Set("leaseFailures", Napi::Number::New(env, static_cast<double>(slabs.lease_failures())));
+    result.Set("expiredCommits", Napi::Number::New(env, static_cast<double>(slabs.expired_commits())));
+    result.Set("leaseWait", histogram_to_object(env, stats.leaseWait));
+
+    const PluginDispatcher& dispatcher = channel.get_dispatcher();
+    const DispatchStats& dispatch = dispatcher.get_stats();
+    Napi::Object dispatchObj = Napi::Object::New(env);
+    dispatchObj.Set("workers", Napi::Number::New(env, static_cast<double>(dispatcher.workerCount())));
+    dispatchObj.Set("capacity", Napi::Number::New(env, static_cast<double>(dispatcher.capacity())));
+    dispatchObj.Set("depth", Napi::Number::New(env, static_cast<double>(dispatcher.depth())));
+    dispatchObj.Set("maxDepth", Napi::Number::New(env, dispatch.maxDepth.load()));
+    dispatchObj.Set("enqueued", Napi::Number::New(env, static_cast<double>(dispatch.enqueued.load())));
+    dispatchObj.Set("processed", Napi::Number::New(env, static_cast<double>(dispatch.processed.load())));
+    dispatchObj.Set("backpressureStalls", Napi::Number::New(env, static_cast<double>(dispatch.backpressureStalls.load())));
+    dispatchObj.Set("copyFailures", Napi::Number::New(env, static_cast<double>(dispatch.copyFailures.load())));
+    dispatchObj.Set("retained", Napi::Number::New(env, static_cast<double>(dispatch.retained.load())));
+    dispatchObj.Set("queueLatency", histogram_to_object(env, dispatch.queueLatency));
+    dispatchObj.Set("backpressureWait", histogram_to_object(env, dispatch.backpressureWait));
+    result.Set("dispatch", dispatchObj);
+
+    const TimerWheel& timers = TimerWheel::global();
+    Napi::Object timerObj = Napi::Object::New(env);
+    timerObj.Set("active", Napi::Number::New(env, static_cast<double>(timers.active())));
+    timerObj.Set("wakeups", Napi::Number::New(env, static_cast<double>(timers.stats().wakeups.load())));
+    timerObj.Set("fired", Napi::Number::New(env, static_cast<double>(timers.stats().fired.load())));
+    timerObj.Set("lateness", histogram_to_object(env, timers.stats().lateness));
+    result.Set("timers", timerObj);
+    return result;
+}
+
+Napi::Value ReleaseMessageBuffer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArrayBuffer()) {
+        Napi::TypeError::New(env, "Expected an ArrayBuffer").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Boolean::New(env, g_delivery.release_js(env, info[0]));
+}
+
+Napi::Value GetDeliveryStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const DeliveryStats& stats = g_delivery.get_stats();
+    BufferPool& pool = g_delivery.get_pool();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("zeroCopy", Napi::Boolean::New(env, g_delivery.active()));
+    result.Set("messages", Napi::Number::New(env, static_cast<double>(stats.messages.load())));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(stats.bytes.load())));
+    result.Set("copiesMade", Napi::Number::New(env, static_cast<double>(stats.copiesMade.load())));
+    result.Set("copiesAvoided", Napi::Number::New(env, static_cast<double>(stats.copiesAvoided.load())));
+    result.Set("externalFallbacks", Napi::Number::New(env, static_cast<double>(stats.externalFallbacks.load())));
+    result.Set("explicitReleases", Napi::Number::New(env, static_cast<double>(stats.explicitReleases.load())));
+    result.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped.load())));
+    result.Set("poolHits", Napi::Number::New(env, static_cast<double>(pool.hits())));
+    result.Set("poolMisses", Napi::Number::New(env, static_cast<double>(pool.misses())));
+    result.Set("poolOutstanding", Napi::Number::New(env, static_cast<double>(pool.outstanding())));
+    result.Set("latency", histogram_to_object(env, stats.latency));
+    return result;
+}
+
 // New function to load a plugin
 Napi::Value LoadPlugin(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -333,33 +1566,190 @@ Napi::Value LoadPlugin(const Napi::CallbackInfo& info) {
 
     std::string plugin_path = info[0].As<Napi::String>().Utf8Value();
     printf("Loading plugin from: %s\n", plugin_path.c_str());
-    bool success = g_plugin_loader.load(plugin_path);
-    if (success) {
-        // Initialize the plugin with our callback
-        const PluginInterface* iface = g_plugin_loader.get_interface();
-        if (iface) {
-            iface->initialize(memcpy_to_shared_buffer,
-            req_available_buffer,send_current_buffer);
-        }
+    // Initialize the plugin with our callbacks; replaces a running plugin in place
+    std::string error = g_plugin_host.load(plugin_path, g_host_callbacks);
+    if (!error.empty()) {
+        fprintf(stderr, "loadPlugin: %s\n", error.c_str());
     }
     
-    return Napi::Boolean::New(env, success);
+    return Napi::Boolean::New(env, error.empty());
 }
 
 // New function to unload the current plugin
 Napi::Value UnloadPlugin(const Napi::CallbackInfo& info) {
-    g_plugin_loader.unload();
+    g_plugin_host.unload();
     return info.Env().Undefined();
 }
 
+// reloadPlugin(path[, name]) -> { generation, loadUs, swapUs }
+// Hot-swaps the loadPlugin() plugin, or the registered plugin `name`. The
+// new build is initialized before it takes over; the old one is drained and
+// unloaded in the background (see getReloadStats().lastDrainUs).
+Napi::Value ReloadPlugin(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (path[, name])").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+
+    PluginHost::LoadTimes times;
+    std::string error;
+    if (info.Length() >= 2 && info[1].IsString()) {
+        error = g_plugin_registry.reload(info[1].As<Napi::String>().Utf8Value(), path, &times);
+    } else {
+        error = g_plugin_host.load(path, g_host_callbacks, &times);
+    }
+    if (!error.empty()) {
+        Napi::Error::New(env, ("reloadPlugin: " + error).c_str()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("generation", Napi::Number::New(env, times.generation));
+    result.Set("loadUs", Napi::Number::New(env, static_cast<double>(times.load_us)));
+    result.Set("swapUs", Napi::Number::New(env, static_cast<double>(times.swap_us)));
+    return result;
+}
+
+static void reload_stats_to_object(Napi::Env env, Napi::Object obj, const PluginHost& host) {
+    const PluginHost::ReloadStats& stats = host.stats();
+    obj.Set("apiVersion", Napi::Number::New(env, host.api_version()));
+    obj.Set("generation", Napi::Number::New(env, host.generation()));
+    obj.Set("retiring", Napi::Boolean::New(env, host.retiring()));
+    obj.Set("reloads", Napi::Number::New(env, static_cast<double>(stats.reloads.load())));
+    obj.Set("reloadFailures", Napi::Number::New(env, static_cast<double>(stats.failures.load())));
+    obj.Set("lastLoadUs", Napi::Number::New(env, static_cast<double>(stats.lastLoadUs.load())));
+    obj.Set("lastSwapUs", Napi::Number::New(env, static_cast<double>(stats.lastSwapUs.load())));
+    obj.Set("lastDrainUs", Napi::Number::New(env, static_cast<double>(stats.lastDrainUs.load())));
+}
+
+// Reload counters and timings of the loadPlugin() plugin
+Napi::Value GetReloadStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("loaded", Napi::Boolean::New(env, g_plugin_host.is_loaded()));
+    result.Set("path", Napi::String::New(env, g_plugin_host.path()));
+    reload_stats_to_object(env, result, g_plugin_host);
+    return result;
+}
+
+// registerPlugin(name, path, { targets: number[], tl: string[], default: boolean, queueDepth: number })
+// Loads a plugin next to the others; it gets its own worker thread and the
+// R->N messages whose BPG target_id or TL it claims.
+Napi::Value RegisterPlugin(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "Expected (name, path[, options])").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string name = info[0].As<Napi::String>().Utf8Value();
+    std::string path = info[1].As<Napi::String>().Utf8Value();
+
+    PluginRoute route;
+    uint32_t queueDepth = PluginRegistry::DEFAULT_QUEUE_DEPTH;
+    if (info.Length() >= 3 && info[2].IsObject()) {
+        Napi::Object options = info[2].As<Napi::Object>();
+        if (options.Has("targets") && options.Get("targets").IsArray()) {
+            Napi::Array targets = options.Get("targets").As<Napi::Array>();
+            for (uint32_t i = 0; i < targets.Length(); i++) {
+                Napi::Value target = targets.Get(i);
+                if (!target.IsNumber()) {
+                    Napi::TypeError::New(env, "targets[" + std::to_string(i) + "] must be a number")
+                        .ThrowAsJavaScriptException();
+                    return env.Undefined();
+                }
+                route.targets.push_back(target.As<Napi::Number>().Uint32Value());
+            }
+        }
+        if (options.Has("tl") && options.Get("tl").IsArray()) {
+            Napi::Array tls = options.Get("tl").As<Napi::Array>();
+            for (uint32_t i = 0; i < tls.Length(); i++) {
+                if (tls.Get(i).IsString()) {
+                    route.tl_prefixes.push_back(tls.Get(i).As<Napi::String>().Utf8Value());
+                }
+            }
+        }
+        if (options.Has("default")) {
+            route.is_default = options.Get("default").ToBoolean();
+        }
+        if (options.Has("queueDepth") && options.Get("queueDepth").IsNumber()) {
+            queueDepth = options.Get("queueDepth").As<Napi::Number>().Uint32Value();
+        }
+    }
+
+    std::string error = g_plugin_registry.add(name, path, route, queueDepth, g_host_callbacks);
+    if (!error.empty()) {
+        Napi::Error::New(env, ("registerPlugin: " + error).c_str()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value UnregisterPlugin(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected a plugin name").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Boolean::New(env, g_plugin_registry.remove(info[0].As<Napi::String>().Utf8Value()));
+}
+
+Napi::Value GetPluginStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Array result = Napi::Array::New(env);
+    uint32_t index = 0;
+    g_plugin_registry.for_each([&](const PluginRegistry::PluginView& plugin) {
+        const PluginCounters& c = plugin.counters;
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("name", Napi::String::New(env, plugin.name));
+        obj.Set("path", Napi::String::New(env, plugin.path));
+        Napi::Array targets = Napi::Array::New(env, plugin.route.targets.size());
+        for (size_t i = 0; i < plugin.route.targets.size(); i++) {
+            targets.Set(static_cast<uint32_t>(i), Napi::Number::New(env, plugin.route.targets[i]));
+        }
+        obj.Set("targets", targets);
+        Napi::Array tls = Napi::Array::New(env, plugin.route.tl_prefixes.size());
+        for (size_t i = 0; i < plugin.route.tl_prefixes.size(); i++) {
+            tls.Set(static_cast<uint32_t>(i), Napi::String::New(env, plugin.route.tl_prefixes[i]));
+        }
+        obj.Set("tl", tls);
+        obj.Set("default", Napi::Boolean::New(env, plugin.route.is_default));
+        obj.Set("messages", Napi::Number::New(env, static_cast<double>(c.messages.load())));
+        obj.Set("bytes", Napi::Number::New(env, static_cast<double>(c.bytes.load())));
+        obj.Set("dropped", Napi::Number::New(env, static_cast<double>(c.dropped.load())));
+        obj.Set("backpressureStalls", Napi::Number::New(env, static_cast<double>(c.backpressureStalls.load())));
+        obj.Set("retained", Napi::Number::New(env, static_cast<double>(c.retained.load())));
+        obj.Set("depth", Napi::Number::New(env, static_cast<double>(plugin.depth)));
+        obj.Set("maxDepth", Napi::Number::New(env, c.maxDepth.load()));
+        obj.Set("capacity", Napi::Number::New(env, static_cast<double>(plugin.capacity)));
+        obj.Set("queueLatency", histogram_to_object(env, c.queueLatency));
+        obj.Set("processTime", histogram_to_object(env, c.processTime));
+        reload_stats_to_object(env, obj, plugin.host);
+        result.Set(index++, obj);
+    });
+    return result;
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("setSharedBuffer", Napi::Function::New(env, SetSharedBuffer));
     exports.Set("cleanup", Napi::Function::New(env, Cleanup));
     exports.Set("hello", Napi::Function::New(env, Hello));
     exports.Set("setMessageCallback", Napi::Function::New(env, SetMessageCallback));
     exports.Set("triggerTestCallback", Napi::Function::New(env, TriggerTestCallback));
+    exports.Set("notifyNative", Napi::Function::New(env, NotifyNative));
+    exports.Set("setN2RDoorbell", Napi::Function::New(env, SetN2RDoorbell));
+    exports.Set("getChannelStats", Napi::Function::New(env, GetChannelStats));
+    exports.Set("releaseMessageBuffer", Napi::Function::New(env, ReleaseMessageBuffer));
+    exports.Set("getDeliveryStats", Napi::Function::New(env, GetDeliveryStats));
     exports.Set("loadPlugin", Napi::Function::New(env, LoadPlugin));
     exports.Set("unloadPlugin", Napi::Function::New(env, UnloadPlugin));
+    exports.Set("reloadPlugin", Napi::Function::New(env, ReloadPlugin));
+    exports.Set("getReloadStats", Napi::Function::New(env, GetReloadStats));
+    exports.Set("registerPlugin", Napi::Function::New(env, RegisterPlugin));
+    exports.Set("unregisterPlugin", Napi::Function::New(env, UnregisterPlugin));
+    exports.Set("getPluginStats", Napi::Function::New(env, GetPluginStats));
     return exports;
 }
 
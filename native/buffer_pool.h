@@ -0,0 +1,127 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+class BufferPool;
+
+// A heap block handed out by BufferPool. `length` is the number of valid
+// bytes, `capacity` the usable size of `data`.
+struct PooledBuffer {
+    uint8_t* data;
+    size_t capacity;
+    size_t length;
+    uint64_t enqueue_ns;  // free for the owner to use (e.g. latency stamps)
+    BufferPool* pool;     // where release() must return it
+};
+
+// Recycles message buffers in power-of-two size classes so multi-MB payloads
+// do not hit malloc/free for every message. Thread safe.
+class BufferPool {
+public:
+    static constexpr size_t MIN_CLASS_SHIFT = 12;  // 4 KB
+    static constexpr size_t MAX_CLASS_SHIFT = 30;  // 1 GB
+    static constexpr size_t CLASS_COUNT = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+
+    explicit BufferPool(size_t max_retained_bytes = 64 * 1024 * 1024)
+        : max_retained_bytes_(max_retained_bytes), retained_bytes_(0),
+          hits_(0), misses_(0), outstanding_(0) {}
+
+    ~BufferPool() { trim(); }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Returns a buffer with at least `min_capacity` bytes, or nullptr if the
+    // size is out of range or the allocation failed.
+    PooledBuffer* acquire(size_t min_capacity) {
+        int cls = size_class(min_capacity);
+        if (cls < 0) return nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<PooledBuffer*>& list = free_[cls];
+            if (!list.empty()) {
+                PooledBuffer* buf = list.back();
+                list.pop_back();
+                retained_bytes_ -= buf->capacity;
+                buf->length = 0;
+                hits_++;
+                outstanding_++;
+                return buf;
+            }
+        }
+
+        size_t capacity = static_cast<size_t>(1) << (cls + MIN_CLASS_SHIFT);
+        uint8_t* data = static_cast<uint8_t*>(std::malloc(capacity));
+        if (!data) return nullptr;
+        PooledBuffer* buf = new PooledBuffer{data, capacity, 0, 0, this};
+        misses_++;
+        outstanding_++;
+        return buf;
+    }
+
+    // Hands a buffer back. It is kept for reuse unless the pool already
+    // retains max_retained_bytes.
+    void release(PooledBuffer* buf) {
+        if (!buf) return;
+        outstanding_--;
+        int cls = size_class(buf->capacity);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cls >= 0 && retained_bytes_ + buf->capacity <= max_retained_bytes_) {
+                free_[cls].push_back(buf);
+                retained_bytes_ += buf->capacity;
+                return;
+            }
+        }
+        destroy(buf);
+    }
+
+    // Frees every retained buffer
+    void trim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < CLASS_COUNT; i++) {
+            for (PooledBuffer* buf : free_[i]) destroy(buf);
+            free_[i].clear();
+        }
+        retained_bytes_ = 0;
+    }
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+    int64_t outstanding() const { return outstanding_.load(std::memory_order_relaxed); }
+    size_t retained_bytes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return retained_bytes_;
+    }
+
+private:
+    static int size_class(size_t size) {
+        size_t shift = MIN_CLASS_SHIFT;
+        while ((static_cast<size_t>(1) << shift) < size) {
+            if (++shift > MAX_CLASS_SHIFT) return -1;
+        }
+        return static_cast<int>(shift - MIN_CLASS_SHIFT);
+    }
+
+    static void destroy(PooledBuffer* buf) {
+        std::free(buf->data);
+        delete buf;
+    }
+
+    std::mutex mutex_;
+    std::vector<PooledBuffer*> free_[CLASS_COUNT];
+    size_t max_retained_bytes_;
+    size_t retained_bytes_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<int64_t> outstanding_;
+};
+
+#endif // BUFFER_POOL_H
@@ -0,0 +1,129 @@
+#ifndef EPOCH_RECLAIM_H
+#define EPOCH_RECLAIM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// Epoch-based reclamation for objects that readers reach through an atomic
+// pointer (e.g. the plugin a message is dispatched to).
+//
+// Readers wrap each access in an EpochGuard: on entry the thread publishes
+// the current epoch in its own cache-line padded slot, on exit it clears the
+// slot. A writer swaps the pointer, then calls synchronize(), which bumps
+// the epoch and waits until no slot still holds an older one. After that no
+// reader can hold the old pointer and it can be freed.
+//
+// The read side takes no lock and writes only its own slot, so dispatch
+// threads never contend with each other or with a writer. Threads claim a
+// slot on first use and give it back when they exit; once all MAX_READERS
+// slots are taken, further threads share one counted overflow slot.
+class EpochDomain {
+public:
+    static constexpr size_t MAX_READERS = 64;
+    static constexpr uint32_t SYNC_POLL_US = 50;
+
+    // Process-wide domain shared by every plugin host
+    static EpochDomain& global() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // Waits until every read-side section that started before the call has
+    // ended. Never call it from inside an EpochGuard.
+    void synchronize() {
+        uint64_t target = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with enter()
+        for (size_t i = 0; i < MAX_READERS; i++) {
+            while (true) {
+                uint64_t seen = slots_[i].epoch.load(std::memory_order_acquire);
+                if (seen == 0 || seen >= target) break;
+                std::this_thread::sleep_for(std::chrono::microseconds(SYNC_POLL_US));
+            }
+        }
+        // Overflow readers carry no epoch; wait for a moment with none
+        while (overflow_.load(std::memory_order_acquire) != 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(SYNC_POLL_US));
+        }
+    }
+
+private:
+    friend class EpochGuard;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};  // 0 = outside a read-side section
+        std::atomic<bool> owned{false};
+    };
+
+    // Per-thread registration; releases the slot when the thread exits
+    struct Reader {
+        EpochDomain* domain = nullptr;
+        int slot = -1;
+        int depth = 0;
+        ~Reader() {
+            if (domain && slot >= 0) domain->slots_[slot].owned.store(false, std::memory_order_release);
+        }
+    };
+
+    static Reader& reader() {
+        static thread_local Reader r;
+        return r;
+    }
+
+    int claim_slot() {
+        for (size_t i = 0; i < MAX_READERS; i++) {
+            bool expected = false;
+            if (!slots_[i].owned.load(std::memory_order_relaxed) &&
+                slots_[i].owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    void enter() {
+        Reader& r = reader();
+        if (r.depth++ > 0) return;  // nested: the outer section already covers it
+        if (!r.domain) {
+            r.domain = this;
+            r.slot = claim_slot();
+        }
+        if (r.slot >= 0) {
+            slots_[r.slot].epoch.store(epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        } else {
+            overflow_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Publish the slot before the protected pointer is loaded
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void exit() {
+        Reader& r = reader();
+        if (--r.depth > 0) return;
+        if (r.slot >= 0) {
+            slots_[r.slot].epoch.store(0, std::memory_order_release);
+        } else {
+            overflow_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    EpochDomain() = default;
+
+    Slot slots_[MAX_READERS];
+    alignas(64) std::atomic<uint64_t> epoch_{1};
+    alignas(64) std::atomic<uint32_t> overflow_{0};
+};
+
+// Read-side critical section in the global domain
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::global().enter(); }
+    ~EpochGuard() { EpochDomain::global().exit(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+#endif // EPOCH_RECLAIM_H
@@ -0,0 +1,78 @@
+#ifndef FUTEX_WAIT_H
+#define FUTEX_WAIT_H
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#elif defined(_WIN32)
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#endif
+
+// futex_wait() timeout that never expires
+static const uint32_t FUTEX_WAIT_FOREVER = UINT32_MAX;
+
+// Blocks the calling thread while *word == expected, for at most timeout_us
+// (FUTEX_WAIT_FOREVER: until woken). Spurious returns are allowed, so callers
+// must re-check their condition.
+//
+// Linux waits on the word itself with FUTEX_WAIT (shared, not PRIVATE, so it
+// also works on memory mapped into several processes), Windows uses
+// WaitOnAddress. Other platforms fall back to a short sleep.
+//
+// Note: V8's Atomics.notify() does not wake a kernel futex, so a JS writer
+// has to call futex_wake() through the addon (see notifyNative).
+inline void futex_wait(std::atomic<int32_t>* word, int32_t expected, uint32_t timeout_us) {
+#if defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = timeout_us / 1000000;
+    ts.tv_nsec = (timeout_us % 1000000) * 1000;
+    syscall(SYS_futex, reinterpret_cast<int32_t*>(word), FUTEX_WAIT, expected,
+            timeout_us == FUTEX_WAIT_FOREVER ? nullptr : &ts, nullptr, 0);
+#elif defined(_WIN32)
+    DWORD timeout_ms = timeout_us == FUTEX_WAIT_FOREVER ? INFINITE : (timeout_us + 999) / 1000;
+    WaitOnAddress(reinterpret_cast<volatile VOID*>(word), &expected, sizeof(expected), timeout_ms);
+#else
+    if (word->load(std::memory_order_acquire) == expected) {
+        std::this_thread::sleep_for(std::chrono::microseconds(timeout_us < 50 ? timeout_us : 50));
+    }
+#endif
+}
+
+// Wakes up to `count` threads blocked in futex_wait() on `word`.
+inline void futex_wake(std::atomic<int32_t>* word, int count = 1) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<int32_t*>(word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+    if (count == 1) {
+        WakeByAddressSingle(reinterpret_cast<PVOID>(word));
+    } else {
+        WakeByAddressAll(reinterpret_cast<PVOID>(word));
+    }
+#else
+    (void)word;
+    (void)count;
+#endif
+}
+
+// Busy-wait hint for short spin phases before blocking.
+inline void cpu_relax() {
+#if defined(_WIN32)
+    YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+#endif // FUTEX_WAIT_H
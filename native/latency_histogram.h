@@ -0,0 +1,83 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+
+// Lock-free latency histogram with power-of-two microsecond buckets.
+// Bucket 0 counts samples below 1us, bucket i counts [2^(i-1), 2^i) us and the
+// last bucket collects everything above. Safe to record from any thread.
+class LatencyHistogram {
+public:
+    static constexpr int BUCKET_COUNT = 24; // last bucket: >= ~4.2s
+
+    LatencyHistogram() { reset(); }
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void record_ns(uint64_t ns) {
+        uint64_t us = ns / 1000;
+        int bucket = 0;
+        while (us > 0 && bucket < BUCKET_COUNT - 1) {
+            us >>= 1;
+            bucket++;
+        }
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        total_ns_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+        while (ns > prev && !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+    }
+
+    // Records the time elapsed since a now_ns() timestamp
+    void record_since(uint64_t start_ns) {
+        uint64_t end = now_ns();
+        record_ns(end > start_ns ? end - start_ns : 0);
+    }
+
+    void reset() {
+        for (int i = 0; i < BUCKET_COUNT; i++) buckets_[i].store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        total_ns_.store(0, std::memory_order_relaxed);
+        max_ns_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t bucket(int i) const { return buckets_[i].load(std::memory_order_relaxed); }
+    uint64_t max_ns() const { return max_ns_.load(std::memory_order_relaxed); }
+
+    double mean_us() const {
+        uint64_t n = count();
+        return n ? static_cast<double>(total_ns_.load(std::memory_order_relaxed)) / n / 1000.0 : 0.0;
+    }
+
+    // Upper bound (in us) of the bucket holding the given percentile (0..100)
+    double percentile_us(double p) const {
+        uint64_t n = count();
+        if (n == 0) return 0.0;
+        uint64_t target = static_cast<uint64_t>(n * p / 100.0);
+        if (target >= n) target = n - 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += bucket(i);
+            if (seen > target) return bucket_upper_us(i);
+        }
+        return bucket_upper_us(BUCKET_COUNT - 1);
+    }
+
+    static double bucket_upper_us(int i) {
+        return static_cast<double>(1ull << i);
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> total_ns_;
+    std::atomic<uint64_t> max_ns_;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,260 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include "futex_wait.h"
+
+// Bounded lock-free multi-producer / multi-consumer queue (Vyukov's
+// sequence-numbered ring) with blocking calls, for fan-out between native
+// threads. The plugin registry queues through it; the R->N dispatcher stays
+// on BoundedMpscQueue (mpsc_queue.h) until bench_mpmc_queue shows it ahead
+// under real contention.
+//
+// Every cell carries a sequence number. Producers and consumers claim
+// positions with a CAS on their own cache-line padded index and hand a cell
+// over by advancing its sequence, so the fast path takes no lock and makes
+// no system call. Blocking calls spin briefly and then sleep on a futex word
+// that is only woken when somebody actually sleeps.
+//
+// Differences from ThreadSafeQueue:
+//  - the capacity is fixed (rounded up to a power of two); push() waits for
+//    room, try_push() fails instead
+//  - after interrupt(), pushes fail but items already queued can still be
+//    popped, so consumers can drain before they exit
+template <typename T>
+class MpmcQueue {
+public:
+    static constexpr int SPIN_COUNT = 256;
+    static constexpr uint32_t WAIT_SLICE_US = 1000;
+
+    explicit MpmcQueue(size_t capacity) : interrupted_(false) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mask_ = size - 1;
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Approximate while other threads are pushing or popping
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // --- Non-blocking ---
+
+    bool try_push(const T& item) { return emplace(item); }
+    bool try_push(T&& item) { return emplace(std::move(item)); }
+
+    bool try_pop(T& item) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(cell.value);
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    signal(space_);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // nothing published at this position yet
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Same as try_pop (kept for ThreadSafeQueue callers)
+    bool pop(T& item) { return try_pop(item); }
+
+    // Pushes items in order until one does not fit. Returns how many were pushed.
+    size_t push_n(const T* items, size_t count) {
+        size_t pushed = 0;
+        while (pushed < count && emplace(items[pushed], false)) pushed++;
+        if (pushed > 0) signal(items_, pushed);
+        return pushed;
+    }
+
+    // Pops up to `max` items. Returns how many were popped.
+    size_t pop_n(T* items, size_t max) {
+        size_t popped = 0;
+        while (popped < max && try_pop(items[popped])) popped++;
+        return popped;
+    }
+
+    // --- Blocking ---
+
+    // Waits for room. Returns false if the queue is interrupted first.
+    bool push(const T& item) {
+        T copy(item);
+        return push(std::move(copy));
+    }
+
+    bool push(T&& item) {
+        while (!try_push(std::move(item))) {
+            if (is_interrupted()) return false;
+            wait_for(space_, [this] { return size() < capacity(); }, WAIT_SLICE_US);
+        }
+        return true;
+    }
+
+    // Waits at most timeout_us for room. Returns false on timeout or interrupt.
+    bool push(T&& item, uint32_t timeout_us) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+        while (!try_push(std::move(item))) {
+            if (is_interrupted()) return false;
+            uint32_t remaining = remaining_us(deadline);
+            if (remaining == 0) return false;
+            wait_for(space_, [this] { return size() < capacity(); }, remaining);
+        }
+        return true;
+    }
+
+    // Waits for an item. Returns false once the queue is interrupted and empty.
+    bool wait_and_pop(T& item) {
+        while (!try_pop(item)) {
+            if (is_interrupted()) return try_pop(item);
+            wait_for(items_, [this] { return !empty(); }, WAIT_SLICE_US);
+        }
+        return true;
+    }
+
+    // Waits at most timeout_us for an item
+    bool wait_and_pop(T& item, uint32_t timeout_us) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+        while (!try_pop(item)) {
+            if (is_interrupted()) return try_pop(item);
+            uint32_t remaining = remaining_us(deadline);
+            if (remaining == 0) return false;
+            wait_for(items_, [this] { return !empty(); }, remaining);
+        }
+        return true;
+    }
+
+    // Pops everything that is queued (not thread safe against concurrent pushes)
+    void clear() {
+        T item;
+        while (try_pop(item)) {}
+    }
+
+    // Wakes every waiter; pushes fail until reset_interrupt()
+    void interrupt() {
+        interrupted_.store(true, std::memory_order_seq_cst);
+        for (WaitWord* word : {&items_, &space_}) {
+            word->seq.fetch_add(1, std::memory_order_seq_cst);
+            futex_wake(&word->seq, INT32_MAX);
+        }
+    }
+
+    void reset_interrupt() { interrupted_.store(false, std::memory_order_seq_cst); }
+    bool is_interrupted() const { return interrupted_.load(std::memory_order_seq_cst); }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    template <typename U>
+    bool emplace(U&& item, bool wake = true) {
+        if (is_interrupted()) return false;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::forward<U>(item);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    if (wake) signal(items_);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full: a consumer has not freed this cell yet
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Futex word that blocked pushers or poppers sleep on
+    struct alignas(64) WaitWord {
+        std::atomic<int32_t> seq{0};          // bumped to wake sleepers
+        std::atomic<int32_t> waiters{0};      // threads registered to sleep
+        std::atomic<bool> wake_pending{false};// a wake was issued and no sleeper has run since
+    };
+
+    // Wakes sleepers, if there are any. The fence orders the cell hand-over
+    // before the waiter check (a waiter registers before its last look at the
+    // queue), so the uncontended path never writes the shared word. While a
+    // wake is pending, further signals skip the system call.
+    static void signal(WaitWord& word, size_t count = 1) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (word.waiters.load(std::memory_order_relaxed) > 0 &&
+            !word.wake_pending.exchange(true, std::memory_order_seq_cst)) {
+            word.seq.fetch_add(1, std::memory_order_seq_cst);
+            futex_wake(&word.seq, count > INT32_MAX ? INT32_MAX : static_cast<int>(count));
+        }
+    }
+
+    // Spins until ready() or the spin budget runs out (no spinning on a single
+    // core), then sleeps on `word` for at most timeout_us. Callers re-check
+    // their condition.
+    template <typename Ready>
+    void wait_for(WaitWord& word, Ready ready, uint32_t timeout_us) {
+        static const int spin_count = std::thread::hardware_concurrency() > 1 ? SPIN_COUNT : 0;
+        for (int i = 0; i < spin_count; i++) {
+            if (ready() || is_interrupted()) return;
+            cpu_relax();
+        }
+        int32_t observed = word.seq.load(std::memory_order_seq_cst);
+        word.waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in signal()
+        if (!ready() && !is_interrupted()) {
+            futex_wait(&word.seq, observed, timeout_us);
+        }
+        word.waiters.fetch_sub(1, std::memory_order_seq_cst);
+        // Re-arm signal(); if others still sleep and the condition already
+        // holds, pass the wake on so they do not wait for the next signal
+        if (word.wake_pending.exchange(false, std::memory_order_seq_cst) && ready()) {
+            signal(word);
+        }
+    }
+
+    static uint32_t remaining_us(std::chrono::steady_clock::time_point deadline) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return 0;
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+        return us < 1 ? 1 : (us > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us));
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    std::atomic<bool> interrupted_;
+    alignas(64) std::atomic<size_t> tail_{0};           // producers
+    alignas(64) std::atomic<size_t> head_{0};           // consumers
+    WaitWord items_;                                    // consumers wait here for pushes
+    WaitWord space_;                                    // producers wait here for pops
+};
+
+#endif // MPMC_QUEUE_H
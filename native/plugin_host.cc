@@ -0,0 +1,202 @@
+#include "plugin_host.h"
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+#include "epoch_reclaim.h"
+#include "timer_wheel.h"
+
+namespace fs = std::filesystem;
+
+static uint64_t elapsed_us(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+// Copies the library to a unique name in the temp directory so the loader
+// maps a fresh instance instead of the one that is already open
+static std::string make_shadow_copy(const std::string& path, uint32_t generation) {
+    fs::path source(path);
+    uint64_t stamp = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    fs::path target = fs::temp_directory_path() /
+        (source.stem().string() + ".reload-" + std::to_string(generation) + "-" +
+         std::to_string(stamp) + source.extension().string());
+    std::error_code ec;
+    fs::copy_file(source, target, fs::copy_options::overwrite_existing, ec);
+    return ec ? std::string() : target.string();
+}
+
+PluginHost::PluginHost() : current_(nullptr), generation_(0), retiring_(false) {}
+
+PluginHost::~PluginHost() {
+    unload();
+}
+
+std::string PluginHost::load(const std::string& path, const Callbacks& callbacks, LoadTimes* times) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto start = std::chrono::steady_clock::now();
+
+    Loaded* old = current_.load(std::memory_order_acquire);
+    uint32_t generation = generation_.load(std::memory_order_relaxed) + 1;
+    Loaded* next = new Loaded();
+    next->path = path;
+    next->generation = generation;
+    // Each plugin gets its own copy of the v2 host API so its timers can be told apart
+    Callbacks plugin_callbacks = callbacks;
+    if (callbacks.api) {
+        next->api = *callbacks.api;
+        plugin_callbacks.api = &next->api;
+    }
+
+    std::string open_path = path;
+    if (old) {
+        next->shadow_path = make_shadow_copy(path, generation);
+        if (next->shadow_path.empty()) {
+            delete next;
+            stats_.failures++;
+            return "could not copy '" + path + "' for reloading";
+        }
+        open_path = next->shadow_path;
+    }
+
+    std::string error;
+    if (!next->loader.load(open_path)) {
+        error = "failed to load '" + path + "'";
+    } else {
+        uint32_t caps = next->loader.capabilities();
+        next->concurrent = (caps & PLUGIN_CAP_CONCURRENT) != 0;
+        // acquire_tx reads this from the plugin's copy to cap the slot count
+        if (!(caps & PLUGIN_CAP_MULTI_TX)) next->api.capabilities &= ~PLUGIN_HOST_CAP_MULTI_TX;
+        PluginStatus status = next->loader.initialize(plugin_callbacks);
+        if (status != PLUGIN_SUCCESS) {
+            close_plugin(next);
+            error = "plugin initialize() failed with status " + std::to_string(status);
+        }
+    }
+    if (!error.empty()) {
+        if (!next->shadow_path.empty()) {
+            std::error_code ec;
+            fs::remove(next->shadow_path, ec);
+        }
+        delete next;
+        stats_.failures++;
+        return error;
+    }
+    uint64_t load_us = elapsed_us(start);
+
+    // One retirement at a time: wait for the previous reload's drain
+    join_reaper();
+
+    auto swap_start = std::chrono::steady_clock::now();
+    current_.store(next, std::memory_order_seq_cst);
+    generation_.store(generation, std::memory_order_release);
+    uint64_t swap_us = elapsed_us(swap_start);
+
+    stats_.loads++;
+    stats_.lastLoadUs = load_us;
+    stats_.lastSwapUs = swap_us;
+    if (old) {
+        stats_.reloads++;
+        retire(old);
+    }
+    if (times) {
+        times->generation = generation;
+        times->load_us = load_us;
+        times->swap_us = swap_us;
+    }
+    return std::string();
+}
+
+void PluginHost::unload() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    join_reaper();
+    Loaded* old = current_.exchange(nullptr, std::memory_order_seq_cst);
+    if (old) drain(old);
+}
+
+std::unique_lock<std::mutex> PluginHost::enter(Loaded* plugin) {
+    return plugin->concurrent ? std::unique_lock<std::mutex>() : std::unique_lock<std::mutex>(plugin->serial);
+}
+
+bool PluginHost::process_message(const uint8_t* data, size_t length) {
+    EpochGuard guard;
+    Loaded* plugin = current_.load(std::memory_order_acquire);
+    if (!plugin) return false;
+    auto lock = enter(plugin);
+    plugin->loader.process_message(data, length);
+    return true;
+}
+
+bool PluginHost::process_batch(PluginMessage* messages, size_t count) {
+    EpochGuard guard;
+    Loaded* plugin = current_.load(std::memory_order_acquire);
+    if (!plugin) return false;
+    auto lock = enter(plugin);
+    plugin->loader.process_batch(messages, count);
+    return true;
+}
+
+bool PluginHost::wants_update() const {
+    EpochGuard guard;
+    Loaded* plugin = current_.load(std::memory_order_acquire);
+    return plugin && plugin->loader.wants_update();
+}
+
+uint32_t PluginHost::api_version() const {
+    EpochGuard guard;
+    Loaded* plugin = current_.load(std::memory_order_acquire);
+    return plugin ? plugin->loader.api_version() : 0;
+}
+
+uint32_t PluginHost::capabilities() const {
+    EpochGuard guard;
+    Loaded* plugin = current_.load(std::memory_order_acquire);
+    return plugin ? plugin->loader.capabilities() : 0;
+}
+
+void PluginHost::update() {
+    EpochGuard guard;
+    Loaded* plugin = current_.load(std::memory_order_acquire);
+    if (!plugin) return;
+    auto lock = enter(plugin);
+    plugin->loader.update();
+}
+
+std::string PluginHost::path() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Loaded* plugin = current_.load(std::memory_order_acquire);
+    return plugin ? plugin->path : std::string();
+}
+
+void PluginHost::retire(Loaded* old) {
+    retiring_.store(true, std::memory_order_release);
+    reaper_ = std::thread([this, old] {
+        drain(old);
+        retiring_.store(false, std::memory_order_release);
+    });
+}
+
+void PluginHost::join_reaper() {
+    if (reaper_.joinable()) reaper_.join();
+}
+
+void PluginHost::close_plugin(Loaded* plugin) {
+    // Timers first, so none fires during or after shutdown(); add_timer from
+    // inside shutdown() is refused until the library is gone. The owner is
+    // then reopened because a later plugin may get the same address.
+    TimerWheel::global().close_owner(&plugin->api);
+    plugin->loader.unload();
+    TimerWheel::global().reopen_owner(&plugin->api);
+}
+
+void PluginHost::drain(Loaded* old) {
+    auto start = std::chrono::steady_clock::now();
+    // After the grace period no dispatch thread can still be inside `old`
+    EpochDomain::global().synchronize();
+    close_plugin(old);
+    if (!old->shadow_path.empty()) {
+        std::error_code ec;
+        fs::remove(old->shadow_path, ec);
+    }
+    delete old;
+    stats_.lastDrainUs = elapsed_us(start);
+}
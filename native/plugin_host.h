@@ -0,0 +1,109 @@
+#ifndef PLUGIN_HOST_H
+#define PLUGIN_HOST_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "plugin_loader.h"
+
+// One hot-swappable plugin slot.
+//
+// load() on an occupied slot does not unload first: the new library is
+// loaded and initialized next to the running one, the dispatch pointer is
+// swapped, and the old plugin is retired on a background thread. That thread
+// waits for an epoch grace period (every process_message()/update() that
+// could still see the old pointer has returned), then calls its shutdown()
+// and closes the library. Dispatch threads never block on a reload, and
+// every message reaches exactly one of the two plugins.
+//
+// Calls into a plugin that does not declare PLUGIN_CAP_CONCURRENT (every v1
+// plugin) are serialized per instance, whichever threads dispatch. Its copy
+// of the host API loses PLUGIN_HOST_CAP_MULTI_TX unless it declares
+// PLUGIN_CAP_MULTI_TX.
+//
+// A v2 plugin's host timers are cancelled (waiting for a running callback)
+// before its shutdown(), and add_timer is refused from then until the
+// library is closed, so no timer fires into a closed library.
+//
+// While a plugin is loaded, a reload of the same file is opened from a
+// private copy, because dlopen() would otherwise hand back the running
+// library with its globals.
+class PluginHost {
+public:
+    using Callbacks = PluginHostCallbacks;
+
+    // Timings of one load(), in microseconds
+    struct LoadTimes {
+        uint32_t generation = 0;
+        uint64_t load_us = 0;   // open the library and initialize() it
+        uint64_t swap_us = 0;   // publish it to the dispatch threads
+    };
+
+    struct ReloadStats {
+        std::atomic<uint64_t> loads{0};
+        std::atomic<uint64_t> reloads{0};     // loads that replaced a running plugin
+        std::atomic<uint64_t> failures{0};
+        std::atomic<uint64_t> lastLoadUs{0};
+        std::atomic<uint64_t> lastSwapUs{0};
+        std::atomic<uint64_t> lastDrainUs{0}; // grace period + shutdown + close
+    };
+
+    PluginHost();
+    ~PluginHost();
+
+    PluginHost(const PluginHost&) = delete;
+    PluginHost& operator=(const PluginHost&) = delete;
+
+    // Loads `path` and swaps it in. Returns an empty string on success,
+    // otherwise the reason; the running plugin is untouched on failure.
+    std::string load(const std::string& path, const Callbacks& callbacks, LoadTimes* times = nullptr);
+
+    // Unpublishes the plugin and waits until it is shut down and closed
+    void unload();
+
+    // Dispatch side; safe to call from any thread during load()/unload().
+    // process_message() returns false when no plugin is loaded.
+    bool process_message(const uint8_t* data, size_t length);
+    bool process_batch(PluginMessage* messages, size_t count);
+    void update();
+
+    bool is_loaded() const { return current_.load(std::memory_order_acquire) != nullptr; }
+    uint32_t generation() const { return generation_.load(std::memory_order_acquire); }
+    bool retiring() const { return retiring_.load(std::memory_order_acquire); }
+    uint32_t api_version() const;
+    uint32_t capabilities() const;  // PLUGIN_CAP_* of the current plugin
+    bool wants_update() const;
+    std::string path() const;
+
+    const ReloadStats& stats() const { return stats_; }
+
+private:
+    struct Loaded {
+        PluginLoader loader;
+        PluginHostApi api{};      // per-plugin copy; its address owns the plugin's timers
+        std::string path;         // as requested
+        std::string shadow_path;  // private copy that was opened, if any
+        uint32_t generation = 0;
+        bool concurrent = false;  // PLUGIN_CAP_CONCURRENT
+        std::mutex serial;        // held around every call when !concurrent
+    };
+
+    // Locked unless the plugin may be entered from several threads at once
+    static std::unique_lock<std::mutex> enter(Loaded* plugin);
+
+    void retire(Loaded* old);  // caller holds mutex_
+    void join_reaper();        // caller holds mutex_
+    void drain(Loaded* old);
+    static void close_plugin(Loaded* plugin);  // timers, shutdown(), library
+
+    std::atomic<Loaded*> current_;
+    std::atomic<uint32_t> generation_;
+    std::atomic<bool> retiring_;
+    mutable std::mutex mutex_;  // serializes load()/unload()
+    std::thread reaper_;
+    ReloadStats stats_;
+};
+
+#endif // PLUGIN_HOST_H
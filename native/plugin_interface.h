@@ -8,8 +8,10 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h>
 
-// Plugin API version
+// Plugin API version (v1 layout, PluginInterface)
 #define PLUGIN_API_VERSION 1
+// Batched v2 layout (PluginInterfaceV2)
+#define PLUGIN_API_VERSION_2 2
 
 // Plugin initialization status
 typedef enum {
@@ -54,6 +56,111 @@ typedef struct {
     void (*update)();
 } PluginInterface;
 
+// ---------------------------------------------------------------------------
+// API v2
+//
+// A v2 plugin exports get_plugin_interface_v2(). The host looks for it first
+// and falls back to get_plugin_interface() (v1), so a plugin may export both
+// to keep loading in older hosts. Both structures start with PluginInfo and
+// info.api_version must match the layout.
+// ---------------------------------------------------------------------------
+
+// Plugin capability flags (PluginInterfaceV2.capabilities)
+#define PLUGIN_CAP_RETAIN     0x1u  // may keep received buffers past process_batch (see PluginMessage)
+#define PLUGIN_CAP_MULTI_TX   0x2u  // holds several acquire_tx slots at once
+#define PLUGIN_CAP_CONCURRENT 0x4u  // process_batch and update may run on several host threads at once;
+                                    // without it the host makes one call at a time, in message order
+#define PLUGIN_CAP_TIMERS     0x8u  // schedules its own work with add_timer; update() is never called
+
+// Host capability flags (PluginHostApi.capabilities)
+#define PLUGIN_HOST_CAP_RETAIN   0x1u  // queued messages can be retained
+#define PLUGIN_HOST_CAP_MULTI_TX 0x2u  // acquire_tx can return more than one slot
+#define PLUGIN_HOST_CAP_TIMERS   0x4u  // add_timer / cancel_timer are available
+
+// PluginMessage.flags
+#define PLUGIN_MSG_RETAINABLE 0x1u  // in:  the plugin may retain this buffer
+#define PLUGIN_MSG_RETAINED   0x2u  // out: the plugin kept it and will call release(token)
+
+// One R->N message. `data` stays valid until process_batch returns, unless
+// the plugin (with PLUGIN_CAP_RETAIN) sets PLUGIN_MSG_RETAINED on a message
+// marked PLUGIN_MSG_RETAINABLE; then it stays valid until the plugin passes
+// `token` to PluginHostApi.release(). Messages that are not retainable point
+// into the shared buffer and must be copied to be kept.
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    uint64_t token;
+    uint32_t flags;
+    uint32_t reserved;
+} PluginMessage;
+
+// One N->R output slot from acquire_tx. `handle` and `kind` belong to the host.
+typedef struct {
+    uint8_t* data;
+    uint32_t capacity;
+    uint32_t kind;
+    uint64_t handle;
+} PluginTxSlot;
+
+// Runs on the host timer thread, concurrently with process_batch
+typedef void (*PluginTimerCallback)(void* user);
+
+typedef struct PluginHostApi PluginHostApi;
+
+struct PluginHostApi {
+    uint32_t api_version;   // PLUGIN_API_VERSION_2
+    uint32_t capabilities;  // PLUGIN_HOST_CAP_*
+
+    // Copies one message to the renderer
+    MessageCallback send_message;
+
+    // Fills up to `count` slots, waiting at most wait_ms for the first one.
+    // Returns how many were acquired (at least 1), or a negative error.
+    // Without PLUGIN_HOST_CAP_MULTI_TX in self->capabilities at most one slot
+    // is handed out; a plugin's copy only has it if the plugin declared
+    // PLUGIN_CAP_MULTI_TX.
+    int (*acquire_tx)(const PluginHostApi* self, uint32_t wait_ms, PluginTxSlot* slots, uint32_t count);
+
+    // Publishes `length` bytes of an acquired slot; length 0 gives it back.
+    // Returns 0 on success. Slots may be committed in any order and from any
+    // thread.
+    int (*commit_tx)(const PluginTxSlot* slot, uint32_t length);
+
+    // Returns a buffer retained from process_batch
+    void (*release)(uint64_t token);
+
+    // Runs `callback` after delay_ms, then every period_ms (0 = once).
+    // Deadlines in the same millisecond share one wakeup. Returns a timer id,
+    // 0 on failure. `self` is the PluginHostApi the plugin was initialized
+    // with; its timers are cancelled before shutdown() is called, and
+    // add_timer fails from then on (also from inside shutdown()).
+    uint64_t (*add_timer)(const PluginHostApi* self, uint32_t delay_ms, uint32_t period_ms,
+                          PluginTimerCallback callback, void* user);
+
+    // Returns 0 once the timer is cancelled and its callback is not running
+    // (unless called from that callback), -1 if the id is unknown or the
+    // timer belongs to another plugin.
+    int (*cancel_timer)(const PluginHostApi* self, uint64_t timer_id);
+};
+
+typedef struct {
+    // info.api_version == PLUGIN_API_VERSION_2
+    PluginInfo info;
+    uint32_t capabilities;  // PLUGIN_CAP_*
+    uint32_t max_batch;     // most messages per process_batch call, 0 = host default
+
+    PluginStatus (*initialize)(const PluginHostApi* host);
+
+    // Must release every retained buffer before returning
+    void (*shutdown)();
+
+    // Messages in arrival order
+    void (*process_batch)(PluginMessage* messages, size_t count);
+
+    // Called periodically by the host; may be NULL with PLUGIN_CAP_TIMERS
+    void (*update)();
+} PluginInterfaceV2;
+
 // Plugin entry point - must be implemented by each plugin
 #ifdef _WIN32
     #define PLUGIN_EXPORT __declspec(dllexport)
@@ -62,6 +169,7 @@ typedef struct {
 #endif
 
 PLUGIN_EXPORT const PluginInterface* get_plugin_interface();
+PLUGIN_EXPORT const PluginInterfaceV2* get_plugin_interface_v2();
 
 #ifdef __cplusplus
 }
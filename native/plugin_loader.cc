@@ -8,7 +8,7 @@
     #include <dlfcn.h>
 #endif
 
-PluginLoader::PluginLoader() : library_(nullptr), interface_(nullptr), loaded_(false) {}
+PluginLoader::PluginLoader() : library_(nullptr), interface_(nullptr), interface_v2_(nullptr), loaded_(false) {}
 
 PluginLoader::~PluginLoader() {
     unload();
@@ -25,6 +25,22 @@ bool PluginLoader::load(const std::string& path) {
         return false;
     }
 
+    // Prefer the v2 interface; fall back to v1
+    using GetPluginInterfaceV2 = const PluginInterfaceV2* (*)();
+    auto get_interface_v2 = reinterpret_cast<GetPluginInterfaceV2>(get_symbol("get_plugin_interface_v2"));
+    if (get_interface_v2) {
+        const PluginInterfaceV2* iface = get_interface_v2();
+        if (iface && iface->info.api_version == PLUGIN_API_VERSION_2 && iface->initialize &&
+            iface->shutdown && iface->process_batch &&
+            (iface->update || (iface->capabilities & PLUGIN_CAP_TIMERS))) {
+            interface_v2_ = iface;
+            loaded_ = true;
+            return true;
+        }
+        std::cerr << "Plugin v2 interface unusable (api_version "
+                  << (iface ? iface->info.api_version : 0) << "), trying v1" << std::endl;
+    }
+
     // Get the plugin interface
     using GetPluginInterface = const PluginInterface* (*)();
     auto get_interface = reinterpret_cast<GetPluginInterface>(get_symbol("get_plugin_interface"));
@@ -46,6 +62,7 @@ bool PluginLoader::load(const std::string& path) {
     if (interface_->info.api_version != PLUGIN_API_VERSION) {
         std::cerr << "Plugin API version mismatch. Expected " << PLUGIN_API_VERSION 
                   << ", got " << interface_->info.api_version << std::endl;
+        interface_ = nullptr;
         free_library();
         return false;
     }
@@ -57,10 +74,13 @@ bool PluginLoader::load(const std::string& path) {
 void PluginLoader::unload() {
     if (loaded_ && interface_) {
         interface_->shutdown();
+    } else if (loaded_ && interface_v2_) {
+        interface_v2_->shutdown();
     }
     
     free_library();
     interface_ = nullptr;
+    interface_v2_ = nullptr;
     loaded_ = false;
 }
 
@@ -68,22 +88,81 @@ bool PluginLoader::is_loaded() const {
     return loaded_;
 }
 
+uint32_t PluginLoader::api_version() const {
+    if (interface_v2_) return PLUGIN_API_VERSION_2;
+    return interface_ ? PLUGIN_API_VERSION : 0;
+}
+
+uint32_t PluginLoader::capabilities() const {
+    return interface_v2_ ? interface_v2_->capabilities : 0;
+}
+
+const PluginInfo* PluginLoader::info() const {
+    if (interface_v2_) return &interface_v2_->info;
+    return interface_ ? &interface_->info : nullptr;
+}
+
 const PluginInterface* PluginLoader::get_interface() const {
     return interface_;
 }
 
+PluginStatus PluginLoader::initialize(const PluginHostCallbacks& callbacks) {
+    if (!loaded_) return PLUGIN_ERROR_INITIALIZATION;
+    if (interface_v2_) {
+        if (!callbacks.api) return PLUGIN_ERROR_INVALID_VERSION;
+        return interface_v2_->initialize(callbacks.api);
+    }
+    return interface_->initialize(callbacks.message, callbacks.buffer_request, callbacks.buffer_send);
+}
+
 void PluginLoader::process_message(const uint8_t* data, size_t length) {
     if (loaded_ && interface_) {
         interface_->process_message(data, length);
+    } else if (loaded_ && interface_v2_) {
+        PluginMessage message = {data, length, 0, 0, 0};
+        interface_v2_->process_batch(&message, 1);
+    }
+}
+
+void PluginLoader::process_batch(PluginMessage* messages, size_t count) {
+    if (!loaded_) return;
+    if (interface_) {
+        for (size_t i = 0; i < count; i++) {
+            messages[i].flags &= ~PLUGIN_MSG_RETAINED;
+            interface_->process_message(messages[i].data, messages[i].length);
+        }
+        return;
+    }
+    if (!interface_v2_) return;
+
+    size_t max_batch = interface_v2_->max_batch > 0 ? interface_v2_->max_batch : DEFAULT_MAX_BATCH;
+    for (size_t done = 0; done < count; done += max_batch) {
+        size_t n = count - done < max_batch ? count - done : max_batch;
+        interface_v2_->process_batch(messages + done, n);
+    }
+    // Only a plugin that declared PLUGIN_CAP_RETAIN may keep a retainable buffer
+    bool may_retain = (interface_v2_->capabilities & PLUGIN_CAP_RETAIN) != 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!may_retain || !(messages[i].flags & PLUGIN_MSG_RETAINABLE)) {
+            messages[i].flags &= ~PLUGIN_MSG_RETAINED;
+        }
     }
 }
 
 void PluginLoader::update() {
     if (loaded_ && interface_) {
         interface_->update();
+    } else if (loaded_ && wants_update()) {
+        interface_v2_->update();
     }
 }
 
+bool PluginLoader::wants_update() const {
+    if (!loaded_) return false;
+    if (interface_) return true;
+    return interface_v2_->update && !(interface_v2_->capabilities & PLUGIN_CAP_TIMERS);
+}
+
 #ifdef _WIN32
 bool PluginLoader::load_library(const std::string& path) {
     library_ = LoadLibraryA(path.c_str());
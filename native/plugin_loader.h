@@ -12,8 +12,23 @@ typedef HMODULE LibraryHandle;
 typedef void* LibraryHandle;
 #endif
 
+// Everything the host offers a plugin; each one gets the part its API
+// version understands
+struct PluginHostCallbacks {
+    MessageCallback message;
+    BufferRequestCallback buffer_request;
+    BufferSendCallback buffer_send;
+    const PluginHostApi* api;  // v2 plugins fail to initialize without it
+};
+
+// Loads v1 and v2 plugins behind one interface. v1 plugins get batches as
+// one process_message() call per message; v2 plugins get single messages
+// as a batch of one.
 class PluginLoader {
 public:
+    // Messages per process_batch call when the plugin sets no max_batch
+    static constexpr uint32_t DEFAULT_MAX_BATCH = 32;
+
     PluginLoader();
     ~PluginLoader();
 
@@ -26,18 +41,37 @@ public:
     // Check if a plugin is loaded
     bool is_loaded() const;
     
-    // Get the plugin interface
+    // Negotiated API version (0 when nothing is loaded)
+    uint32_t api_version() const;
+
+    // PLUGIN_CAP_* of a v2 plugin, 0 for v1
+    uint32_t capabilities() const;
+
+    // Name, version and api_version of the loaded plugin
+    const PluginInfo* info() const;
+
+    // Get the v1 plugin interface (nullptr for v2 plugins)
     const PluginInterface* get_interface() const;
+
+    PluginStatus initialize(const PluginHostCallbacks& callbacks);
     
     // Process message through the plugin
     void process_message(const uint8_t* data, size_t length);
+
+    // Process messages in order. PLUGIN_MSG_RETAINED is only left set on
+    // messages a PLUGIN_CAP_RETAIN plugin kept; the caller releases the rest.
+    void process_batch(PluginMessage* messages, size_t count);
     
-    // Update the plugin
+    // Update the plugin (no-op for v2 plugins with PLUGIN_CAP_TIMERS)
     void update();
 
+    // False for plugins that drive themselves with host timers
+    bool wants_update() const;
+
 private:
     LibraryHandle library_;
     const PluginInterface* interface_;
+    const PluginInterfaceV2* interface_v2_;
     bool loaded_;
 
     // Platform-specific functions
@@ -0,0 +1,235 @@
+#include "plugin_registry.h"
+#include <cstring>
+#include <mutex>
+#include "timer_wheel.h"
+
+// BPG frame prefix as written by BPG_Protocol.ts / bpg_types.h
+static const uint8_t BPG_MAGIC_BYTES[4] = {'B', 'P', 'G', 0x01};
+static const size_t BPG_TL_OFFSET = 4;
+static const size_t BPG_TARGET_OFFSET = 10;  // after magic(4) + TL(2) + prop(4)
+static const size_t BPG_ROUTING_BYTES = 14;
+
+std::string PluginRegistry::add(const std::string& name, const std::string& path, const PluginRoute& route,
+                                uint32_t queue_depth, const HostCallbacks& host) {
+    if (name.empty()) return "plugin name must not be empty";
+    for (const std::string& tl : route.tl_prefixes) {
+        if (tl.size() != 2) return "TL prefixes must be two characters";
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const std::shared_ptr<Slot>& slot : plugins_) {
+            if (slot->name == name) return "a plugin named '" + name + "' is already registered";
+            // dlopen would hand back the same library and its globals
+            if (slot->path == path) return "'" + path + "' is already loaded as '" + slot->name + "'";
+        }
+        for (uint32_t target : route.targets) {
+            if (by_target_.count(target)) return "target_id " + std::to_string(target) + " is already routed";
+        }
+        for (const std::string& tl : route.tl_prefixes) {
+            if (by_tl_.count(tl_key(tl.c_str()))) return "TL '" + tl + "' is already routed";
+        }
+        if (route.is_default && default_) return "a default plugin is already registered";
+    }
+
+    auto slot = std::make_shared<Slot>(name, path, route, queue_depth > 0 ? queue_depth : DEFAULT_QUEUE_DEPTH, host);
+    std::string error = slot->host.load(path, host);
+    if (!error.empty()) return error;
+    slot->worker = std::thread(&PluginRegistry::worker_loop, this, slot.get());
+    Slot* s = slot.get();
+    slot->update_timer = TimerWheel::global().schedule(UPDATE_INTERVAL_US, UPDATE_INTERVAL_US, [s] {
+        // Plugins on host timers are not woken just to skip update(); one
+        // tick in the queue is enough, a busy worker sees the flag anyway
+        if (s->host.wants_update() && !s->update_due.exchange(true)) s->queue.try_push(nullptr);
+    }, s);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    plugins_.push_back(slot);
+    rebuild_routes();
+    count_.store(plugins_.size(), std::memory_order_release);
+    return std::string();
+}
+
+bool PluginRegistry::remove(const std::string& name) {
+    std::shared_ptr<Slot> slot;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (auto it = plugins_.begin(); it != plugins_.end(); ++it) {
+            if ((*it)->name == name) {
+                slot = *it;
+                plugins_.erase(it);
+                break;
+            }
+        }
+        if (!slot) return false;
+        rebuild_routes();
+        count_.store(plugins_.size(), std::memory_order_release);
+    }
+    // No new messages are routed to it now; finish the queued ones
+    stop(slot.get());
+    return true;
+}
+
+std::string PluginRegistry::reload(const std::string& name, const std::string& path, PluginHost::LoadTimes* times) {
+    std::shared_ptr<Slot> slot;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const std::shared_ptr<Slot>& s : plugins_) {
+            if (s->name == name) slot = s;
+            else if (s->path == path) return "'" + path + "' is already loaded as '" + s->name + "'";
+        }
+    }
+    if (!slot) return "no plugin named '" + name + "' is registered";
+
+    // The worker keeps draining the queue into whichever library is current
+    std::string error = slot->host.load(path, slot->callbacks, times);
+    if (!error.empty()) return error;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    slot->path = path;
+    return std::string();
+}
+
+void PluginRegistry::clear() {
+    std::vector<std::shared_ptr<Slot>> plugins;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        plugins.swap(plugins_);
+        rebuild_routes();
+        count_.store(0, std::memory_order_release);
+    }
+    for (const std::shared_ptr<Slot>& slot : plugins) stop(slot.get());
+}
+
+bool PluginRegistry::dispatch(const uint8_t* data, size_t length, const std::atomic<bool>& operating) {
+    std::shared_ptr<Slot> slot = lookup(data, length);
+    if (!slot) return false;
+    PluginCounters& counters = slot->counters;
+
+    PooledBuffer* buf = pool_.acquire(length);
+    if (!buf) {
+        counters.dropped++;
+        return true;
+    }
+    memcpy(buf->data, data, length);
+    buf->length = length;
+    buf->enqueue_ns = LatencyHistogram::now_ns();
+
+    bool pushed = slot->queue.try_push(buf);
+    if (!pushed) {
+        counters.backpressureStalls++;
+        // Wait in slices so a stopping channel or plugin is noticed
+        while (!pushed && operating && !slot->queue.is_interrupted()) {
+            pushed = slot->queue.push(std::move(buf), MpmcQueue<PooledBuffer*>::WAIT_SLICE_US);
+        }
+    }
+    if (!pushed) {
+        pool_.release(buf);
+        counters.dropped++;
+        return true;
+    }
+
+    uint32_t depth = static_cast<uint32_t>(slot->queue.size());
+    uint32_t prev = counters.maxDepth.load(std::memory_order_relaxed);
+    while (depth > prev && !counters.maxDepth.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {}
+    return true;
+}
+
+bool PluginRegistry::peek_frame(const uint8_t* data, size_t length, uint32_t* target_id, uint16_t* tl) {
+    if (length < BPG_ROUTING_BYTES || memcmp(data, BPG_MAGIC_BYTES, sizeof(BPG_MAGIC_BYTES)) != 0) {
+        return false;
+    }
+    const uint8_t* t = data + BPG_TARGET_OFFSET;
+    *target_id = (static_cast<uint32_t>(t[0]) << 24) | (static_cast<uint32_t>(t[1]) << 16) |
+                 (static_cast<uint32_t>(t[2]) << 8) | static_cast<uint32_t>(t[3]);
+    *tl = tl_key(reinterpret_cast<const char*>(data + BPG_TL_OFFSET));
+    return true;
+}
+
+std::shared_ptr<PluginRegistry::Slot> PluginRegistry::lookup(const uint8_t* data, size_t length) {
+    uint32_t target_id;
+    uint16_t tl;
+    if (!peek_frame(data, length, &target_id, &tl)) {
+        // Rest of a frame that did not fit into the previous message
+        std::shared_ptr<Slot> slot = continuation_.lock();
+        if (slot) return slot;
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return default_;
+    }
+
+    std::shared_ptr<Slot> slot;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto by_target = by_target_.find(target_id);
+        if (by_target != by_target_.end()) {
+            slot = by_target->second;
+        } else {
+            auto by_tl = by_tl_.find(tl);
+            slot = by_tl != by_tl_.end() ? by_tl->second : default_;
+        }
+    }
+    continuation_ = slot;
+    return slot;
+}
+
+void PluginRegistry::rebuild_routes() {
+    by_target_.clear();
+    by_tl_.clear();
+    default_.reset();
+    for (const std::shared_ptr<Slot>& slot : plugins_) {
+        for (uint32_t target : slot->route.targets) by_target_[target] = slot;
+        for (const std::string& tl : slot->route.tl_prefixes) by_tl_[tl_key(tl.c_str())] = slot;
+        if (slot->route.is_default) default_ = slot;
+    }
+}
+
+void PluginRegistry::worker_loop(Slot* slot) {
+    PluginCounters& counters = slot->counters;
+    PooledBuffer* bufs[PluginLoader::DEFAULT_MAX_BATCH];
+    PluginMessage batch[PluginLoader::DEFAULT_MAX_BATCH];
+    while (true) {
+        if (slot->queue.wait_and_pop(bufs[0], IDLE_WAIT_US)) {
+            // Hand over whatever else is already queued in the same call
+            size_t popped = 1 + slot->queue.pop_n(bufs + 1, PluginLoader::DEFAULT_MAX_BATCH - 1);
+            size_t count = 0;
+            for (size_t i = 0; i < popped; i++) {
+                if (bufs[i]) bufs[count++] = bufs[i];  // drop update ticks
+            }
+            for (size_t i = 0; i < count; i++) {
+                counters.queueLatency.record_since(bufs[i]->enqueue_ns);
+                batch[i] = {bufs[i]->data, bufs[i]->length, reinterpret_cast<uint64_t>(bufs[i]),
+                            PLUGIN_MSG_RETAINABLE, 0};
+            }
+            uint64_t start = LatencyHistogram::now_ns();
+            if (count > 0) slot->host.process_batch(batch, count);
+            counters.processTime.record_since(start);
+            counters.messages += count;
+            for (size_t i = 0; i < count; i++) {
+                counters.bytes += bufs[i]->length;
+                if (batch[i].flags & PLUGIN_MSG_RETAINED) {
+                    counters.retained++;  // the plugin calls PluginHostApi.release()
+                } else {
+                    pool_.release(bufs[i]);
+                }
+            }
+        } else if (slot->queue.is_interrupted() && slot->queue.empty()) {
+            return;
+        }
+
+        if (slot->update_due.load(std::memory_order_relaxed) && slot->update_due.exchange(false)) {
+            slot->host.update();
+        }
+    }
+}
+
+void PluginRegistry::stop(Slot* slot) {
+    // Waits for a tick that is being queued right now
+    if (slot->update_timer) TimerWheel::global().cancel(slot->update_timer);
+    slot->queue.interrupt();
+    if (slot->worker.joinable()) slot->worker.join();
+    PooledBuffer* buf;
+    while (slot->queue.try_pop(buf)) {
+        if (!buf) continue;
+        pool_.release(buf);
+        slot->counters.dropped++;
+    }
+    slot->host.unload();
+}
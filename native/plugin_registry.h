@@ -0,0 +1,145 @@
+#ifndef PLUGIN_REGISTRY_H
+#define PLUGIN_REGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "buffer_pool.h"
+#include "latency_histogram.h"
+#include "mpmc_queue.h"
+#include "plugin_host.h"
+
+// Several plugins loaded side by side (e.g. camera, inference, logging), each
+// running on its own worker thread behind its own bounded queue.
+//
+// R->N messages are routed by peeking at the BPG frame header at the start of
+// the message ('BPG\x01', TL(2), prop(4), target_id(4) ...): first by
+// target_id, then by the two-character TL, then to the default plugin.
+// Messages that do not start with a frame header are continuations of the
+// previous message and go to the same plugin. Lookups are hash-map hits
+// under a shared lock; the table only changes on add()/remove().
+//
+// Each plugin's update() is called from its own worker thread, so a plugin
+// is only ever entered from one thread. A periodic host timer marks it due
+// and, if the worker sleeps, queues a tick (a null buffer) to wake it; an
+// idle plugin on its own timers is never woken. reload() hot-swaps a plugin's
+// library under its worker (see PluginHost) without touching its routes or
+// queue.
+
+// Which messages a plugin claims
+struct PluginRoute {
+    std::vector<uint32_t> targets;        // BPG target_ids
+    std::vector<std::string> tl_prefixes; // two-character BPG packet types
+    bool is_default = false;              // everything nobody else claims
+};
+
+struct PluginCounters {
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> dropped{0};            // queue closed or no pooled buffer
+    std::atomic<uint64_t> backpressureStalls{0}; // receive thread found the queue full
+    std::atomic<uint64_t> retained{0};           // buffers a v2 plugin kept past process_batch
+    std::atomic<uint32_t> maxDepth{0};
+    LatencyHistogram queueLatency;               // routed -> plugin called
+    LatencyHistogram processTime;                // time spent per process_batch call
+};
+
+class PluginRegistry {
+public:
+    static constexpr uint32_t DEFAULT_QUEUE_DEPTH = 64;
+    static constexpr uint32_t UPDATE_INTERVAL_US = 1000;  // update() period
+    static constexpr uint32_t IDLE_WAIT_US = 100000;      // longest wait for a message or a tick
+
+    using HostCallbacks = PluginHost::Callbacks;
+
+    // Read-only view of one plugin for stats reporting
+    struct PluginView {
+        const std::string& name;
+        const std::string& path;
+        const PluginRoute& route;
+        const PluginCounters& counters;
+        const PluginHost& host;
+        size_t depth;
+        size_t capacity;
+    };
+
+    PluginRegistry() : count_(0) {}
+    ~PluginRegistry() { clear(); }
+
+    PluginRegistry(const PluginRegistry&) = delete;
+    PluginRegistry& operator=(const PluginRegistry&) = delete;
+
+    // Loads and initializes a plugin and starts its worker. Returns an empty
+    // string on success, otherwise the reason it was refused.
+    std::string add(const std::string& name, const std::string& path, const PluginRoute& route,
+                    uint32_t queue_depth, const HostCallbacks& host);
+
+    // Unroutes the plugin, lets its worker drain the queue, then unloads it
+    bool remove(const std::string& name);
+
+    // Swaps in a new build of a registered plugin. Returns an empty string on
+    // success, otherwise the reason (the running plugin keeps going).
+    std::string reload(const std::string& name, const std::string& path, PluginHost::LoadTimes* times = nullptr);
+
+    void clear();
+
+    bool empty() const { return count_.load(std::memory_order_acquire) == 0; }
+
+    // Receive thread only. Copies the message into the owning plugin's queue,
+    // waiting while that queue is full. Returns false if no plugin claims it.
+    bool dispatch(const uint8_t* data, size_t length, const std::atomic<bool>& operating);
+
+    template <typename F>
+    void for_each(F&& fn) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const std::shared_ptr<Slot>& slot : plugins_) {
+            fn(PluginView{slot->name, slot->path, slot->route, slot->counters, slot->host,
+                          slot->queue.size(), slot->queue.capacity()});
+        }
+    }
+
+private:
+    struct Slot {
+        Slot(const std::string& n, const std::string& p, const PluginRoute& r, uint32_t depth,
+             const HostCallbacks& cb)
+            : name(n), path(p), route(r), callbacks(cb), queue(depth) {}
+
+        std::string name;
+        std::string path;   // guarded by mutex_ after add()
+        PluginRoute route;
+        HostCallbacks callbacks;
+        PluginHost host;
+        MpmcQueue<PooledBuffer*> queue;  // nullptr entries are update ticks
+        std::thread worker;
+        uint64_t update_timer = 0;
+        std::atomic<bool> update_due{false};
+        PluginCounters counters;
+    };
+
+    static bool peek_frame(const uint8_t* data, size_t length, uint32_t* target_id, uint16_t* tl);
+    static uint16_t tl_key(const char* tl) {
+        return static_cast<uint16_t>((static_cast<uint8_t>(tl[0]) << 8) | static_cast<uint8_t>(tl[1]));
+    }
+
+    std::shared_ptr<Slot> lookup(const uint8_t* data, size_t length);
+    void rebuild_routes();  // caller holds mutex_ exclusively
+    void worker_loop(Slot* slot);
+    void stop(Slot* slot);
+
+    mutable std::shared_mutex mutex_;
+    std::vector<std::shared_ptr<Slot>> plugins_;
+    std::unordered_map<uint32_t, std::shared_ptr<Slot>> by_target_;
+    std::unordered_map<uint16_t, std::shared_ptr<Slot>> by_tl_;
+    std::shared_ptr<Slot> default_;
+    std::atomic<size_t> count_;
+
+    std::weak_ptr<Slot> continuation_;  // receive thread only
+    BufferPool pool_;
+};
+
+#endif // PLUGIN_REGISTRY_H
@@ -0,0 +1,215 @@
+#ifndef SLAB_POOL_H
+#define SLAB_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "latency_histogram.h"
+
+// N independently leasable N->R slabs inside the dataN2R region. Plugin
+// threads lease a free slab, fill it and commit it; the renderer consumes
+// committed slabs in sequence order and hands them back. The byte layout must
+// stay in sync with SlabPool.ts on the renderer side.
+//
+// Region layout:
+//   [ 0.. 3]  slab count   (written by native at attach)
+//   [ 4.. 7]  slab size    (written by native at attach)
+//   [64.. ]   descriptors, 16 bytes per slab:
+//               +0 state   (SLAB_FREE / SLAB_LEASED / SLAB_READY)
+//               +4 length  (valid while READY)
+//               +8 seq     (commit order, valid while READY)
+//   [SLAB_POOL_DATA_OFFSET(n) ..]  slab data, `slab size` bytes each
+//
+// Ownership: native moves FREE -> LEASED -> READY, the renderer moves
+// READY -> FREE. Sequence numbers are assigned at commit, so the renderer can
+// deliver in order without gaps.
+
+constexpr size_t SLAB_POOL_HEADER_SIZE = 64;
+constexpr size_t SLAB_DESCRIPTOR_SIZE = 16;
+constexpr size_t SLAB_ALIGN = 64;
+constexpr uint32_t SLAB_POOL_MAX_SLABS = 64;
+
+enum SlabState : int32_t {
+    SLAB_FREE = 0,
+    SLAB_LEASED = 1,
+    SLAB_READY = 2
+};
+
+inline size_t SLAB_POOL_DATA_OFFSET(uint32_t slab_count) {
+    size_t end = SLAB_POOL_HEADER_SIZE + slab_count * SLAB_DESCRIPTOR_SIZE;
+    return (end + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+}
+
+// Identifies a lease; a lease reclaimed after its timeout gets a new
+// generation, so a late commit from the original holder is rejected.
+struct SlabLease {
+    int32_t index;
+    uint32_t generation;
+};
+
+class SlabPool {
+public:
+    SlabPool() : region_(nullptr), slab_count_(0), slab_size_(0), next_seq_(0),
+        lease_timeout_ns_(1000ull * 1000 * 1000),
+        leases_granted_(0), lease_timeouts_(0), lease_failures_(0), expired_commits_(0) {}
+
+    // Size of each slab when `region_size` bytes are split into `slab_count`
+    // slabs, or 0 if they would not fit (each slab needs at least 64 bytes).
+    static size_t slab_size_for(size_t region_size, uint32_t slab_count) {
+        if (slab_count < 1 || slab_count > SLAB_POOL_MAX_SLABS) return 0;
+        size_t data_offset = SLAB_POOL_DATA_OFFSET(slab_count);
+        if (region_size <= data_offset) return 0;
+        size_t slab_size = ((region_size - data_offset) / slab_count) & ~(SLAB_ALIGN - 1);
+        return slab_size < SLAB_ALIGN ? 0 : slab_size;
+    }
+
+    // Binds the pool to a region and marks every slab free. Returns false if
+    // the region cannot hold `slab_count` slabs. A lease timeout of 0 disables
+    // reclaiming.
+    bool attach(uint8_t* region, size_t region_size, uint32_t slab_count, uint32_t lease_timeout_ms) {
+        detach();
+        if (!region || (reinterpret_cast<uintptr_t>(region) & 3) != 0) return false;
+        size_t slab_size = slab_size_for(region_size, slab_count);
+        if (slab_size == 0) return false;
+
+        region_ = region;
+        slab_count_ = slab_count;
+        slab_size_ = static_cast<uint32_t>(slab_size);
+        next_seq_ = 0;
+        lease_timeout_ns_ = static_cast<uint64_t>(lease_timeout_ms) * 1000 * 1000;
+        slots_.assign(slab_count, SlotInfo());
+        leases_granted_ = 0;
+        lease_timeouts_ = 0;
+        lease_failures_ = 0;
+        expired_commits_ = 0;
+
+        header(0)->store(static_cast<int32_t>(slab_count), std::memory_order_relaxed);
+        header(1)->store(static_cast<int32_t>(slab_size), std::memory_order_relaxed);
+        for (uint32_t i = 0; i < slab_count; i++) {
+            descriptor(i, 1)->store(0, std::memory_order_relaxed);
+            descriptor(i, 2)->store(0, std::memory_order_relaxed);
+            descriptor(i, 0)->store(SLAB_FREE, std::memory_order_seq_cst);
+        }
+        return true;
+    }
+
+    void detach() {
+        region_ = nullptr;
+        slab_count_ = 0;
+        slab_size_ = 0;
+        slots_.clear();
+    }
+
+    bool attached() const { return region_ != nullptr; }
+    uint32_t slab_count() const { return slab_count_; }
+    uint32_t slab_size() const { return slab_size_; }
+
+    // Tries to lease one free slab, reclaiming expired leases when none is
+    // free. Returns false if every slab is in use.
+    bool try_lease(SlabLease* out, uint8_t** data) {
+        if (!attached()) return false;
+        if (try_lease_free(out, data)) return true;
+        if (reclaim_expired() > 0 && try_lease_free(out, data)) return true;
+        return false;
+    }
+
+    // Publishes a leased slab. Returns 0, -1 for a bad length, -3 if the
+    // lease expired and the slab was reclaimed in the meantime.
+    int commit(const SlabLease& lease, uint32_t length) {
+        if (!attached() || lease.index < 0 || static_cast<uint32_t>(lease.index) >= slab_count_) return -1;
+        std::lock_guard<std::mutex> lock(commit_mutex_);
+        SlotInfo& slot = slots_[lease.index];
+        if (slot.generation != lease.generation ||
+            descriptor(lease.index, 0)->load(std::memory_order_acquire) != SLAB_LEASED) {
+            expired_commits_++;
+            return -3;
+        }
+        slot.generation++;
+        if (length == 0 || length > slab_size_) {
+            descriptor(lease.index, 0)->store(SLAB_FREE, std::memory_order_release);
+            return -1;
+        }
+        // Sequence assignment and publication happen under one lock, so
+        // READY slabs never leave a gap in the sequence.
+        descriptor(lease.index, 1)->store(static_cast<int32_t>(length), std::memory_order_relaxed);
+        descriptor(lease.index, 2)->store(static_cast<int32_t>(next_seq_++), std::memory_order_relaxed);
+        descriptor(lease.index, 0)->store(SLAB_READY, std::memory_order_release);
+        return 0;
+    }
+
+    // Gives an unused lease back without publishing anything
+    void abandon(const SlabLease& lease) {
+        commit(lease, 0);
+    }
+
+    uint64_t leases_granted() const { return leases_granted_.load(std::memory_order_relaxed); }
+    uint64_t lease_timeouts() const { return lease_timeouts_.load(std::memory_order_relaxed); }
+    uint64_t lease_failures() const { return lease_failures_.load(std::memory_order_relaxed); }
+    uint64_t expired_commits() const { return expired_commits_.load(std::memory_order_relaxed); }
+    void count_failure() { lease_failures_++; }
+
+private:
+    struct SlotInfo {
+        uint32_t generation = 0;
+        uint64_t leased_at_ns = 0;
+    };
+
+    std::atomic<int32_t>* header(size_t word) {
+        return reinterpret_cast<std::atomic<int32_t>*>(region_ + word * 4);
+    }
+
+    std::atomic<int32_t>* descriptor(uint32_t index, size_t word) {
+        return reinterpret_cast<std::atomic<int32_t>*>(
+            region_ + SLAB_POOL_HEADER_SIZE + index * SLAB_DESCRIPTOR_SIZE + word * 4);
+    }
+
+    bool try_lease_free(SlabLease* out, uint8_t** data) {
+        std::lock_guard<std::mutex> lock(commit_mutex_);
+        for (uint32_t i = 0; i < slab_count_; i++) {
+            int32_t expected = SLAB_FREE;
+            if (descriptor(i, 0)->compare_exchange_strong(expected, SLAB_LEASED, std::memory_order_acq_rel)) {
+                slots_[i].leased_at_ns = LatencyHistogram::now_ns();
+                out->index = static_cast<int32_t>(i);
+                out->generation = slots_[i].generation;
+                *data = region_ + SLAB_POOL_DATA_OFFSET(slab_count_) + static_cast<size_t>(i) * slab_size_;
+                leases_granted_++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Frees leases held longer than the timeout. Their holders' commits fail.
+    int reclaim_expired() {
+        if (lease_timeout_ns_ == 0) return 0;
+        uint64_t now = LatencyHistogram::now_ns();
+        int reclaimed = 0;
+        std::lock_guard<std::mutex> lock(commit_mutex_);
+        for (uint32_t i = 0; i < slab_count_; i++) {
+            if (descriptor(i, 0)->load(std::memory_order_acquire) != SLAB_LEASED) continue;
+            if (now - slots_[i].leased_at_ns < lease_timeout_ns_) continue;
+            slots_[i].generation++;
+            descriptor(i, 0)->store(SLAB_FREE, std::memory_order_release);
+            lease_timeouts_++;
+            reclaimed++;
+        }
+        return reclaimed;
+    }
+
+    uint8_t* region_;
+    uint32_t slab_count_;
+    uint32_t slab_size_;
+    uint32_t next_seq_;            // guarded by commit_mutex_ (as are lease state changes)
+    uint64_t lease_timeout_ns_;
+    std::mutex commit_mutex_;
+    std::vector<SlotInfo> slots_;  // native-only bookkeeping, guarded by commit_mutex_
+
+    std::atomic<uint64_t> leases_granted_;
+    std::atomic<uint64_t> lease_timeouts_;
+    std::atomic<uint64_t> lease_failures_;
+    std::atomic<uint64_t> expired_commits_;
+};
+
+#endif // SLAB_POOL_H
@@ -0,0 +1,258 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// Single-producer / single-consumer ring of variable-length records living
+// inside one data region of the SharedArrayBuffer. The byte layout must stay
+// in sync with SpscRing.ts on the renderer side. The Python IPC segment uses
+// the same rings (copy in APP/backend/include, Python side ShmRing in
+// python_bidirectional_ipc_script.py).
+//
+// Region layout:
+//   [ 0.. 3]  write index (Int32, owned by the producer)
+//   [32..35]  read index  (Int32, owned by the consumer)
+//   [64.. ]   record area (capacity = region size - 64, rounded down to 4)
+//
+// Record layout: [length u32 host order][payload][pad to 4 bytes]
+// A length of SPSC_RING_WRAP_MARKER tells the consumer to continue at offset 0.
+// The ring is empty when read == write; the producer never lets write catch up
+// with read, so a full ring always keeps at least one 4-byte gap.
+
+constexpr size_t SPSC_RING_HEADER_SIZE = 64;
+constexpr size_t SPSC_RING_WRITE_INDEX_OFFSET = 0;
+constexpr size_t SPSC_RING_READ_INDEX_OFFSET = 32;
+constexpr uint32_t SPSC_RING_WRAP_MARKER = 0xFFFFFFFFu;
+constexpr size_t SPSC_RING_RECORD_HEADER_SIZE = 4;
+
+class SpscRing {
+public:
+    SpscRing() : write_index_(nullptr), read_index_(nullptr), records_(nullptr),
+        capacity_(0), reserved_pos_(0), reserved_space_(0), peek_pos_(0), peek_length_(0), corrupt_(false) {}
+
+    // Binds the ring to a region and resets both indices. Returns false if the
+    // region is too small or not 4-byte aligned.
+    bool attach(uint8_t* region, size_t region_size) {
+        detach();
+        if (!region || (reinterpret_cast<uintptr_t>(region) & 3) != 0) return false;
+        if (region_size < SPSC_RING_HEADER_SIZE + 4 * SPSC_RING_RECORD_HEADER_SIZE) return false;
+
+        write_index_ = reinterpret_cast<std::atomic<int32_t>*>(region + SPSC_RING_WRITE_INDEX_OFFSET);
+        read_index_ = reinterpret_cast<std::atomic<int32_t>*>(region + SPSC_RING_READ_INDEX_OFFSET);
+        records_ = region + SPSC_RING_HEADER_SIZE;
+        capacity_ = (region_size - SPSC_RING_HEADER_SIZE) & ~static_cast<size_t>(3);
+
+        write_index_->store(0, std::memory_order_seq_cst);
+        read_index_->store(0, std::memory_order_seq_cst);
+        return true;
+    }
+
+    void detach() {
+        write_index_ = nullptr;
+        read_index_ = nullptr;
+        records_ = nullptr;
+        capacity_ = 0;
+        reserved_space_ = 0;
+        peek_length_ = 0;
+        corrupt_ = false;
+    }
+
+    bool attached() const { return records_ != nullptr; }
+    size_t capacity() const { return capacity_; }
+
+    // Largest payload that is guaranteed to fit once the consumer has drained
+    // the ring, wherever the indices happen to sit.
+    uint32_t max_payload() const {
+        if (capacity_ < 4 * SPSC_RING_RECORD_HEADER_SIZE) return 0;
+        return static_cast<uint32_t>(((capacity_ / 2) & ~static_cast<size_t>(3)) - 2 * SPSC_RING_RECORD_HEADER_SIZE);
+    }
+
+    bool empty() const {
+        if (!attached()) return true;
+        return read_index_->load(std::memory_order_acquire) == write_index_->load(std::memory_order_acquire);
+    }
+
+    // --- Producer side ---
+
+    // Reserves room for exactly `length` payload bytes.
+    // Returns the payload pointer, or nullptr when the ring is too full.
+    uint8_t* try_reserve(uint32_t length) {
+        if (!attached() || length > max_payload()) return nullptr;
+        size_t need = record_size(length);
+        size_t w = static_cast<size_t>(write_index_->load(std::memory_order_relaxed));
+        size_t r = static_cast<size_t>(read_index_->load(std::memory_order_acquire));
+
+        if (w >= r) {
+            size_t tail = capacity_ - w;
+            // A record ending exactly at the end wraps write to 0, which must not equal read.
+            if (need < tail || (need == tail && r != 0)) {
+                return begin_reservation(w, tail);
+            }
+            if (need < r) {
+                write_wrap_marker(w);
+                return begin_reservation(0, r - SPSC_RING_RECORD_HEADER_SIZE);
+            }
+            return nullptr;
+        }
+        if (need < r - w) {
+            return begin_reservation(w, r - w - SPSC_RING_RECORD_HEADER_SIZE);
+        }
+        return nullptr;
+    }
+
+    // Reserves the largest contiguous free chunk if it can hold at least
+    // `min_length` payload bytes. `out_space` receives the usable payload size.
+    uint8_t* try_reserve_contiguous(uint32_t min_length, uint32_t* out_space) {
+        if (!attached() || min_length > max_payload()) return nullptr;
+        size_t w = static_cast<size_t>(write_index_->load(std::memory_order_relaxed));
+        size_t r = static_cast<size_t>(read_index_->load(std::memory_order_acquire));
+
+        size_t pos = w;
+        size_t record_space = 0;
+        bool wrap = false;
+        if (w >= r) {
+            size_t tail = capacity_ - w;
+            size_t tail_space = (r == 0) ? tail - SPSC_RING_RECORD_HEADER_SIZE : tail;
+            size_t front_space = (r >= SPSC_RING_RECORD_HEADER_SIZE) ? r - SPSC_RING_RECORD_HEADER_SIZE : 0;
+            if (front_space > tail_space) {
+                pos = 0;
+                record_space = front_space;
+                wrap = true;
+            } else {
+                record_space = tail_space;
+            }
+        } else {
+            record_space = r - w - SPSC_RING_RECORD_HEADER_SIZE;
+        }
+
+        if (record_space < record_size(min_length)) return nullptr;
+        if (wrap) write_wrap_marker(w);
+        uint8_t* payload = begin_reservation(pos, record_space);
+        *out_space = static_cast<uint32_t>(reserved_space_);
+        return payload;
+    }
+
+    // Publishes the reserved record. A zero length abandons the reservation.
+    bool commit(uint32_t length) {
+        if (!attached() || length > reserved_space_) {
+            reserved_space_ = 0;
+            return false;
+        }
+        reserved_space_ = 0;
+        if (length == 0) return true;
+
+        std::memcpy(records_ + reserved_pos_, &length, sizeof(length));
+        size_t next = reserved_pos_ + record_size(length);
+        if (next == capacity_) next = 0;
+        write_index_->store(static_cast<int32_t>(next), std::memory_order_release);
+        return true;
+    }
+
+    // Copies `length` bytes in as one record. Returns false when full.
+    bool try_push(const uint8_t* data, uint32_t length) {
+        uint8_t* dst = try_reserve(length);
+        if (!dst) return false;
+        std::memcpy(dst, data, length);
+        return commit(length);
+    }
+
+    // --- Consumer side ---
+
+    // Returns the oldest record without consuming it, or nullptr if the ring
+    // is empty or the next record is corrupt (see corrupt()).
+    const uint8_t* peek(uint32_t* out_length) {
+        corrupt_ = false;
+        if (!attached()) return nullptr;
+        size_t r = static_cast<size_t>(read_index_->load(std::memory_order_relaxed));
+        size_t w = static_cast<size_t>(write_index_->load(std::memory_order_acquire));
+        if (!valid_index(r) || !valid_index(w)) {
+            corrupt_ = true;
+            return nullptr;
+        }
+
+        for (int hops = 0; hops < 2; hops++) {
+            if (r == w) return nullptr;
+            if (capacity_ - r < SPSC_RING_RECORD_HEADER_SIZE) {
+                r = 0;
+                continue;
+            }
+            uint32_t length;
+            std::memcpy(&length, records_ + r, sizeof(length));
+            if (length == SPSC_RING_WRAP_MARKER) {
+                r = 0;
+                continue;
+            }
+            if (record_size(length) > capacity_ - r) break; // corrupted record
+            peek_pos_ = r;
+            peek_length_ = length;
+            *out_length = length;
+            return records_ + r + SPSC_RING_RECORD_HEADER_SIZE;
+        }
+        // An oversized length, or a wrap marker right after wrapping
+        corrupt_ = true;
+        return nullptr;
+    }
+
+    // True if the last peek() stopped at a record that cannot be valid. The
+    // ring is not empty then, but peek() will never get past it.
+    bool corrupt() const { return corrupt_; }
+
+    // Drops every record up to the producer's write index, the only position
+    // the consumer can trust after corrupt(). Returns the dropped byte count,
+    // or -1 if the write index itself is out of range.
+    int64_t resync() {
+        corrupt_ = false;
+        if (!attached()) return -1;
+        size_t r = static_cast<size_t>(read_index_->load(std::memory_order_relaxed));
+        size_t w = static_cast<size_t>(write_index_->load(std::memory_order_acquire));
+        if (!valid_index(w)) return -1;
+        read_index_->store(static_cast<int32_t>(w), std::memory_order_release);
+        if (!valid_index(r)) return 0;
+        return static_cast<int64_t>(w >= r ? w - r : capacity_ - r + w);
+    }
+
+    // Consumes the record returned by the last successful peek().
+    void release() {
+        if (!attached()) return;
+        size_t next = peek_pos_ + record_size(peek_length_);
+        if (next == capacity_) next = 0;
+        read_index_->store(static_cast<int32_t>(next), std::memory_order_release);
+    }
+
+private:
+    // Indices are 4-byte aligned offsets into the record area
+    bool valid_index(size_t index) const { return index < capacity_ && (index & 3) == 0; }
+
+    static size_t record_size(size_t length) {
+        return (SPSC_RING_RECORD_HEADER_SIZE + length + 3) & ~static_cast<size_t>(3);
+    }
+
+    uint8_t* begin_reservation(size_t pos, size_t record_space) {
+        reserved_pos_ = pos;
+        reserved_space_ = record_space - SPSC_RING_RECORD_HEADER_SIZE;
+        return records_ + pos + SPSC_RING_RECORD_HEADER_SIZE;
+    }
+
+    void write_wrap_marker(size_t pos) {
+        if (capacity_ - pos >= SPSC_RING_RECORD_HEADER_SIZE) {
+            uint32_t marker = SPSC_RING_WRAP_MARKER;
+            std::memcpy(records_ + pos, &marker, sizeof(marker));
+        }
+    }
+
+    std::atomic<int32_t>* write_index_;
+    std::atomic<int32_t>* read_index_;
+    uint8_t* records_;
+    size_t capacity_;
+
+    size_t reserved_pos_;
+    size_t reserved_space_;
+    size_t peek_pos_;
+    uint32_t peek_length_;
+    bool corrupt_;
+};
+
+#endif // SPSC_RING_H
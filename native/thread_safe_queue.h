@@ -6,6 +6,8 @@
 #include <condition_variable>
 #include <vector>
 
+// Unbounded queue behind one mutex. MpmcQueue (mpmc_queue.h) is the bounded
+// lock-free alternative; bench_mpmc_queue compares the two.
 template<typename T>
 class ThreadSafeQueue {
 public:
@@ -0,0 +1,211 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel() : origin_(Clock::now()), slots_(SLOT_COUNT, nullptr) {
+    current_tick_ = now_tick();
+}
+
+TimerWheel::~TimerWheel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    for (auto& entry : timers_) delete entry.second;
+}
+
+uint64_t TimerWheel::now_tick() const {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - origin_).count();
+    return static_cast<uint64_t>(us) / TICK_US;
+}
+
+uint64_t TimerWheel::schedule(uint64_t delay_us, uint64_t period_us, Callback callback, const void* owner) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_ || (owner && closed_owners_.count(owner))) return 0;
+    if (!thread_.joinable()) {
+        // Started on first use so hosts without timers have no extra thread
+        thread_ = std::thread(&TimerWheel::run, this);
+        thread_id_ = thread_.get_id();
+    }
+
+    Timer* timer = new Timer();
+    timer->id = next_id_++;
+    // Round up: a timer never fires early
+    uint64_t delay_ticks = (delay_us + TICK_US - 1) / TICK_US;
+    timer->deadline_tick = now_tick() + (delay_ticks > 0 ? delay_ticks : 1);
+    if (timer->deadline_tick <= current_tick_) timer->deadline_tick = current_tick_ + 1;
+    timer->period_ticks = period_us > 0 ? (period_us + TICK_US - 1) / TICK_US : 0;
+    timer->owner = owner;
+    timer->callback = std::move(callback);
+    timers_[timer->id] = timer;
+    link(timer);
+
+    // Only wake the thread if it sleeps past the new deadline
+    bool earlier = sleeping_until_ == 0 || timer->deadline_tick < sleeping_until_;
+    uint64_t id = timer->id;
+    lock.unlock();
+    if (earlier) wake_.notify_one();
+    return id;
+}
+
+bool TimerWheel::cancel(uint64_t id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = timers_.find(id);
+    if (it == timers_.end()) return false;
+    erase(it, lock);
+    return true;
+}
+
+bool TimerWheel::cancel(uint64_t id, const void* owner) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = timers_.find(id);
+    if (it == timers_.end() || it->second->owner != owner) return false;
+    erase(it, lock);
+    return true;
+}
+
+void TimerWheel::erase(std::unordered_map<uint64_t, Timer*>::iterator it, std::unique_lock<std::mutex>& lock) {
+    uint64_t id = it->first;
+    Timer* timer = it->second;
+    timers_.erase(it);
+    unlink(timer);
+    if (running_id_ != id) {
+        delete timer;
+        return;
+    }
+    // In flight: run() deletes it once the callback returns. Other threads
+    // wait for that, so they may free what the callback uses.
+    if (std::this_thread::get_id() != thread_id_) {
+        callback_done_.wait(lock, [this, id] { return running_id_ != id; });
+    }
+}
+
+size_t TimerWheel::cancel_owner(const void* owner) {
+    std::vector<uint64_t> ids;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : timers_) {
+            if (entry.second->owner == owner) ids.push_back(entry.first);
+        }
+    }
+    size_t cancelled = 0;
+    for (uint64_t id : ids) {
+        if (cancel(id)) cancelled++;
+    }
+    return cancelled;
+}
+
+size_t TimerWheel::close_owner(const void* owner) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_owners_.insert(owner);
+    }
+    // A callback still running may try to re-arm; schedule() now refuses it
+    return cancel_owner(owner);
+}
+
+void TimerWheel::reopen_owner(const void* owner) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_owners_.erase(owner);
+}
+
+size_t TimerWheel::active() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.size();
+}
+
+void TimerWheel::link(Timer* timer) {
+    Timer*& head = slots_[timer->deadline_tick % SLOT_COUNT];
+    timer->prev = nullptr;
+    timer->next = head;
+    if (head) head->prev = timer;
+    head = timer;
+}
+
+void TimerWheel::unlink(Timer* timer) {
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        Timer*& head = slots_[timer->deadline_tick % SLOT_COUNT];
+        if (head == timer) head = timer->next;
+    }
+    if (timer->next) timer->next->prev = timer->prev;
+    timer->prev = timer->next = nullptr;
+}
+
+uint64_t TimerWheel::next_due_tick() const {
+    // First slot within one rotation holding a timer due in this round
+    for (uint64_t tick = current_tick_ + 1; tick <= current_tick_ + SLOT_COUNT; tick++) {
+        for (Timer* t = slots_[tick % SLOT_COUNT]; t; t = t->next) {
+            if (t->deadline_tick <= tick) return tick;
+        }
+    }
+    return current_tick_ + SLOT_COUNT;
+}
+
+void TimerWheel::run() {
+    std::vector<uint64_t> due;  // ids: a callback may cancel (and free) a later timer
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        uint64_t target = timers_.empty() ? 0 : next_due_tick();
+        if (target == 0) {
+            // Nothing scheduled: sleep until schedule() wakes us
+            sleeping_until_ = UINT64_MAX;
+            wake_.wait(lock, [this] { return stopping_ || !timers_.empty(); });
+        } else if (target > now_tick()) {
+            sleeping_until_ = target;
+            wake_.wait_until(lock, origin_ + std::chrono::microseconds(target * TICK_US));
+        }
+        sleeping_until_ = 0;
+        if (stopping_) break;
+        stats_.wakeups++;
+
+        // Collect everything due up to now, one slot per elapsed tick
+        uint64_t now = now_tick();
+        if (now - current_tick_ > SLOT_COUNT) current_tick_ = now - SLOT_COUNT;  // visit each slot once
+        while (current_tick_ < now) {
+            current_tick_++;
+            Timer* t = slots_[current_tick_ % SLOT_COUNT];
+            while (t) {
+                Timer* next = t->next;
+                if (t->deadline_tick <= now) {
+                    unlink(t);
+                    due.push_back(t->id);
+                }
+                t = next;
+            }
+        }
+
+        for (uint64_t id : due) {
+            auto it = timers_.find(id);
+            if (it == timers_.end()) continue;  // cancelled by an earlier callback
+            Timer* timer = it->second;
+            running_id_ = id;
+            uint64_t deadline_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                (origin_ + std::chrono::microseconds(timer->deadline_tick * TICK_US)).time_since_epoch()).count());
+            lock.unlock();
+            stats_.lateness.record_since(deadline_ns);
+            timer->callback();
+            stats_.fired++;
+            lock.lock();
+            running_id_ = 0;
+            callback_done_.notify_all();
+
+            if (timers_.find(id) == timers_.end()) {
+                delete timer;  // cancelled while it ran
+            } else if (timer->period_ticks > 0) {
+                // Keep the phase; skip periods that were missed entirely
+                timer->deadline_tick += timer->period_ticks;
+                if (timer->deadline_tick <= current_tick_) {
+                    uint64_t behind = current_tick_ - timer->deadline_tick;
+                    timer->deadline_tick += (behind / timer->period_ticks + 1) * timer->period_ticks;
+                }
+                link(timer);
+            } else {
+                timers_.erase(id);
+                delete timer;
+            }
+        }
+        due.clear();
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "latency_histogram.h"
+
+// Host timer service: periodic ticks and one-shot deadlines, run on one
+// dedicated thread.
+//
+// Timers hang in a hashed wheel of SLOT_COUNT slots, one per TICK_US; a timer
+// further out than one rotation waits in its slot for later rounds. Adding
+// and cancelling are O(1). The thread sleeps until the first slot that holds
+// a due timer (or one full rotation when the wheel is empty), so deadlines
+// that fall into the same tick share one wakeup and an idle host does not
+// wake at all.
+//
+// Callbacks run without the wheel lock held and may add or cancel timers.
+// cancel() and cancel_owner() wait for a callback that is running on the
+// timer thread, so code behind a cancelled timer can be unloaded right after.
+class TimerWheel {
+public:
+    static constexpr uint32_t TICK_US = 1000;
+    static constexpr size_t SLOT_COUNT = 512;
+
+    using Callback = std::function<void()>;
+
+    struct Stats {
+        std::atomic<uint64_t> wakeups{0};  // timer thread woke up
+        std::atomic<uint64_t> fired{0};    // callbacks run
+        LatencyHistogram lateness;         // deadline -> callback started
+    };
+
+    // Process-wide service shared by the channel and every plugin. Never
+    // destroyed, so plugin hosts may still cancel timers during exit.
+    static TimerWheel& global() {
+        static TimerWheel* wheel = new TimerWheel();
+        return *wheel;
+    }
+
+    TimerWheel();
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Runs `callback` after delay_us, then every period_us (0 = once).
+    // `owner` groups timers for cancel_owner(). Returns an id, or 0 while
+    // `owner` is closed.
+    uint64_t schedule(uint64_t delay_us, uint64_t period_us, Callback callback, const void* owner = nullptr);
+
+    // Returns false if the timer already fired (one-shot) or never existed
+    bool cancel(uint64_t id);
+
+    // Same, and also false if the timer belongs to another owner
+    bool cancel(uint64_t id, const void* owner);
+
+    // Cancels every timer registered with `owner`; returns how many
+    size_t cancel_owner(const void* owner);
+
+    // cancel_owner(), and schedule() refuses `owner` until reopen_owner().
+    // Hosts close a plugin's owner before its shutdown() and reopen it once
+    // the library is gone, so nothing added in between outlives the code.
+    size_t close_owner(const void* owner);
+    void reopen_owner(const void* owner);
+
+    size_t active() const;
+    const Stats& stats() const { return stats_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        uint64_t id;
+        uint64_t deadline_tick;
+        uint64_t period_ticks;
+        const void* owner;
+        Callback callback;
+        Timer* prev = nullptr;  // intrusive slot list
+        Timer* next = nullptr;
+    };
+
+    uint64_t now_tick() const;
+    void link(Timer* timer);    // caller holds mutex_
+    void unlink(Timer* timer);  // caller holds mutex_
+    // `lock` holds mutex_; waits out a running callback unless called from it
+    void erase(std::unordered_map<uint64_t, Timer*>::iterator it, std::unique_lock<std::mutex>& lock);
+    uint64_t next_due_tick() const;  // caller holds mutex_
+    void run();
+
+    Clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;       // timer thread: new earlier deadline / stop
+    std::condition_variable callback_done_;
+    std::vector<Timer*> slots_;          // list heads
+    std::unordered_map<uint64_t, Timer*> timers_;
+    std::unordered_set<const void*> closed_owners_;
+    uint64_t next_id_ = 1;
+    uint64_t current_tick_ = 0;          // every slot up to here has been processed
+    uint64_t sleeping_until_ = 0;        // tick the thread sleeps towards, 0 = not sleeping
+    uint64_t running_id_ = 0;            // callback in progress on the timer thread
+    bool stopping_ = false;
+    std::thread thread_;
+    std::thread::id thread_id_;
+    Stats stats_;
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,132 @@
+/**
+ * Throughput benchmark: mailbox layout vs. ring layout for R2N traffic.
+ *
+ * The producer runs synchronously on the JS thread and spins on plain
+ * Int32Array reads (ArrayBuffer, no Atomics.wait outside Electron), so the
+ * numbers reflect how fast the native receive thread turns messages around.
+ *
+ * Run with:
+ *   node tests/bench_channel_layouts.mjs [messageSize] [durationMs]
+ */
+
+import { createRequire } from 'node:module';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+
+const R2N_SIGNAL = 0;
+const R2N_LENGTH = 1;
+const CONTROL_BYTES = 16;
+
+const R2N_SIZE = 64 * 1024;
+const N2R_SIZE = 64 * 1024;
+
+// Ring region layout (native/spsc_ring.h)
+const RING_HEADER = 64;
+const RING_WRITE_IDX = 0;
+const RING_READ_IDX = 8;
+const RING_WRAP_MARKER = 0xFFFFFFFF;
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const require = createRequire(import.meta.url);
+
+let addon;
+try {
+    addon = require(path.resolve(__dirname, '..', 'build', 'Release', 'addon'));
+} catch {
+    addon = require('bindings')('addon');
+}
+
+const messageSize = parseInt(process.argv[2] || '64', 10);
+const durationMs = parseInt(process.argv[3] || '2000', 10);
+
+function createBufferViews() {
+    const sab = new ArrayBuffer(CONTROL_BYTES + R2N_SIZE + N2R_SIZE);
+    const control = new Int32Array(sab, 0, 4);
+    const dataR2N = new Uint8Array(sab, CONTROL_BYTES, R2N_SIZE);
+    return { sab, control, dataR2N };
+}
+
+function benchMailbox(payload) {
+    const { sab, control, dataR2N } = createBufferViews();
+    addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { layout: 'mailbox' });
+
+    let sent = 0;
+    const start = performance.now();
+    const deadline = start + durationMs;
+    while (performance.now() < deadline) {
+        if (control[R2N_SIGNAL] !== 0) continue;
+        dataR2N.set(payload, 0);
+        control[R2N_LENGTH] = payload.length;
+        control[R2N_SIGNAL] = 1;
+        addon.notifyNative();
+        sent++;
+    }
+    while (control[R2N_SIGNAL] !== 0) { /* wait for last message */ }
+    const elapsed = performance.now() - start;
+    addon.cleanup();
+    return { sent, elapsed };
+}
+
+function benchRing(payload) {
+    const { sab, control, dataR2N } = createBufferViews();
+    const layout = addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { layout: 'ring' });
+    if (layout !== 'ring') throw new Error(`ring layout rejected (got ${layout})`);
+
+    const indices = new Int32Array(sab, CONTROL_BYTES, RING_HEADER / 4);
+    const capacity = (R2N_SIZE - RING_HEADER) & ~3;
+    const records = new DataView(sab, CONTROL_BYTES + RING_HEADER, capacity);
+    const bytes = new Uint8Array(sab, CONTROL_BYTES + RING_HEADER, capacity);
+    const need = (4 + payload.length + 3) & ~3;
+
+    let sent = 0;
+    const start = performance.now();
+    const deadline = start + durationMs;
+    while (performance.now() < deadline) {
+        const w = indices[RING_WRITE_IDX];
+        const r = indices[RING_READ_IDX];
+        let pos;
+        if (w >= r) {
+            const tail = capacity - w;
+            if (need < tail || (need === tail && r !== 0)) {
+                pos = w;
+            } else if (need < r) {
+                if (tail >= 4) records.setUint32(w, RING_WRAP_MARKER, true);
+                pos = 0;
+            } else {
+                continue;
+            }
+        } else if (need < r - w) {
+            pos = w;
+        } else {
+            continue;
+        }
+        bytes.set(payload, pos + 4);
+        records.setUint32(pos, payload.length, true);
+        let next = pos + need;
+        if (next === capacity) next = 0;
+        indices[RING_WRITE_IDX] = next;
+        control[R2N_SIGNAL] = 1;
+        addon.notifyNative();
+        sent++;
+    }
+    while (indices[RING_READ_IDX] !== indices[RING_WRITE_IDX]) { /* drain */ }
+    const elapsed = performance.now() - start;
+    addon.cleanup();
+    return { sent, elapsed };
+}
+
+function report(name, { sent, elapsed }) {
+    const rate = sent / (elapsed / 1000);
+    const mbps = (rate * messageSize) / (1024 * 1024);
+    console.log(`${name.padEnd(8)} ${sent.toString().padStart(10)} msgs  ` +
+        `${rate.toFixed(0).padStart(10)} msgs/s  ${mbps.toFixed(2).padStart(8)} MB/s`);
+    return rate;
+}
+
+const payload = new Uint8Array(messageSize);
+for (let i = 0; i < payload.length; i++) payload[i] = i & 0xFF;
+
+console.log(`R2N throughput, ${messageSize}-byte messages, ${durationMs} ms per layout`);
+const mailboxRate = report('mailbox', benchMailbox(payload));
+const ringRate = report('ring', benchRing(payload));
+console.log(`ring / mailbox: ${(ringRate / mailboxRate).toFixed(2)}x`);
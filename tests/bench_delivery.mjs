@@ -0,0 +1,91 @@
+/**
+ * N2R delivery benchmark: shared-buffer mailbox vs. zero-copy callback.
+ *
+ * Both modes use triggerTestCallback(size), which behaves like a plugin that
+ * encodes `size` bytes straight into the buffer handed out by
+ * req_available_buffer. The mailbox mode reads the message back with slice()
+ * as SharedMemoryChannel does; the zero-copy mode receives pooled buffers as
+ * external ArrayBuffers and releases them explicitly.
+ *
+ * Run with:
+ *   node tests/bench_delivery.mjs [messagesPerSize]
+ */
+
+import { createRequire } from 'node:module';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+
+const N2R_SIGNAL = 2;
+const N2R_LENGTH = 3;
+const CONTROL_BYTES = 16;
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const require = createRequire(import.meta.url);
+
+let addon;
+try {
+    addon = require(path.resolve(__dirname, '..', 'build', 'Release', 'addon'));
+} catch {
+    addon = require('bindings')('addon');
+}
+
+const count = parseInt(process.argv[2] || '200', 10);
+const sizes = [64 * 1024, 1024 * 1024, 4 * 1024 * 1024];
+
+function benchMailbox(size) {
+    const r2nSize = 1024;
+    const sab = new ArrayBuffer(CONTROL_BYTES + r2nSize + size);
+    const control = new Int32Array(sab, 0, 4);
+    const dataN2R = new Uint8Array(sab, CONTROL_BYTES + r2nSize, size);
+    addon.setSharedBuffer(sab, r2nSize, size);
+
+    let checksum = 0;
+    const start = performance.now();
+    for (let i = 0; i < count; i++) {
+        addon.triggerTestCallback(size);
+        const copy = dataN2R.slice(0, control[N2R_LENGTH]);
+        control[N2R_SIGNAL] = 0;
+        checksum += copy[copy.length - 1];
+    }
+    const elapsed = performance.now() - start;
+    addon.cleanup();
+    return { elapsed, checksum };
+}
+
+async function benchZeroCopy(size) {
+    const sab = new ArrayBuffer(CONTROL_BYTES + 2048);
+    addon.setSharedBuffer(sab, 1024, 1024);
+
+    let received = 0;
+    let checksum = 0;
+    let resolveDone;
+    const done = new Promise((resolve) => { resolveDone = resolve; });
+    addon.setMessageCallback((ab) => {
+        checksum += new Uint8Array(ab)[ab.byteLength - 1];
+        addon.releaseMessageBuffer(ab);
+        if (++received === count) resolveDone();
+    }, { zeroCopy: true, maxMessageSize: size });
+
+    const start = performance.now();
+    for (let i = 0; i < count; i++) {
+        addon.triggerTestCallback(size);
+    }
+    await done;
+    const elapsed = performance.now() - start;
+    const stats = addon.getDeliveryStats();
+    addon.cleanup();
+    return { elapsed, checksum, stats };
+}
+
+console.log(`${count} messages per size`);
+for (const size of sizes) {
+    const mailbox = benchMailbox(size);
+    const zeroCopy = await benchZeroCopy(size);
+    const mbps = (elapsed) => ((count * size) / (1024 * 1024) / (elapsed / 1000)).toFixed(0);
+    const s = zeroCopy.stats;
+    console.log(`${(size / 1024).toString().padStart(5)} KB  mailbox ${mbps(mailbox.elapsed).padStart(6)} MB/s` +
+        `  zero-copy ${mbps(zeroCopy.elapsed).padStart(6)} MB/s` +
+        `  copies avoided ${s.copiesAvoided}  fallbacks ${s.externalFallbacks}` +
+        `  pool hits ${s.poolHits}/${s.poolHits + s.poolMisses}` +
+        `  latency p50 <${s.latency.p50Us}us p99 <${s.latency.p99Us}us`);
+}
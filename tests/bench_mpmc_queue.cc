@@ -0,0 +1,88 @@
+// Contention benchmark: MpmcQueue (native/mpmc_queue.h) against the mutex +
+// condvar ThreadSafeQueue (native/thread_safe_queue.h) with 1..16 producer
+// threads feeding a fixed set of blocking consumers. Every run checks that
+// each item arrived exactly once.
+//
+// Build and run (no addon needed):
+//   g++ -O2 -std=c++17 -pthread -Inative tests/bench_mpmc_queue.cc -o bench_mpmc_queue
+//   ./bench_mpmc_queue [consumers [items_per_run]]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "mpmc_queue.h"
+#include "thread_safe_queue.h"
+
+static const uint64_t STOP = ~0ull;
+
+struct Result {
+    double seconds;
+    bool ok;
+};
+
+template <typename Push, typename Pop>
+static Result run(int producers, int consumers, uint64_t items, Push push, Pop pop) {
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> count{0};
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&] {
+            uint64_t local_sum = 0, local_count = 0, item;
+            while (pop(item) && item != STOP) {
+                local_sum += item;
+                local_count++;
+            }
+            sum += local_sum;
+            count += local_count;
+        });
+    }
+    std::vector<std::thread> senders;
+    uint64_t per_producer = items / producers;
+    for (int p = 0; p < producers; p++) {
+        senders.emplace_back([&, p] {
+            uint64_t base = p * per_producer;
+            for (uint64_t i = 0; i < per_producer; i++) push(base + i);
+        });
+    }
+    for (std::thread& t : senders) t.join();
+    for (int c = 0; c < consumers; c++) push(STOP);
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = per_producer * producers;
+    return {seconds, count == total && sum == total * (total - 1) / 2};
+}
+
+int main(int argc, char** argv) {
+    int consumers = argc > 1 ? std::atoi(argv[1]) : 2;
+    uint64_t items = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+    printf("%d consumers, %llu items per run, %u hardware threads\n", consumers,
+           static_cast<unsigned long long>(items), std::thread::hardware_concurrency());
+    printf("producers   ThreadSafeQueue      MpmcQueue(1024)   speedup\n");
+
+    for (int producers : {1, 2, 4, 8, 16}) {
+        ThreadSafeQueue<uint64_t> locked;
+        bool keep_going = true;
+        Result a = run(producers, consumers, items,
+            [&](uint64_t v) { locked.push(v); },
+            [&](uint64_t& v) { return locked.wait_and_pop(v, keep_going); });
+
+        MpmcQueue<uint64_t> lock_free(1024);
+        Result b = run(producers, consumers, items,
+            [&](uint64_t v) { lock_free.push(v); },
+            [&](uint64_t& v) { return lock_free.wait_and_pop(v); });
+
+        if (!a.ok || !b.ok) {
+            printf("MISMATCH at %d producers (ThreadSafeQueue %s, MpmcQueue %s)\n", producers,
+                   a.ok ? "ok" : "bad", b.ok ? "ok" : "bad");
+            return 1;
+        }
+        printf("%9d   %8.2f Mops/s      %8.2f Mops/s   %6.2fx\n", producers,
+               items / a.seconds / 1e6, items / b.seconds / 1e6, a.seconds / b.seconds);
+    }
+    return 0;
+}
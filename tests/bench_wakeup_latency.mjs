@@ -0,0 +1,74 @@
+/**
+ * R2N wakeup latency and idle CPU of the native receive thread.
+ *
+ * Sends one mailbox message at a time with idle gaps in between, so every
+ * message finds the receive thread blocked in its futex wait, then prints the
+ * native-side latency histogram (notifyNative() -> thread running) and the
+ * process CPU time burnt while the channel sits idle.
+ *
+ * Run with:
+ *   node tests/bench_wakeup_latency.mjs [messages] [gapMs]
+ */
+
+import { createRequire } from 'node:module';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+
+const R2N_SIGNAL = 0;
+const R2N_LENGTH = 1;
+const CONTROL_BYTES = 16;
+const R2N_SIZE = 1024;
+const N2R_SIZE = 1024;
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const require = createRequire(import.meta.url);
+
+let addon;
+try {
+    addon = require(path.resolve(__dirname, '..', 'build', 'Release', 'addon'));
+} catch {
+    addon = require('bindings')('addon');
+}
+
+const messages = parseInt(process.argv[2] || '500', 10);
+const gapMs = parseInt(process.argv[3] || '2', 10);
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+const sab = new ArrayBuffer(CONTROL_BYTES + R2N_SIZE + N2R_SIZE);
+const control = new Int32Array(sab, 0, 4);
+const dataR2N = new Uint8Array(sab, CONTROL_BYTES, R2N_SIZE);
+addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+
+// Idle CPU: nothing is sent for one second
+await sleep(100);
+const idleStart = process.cpuUsage();
+await sleep(1000);
+const idle = process.cpuUsage(idleStart);
+console.log(`idle CPU over 1s: ${((idle.user + idle.system) / 1000).toFixed(1)} ms`);
+
+// Round trips: each message wakes a blocked receive thread
+const rtt = [];
+for (let i = 0; i < messages; i++) {
+    await sleep(gapMs);
+    dataR2N[0] = i & 0xFF;
+    control[R2N_LENGTH] = 1;
+    const start = process.hrtime.bigint();
+    control[R2N_SIGNAL] = 1;
+    addon.notifyNative();
+    while (control[R2N_SIGNAL] !== 0) { /* spin until consumed */ }
+    rtt.push(Number(process.hrtime.bigint() - start) / 1000);
+}
+rtt.sort((a, b) => a - b);
+const pct = (p) => rtt[Math.min(rtt.length - 1, Math.floor(rtt.length * p / 100))].toFixed(1);
+console.log(`round trip (us): p50 ${pct(50)}  p99 ${pct(99)}  max ${rtt[rtt.length - 1].toFixed(1)}`);
+
+const stats = addon.getChannelStats();
+const wake = stats.r2nWakeLatency;
+console.log(`wakeups: spin ${stats.spinWakeups}  futex ${stats.futexWakeups}  timeouts ${stats.waitTimeouts}`);
+console.log(`native wake latency (us): mean ${wake.meanUs.toFixed(1)}  p50 <${wake.p50Us}  p99 <${wake.p99Us}  max ${wake.maxUs.toFixed(1)}`);
+wake.buckets.forEach((n, i) => {
+    if (n > 0) console.log(`  < ${String(2 ** i).padStart(8)} us: ${n}`);
+});
+
+addon.cleanup();
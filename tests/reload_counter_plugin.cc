@@ -0,0 +1,102 @@
+// Minimal plugin for stress_plugin_reload.cc. Echoes every message back
+// through the host's MessageCallback and flags any call that reaches an
+// instance which is not initialized (or initialized twice, which is what
+// happens when a reload maps the running library instead of a fresh copy).
+// The v1 build also flags two calls that overlap, which the host must never
+// allow for a plugin without PLUGIN_CAP_CONCURRENT.
+// Built with -DRELOAD_PLUGIN_V2 it exports the batched v2 interface instead,
+// declares PLUGIN_CAP_CONCURRENT and also runs a 1 ms host timer, which must
+// never fire after shutdown(); a timer it tries to add from shutdown() must
+// be refused.
+#include <atomic>
+#include <cstring>
+#include "plugin_interface.h"
+
+static MessageCallback g_send = nullptr;
+static std::atomic<bool> g_live{false};
+static std::atomic<int> g_inside{0};
+
+#ifdef RELOAD_PLUGIN_V2
+static const bool CONCURRENT = true;
+#else
+static const bool CONCURRENT = false;
+#endif
+
+static const uint8_t MISUSE_MARKER[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+static PluginStatus initialize(MessageCallback callback, BufferRequestCallback, BufferSendCallback) {
+    if (g_live.exchange(true)) return PLUGIN_ERROR_INITIALIZATION;
+    g_send = callback;
+    return PLUGIN_SUCCESS;
+}
+
+static void shutdown() {
+    g_live = false;
+}
+
+static void process_message(const uint8_t* data, size_t length) {
+    bool overlapped = g_inside.fetch_add(1) > 0 && !CONCURRENT;
+    if (!g_live || overlapped) {
+        if (g_send) g_send(MISUSE_MARKER, sizeof(MISUSE_MARKER));
+    } else {
+        g_send(data, length);
+    }
+    g_inside.fetch_sub(1);
+}
+
+#ifdef RELOAD_PLUGIN_V2
+static const PluginHostApi* g_host = nullptr;
+
+static void on_tick(void*) {
+    if (!g_live && g_send) g_send(MISUSE_MARKER, sizeof(MISUSE_MARKER));
+}
+
+static PluginStatus initialize_v2(const PluginHostApi* host) {
+    if (host->api_version != PLUGIN_API_VERSION_2) return PLUGIN_ERROR_INVALID_VERSION;
+    g_host = host;
+    PluginStatus status = initialize(host->send_message, nullptr, nullptr);
+    // Left running on purpose: the host cancels it before shutdown()
+    if (status == PLUGIN_SUCCESS && host->add_timer) host->add_timer(host, 1, 1, on_tick, nullptr);
+    return status;
+}
+
+static void shutdown_v2() {
+    shutdown();
+    // Would fire into the closed library if the host accepted it
+    if (g_host->add_timer && g_host->add_timer(g_host, 1, 0, on_tick, nullptr) != 0 && g_send) {
+        g_send(MISUSE_MARKER, sizeof(MISUSE_MARKER));
+    }
+}
+
+static void process_batch(PluginMessage* messages, size_t count) {
+    for (size_t i = 0; i < count; i++) process_message(messages[i].data, messages[i].length);
+}
+
+static const PluginInterfaceV2 g_interface = {
+    {"reload_counter", "2.0", PLUGIN_API_VERSION_2},
+    PLUGIN_CAP_CONCURRENT | PLUGIN_CAP_TIMERS,
+    0,
+    initialize_v2,
+    shutdown_v2,
+    process_batch,
+    nullptr
+};
+
+extern "C" PLUGIN_EXPORT const PluginInterfaceV2* get_plugin_interface_v2() {
+    return &g_interface;
+}
+#else
+static void update() {}
+
+static const PluginInterface g_interface = {
+    {"reload_counter", "1.0", PLUGIN_API_VERSION},
+    initialize,
+    shutdown,
+    process_message,
+    update
+};
+
+extern "C" PLUGIN_EXPORT const PluginInterface* get_plugin_interface() {
+    return &g_interface;
+}
+#endif
@@ -0,0 +1,128 @@
+// Hot-reload stress test for PluginHost (native/plugin_host.h): dispatch
+// threads push sequence-numbered messages through the host while the main
+// thread keeps reloading the plugin. Checks that every message reached
+// exactly one live plugin instance, that a plugin without
+// PLUGIN_CAP_CONCURRENT was never entered from two threads at once, and
+// reports reload timings.
+//
+// Build and run (no addon needed):
+//   g++ -O2 -std=c++17 -shared -fPIC -Inative tests/reload_counter_plugin.cc -o reload_counter_plugin.so
+//   (add -DRELOAD_PLUGIN_V2 to exercise the v2 interface)
+//   g++ -O2 -std=c++17 -pthread -Inative tests/stress_plugin_reload.cc native/plugin_host.cc native/timer_wheel.cc native/plugin_loader.cc -ldl -o stress_plugin_reload
+//   ./stress_plugin_reload ./reload_counter_plugin.so [reloads [dispatch_threads]]
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "plugin_host.h"
+#include "timer_wheel.h"
+
+static std::vector<std::atomic<uint8_t>>* g_seen = nullptr;
+static std::atomic<uint64_t> g_misuse{0};
+
+static void on_message(const uint8_t* data, size_t length) {
+    uint64_t seq;
+    if (length != sizeof(seq)) return;
+    memcpy(&seq, data, sizeof(seq));
+    if (seq == ~0ull) {
+        g_misuse++;
+        return;
+    }
+    (*g_seen)[seq].fetch_add(1, std::memory_order_relaxed);
+}
+
+static int on_buffer_request(uint32_t, uint8_t**, uint32_t*) { return -1; }
+static int on_buffer_send(uint32_t) { return -1; }
+static int on_acquire_tx(const PluginHostApi*, uint32_t, PluginTxSlot*, uint32_t) { return -1; }
+static int on_commit_tx(const PluginTxSlot*, uint32_t) { return -1; }
+static void on_release(uint64_t) {}
+
+// Same as the addon: timers are owned by the plugin's copy of the host API
+static uint64_t on_add_timer(const PluginHostApi* self, uint32_t delay_ms, uint32_t period_ms,
+                             PluginTimerCallback callback, void* user) {
+    return TimerWheel::global().schedule(delay_ms * 1000ull, period_ms * 1000ull,
+                                         [callback, user] { callback(user); }, self);
+}
+static int on_cancel_timer(const PluginHostApi* self, uint64_t id) {
+    return TimerWheel::global().cancel(id, self) ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s plugin.so [reloads [dispatch_threads]]\n", argv[0]);
+        return 2;
+    }
+    const char* path = argv[1];
+    int reloads = argc > 2 ? std::atoi(argv[2]) : 200;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 2;
+    const uint64_t per_thread = 200000;
+
+    std::vector<std::atomic<uint8_t>> seen(per_thread * threads);
+    g_seen = &seen;
+
+    PluginHost host;
+    PluginHostApi api = {PLUGIN_API_VERSION_2, PLUGIN_HOST_CAP_TIMERS, on_message, on_acquire_tx, on_commit_tx, on_release,
+                         on_add_timer, on_cancel_timer};
+    PluginHost::Callbacks callbacks = {on_message, on_buffer_request, on_buffer_send, &api};
+    std::string error = host.load(path, callbacks);
+    if (!error.empty()) {
+        fprintf(stderr, "initial load failed: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::atomic<int> running{threads};
+    std::vector<std::thread> dispatchers;
+    for (int t = 0; t < threads; t++) {
+        dispatchers.emplace_back([&, t] {
+            for (uint64_t i = 0; i < per_thread; i++) {
+                uint64_t seq = t * per_thread + i;
+                while (!host.process_message(reinterpret_cast<const uint8_t*>(&seq), sizeof(seq))) {}
+                if ((i & 1023) == 0) host.update();
+            }
+            running--;
+        });
+    }
+
+    std::vector<uint64_t> load_us, drain_us;
+    int done = 0;
+    for (; done < reloads && running > 0; done++) {
+        PluginHost::LoadTimes times;
+        error = host.load(path, callbacks, &times);
+        if (!error.empty()) {
+            fprintf(stderr, "reload %d failed: %s\n", done, error.c_str());
+            return 1;
+        }
+        load_us.push_back(times.load_us);
+        if (done > 0) drain_us.push_back(host.stats().lastDrainUs);
+    }
+    for (std::thread& t : dispatchers) t.join();
+    uint32_t api_version = host.api_version();
+    host.unload();
+
+    uint64_t lost = 0, duplicated = 0;
+    for (auto& count : seen) {
+        uint8_t c = count.load();
+        if (c == 0) lost++;
+        if (c > 1) duplicated++;
+    }
+
+    auto p50 = [](std::vector<uint64_t> v) {
+        if (v.empty()) return uint64_t(0);
+        std::sort(v.begin(), v.end());
+        return v[v.size() / 2];
+    };
+    printf("API v%u plugin, %d reloads under %d dispatch threads, %llu messages\n", api_version, done, threads,
+           static_cast<unsigned long long>(seen.size()));
+    printf("load+init p50 %llu us, swap %llu us, drain p50 %llu us\n",
+           static_cast<unsigned long long>(p50(load_us)),
+           static_cast<unsigned long long>(host.stats().lastSwapUs.load()),
+           static_cast<unsigned long long>(p50(drain_us)));
+    printf("host timer callbacks %llu\n", static_cast<unsigned long long>(TimerWheel::global().stats().fired.load()));
+    printf("lost %llu, duplicated %llu, calls into a retired instance or overlapping calls %llu\n",
+           static_cast<unsigned long long>(lost), static_cast<unsigned long long>(duplicated),
+           static_cast<unsigned long long>(g_misuse.load()));
+    return lost == 0 && duplicated == 0 && g_misuse == 0 ? 0 : 1;
+}
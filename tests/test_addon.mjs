@@ -182,6 +182,17 @@ describe('Plugin Load / Unload', () => {
     });
   });
 
+  it('reloadPlugin with a non-existent path should throw and keep the slot empty', () => {
+    assert.throws(() => addon.reloadPlugin('/does/not/exist/plugin.so'), /failed to load/);
+    const stats = addon.getReloadStats();
+    assert.strictEqual(stats.loaded, false);
+    assert.ok(stats.reloadFailures >= 1);
+  });
+
+  it('reloadPlugin for an unknown registered name should throw', () => {
+    assert.throws(() => addon.reloadPlugin('/does/not/exist/plugin.so', 'nobody'), /no plugin named/);
+  });
+
   it('loadPlugin then unloadPlugin cycle should not crash', () => {
     // load (will fail) then unload -- should still be safe
     addon.loadPlugin('/nonexistent/path.so');
@@ -191,6 +202,39 @@ describe('Plugin Load / Unload', () => {
   });
 });
 
+// ---------------------------------------------------------------------------
+// 3b. Plugin Registry
+// ---------------------------------------------------------------------------
+
+describe('Plugin Registry', () => {
+  it('getPluginStats should be empty with no registered plugins', () => {
+    assert.deepStrictEqual(addon.getPluginStats(), []);
+  });
+
+  it('registerPlugin with a non-existent path should throw', () => {
+    assert.throws(
+      () => addon.registerPlugin('camera', '/does/not/exist/plugin.so', { targets: [1] }),
+      /failed to load/
+    );
+    assert.deepStrictEqual(addon.getPluginStats(), []);
+  });
+
+  it('registerPlugin should reject TL prefixes that are not two characters', () => {
+    assert.throws(
+      () => addon.registerPlugin('logger', '/does/not/exist/plugin.so', { tl: ['LOG'] }),
+      /two characters/
+    );
+  });
+
+  it('registerPlugin should require a name and a path', () => {
+    assert.throws(() => addon.registerPlugin('camera'), TypeError);
+  });
+
+  it('unregisterPlugin should return false for an unknown name', () => {
+    assert.strictEqual(addon.unregisterPlugin('nobody'), false);
+  });
+});
+
 // ---------------------------------------------------------------------------
 // 4. Cleanup
 // ---------------------------------------------------------------------------
@@ -210,6 +210,7 @@ describe('SharedArrayBuffer Integration Tests', { skip: !addonAvailable && 'nati
             // Set length and signal
             control[R2N_LENGTH] = payload.length;
             control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
 
             // The native recv thread should pick it up and reset R2N_SIGNAL to 0
             const signalReset = await pollUntil(
@@ -271,6 +272,7 @@ describe('SharedArrayBuffer Integration Tests', { skip: !addonAvailable && 'nati
             dataR2N.set(pattern, 0);
             control[R2N_LENGTH] = patternSize;
             control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
 
             // Wait for native to consume it
             const consumed = await pollUntil(
@@ -340,6 +342,7 @@ describe('SharedArrayBuffer Integration Tests', { skip: !addonAvailable && 'nati
                 dataR2N.set(msg, 0);
                 control[R2N_LENGTH] = msg.length;
                 control[R2N_SIGNAL] = 1;
+                addon.notifyNative();
 
                 // Wait for native to consume
                 const consumed = await pollUntil(
@@ -393,6 +396,7 @@ describe('SharedArrayBuffer Integration Tests', { skip: !addonAvailable && 'nati
             dataR2N.set(new Uint8Array([0xDE, 0xAD]), 0);
             control[R2N_LENGTH] = 2;
             control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
 
             // Give native thread a moment to start processing
             await new Promise((resolve) => setTimeout(resolve, 50));
@@ -418,6 +422,7 @@ describe('SharedArrayBuffer Integration Tests', { skip: !addonAvailable && 'nati
             views2.dataR2N.set(new Uint8Array([0x42]), 0);
             views2.control[R2N_LENGTH] = 1;
             views2.control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
 
             const consumed = await pollUntil(
                 () => views2.control[R2N_SIGNAL] === 0,
@@ -428,6 +433,341 @@ describe('SharedArrayBuffer Integration Tests', { skip: !addonAvailable && 'nati
             addon.cleanup();
         });
     });
+
+    // -----------------------------------------------------------------------
+    // 8. Ring Layout
+    // -----------------------------------------------------------------------
+    describe('Ring Layout', () => {
+        // Region byte layout from native/spsc_ring.h
+        const RING_HEADER = 64;
+        const RING_WRITE_IDX = 0;      // Int32 slot
+        const RING_READ_IDX = 8;       // Int32 slot (byte 32)
+
+        function ringViews(region) {
+            return {
+                indices: new Int32Array(region.buffer, region.byteOffset, RING_HEADER / 4),
+                records: new DataView(region.buffer, region.byteOffset + RING_HEADER,
+                    (region.byteLength - RING_HEADER) & ~3),
+            };
+        }
+
+        it('should default to the mailbox layout', () => {
+            assert.equal(addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE), 'mailbox');
+        });
+
+        it('should negotiate the ring layout when requested', () => {
+            assert.equal(addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { layout: 'ring' }), 'ring');
+        });
+
+        it('should reject an unknown layout name', () => {
+            assert.throws(
+                () => addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { layout: 'bogus' }),
+                TypeError
+            );
+        });
+
+        it('should drain several queued R2N records after one doorbell', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { layout: 'ring' });
+            const { indices, records } = ringViews(dataR2N);
+
+            // Queue three 3-byte records back to back (4-byte header + pad to 8)
+            let w = 0;
+            for (let i = 0; i < 3; i++) {
+                records.setUint32(w, 3, true);
+                records.setUint8(w + 4, 0x10 + i);
+                records.setUint8(w + 5, 0x20 + i);
+                records.setUint8(w + 6, 0x30 + i);
+                w += 8;
+            }
+            indices[RING_WRITE_IDX] = w;
+            control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
+
+            const consumed = await pollUntil(() => indices[RING_READ_IDX] === w, 3000);
+            assert.ok(consumed, 'Native should consume every queued record');
+        });
+
+        it('should resync past a corrupt R2N record instead of spinning on it', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { layout: 'ring' });
+            const { indices, records } = ringViews(dataR2N);
+
+            // A length far beyond the ring, followed by a valid record
+            records.setUint32(0, 0x7fffff00, true);
+            records.setUint32(8, 3, true);
+            indices[RING_WRITE_IDX] = 16;
+            control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
+
+            const skipped = await pollUntil(() => indices[RING_READ_IDX] === 16, 3000);
+            assert.ok(skipped, 'Native should move the read index to the write index');
+            assert.equal(addon.getChannelStats().corruptRecords, 1);
+
+            // The ring keeps working afterwards
+            records.setUint32(16, 3, true);
+            indices[RING_WRITE_IDX] = 24;
+            control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
+            assert.ok(await pollUntil(() => indices[RING_READ_IDX] === 24, 3000), 'Next record should be consumed');
+            assert.equal(addon.getChannelStats().corruptRecords, 1);
+        });
+
+        it('should deliver N2R messages as ring records', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { layout: 'ring' });
+            const { indices, records } = ringViews(dataN2R);
+
+            addon.triggerTestCallback();
+            addon.triggerTestCallback();
+
+            const expected = 'Test callback from native code!';
+            const recordBytes = (4 + expected.length + 3) & ~3;
+            const written = await pollUntil(
+                () => indices[RING_WRITE_IDX] === 2 * recordBytes,
+                3000
+            );
+            assert.ok(written, 'Both records should be published');
+            assert.equal(control[N2R_SIGNAL], 1, 'Doorbell should be raised');
+
+            for (let i = 0; i < 2; i++) {
+                const base = i * recordBytes;
+                assert.equal(records.getUint32(base, true), expected.length);
+                const payload = new Uint8Array(records.buffer, records.byteOffset + base + 4, expected.length);
+                assert.equal(new TextDecoder().decode(payload), expected);
+            }
+        });
+    });
+
+    // -----------------------------------------------------------------------
+    // 9. Wakeups
+    // -----------------------------------------------------------------------
+    describe('Wakeups', () => {
+        it('should consume a message woken through notifyNative', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+
+            // Let the receive thread settle into its futex wait
+            await new Promise((resolve) => setTimeout(resolve, 20));
+
+            dataR2N.set(new Uint8Array([0x01, 0x02]), 0);
+            control[R2N_LENGTH] = 2;
+            control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
+
+            const consumed = await pollUntil(() => control[R2N_SIGNAL] === 0, 3000);
+            assert.ok(consumed, 'Native should consume the message');
+
+            const stats = addon.getChannelStats();
+            assert.equal(stats.spinWakeups + stats.futexWakeups, 1, 'Exactly one wakeup should be counted');
+            assert.equal(stats.r2nWakeLatency.buckets.length, 24);
+        });
+
+        it('should pick up a signal raised without notifyNative when pollFallbackMs is set', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { pollFallbackMs: 1 });
+            await new Promise((resolve) => setTimeout(resolve, 20));
+
+            dataR2N[0] = 0x42;
+            control[R2N_LENGTH] = 1;
+            control[R2N_SIGNAL] = 1;
+
+            const consumed = await pollUntil(() => control[R2N_SIGNAL] === 0, 3000);
+            assert.ok(consumed, 'Native should re-check at the poll fallback period');
+        });
+
+        it('should ring the N2R doorbell after publishing', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+
+            let rings = 0;
+            addon.setN2RDoorbell(() => { rings++; });
+            addon.triggerTestCallback();
+
+            const rang = await pollUntil(() => rings > 0, 3000);
+            assert.ok(rang, 'Doorbell callback should fire');
+            assert.equal(control[N2R_SIGNAL], 1);
+            assert.equal(addon.getChannelStats().n2rDoorbellLatency.count, 1);
+
+            addon.setN2RDoorbell(null);
+        });
+
+        it('should reject a non-function doorbell', () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+            assert.throws(() => addon.setN2RDoorbell(42), TypeError);
+        });
+    });
+
+    // -----------------------------------------------------------------------
+    // 10. Zero-copy Delivery
+    // -----------------------------------------------------------------------
+    describe('Zero-copy Delivery', () => {
+        it('should deliver plugin-style messages to the callback instead of the SAB', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+
+            const received = [];
+            addon.setMessageCallback((ab) => received.push(ab), { zeroCopy: true });
+            addon.triggerTestCallback();
+            assert.equal(addon.triggerTestCallback(4096), 0);
+
+            const done = await pollUntil(() => received.length === 2, 3000);
+            assert.ok(done, 'Both messages should reach the callback');
+            assert.equal(control[N2R_SIGNAL], 0, 'The SAB should not be used');
+
+            assert.equal(new TextDecoder().decode(received[0]), 'Test callback from native code!');
+            const bytes = new Uint8Array(received[1]);
+            assert.equal(bytes.length, 4096);
+            assert.equal(bytes[255], 255);
+            assert.equal(bytes[256], 0);
+
+            const stats = addon.getDeliveryStats();
+            assert.equal(stats.messages, 2);
+            assert.equal(stats.latency.count, 2);
+            // 1 copy avoided for the copied message, 2 for the direct one,
+            // minus one per external-buffer fallback
+            assert.equal(stats.copiesAvoided, 3 - stats.externalFallbacks);
+        });
+
+        it('should recycle a released buffer', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+
+            const received = [];
+            addon.setMessageCallback((ab) => received.push(ab), { zeroCopy: true, maxMessageSize: 65536 });
+            addon.triggerTestCallback(1000);
+            assert.ok(await pollUntil(() => received.length === 1, 3000));
+
+            const external = addon.getDeliveryStats().externalFallbacks === 0;
+            assert.equal(addon.releaseMessageBuffer(received[0]), external);
+            if (external) {
+                assert.equal(received[0].byteLength, 0, 'Released buffer should be detached');
+            }
+
+            addon.triggerTestCallback(1000);
+            assert.ok(await pollUntil(() => received.length === 2, 3000));
+            if (external) {
+                assert.ok(addon.getDeliveryStats().poolHits >= 1, 'Second message should reuse the pool');
+            }
+        });
+
+        it('should reject messages larger than maxMessageSize', () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+            addon.setMessageCallback(() => {}, { zeroCopy: true, maxMessageSize: 4096 });
+            assert.equal(addon.triggerTestCallback(1 << 20), -1);
+        });
+    });
+
+    // -----------------------------------------------------------------------
+    // 11. N2R Slabs
+    // -----------------------------------------------------------------------
+    describe('N2R Slabs', () => {
+        // Region layout from native/slab_pool.h
+        const SLAB_HEADER = 64;
+        const SLAB_READY = 2;
+
+        function slabViews(region) {
+            const words = new Int32Array(region.buffer, region.byteOffset, region.byteLength >> 2);
+            const count = words[0];
+            const size = words[1];
+            const dataStart = (SLAB_HEADER + count * 16 + 63) & ~63;
+            const desc = (i, w) => (SLAB_HEADER + i * 16) / 4 + w;
+            return { words, count, size, dataStart, desc };
+        }
+
+        it('should let several messages be committed without renderer reads', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { n2rSlabs: 4 });
+            const { words, count, size, dataStart, desc } = slabViews(dataN2R);
+            assert.equal(count, 4);
+            assert.ok(size >= 64 && size % 64 === 0);
+
+            for (let i = 0; i < 3; i++) {
+                assert.equal(addon.triggerTestCallback(16 + i), 0, `Commit ${i} should not wait`);
+            }
+            assert.equal(control[N2R_SIGNAL], 1);
+
+            // Deliver in sequence order
+            for (let seq = 0; seq < 3; seq++) {
+                let found = -1;
+                for (let i = 0; i < count; i++) {
+                    if (words[desc(i, 0)] === SLAB_READY && words[desc(i, 2)] === seq) found = i;
+                }
+                assert.ok(found >= 0, `Slab with seq ${seq} should be ready`);
+                assert.equal(words[desc(found, 1)], 16 + seq);
+                assert.equal(dataN2R[dataStart + found * size + 5], 5);
+                words[desc(found, 0)] = 0; // hand back
+            }
+
+            const stats = addon.getChannelStats();
+            assert.equal(stats.n2rSlabs, 4);
+            assert.equal(stats.leasesGranted, 3);
+            assert.equal(stats.leaseWait.count, 3);
+        });
+
+        it('should fail a lease once every slab is in use', () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { n2rSlabs: 2 });
+            assert.equal(addon.triggerTestCallback(8), 0);
+            assert.equal(addon.triggerTestCallback(8), 0);
+            assert.equal(addon.triggerTestCallback(8), -2, 'Third lease should time out');
+            assert.equal(addon.getChannelStats().leaseFailures, 1);
+        });
+
+        it('should reject a slab count that does not fit', () => {
+            assert.throws(
+                () => addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { n2rSlabs: 64 }),
+                RangeError
+            );
+        });
+    });
+
+    // -----------------------------------------------------------------------
+    // 12. Plugin Dispatch Queue
+    // -----------------------------------------------------------------------
+    describe('Plugin Dispatch Queue', () => {
+        it('should release R2N_SIGNAL and hand messages to a worker', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { dispatchWorkers: 1, dispatchQueueDepth: 4 });
+
+            for (let i = 0; i < 3; i++) {
+                dataR2N.set([0x40 + i, 1, 2, 3], 0);
+                control[R2N_LENGTH] = 4;
+                control[R2N_SIGNAL] = 1;
+                addon.notifyNative();
+                assert.ok(await pollUntil(() => control[R2N_SIGNAL] === 0, 3000), `Message ${i} should be released`);
+            }
+
+            assert.ok(await pollUntil(() => addon.getChannelStats().dispatch.processed === 3, 3000));
+            const dispatch = addon.getChannelStats().dispatch;
+            assert.equal(dispatch.workers, 1);
+            assert.equal(dispatch.capacity, 4);
+            assert.equal(dispatch.enqueued, 3);
+            assert.equal(dispatch.depth, 0);
+            assert.equal(dispatch.queueLatency.count, 3);
+        });
+
+        it('should stay inline unless workers are requested', () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE);
+            assert.equal(addon.getChannelStats().dispatch.workers, 0);
+        });
+
+        it('should reject a zero queue depth', () => {
+            assert.throws(
+                () => addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { dispatchWorkers: 1, dispatchQueueDepth: 0 }),
+                RangeError
+            );
+        });
+    });
+
+    // -----------------------------------------------------------------------
+    // 13. Host Timers
+    // -----------------------------------------------------------------------
+    describe('Host Timers', () => {
+        it('should run the update timer at updateIntervalMs', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { updateIntervalMs: 5 });
+            const before = addon.getChannelStats().timers;
+            assert.ok(before.active >= 1, 'update timer should be scheduled');
+            assert.ok(await pollUntil(() => addon.getChannelStats().timers.fired >= before.fired + 3, 3000));
+            assert.ok(addon.getChannelStats().timers.lateness.count > 0);
+        });
+
+        it('should not schedule a timer when updateIntervalMs is 0', async () => {
+            addon.setSharedBuffer(sab, R2N_SIZE, N2R_SIZE, { updateIntervalMs: 0 });
+            const { fired } = addon.getChannelStats().timers;
+            await new Promise(resolve => setTimeout(resolve, 50));
+            assert.equal(addon.getChannelStats().timers.fired, fired);
+        });
+    });
 });
 
 // ---------------------------------------------------------------------------
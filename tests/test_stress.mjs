@@ -132,6 +132,7 @@ describe('Stress Tests', { skip: !addonAvailable && 'native addon not built' },
             dataR2N.set(payload, 0);
             control[R2N_LENGTH] = payload.length;
             control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
 
             // Wait for native to consume
             const consumed = await pollUntil(() => control[R2N_SIGNAL] === 0, 5000);
@@ -169,6 +170,7 @@ describe('Stress Tests', { skip: !addonAvailable && 'native addon not built' },
         dataR2N.set(payload, 0);
         control[R2N_LENGTH] = payloadSize;
         control[R2N_SIGNAL] = 1;
+        addon.notifyNative();
 
         // Wait for native to consume it (signal resets to 0)
         const consumed = await pollUntil(() => control[R2N_SIGNAL] === 0, 10000);
@@ -244,6 +246,7 @@ describe('Stress Tests', { skip: !addonAvailable && 'native addon not built' },
             dataR2N.set(payload, 0);
             control[R2N_LENGTH] = payload.length;
             control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
 
             // Wait for native to reset the signal
             const reset = await pollUntil(() => control[R2N_SIGNAL] === 0, 5000);
@@ -285,6 +288,7 @@ describe('Stress Tests', { skip: !addonAvailable && 'native addon not built' },
             dataR2N.set(payload, 0);
             control[R2N_LENGTH] = payloadSize;
             control[R2N_SIGNAL] = 1;
+            addon.notifyNative();
 
             const consumed = await pollUntil(() => control[R2N_SIGNAL] === 0, 5000);
             assert.ok(consumed, `Native should consume message ${i}`);